@@ -313,6 +313,15 @@ public:
         timeStep =    opts.parse("-ts", 0.1, "timestep for clock-based simulations (ns)");
         saveTestSet = opts.parse("-save-test-set", std::string(), "save the test dataset to a "
                                                                   "specified location");
+        packCache =   opts.parse("-pack-cache", std::string(), "pack the stimuli pre-processed with "
+                                                               "the cacheable transformations in "
+                                                               "shards at the specified location "
+                                                               "(to be used as CachePath) and exit");
+        packPng =     opts.parse("-pack-png", "PNG compression of the 8 and 16 bits stimuli "
+                                              "with -pack-cache");
+        iniCache =    opts.parse("-ini-cache", std::string(), "cache the parsed INI file and the "
+                                                                "network topology at the specified "
+                                                                "location");
         load =        opts.parse("-l", std::string(), "start with a previously saved state from a "
                                                       "specified location");
         weights =     opts.parse("-w", std::string(), "start with weights imported from a specified "
@@ -394,6 +403,9 @@ public:
     bool exportNoCrossLayerEqualization;
     double timeStep;
     std::string saveTestSet;
+    std::string packCache;
+    bool packPng;
+    std::string iniCache;
     std::string load;
     std::string weights;
     bool ignoreNoExist;
@@ -2395,6 +2407,7 @@ int main(int argc, char* argv[]) try
 #endif
 
     Network net(opt.seed);
+    DeepNetGenerator::mIniCachePath = opt.iniCache;
     std::shared_ptr<DeepNet> deepNet
         = DeepNetGenerator::generate(net, opt.iniConfig);
     deepNet->initialize();
@@ -2404,6 +2417,13 @@ int main(int argc, char* argv[]) try
         std::exit(0);
     }
 
+    if (!opt.packCache.empty()) {
+        deepNet->getStimuliProvider()->packCache(opt.packCache,
+            Database::All,
+            (opt.packPng) ? StimuliShards::Png : StimuliShards::None);
+        std::exit(0);
+    }
+
 #ifdef CUDA
 #ifdef NVML
     if (opt.banMultiDevice && opt.learnEpoch > 0)
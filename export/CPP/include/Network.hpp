@@ -13,6 +13,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <limits>
 #include <stdexcept>
@@ -23,6 +24,14 @@
 
 #include "typedefs.h"
 
+#ifdef PROFILING
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#endif
+
 #define N2D2_THROW_OR_ABORT(ex, msg) throw ex(msg)
 #define N2D2_ALWAYS_INLINE __attribute__((always_inline))
 
@@ -55,6 +64,15 @@ public:
         double mean;
         unsigned long long int count;
     } RunningMean_T;
+    typedef unsigned long long int Cycle_T;
+
+#ifdef PROFILING
+    // The profiling trace file is owned by the network
+    Network() = default;
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+    ~Network();
+#endif
 
     template<typename Input_T, typename Output_T>
     void propagate(const Input_T* inputs, Output_T* outputs) const;
@@ -254,6 +272,35 @@ private:
         const WDATA_T* __restrict weights,
         const Rescaling_T& __restrict rescaling) const;
 
+    template<int NB_CHANNELS, 
+            int CHANNELS_HEIGHT, int CHANNELS_WIDTH,
+            int NB_OUTPUTS,
+            int OUTPUTS_HEIGHT, int OUTPUTS_WIDTH,
+            int WEIGHTS_BLOCK_SIZE,
+            ActivationFunction_T ACTIVATION,
+            // Memory mapping: inputs
+            int INPUT_MEM_CONT_OFFSET,
+            int INPUT_MEM_CONT_SIZE,
+            int INPUT_MEM_WRAP_OFFSET,
+            int INPUT_MEM_WRAP_SIZE,
+            int INPUT_MEM_STRIDE,
+            // Memory mapping: outputs
+            int OUTPUT_MEM_CONT_OFFSET,
+            int OUTPUT_MEM_CONT_SIZE,
+            int OUTPUT_MEM_WRAP_OFFSET,
+            int OUTPUT_MEM_WRAP_SIZE,
+            int OUTPUT_MEM_STRIDE,
+            typename Input_T, typename Output_T,
+            typename Index_T, typename Rescaling_T>
+    N2D2_ALWAYS_INLINE void fccellSparsePropagate(
+        const Input_T* __restrict inputs,
+        Output_T* __restrict outputs,
+        const BDATA_T* __restrict biasses,
+        const WDATA_T* __restrict weightsBlocks,
+        const unsigned int* __restrict weightsRowPtr,
+        const Index_T* __restrict weightsBlockIdx,
+        const Rescaling_T& __restrict rescaling) const;
+
     template<int NB_CHANNELS, 
             int CHANNELS_HEIGHT, int CHANNELS_WIDTH,
             int NB_OUTPUTS,
@@ -348,6 +395,10 @@ private:
 
 private:
     mutable std::map<std::string, double> cumulativeTiming;
+#ifdef PROFILING
+    mutable FILE* profilingFile = NULL;
+    mutable std::map<std::string, unsigned short> profilingIds;
+#endif
 
     template<typename Output_T>
     N2D2_ALWAYS_INLINE void concatenate(
@@ -480,9 +531,25 @@ private:
                                       const Tick_T& start,
                                       const Tick_T& end,
                                       RunningMean_T& timing) const;
+
+#ifdef PROFILING
+    N2D2_ALWAYS_INLINE Cycle_T cycles() const;
+    void profile(const char* name,
+                 Cycle_T start,
+                 Cycle_T end,
+                 unsigned long long int nbMacs,
+                 unsigned long long int nbBytes) const;
+#endif
 };
 }
 
+#ifdef PROFILING
+inline N2D2::Network::~Network() {
+    if (profilingFile != NULL)
+        fclose(profilingFile);
+}
+#endif
+
 template<typename Output_T>
 N2D2_ALWAYS_INLINE inline void N2D2::Network::concatenate(
     Output_T* __restrict /*outputs*/,
@@ -1246,6 +1313,68 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::fccellPropagate(
     }
 }
 
+template<int NB_CHANNELS, 
+         int CHANNELS_HEIGHT, int CHANNELS_WIDTH,
+         int NB_OUTPUTS,
+         int OUTPUTS_HEIGHT, int OUTPUTS_WIDTH,
+         int WEIGHTS_BLOCK_SIZE,
+         ActivationFunction_T ACTIVATION,
+         // Memory mapping: inputs
+         int INPUT_MEM_CONT_OFFSET,
+         int INPUT_MEM_CONT_SIZE,
+         int INPUT_MEM_WRAP_OFFSET,
+         int INPUT_MEM_WRAP_SIZE,
+         int INPUT_MEM_STRIDE,
+         // Memory mapping: outputs
+         int OUTPUT_MEM_CONT_OFFSET,
+         int OUTPUT_MEM_CONT_SIZE,
+         int OUTPUT_MEM_WRAP_OFFSET,
+         int OUTPUT_MEM_WRAP_SIZE,
+         int OUTPUT_MEM_STRIDE,
+         typename Input_T, typename Output_T,
+         typename Index_T, typename Rescaling_T>
+N2D2_ALWAYS_INLINE inline void N2D2::Network::fccellSparsePropagate(
+    const Input_T* __restrict inputs,
+    Output_T* __restrict outputs,
+    const BDATA_T* __restrict biasses,
+    const WDATA_T* __restrict weightsBlocks,
+    const unsigned int* __restrict weightsRowPtr,
+    const Index_T* __restrict weightsBlockIdx,
+    const Rescaling_T& __restrict rescaling) const
+{
+    static_assert(OUTPUTS_HEIGHT == 1, "Outputs height should be 1");
+    static_assert(OUTPUTS_WIDTH == 1, "Outputs width should be 1");
+    static_assert(OUTPUT_MEM_WRAP_SIZE == 0, "Output wrapping not supported");
+    static_assert(NB_CHANNELS % WEIGHTS_BLOCK_SIZE == 0,
+        "Weights blocks should not cross pixels");
+
+#pragma omp parallel for
+    for (int och = 0; och < NB_OUTPUTS; och++) {
+        SUM_T weightedSum = biasses[och];
+
+        // Only the non-zero weights blocks are stored
+        for (int b = weightsRowPtr[och]; b < (int)weightsRowPtr[och + 1]; ++b)
+        {
+            const int c = WEIGHTS_BLOCK_SIZE * (int)weightsBlockIdx[b];
+            const int iPos = c / NB_CHANNELS;
+            int iOffset = INPUT_MEM_STRIDE * iPos;
+
+            // Wrapping cannot occur in the middle of a pixel
+            if (INPUT_MEM_WRAP_SIZE > 0 && iOffset >= INPUT_MEM_CONT_SIZE) {
+                iOffset += INPUT_MEM_WRAP_OFFSET - INPUT_MEM_CONT_OFFSET
+                            - INPUT_MEM_CONT_SIZE;
+            }
+
+            macsOnRange<WEIGHTS_BLOCK_SIZE>(
+                inputs + iOffset + (c % NB_CHANNELS), 
+                weightsBlocks + b * WEIGHTS_BLOCK_SIZE, 
+                weightedSum);
+        }
+
+        outputs[och] = sat<Output_T>(weightedSum, och, ACTIVATION, rescaling);
+    }
+}
+
 template<typename Output_T>
 inline void N2D2::Network::saveOutputs(
     int NB_OUTPUTS,
@@ -1554,4 +1683,67 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::benchmark(const char* name,
     printf("%s timing = %.02f us -- %.02f us\n", name, timing.mean, cumMeanTiming);
 }
 
+#ifdef PROFILING
+N2D2_ALWAYS_INLINE inline N2D2::Network::Cycle_T N2D2::Network::cycles() const {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1000000000ULL * ts.tv_sec + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Append a sample to the "profiling.bin" binary trace, in native byte order:
+ * - file header: "N2D2PROF" (8 bytes);
+ * - cell record, before the first sample of a cell: 'C' (1 byte), cell ID
+ *   (uint16), name length (uint16), name (without the trailing '\0');
+ * - sample record: 'S' (1 byte), cell ID (uint16), cycles (uint64),
+ *   MACs (uint64), memory bytes (uint64).
+ * Cycles are TSC cycles on x86 and nanoseconds elsewhere.
+ */
+inline void N2D2::Network::profile(const char* name,
+                                   Cycle_T start,
+                                   Cycle_T end,
+                                   unsigned long long int nbMacs,
+                                   unsigned long long int nbBytes) const
+{
+    if (profilingFile == NULL) {
+        profilingFile = fopen("profiling.bin", "wb");
+
+        if (profilingFile == NULL) {
+            N2D2_THROW_OR_ABORT(std::runtime_error,
+                "Could not create profiling file: profiling.bin");
+        }
+
+        fwrite("N2D2PROF", 1, 8, profilingFile);
+    }
+
+    const std::map<std::string, unsigned short>::const_iterator it
+        = profilingIds.find(name);
+    uint16_t id;
+
+    if (it == profilingIds.end()) {
+        id = profilingIds.size();
+        profilingIds[name] = id;
+
+        const uint16_t length = strlen(name);
+
+        fputc('C', profilingFile);
+        fwrite(&id, sizeof(id), 1, profilingFile);
+        fwrite(&length, sizeof(length), 1, profilingFile);
+        fwrite(name, 1, length, profilingFile);
+    }
+    else
+        id = (*it).second;
+
+    const uint64_t sample[3] = {end - start, nbMacs, nbBytes};
+
+    fputc('S', profilingFile);
+    fwrite(&id, sizeof(id), 1, profilingFile);
+    fwrite(sample, sizeof(sample[0]), 3, profilingFile);
+}
+#endif
+
 #endif
@@ -105,7 +105,10 @@ protected:
     bool mInitialized;
     bool mStopStimulus;
 
-    std::vector<AerReadEvent> mAerData;
+    // Events of the AER stream loaded by loadAerStream() and the window
+    // between its start and stop times
+    AerStream mAerStream;
+    AerStream::Window mAerData;
 
 #ifdef CUDA
     // If CUDA activated use CudaTensor to enable CUDA spike generation
@@ -128,8 +131,8 @@ protected:
 #endif
     Tensor<std::pair<Time_T, int> > mNextEvent;
 
-    // With this iterator we avoid to iterate over all events in every tick
-    std::vector<AerReadEvent>::iterator mEventIterator;
+    // With this index we avoid to iterate over all events in every tick
+    std::size_t mEventIndex;
     Time_T mNextAerEventTime;
 
     Parameter<bool> mNoConversion;
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include "containers/Tensor.hpp"
+#include "third_party/half.hpp"
 
 namespace N2D2 {
 
@@ -66,6 +67,21 @@ namespace ConvCell_Frame_Kernels {
                      const T* beta,
                      Tensor<T>& outputs);
 
+    // Half precision forward, computed in single precision
+    template <>
+    void forward<half_float::half>(const half_float::half* alpha,
+                                   const Tensor<half_float::half>& inputs,
+                                   const Tensor<half_float::half>& sharedSynapses,
+                                   const Descriptor& desc,
+                                   const half_float::half* beta,
+                                   Tensor<half_float::half>& outputs,
+                                   const Tensor<bool>& maps);
+    template <>
+    void forwardBias<half_float::half>(const half_float::half* alpha,
+                                       const Tensor<half_float::half>& bias,
+                                       const half_float::half* beta,
+                                       Tensor<half_float::half>& outputs);
+
     // Backward
     template <class T>
     void backwardData(const T* alpha,
@@ -23,6 +23,7 @@
 
 #include "Cell_Frame.hpp"
 #include "ConvCell_Frame_Kernels.hpp"
+#include "DeconvCell_Frame_Kernels.hpp"
 #include "DeconvCell.hpp"
 #include "DeepNet.hpp"
 #include "Activation/TanhActivation_Frame.hpp"
@@ -0,0 +1,80 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_DECONVCELL_FRAME_KERNELS_H
+#define N2D2_DECONVCELL_FRAME_KERNELS_H
+
+#include "Cell/ConvCell_Frame_Kernels.hpp"
+#include "containers/Tensor.hpp"
+#include "third_party/half.hpp"
+
+namespace N2D2 {
+/**
+ * Transposed convolution kernels, computed with a GEMM between the weights
+ * and the inputs followed by a col2im scatter (forward), or an im2col gather
+ * of the output gradients followed by a GEMM (backward).
+ * The weights are (kernel width, kernel height, nb. outputs, nb. inputs),
+ * the maps are (nb. outputs, nb. inputs) and the descriptor subSample is
+ * ignored.
+*/
+namespace DeconvCell_Frame_Kernels {
+    typedef ConvCell_Frame_Kernels::Descriptor Descriptor;
+
+    // Forward
+    template <class T>
+    void forward(const T* alpha,
+                 const Tensor<T>& inputs,
+                 const Tensor<T>& sharedSynapses,
+                 const Descriptor& desc,
+                 const T* beta,
+                 Tensor<T>& outputs,
+                 const Tensor<bool>& maps = Tensor<bool>());
+
+    // Half precision forward, computed in single precision
+    template <>
+    void forward<half_float::half>(const half_float::half* alpha,
+                                   const Tensor<half_float::half>& inputs,
+                                   const Tensor<half_float::half>& sharedSynapses,
+                                   const Descriptor& desc,
+                                   const half_float::half* beta,
+                                   Tensor<half_float::half>& outputs,
+                                   const Tensor<bool>& maps);
+
+    // Backward
+    template <class T>
+    void backwardData(const T* alpha,
+                      const Tensor<T>& sharedSynapses,
+                      const Tensor<T>& diffInputs,
+                      const Descriptor& desc,
+                      const T* beta,
+                      Tensor<T>& diffOutputs,
+                      const Tensor<bool>& maps = Tensor<bool>());
+    template <class T>
+    void backwardFilter(const T* alpha,
+                        const Tensor<T>& inputs,
+                        const Tensor<T>& diffInputs,
+                        const Descriptor& desc,
+                        const T* beta,
+                        Tensor<T>& diffSharedSynapses,
+                        const Tensor<bool>& maps = Tensor<bool>());
+}
+}
+
+#endif // N2D2_DECONVCELL_FRAME_KERNELS_H
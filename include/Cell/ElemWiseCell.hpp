@@ -115,6 +115,9 @@ protected:
     std::vector<Float_T> mWeights;
     // Block shifts
     std::vector<Float_T> mShifts;
+    /// If true, accumulate the result in the first input buffer in
+    /// inference, when it is not read by any other cell
+    Parameter<bool> mInPlace;
 
 };
 }
@@ -70,8 +70,13 @@ public:
     virtual ~ElemWiseCell_Frame();
 
 protected:
+    bool canPropagateInPlace() const;
+
     Tensor<Float_T> mInterTerm;
     Tensor<unsigned int> mArgMax;
+    // Own outputs storage, restored when leaving the in-place mode
+    Tensor<Float_T> mOutputsStorage;
+    bool mInPlaceOutputs;
 
 private:
     static Registrar<ElemWiseCell> mRegistrar;
@@ -0,0 +1,366 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_LSTMCELL_FRAME_H
+#define N2D2_LSTMCELL_FRAME_H
+
+#include "Cell_Frame.hpp"
+#include "DeepNet.hpp"
+#include "LSTMCell.hpp"
+
+namespace N2D2 {
+/**
+ * CPU implementation of the LSTM cell.
+ * The free parameters are stored in the same packed layout as
+ * LSTMCell_Frame_CUDA (cuDNN layout), so that weights can be exchanged
+ * between the two implementations. For the computation, they are repacked
+ * per layer and direction in a gate-interleaved layout: for each input, the
+ * 4 gates x hidden size weights are contiguous.
+ * The input projection is computed for all the time steps at once, with a
+ * single GEMM per layer and direction. Only the recurrent projection is
+ * computed step by step, and is followed by the fused gates
+ * nonlinearities and cell/hidden states update.
+ * Only the forward pass is implemented.
+*/
+template <class T>
+class LSTMCell_Frame : public virtual LSTMCell, public Cell_Frame<T> {
+public:
+    using Cell_Frame<T>::mInputs;
+    using Cell_Frame<T>::mOutputs;
+    using Cell_Frame<T>::mDiffInputs;
+    using Cell_Frame<T>::mDiffOutputs;
+    using Cell_Frame<T>::addInput;
+
+    LSTMCell_Frame(const DeepNet& deepNet, const std::string& name,
+                   unsigned int seqLength,
+                   unsigned int batchSize,
+                   unsigned int inputDim,
+                   unsigned int numberLayers,
+                   unsigned int hiddenSize,
+                   unsigned int algo,
+                   unsigned int nbOutputs,
+                   unsigned int bidirectional,
+                   unsigned int inputMode,
+                   float dropout,
+                   bool singleBackpropFeeding);
+    static std::shared_ptr<LSTMCell>
+    create(Network& /*net*/, const DeepNet& deepNet,
+           const std::string& name,
+           unsigned int seqLength,
+           unsigned int batchSize,
+           unsigned int inputDim,
+           unsigned int numberLayers,
+           unsigned int hiddenSize,
+           unsigned int algo,
+           unsigned int nbOutputs,
+           unsigned int bidirectional,
+           unsigned int inputMode,
+           float dropout,
+           bool singleBackpropFeeding)
+    {
+        return std::make_shared<LSTMCell_Frame>(deepNet, name,
+                                                seqLength,
+                                                batchSize,
+                                                inputDim,
+                                                numberLayers,
+                                                hiddenSize,
+                                                algo,
+                                                nbOutputs,
+                                                bidirectional,
+                                                inputMode,
+                                                dropout,
+                                                singleBackpropFeeding);
+    }
+
+    virtual void initialize();
+    virtual void propagate(bool inference = false);
+    virtual void backPropagate();
+    virtual void update();
+    void checkGradient(double /*epsilon*/ = 1.0e-4,
+                       double /*maxError*/ = 1.0e-6) {};
+
+    virtual void addInput(Cell* cell,
+                          const Tensor<bool>& mapping = Tensor<bool>());
+    virtual void addInput(StimuliProvider& sp,
+                          unsigned int x0,
+                          unsigned int y0,
+                          unsigned int width,
+                          unsigned int height,
+                          const Tensor<bool>& mapping);
+
+    inline std::shared_ptr<Tensor<T> > getmhx()
+    {
+        return mhx;
+    };
+    inline std::shared_ptr<Tensor<T> > getmcx()
+    {
+        return mcx;
+    };
+    inline const Tensor<T>& getmhy() const
+    {
+        return mhy;
+    };
+    inline const Tensor<T>& getmcy() const
+    {
+        return mcy;
+    };
+
+    void setWeights(const std::shared_ptr<Tensor<T> >& weights);
+    inline std::shared_ptr<Tensor<T> > getWeights()
+    {
+        // The weights may be modified through the returned pointer
+        mPackedValid = false;
+        return mWeights;
+    };
+    inline void setBoolContinousBatch(bool val)
+    {
+        mContinousBatch = val;
+    };
+
+    void getWeightPLIG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 0), value);
+    };
+    void getWeightPLFG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 1), value);
+    };
+    void getWeightPLCG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 2), value);
+    };
+    void getWeightPLOG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 3), value);
+    };
+
+    void getWeightPLIG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 0), value);
+    };
+    void getWeightPLFG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 1), value);
+    };
+    void getWeightPLCG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 2), value);
+    };
+    void getWeightPLOG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 3), value);
+    };
+
+    void getWeightRIG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 4), value);
+    };
+    void getWeightRFG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 5), value);
+    };
+    void getWeightRCG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 6), value);
+    };
+    void getWeightROG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 7), value);
+    };
+
+    void getBiasPLIG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 0), value);
+    };
+    void getBiasPLFG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 1), value);
+    };
+    void getBiasPLCG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 2), value);
+    };
+    void getBiasPLOG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 3), value);
+    };
+
+    void getBiasRIG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 4), value);
+    };
+    void getBiasRFG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 5), value);
+    };
+    void getBiasRCG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 6), value);
+    };
+    void getBiasROG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value) const
+    {
+        getParameter(getBiasPosition(hiddenidx, nlbidir, 7), value);
+    };
+
+    virtual ~LSTMCell_Frame() {};
+
+protected:
+    void setWeightPLIG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 0), value);
+    };
+    void setWeightPLFG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 1), value);
+    };
+    void setWeightPLCG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 2), value);
+    };
+    void setWeightPLOG_1stLayer(unsigned int inputidx, unsigned int hiddenidx, unsigned int bidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition_1stLayer(inputidx, hiddenidx, bidir, 3), value);
+    };
+
+    void setWeightPLIG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 0), value);
+    };
+    void setWeightPLFG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 1), value);
+    };
+    void setWeightPLCG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 2), value);
+    };
+    void setWeightPLOG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getInputWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 3), value);
+    };
+
+    void setWeightRIG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 4), value);
+    };
+    void setWeightRFG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 5), value);
+    };
+    void setWeightRCG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 6), value);
+    };
+    void setWeightROG(unsigned int channelhiddenidx, unsigned int outputhiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getRecurrentWeightPosition(channelhiddenidx, outputhiddenidx, nlbidir, 7), value);
+    };
+
+    void setBiasPLIG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 0), value);
+    };
+    void setBiasPLFG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 1), value);
+    };
+    void setBiasPLCG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 2), value);
+    };
+    void setBiasPLOG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 3), value);
+    };
+
+    void setBiasRIG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 4), value);
+    };
+    void setBiasRFG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 5), value);
+    };
+    void setBiasRCG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 6), value);
+    };
+    void setBiasROG(unsigned int hiddenidx, unsigned int nlbidir, BaseTensor& value)
+    {
+        setParameter(getBiasPosition(hiddenidx, nlbidir, 7), value);
+    };
+
+    /// Same layout as LSTMCell_Frame_CUDA::getStartPosition()
+    /// Each gate matrix is [output hidden][input], row-major, which is the
+    /// layout used by packWeights().
+    unsigned int getStartPosition(unsigned int layer,
+                                  unsigned int gate,
+                                  bool weight) const;
+    unsigned int getInputWeightPosition_1stLayer(unsigned int inputidx,
+                                                 unsigned int hiddenidx,
+                                                 unsigned int bidir,
+                                                 unsigned int gate) const;
+    unsigned int getInputWeightPosition(unsigned int channelhiddenidx,
+                                        unsigned int outputhiddenidx,
+                                        unsigned int nlbidir,
+                                        unsigned int gate) const;
+    unsigned int getRecurrentWeightPosition(unsigned int channelhiddenidx,
+                                            unsigned int outputhiddenidx,
+                                            unsigned int nlbidir,
+                                            unsigned int gate) const;
+    unsigned int getBiasPosition(unsigned int hiddenidx,
+                                 unsigned int nlbidir,
+                                 unsigned int gate) const;
+    void getParameter(unsigned int pos, BaseTensor& value) const;
+    void setParameter(unsigned int pos, BaseTensor& value);
+    void packWeights();
+
+    // Free parameters, in the LSTMCell_Frame_CUDA (cuDNN) layout
+    std::shared_ptr<Tensor<T> > mWeights;
+    // Packed parameters, per layer and direction:
+    // input weights [inputSize][4 x mHiddenSize]
+    std::vector<std::vector<T> > mPackedInputWeights;
+    // recurrent weights [mHiddenSize][4 x mHiddenSize]
+    std::vector<std::vector<T> > mPackedRecurrentWeights;
+    // sum of the input and recurrent biases [4 x mHiddenSize]
+    std::vector<std::vector<T> > mPackedBias;
+    bool mPackedValid;
+
+    std::shared_ptr<Tensor<T> > mhx;
+    std::shared_ptr<Tensor<T> > mcx;
+    Tensor<T> mhy;
+    Tensor<T> mcy;
+    Tensor<T> mOutputsLocal;
+
+    // Work buffers
+    std::vector<T> mGates;
+    std::vector<T> mLayerOutputs[2];
+    std::vector<T> mHidden;
+    std::vector<T> mCellState;
+
+    mutable bool mContinousBatch;
+    unsigned int biDirScale = (mBidirectional ? 2 : 1);
+
+private:
+    static Registrar<LSTMCell> mRegistrar;
+};
+}
+
+#endif // N2D2_LSTMCELL_FRAME_H
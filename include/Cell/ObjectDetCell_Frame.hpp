@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "Cell_Frame.hpp"
+#include "ComputerVision/NMS.hpp"
 #include "DeepNet.hpp"
 #include "ObjectDetCell.hpp"
 
@@ -97,6 +98,7 @@ protected:
     Tensor<Float_T> mPartsPrediction;
     Tensor<Float_T> mTemplatesPrediction;
     std::vector<AnchorCell_Frame_Kernels::Anchor> mAnchors;
+    ComputerVision::NMS mNMS;
 
 private:
     static Registrar<ObjectDetCell> mRegistrar;
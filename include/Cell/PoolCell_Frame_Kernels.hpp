@@ -22,6 +22,7 @@
 #define N2D2_POOLCELL_FRAME_KERNELS_H
 
 #include "PoolCell_Frame_Kernels_struct.hpp"
+#include "third_party/half.hpp"
 
 namespace N2D2 {
 namespace PoolCell_Frame_Kernels {
@@ -46,6 +47,17 @@ namespace PoolCell_Frame_Kernels {
                     bool useArgMax = false,
                     const Tensor<bool>& maps = Tensor<bool>());
 
+    // Half precision average pooling, computed in single precision
+    template <>
+    void forwardAverage<half_float::half>(const half_float::half* alpha,
+                                          const Tensor<half_float::half>& inputs,
+                                          const Descriptor& desc,
+                                          const half_float::half* beta,
+                                          Tensor<half_float::half>& outputs,
+                                          bool isQuantized,
+                                          bool countIncludePadding,
+                                          const Tensor<bool>& maps);
+
     // Backward
     template <class T>
     void backwardAverage(const T* alpha,
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "Cell_Frame.hpp"
+#include "ComputerVision/NMS.hpp"
 #include "DeepNet.hpp"
 #include "ProposalCell.hpp"
 
@@ -99,6 +100,8 @@ public:
 protected:
     virtual void setOutputsDims();
 
+    ComputerVision::NMS mNMS;
+
 private:
     static Registrar<ProposalCell> mRegistrar;
 };
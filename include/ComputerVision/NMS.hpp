@@ -0,0 +1,168 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_COMPUTERVISION_NMS_H
+#define N2D2_COMPUTERVISION_NMS_H
+
+#include <vector>
+
+namespace N2D2 {
+namespace ComputerVision {
+    /**
+     * Non-Maximum Suppression (NMS) engine, shared by the detection cells.
+     * Boxes are stored as structure-of-arrays (x0, y0, x1, y1, area, score),
+     * so that the IoU of a selected box against all the remaining candidates
+     * is computed in a single branch-free, vectorizable loop.
+     * Boxes of different classes never suppress each other: multi-class
+     * inputs are grouped by class and each class is processed independently
+     * (in parallel when OpenMP is available).
+     * The internal buffers are kept between calls, in order to avoid any
+     * memory allocation when the engine is reused for each frame.
+    */
+    class NMS {
+    public:
+        enum Method {
+            // Classical greedy NMS: a box is removed if its IoU with an
+            // already selected box is above the IoU threshold
+            Greedy,
+            // Soft-NMS with linear score decay (1 - IoU) above the threshold
+            SoftLinear,
+            // Soft-NMS with gaussian score decay exp(-IoU^2 / sigma)
+            SoftGaussian
+        };
+
+        NMS(double IoUThreshold = 0.5,
+            Method method = Greedy,
+            double sigma = 0.5,
+            double scoreThreshold = 0.001);
+
+        void setIoUThreshold(double IoUThreshold)
+        {
+            mIoUThreshold = IoUThreshold;
+        };
+        void setMethod(Method method)
+        {
+            mMethod = method;
+        };
+
+        /// Remove all the boxes (the allocated memory is kept)
+        void clear();
+        void reserve(unsigned int size);
+
+        /**
+         * Add a box, in (x, y, w, h) format.
+         *
+         * @param x             Left coordinate
+         * @param y             Top coordinate
+         * @param w             Width
+         * @param h             Height
+         * @param score         Box score (used for the ordering)
+         * @param cls           Box class
+         * @return Index of the box, to be matched against the getKept() list
+        */
+        unsigned int push_back(float x,
+                               float y,
+                               float w,
+                               float h,
+                               float score = 1.0f,
+                               int cls = 0);
+
+        /**
+         * Apply NMS on the current set of boxes.
+         *
+         * @param maxKeep       Maximum number of boxes kept per class (0 =
+         *no limit). With greedy NMS, only the top-scored candidates are
+         *sorted, as needed to select @p maxKeep boxes.
+         * @param sortByScore   If false, greedy NMS processes the boxes in
+         *insertion order instead of decreasing score order. Soft-NMS always
+         *processes the boxes by decreasing (decayed) score.
+         * @return Indexes of the selected boxes, grouped by increasing class
+         *and, within a class, in selection order
+        */
+        const std::vector<unsigned int>& process(unsigned int maxKeep = 0,
+                                                 bool sortByScore = true);
+
+        unsigned int size() const
+        {
+            return mScore.size();
+        };
+        const std::vector<unsigned int>& getKept() const
+        {
+            return mKept;
+        };
+        /// Box score, after decay in the case of soft-NMS
+        float getScore(unsigned int index) const
+        {
+            return mScore[index];
+        };
+        int getCls(unsigned int index) const
+        {
+            return mCls[index];
+        };
+
+        /// IoU between two boxes in (x, y, w, h) format
+        static float IoU(float x0, float y0, float w0, float h0,
+                         float x1, float y1, float w1, float h1);
+
+    private:
+        void groupByClass();
+        void processGreedy(unsigned int begin,
+                           unsigned int end,
+                           unsigned int maxKeep,
+                           bool sortByScore,
+                           std::vector<unsigned int>& kept);
+        void processSoft(unsigned int begin,
+                         unsigned int end,
+                         unsigned int maxKeep,
+                         std::vector<unsigned int>& kept);
+
+        double mIoUThreshold;
+        Method mMethod;
+        double mSigma;
+        double mScoreThreshold;
+
+        // Boxes, in insertion order
+        std::vector<float> mX0;
+        std::vector<float> mY0;
+        std::vector<float> mX1;
+        std::vector<float> mY1;
+        std::vector<float> mScore;
+        std::vector<int> mCls;
+
+        // Working set, grouped by class
+        std::vector<float> mWX0;
+        std::vector<float> mWY0;
+        std::vector<float> mWX1;
+        std::vector<float> mWY1;
+        std::vector<float> mWArea;
+        std::vector<float> mWScore;
+        std::vector<unsigned int> mWIndex;
+        std::vector<unsigned char> mWRemoved;
+        std::vector<unsigned int> mWOrder;
+        // Class group boundaries in the working set
+        std::vector<unsigned int> mGroups;
+        std::vector<std::vector<unsigned int> > mGroupKept;
+
+        std::vector<unsigned int> mKept;
+    };
+}
+}
+
+#endif // N2D2_COMPUTERVISION_NMS_H
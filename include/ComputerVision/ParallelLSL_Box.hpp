@@ -0,0 +1,265 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_COMPUTERVISION_PARALLELLSL_BOX_H
+#define N2D2_COMPUTERVISION_PARALLELLSL_BOX_H
+
+#include <algorithm>
+#include <vector>
+
+#include "ComputerVision/ROI.hpp"
+#include "containers/Matrix.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace N2D2 {
+namespace ComputerVision {
+    /**
+     * Tile-parallel variant of the LSL_Box labeling, for multi-label maps.
+     * The frame is split in horizontal tiles, which are labeled concurrently
+     * by segments (runs of identical, non-zero values) with a local
+     * union-find. The tiles are then merged with a global union-find across
+     * the tiles boundaries.
+     * The produced ROIs are the 8-connected components of each class, in the
+     * same order as LSL_Box::process(const Matrix<T>&) (by class, then in
+     * raster order of the first segment of each component), but all the
+     * classes are processed in a single pass.
+     * All the buffers are kept between calls, so that an instance can be
+     * reused for each frame without memory allocation.
+    */
+    class ParallelLSL_Box {
+    public:
+        ParallelLSL_Box(unsigned int minSize = 0,
+                        unsigned int minTileHeight = 64)
+            : mMinSize(minSize),
+              mMinTileHeight(minTileHeight)
+        {
+        }
+        void setMinSize(unsigned int minSize)
+        {
+            mMinSize = minSize;
+        };
+        template <class T> void process(const Matrix<T>& frame);
+        /**
+         * Process a row-major frame.
+         *
+         * @param frame         Frame data (height x width values)
+         * @param width         Frame width
+         * @param height        Frame height
+        */
+        template <class T>
+        void process(const T* frame, unsigned int width, unsigned int height);
+        const std::vector<ROI::Roi_T>& getRoi() const
+        {
+            return mRoi;
+        };
+        std::vector<ROI::Roi_T>& roi()
+        {
+            return mRoi;
+        };
+
+    private:
+        struct Segment_T {
+            unsigned int i;
+            unsigned int j0;
+            unsigned int j1;
+            int cls;
+        };
+
+        template <class T>
+        void labelTile(const T* frame,
+                       unsigned int width,
+                       unsigned int tile,
+                       unsigned int rowBegin,
+                       unsigned int rowEnd);
+        void mergeTiles();
+        template <class T>
+        void filterMinSize(const T* frame, unsigned int width);
+
+        static unsigned int find(std::vector<unsigned int>& parent,
+                                 unsigned int label);
+        static void unite(std::vector<unsigned int>& parent,
+                          unsigned int labelA,
+                          unsigned int labelB);
+        static void connect(std::vector<unsigned int>& parent,
+                            const std::vector<Segment_T>& prevSegments,
+                            unsigned int prevBegin,
+                            unsigned int prevEnd,
+                            unsigned int prevOffset,
+                            const std::vector<Segment_T>& curSegments,
+                            unsigned int curBegin,
+                            unsigned int curEnd,
+                            unsigned int curOffset);
+
+        unsigned int mMinSize;
+        unsigned int mMinTileHeight;
+
+        // Per-tile segments, index of the first segment of each row and local
+        // equivalence table
+        std::vector<std::vector<Segment_T> > mTileSegments;
+        std::vector<std::vector<unsigned int> > mTileRowBegin;
+        std::vector<std::vector<unsigned int> > mTileParent;
+        // Global equivalence table
+        std::vector<unsigned int> mParent;
+        std::vector<unsigned int> mTileOffset;
+        std::vector<int> mComponent;
+        // Extracted ROIs
+        std::vector<ROI::Roi_T> mRoi;
+    };
+}
+}
+
+template <class T>
+void N2D2::ComputerVision::ParallelLSL_Box::process(const Matrix<T>& frame)
+{
+    process(&frame.data()[0], frame.cols(), frame.rows());
+}
+
+template <class T>
+void N2D2::ComputerVision::ParallelLSL_Box::process(const T* frame,
+                                                    unsigned int width,
+                                                    unsigned int height)
+{
+    const unsigned int maxTiles = std::max(1U, height / mMinTileHeight);
+    unsigned int nbTiles = 1;
+
+#ifdef _OPENMP
+    if (!omp_in_parallel())
+        nbTiles = std::min(maxTiles, (unsigned int)omp_get_max_threads());
+#endif
+
+    const unsigned int tileHeight = (height + nbTiles - 1) / nbTiles;
+
+    if (mTileSegments.size() < nbTiles) {
+        mTileSegments.resize(nbTiles);
+        mTileRowBegin.resize(nbTiles);
+        mTileParent.resize(nbTiles);
+    }
+
+    mTileOffset.resize(nbTiles + 1);
+
+#pragma omp parallel for schedule(static) if (nbTiles > 1)
+    for (int tile = 0; tile < (int)nbTiles; ++tile) {
+        const unsigned int rowBegin = std::min(height, tile * tileHeight);
+        const unsigned int rowEnd = std::min(height, rowBegin + tileHeight);
+
+        labelTile(frame, width, tile, rowBegin, rowEnd);
+    }
+
+    mTileOffset[0] = 0;
+
+    for (unsigned int tile = 0; tile < nbTiles; ++tile) {
+        mTileOffset[tile + 1] = mTileOffset[tile]
+                                + mTileSegments[tile].size();
+    }
+
+    mergeTiles();
+
+    if (mMinSize > 0)
+        filterMinSize(frame, width);
+}
+
+template <class T>
+void N2D2::ComputerVision::ParallelLSL_Box::labelTile(const T* frame,
+                                                      unsigned int width,
+                                                      unsigned int tile,
+                                                      unsigned int rowBegin,
+                                                      unsigned int rowEnd)
+{
+    std::vector<Segment_T>& segments = mTileSegments[tile];
+    std::vector<unsigned int>& rowSegBegin = mTileRowBegin[tile];
+    std::vector<unsigned int>& parent = mTileParent[tile];
+
+    segments.clear();
+    rowSegBegin.clear();
+    parent.clear();
+
+    for (unsigned int i = rowBegin; i < rowEnd; ++i) {
+        const T* line = frame + (size_t)i * width;
+        const unsigned int curBegin = segments.size();
+
+        rowSegBegin.push_back(curBegin);
+
+        // Step #1: segments (runs of identical non-zero values) extraction
+        for (unsigned int j = 0; j < width; ) {
+            const T value = line[j];
+            const unsigned int j0 = j;
+
+            while (j < width && line[j] == value)
+                ++j;
+
+            if (value != 0) {
+                Segment_T segment;
+                segment.i = i;
+                segment.j0 = j0;
+                segment.j1 = j - 1;
+                segment.cls = (int)value;
+
+                segments.push_back(segment);
+                parent.push_back(parent.size());
+            }
+        }
+
+        // Step #2: equivalences with the previous line of the tile
+        if (i > rowBegin) {
+            connect(parent,
+                    segments, rowSegBegin[i - rowBegin - 1], curBegin, 0,
+                    segments, curBegin, segments.size(), 0);
+        }
+    }
+
+    rowSegBegin.push_back(segments.size());
+}
+
+template <class T>
+void N2D2::ComputerVision::ParallelLSL_Box::filterMinSize(const T* frame,
+                                                          unsigned int width)
+{
+    // Same criterion (and bounds) as LSL_Box: number of pixels of the class
+    // within the ROI
+    std::vector<char> keep(mRoi.size(), true);
+
+#pragma omp parallel for schedule(dynamic) if (mRoi.size() > 16)
+    for (int k = 0; k < (int)mRoi.size(); ++k) {
+        unsigned int size = 0;
+
+        for (unsigned int i = mRoi[k].i0; i < mRoi[k].i1; ++i) {
+            const T* line = frame + (size_t)i * width;
+
+            for (unsigned int j = mRoi[k].j0; j < mRoi[k].j1; ++j)
+                size += ((int)line[j] == mRoi[k].cls);
+        }
+
+        keep[k] = (size >= mMinSize);
+    }
+
+    unsigned int nbKept = 0;
+
+    for (unsigned int k = 0; k < mRoi.size(); ++k) {
+        if (keep[k])
+            mRoi[nbKept++] = mRoi[k];
+    }
+
+    mRoi.erase(mRoi.begin() + nbKept, mRoi.end());
+}
+
+#endif // N2D2_COMPUTERVISION_PARALLELLSL_BOX_H
@@ -0,0 +1,111 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_COMPUTERVISION_REALTIMEGAUSSIANMIXTURE_H
+#define N2D2_COMPUTERVISION_REALTIMEGAUSSIANMIXTURE_H
+
+#include <vector>
+
+#include "ComputerVision/ROI.hpp"
+#include "containers/Matrix.hpp"
+#include "utils/Parameterizable.hpp"
+
+namespace N2D2 {
+namespace ComputerVision {
+    /**
+     * Real-time (streaming) mode of the GaussianMixture background model.
+     * The model is the same, with the same parameters, but:
+     * - the mixtures are stored in single precision, as structure-of-arrays
+     *   (one plane of w, mu and sigma per gaussian), so that each step is a
+     *   vectorizable loop over the pixels;
+     * - the classification and the model update are fused in a single pass
+     *   over the frame (see process());
+     * - the gaussians are never physically sorted by w/sigma: the ranks
+     *   required for the matching and the background selection are computed
+     *   on the fly, which is branch-free for small K.
+     * As in Stauffer & Grimson, a pixel that matches no distribution is
+     * classified as foreground.
+     * The model file format is the same as GaussianMixture.
+    */
+    class RealTimeGaussianMixture : public Parameterizable {
+    public:
+        RealTimeGaussianMixture(unsigned int k);
+
+        /**
+         * Classify the pixels of a new frame and update the model, in a
+         * single pass.
+         * The pixels excluded with excludeRoi() since the previous call are
+         * classified but not learned.
+         *
+         * @param frame         Frame, values in [0, 1]
+         * @return Foreground mask (1 = foreground)
+        */
+        Matrix<unsigned char> process(const Matrix<float>& frame);
+        /**
+         * Same as process(const Matrix<float>&), on row-major buffers.
+         *
+         * @param frame         Frame data (height x width values in [0, 1])
+         * @param width         Frame width
+         * @param height        Frame height
+         * @param foreground    Foreground mask output (height x width)
+        */
+        void process(const float* frame,
+                     unsigned int width,
+                     unsigned int height,
+                     unsigned char* foreground);
+        /// Exclude a ROI (inclusive bounds) from the next model update
+        void excludeRoi(const ROI::Roi_T& roi);
+        Matrix<float> getBaseBackground(unsigned int level = 0) const;
+        void load(const std::string& fileName, bool ignoreNotExists = false);
+        void save(const std::string& fileName) const;
+
+    private:
+        void initialize(unsigned int width, unsigned int height);
+        template <unsigned int K>
+        void processKernel(const float* frame, unsigned char* foreground);
+
+        /// Learning rate
+        Parameter<double> mAlpha;
+        /// A match is defined as a pixel value within mMatchThreshold standard
+        /// deviations of a distribution
+        Parameter<double> mMatchThreshold;
+        /// Measure of the minimum portion of the data that should be accounted
+        /// for by the background
+        Parameter<double> mBackgroundPortion;
+        /// Initial sigma (should be high), variance = sigma^2
+        Parameter<double> mSigmaInit;
+        /// Minimal sigma / low sigma threshold, variance = sigma^2
+        Parameter<double> mSigmaMin;
+
+        // Number of gaussian per pixel in the gaussian mixture model
+        unsigned int mK;
+        unsigned int mWidth;
+        unsigned int mHeight;
+        // Gaussian mixture model storage: mK planes of width x height values
+        std::vector<float> mW;
+        std::vector<float> mMu;
+        std::vector<float> mSigma;
+        // Pixels excluded from the next update
+        std::vector<unsigned char> mExcluded;
+    };
+}
+}
+
+#endif // N2D2_COMPUTERVISION_REALTIMEGAUSSIANMIXTURE_H
@@ -23,6 +23,7 @@
 #define N2D2_AER_DATABASE_H
 
 #include "Database.hpp"
+#include "Xnet/AerStream.hpp"
 #include "Xnet/Network.hpp"
 
 namespace N2D2 {
@@ -56,6 +57,17 @@ public:
                                           StimulusID id,
                                           unsigned int batch)=0;
 
+    /**
+     * Decode the events of a stimulus into @p stream, without conversion to
+     * AerReadEvent. Time windows can then be taken with
+     * AerStream::getWindow().
+     *
+     * @exception std::runtime_error Not supported by the database
+    */
+    virtual void loadAerStimulusStream(AerStream& stream,
+                                       StimuliSet set,
+                                       StimulusID id);
+
     virtual ~AER_Database(){};
 
 protected:
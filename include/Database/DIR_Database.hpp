@@ -52,16 +52,62 @@ public:
                          int depth = 0,
                          const std::string& labelName = "",
                          int labelDepth = 0);
+
+    /**
+     * Same as successive loadDir() calls for each directory of @p dirPaths,
+     * with the corresponding label name of @p labelNames, but all the
+     * directories are indexed in parallel.
+     * If the ManifestPath parameter is set, the directory index is saved in
+     * a manifest file in this directory and reused as long as the
+     * modification time of every indexed directory is unchanged.
+    */
+    virtual void loadDirs(const std::vector<std::string>& dirPaths,
+                          int depth,
+                          const std::vector<std::string>& labelNames,
+                          int labelDepth);
     virtual StimulusID loadFile(const std::string& fileName);
     virtual StimulusID loadFile(const std::string& fileName,
                           const std::string& labelName);
     virtual ~DIR_Database() {};
 
 protected:
+    /// Content of a directory, as listed by scanDir()
+    struct DirIndex {
+        std::string path;
+        int depth;
+        std::string labelName;
+        int labelDepth;
+        // Modification time of the directory, used to validate manifests
+        long long int time;
+        // Sorted list of the valid stimuli
+        std::vector<std::string> files;
+        // Sub-directories to load, as indexes in the DirIndex vector
+        std::vector<std::size_t> subDirs;
+        // Notices issued during the scan, displayed when loading
+        std::string log;
+        // Non-empty if the directory could not be opened
+        std::string error;
+    };
+
     virtual StimulusID loadFile(const std::string& fileName, int label);
+    void indexDirs(std::vector<DirIndex>& index) const;
+    void scanDir(DirIndex& dir, std::vector<std::string>& subDirs) const;
+    void loadDirIndex(const std::vector<DirIndex>& index, std::size_t dir);
+    std::string getManifestKey(const std::vector<DirIndex>& index) const;
+    bool loadManifest(const std::string& fileName,
+                      const std::string& key,
+                      std::vector<DirIndex>& index) const;
+    void saveManifest(const std::string& fileName,
+                      const std::string& key,
+                      const std::vector<DirIndex>& index) const;
 
     std::vector<std::string> mIgnoreMasks;
     std::vector<std::string> mValidExtensions;
+
+    // Parameters
+    /// Directory where directory index manifests are stored (disabled if
+    /// empty)
+    Parameter<std::string> mManifestPath;
 };
 }
 
@@ -40,6 +40,11 @@ public:
 
 protected:
     void loadLabels(const std::string& labelPath);
+    /// Read only the categories of a label file, when loading
+    static std::vector<std::string> parseLabelNames(
+        const std::string& fileName);
+    /// Parse a label file, on first access to the stimulus ROIs
+    static NamedROIs_T parseLabelFile(const std::string& fileName);
 
     double mLearn;
     bool mUseValidationForTest;
@@ -22,6 +22,9 @@
 #define N2D2_DATABASE_H
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -50,7 +53,9 @@
 #include "utils/Parameterizable.hpp"
 #include "utils/Utils.hpp"
 #include "utils/Registrar.hpp"
+#include "utils/MemoryMappedFile.hpp"
 #include "DataFile/DataFile.hpp"
+#include "Database/ROIPool.hpp"
 
 namespace N2D2 {
 
@@ -89,12 +94,19 @@ public:
         /// ROIs associated to the stimulus
         std::vector<ROI*> ROIs;
         ROI* slice;
+        /// Entry of the ROIs in the database ROIs pool, if they were moved
+        /// there (in which case ROIs is empty), or -1
+        int ROIsPoolEntry;
 
         Stimulus(const std::string& name_,
                  int label_ = -1,
                  const std::vector<ROI*>& ROIs_ = std::vector<ROI*>(),
                  ROI* slice_ = NULL)
-            : name(name_), label(label_), ROIs(ROIs_), slice(slice_)
+            : name(name_),
+              label(label_),
+              ROIs(ROIs_),
+              slice(slice_),
+              ROIsPoolEntry(-1)
         {
         }
     };
@@ -122,6 +134,12 @@ public:
         Combine
     };
 
+    /// ROIs of a stimulus with their label name, as returned by a deferred
+    /// ROIs loader. The ROIs label is ignored and an empty name gives the
+    /// label ID -1.
+    typedef std::vector<std::pair<std::string, ROI*> > NamedROIs_T;
+    typedef std::function<NamedROIs_T()> ROIsLoader_T;
+
     /**
      * This objects contains the list of stimuli in each database stimuli set.
      * There are 3 different stimuli sets possible;
@@ -147,6 +165,21 @@ public:
         inline const std::vector<StimulusID>& operator()(StimuliSet set) const;
     };
 
+    /**
+     * Per label index of a stimuli set, built on demand.
+    */
+    struct LabelIndex {
+        /// Stimuli having the label, either as stimulus label or as the label
+        /// of one of their ROIs, in the set order
+        std::vector<std::vector<StimulusID> > stimuli;
+        /// Number of stimuli having the label as stimulus label
+        std::vector<unsigned int> nbStimuli;
+        /// Number of ROIs having the label
+        std::vector<unsigned int> nbROIs;
+    };
+    /// Number of stimuli, number of labels and number of stimuli in each set
+    typedef std::array<std::size_t, Unpartitioned + 3> LabelIndexSizes_T;
+
     Database(bool loadDataInMemory = false);
     virtual void loadROIs(const std::string& fileName,
                           const std::string& relPath = "",
@@ -159,12 +192,12 @@ public:
                           const std::string& header = "") const;
     void logStats(const std::string& sizeFileName,
                   const std::string& labelFileName,
-                  StimuliSetMask setMask = All) const;
+                  StimuliSetMask setMask = All);
     void logROIsStats(const std::string& sizeFileName,
                       const std::string& labelFileName,
                       StimuliSetMask setMask = All) const;
     void logMultiChannelStats(const std::string& fileName,
-                              StimuliSetMask setMask = All) const;
+                              StimuliSetMask setMask = All);
 
     /**
      * Extract all the ROIs in stimuli as new stimuli and remove stimuli with no
@@ -302,6 +335,18 @@ public:
                                     StimuliSetMask setMask = All) const;
     inline unsigned int getNbROIsWithLabel(const std::string& labelName,
                                            StimuliSetMask setMask = All) const;
+
+    /**
+     * Returns the stimuli of a set having a label, either as stimulus label
+     * or as the label of one of their ROIs.
+     * The returned reference is invalidated by any change to the database.
+     *
+     * @param label         Label ID
+     * @param set           Set of stimuli
+     * @return Stimuli IDs, in the set order
+    */
+    const std::vector<StimulusID>& getStimuliWithLabel(int label,
+                                                       StimuliSet set) const;
     bool isLabel(const std::string& labelName) const;
     bool isMatchingLabel(const std::string& labelMask) const;
     int getLabelID(const std::string& labelName) const;
@@ -367,6 +412,43 @@ protected:
                           StimuliSet set);
     void removeIndexesFromSet(std::vector<unsigned int>& indexes,
                               StimuliSet set);
+    const LabelIndex& getLabelIndex(StimuliSet set) const;
+    LabelIndexSizes_T getLabelIndexSizes() const;
+    /// Must be called when the stimuli labels or ROIs are modified in place
+    /// (adding or partitioning stimuli is automatically detected)
+    inline void invalidateLabelIndex();
+    /// Move the ROIs of a stimulus to the ROIs pool, where they are stored in
+    /// a compact form. Stimuli with ROI types that cannot be pooled are left
+    /// untouched.
+    void poolStimulusROIs(StimulusID id);
+    /// Pool the ROIs of all the stimuli, starting from stimulus @p first
+    void poolROIs(StimulusID first = 0);
+    /// Move back all the pooled ROIs to their stimulus, as ROI objects. Must
+    /// be called before modifying the stimuli ROIs.
+    void unpoolROIs();
+    /// Parse the ROIs of a stimulus with @p loader on first access only, and
+    /// keep them in the ROIs pool. The label IDs of @p labelNames, the label
+    /// names of the ROIs gathered when indexing the annotations, are created
+    /// right away, so that the labels never depend on the parsing order and
+    /// the labels accessors never parse the ROIs. @p loader must only return
+    /// poolable ROIs, with one of these label names, and must not refer to
+    /// the database, which may be modified in between.
+    void deferStimulusROIs(StimulusID id,
+                           const std::vector<std::string>& labelNames,
+                           const ROIsLoader_T& loader);
+    /// Parse the ROIs of all the deferred stimuli
+    inline void loadDeferredROIs() const;
+    /// Read-only ROIs of a stimulus, whether they are pooled or not
+    ROIPool::ROIs_T getStimulusROIsRef(StimulusID id) const;
+    inline unsigned int getStimulusNbROIs(StimulusID id) const;
+    inline int getStimulusROILabel(StimulusID id, unsigned int index) const;
+    /// Pool entry of the ROIs of a stimulus, or -1, after parsing them if
+    /// they are deferred
+    inline int getROIsPoolEntry(StimulusID id) const;
+    void loadDeferredROIs(StimulusID id) const;
+    void parseDeferredROIs(StimulusID id);
+    /// Remove the ROIs of a stimulus from the ROIs pool
+    void releaseROIsPoolEntry(StimulusID id);
     void plotStats(
         const std::string& sizeFileName,
         const std::string& labelFileName,
@@ -416,6 +498,9 @@ protected:
     Parameter<std::string> mTargetDataPath;
     Parameter<std::string> mMultiChannelMatch;
     Parameter<std::vector<std::string> > mMultiChannelReplace;
+    /// Maximum number of stimuli with pooled ROIs that are kept as ROI
+    /// objects
+    Parameter<unsigned int> mROIsCacheSize;
 
     /**
      * TABLES
@@ -432,6 +517,23 @@ protected:
     std::vector<cv::Mat> mStimuliTargetData;
     /// Stimuli sets
     StimuliSets mStimuliSets;
+    /// Label indexes, for each stimuli set
+    mutable std::vector<LabelIndex> mLabelIndex;
+    /// Database sizes at the time the label indexes were built: number of
+    /// stimuli, number of labels and number of stimuli in each set
+    mutable LabelIndexSizes_T mLabelIndexSizes;
+    /// Checked without lock by getLabelIndex()
+    mutable std::atomic<bool> mLabelIndexValid;
+    /// Compact storage of the stimuli ROIs
+    ROIPool mROIPool;
+    /// Loaders of the deferred ROIs which were not parsed yet, for each pool
+    /// entry
+    std::map<unsigned int, ROIsLoader_T> mROIsLoaders;
+    /// Number of loaders in mROIsLoaders, which can be read during parallel
+    /// accesses
+    unsigned int mNbDeferredROIs;
+    /// Memory mapped files, referenced by the in-memory stimuli data
+    std::vector<std::shared_ptr<MemoryMappedFile> > mMappedFiles;
 
     /// Put data in program memory
     bool mLoadDataInMemory;
@@ -516,13 +618,61 @@ void N2D2::Database::setStimulusLabel(StimulusID id,
 {
     assert(id < mStimuli.size());
     mStimuli[id].label = getLabelID(labelName);
+    invalidateLabelIndex();
 }
 
 void N2D2::Database::setStimulusROIs(StimulusID id,
                                      const std::vector<ROI*>& ROIs)
 {
     assert(id < mStimuli.size());
+    releaseROIsPoolEntry(id);
     mStimuli[id].ROIs = ROIs;
+    invalidateLabelIndex();
+}
+
+void N2D2::Database::invalidateLabelIndex()
+{
+    mLabelIndexValid.store(false, std::memory_order_release);
+}
+
+void N2D2::Database::loadDeferredROIs() const
+{
+    unsigned int nbDeferredROIs;
+
+#pragma omp atomic read
+    nbDeferredROIs = mNbDeferredROIs;
+
+    if (nbDeferredROIs > 0)
+        loadDeferredROIs(mStimuli.size());
+}
+
+int N2D2::Database::getROIsPoolEntry(StimulusID id) const
+{
+    const int entry = mStimuli[id].ROIsPoolEntry;
+
+    if (entry >= 0 && mROIPool.isPending(entry))
+        loadDeferredROIs(id);
+
+    return entry;
+}
+
+unsigned int N2D2::Database::getStimulusNbROIs(StimulusID id) const
+{
+    const int entry = getROIsPoolEntry(id);
+
+    return (entry >= 0)
+        ? mROIPool.getSize(entry)
+        : mStimuli[id].ROIs.size();
+}
+
+int N2D2::Database::getStimulusROILabel(StimulusID id,
+                                        unsigned int index) const
+{
+    const int entry = getROIsPoolEntry(id);
+
+    return (entry >= 0)
+        ? mROIPool.getLabel(entry, index)
+        : mStimuli[id].ROIs[index]->getLabel();
 }
 
 N2D2::Database::StimulusID
@@ -39,6 +39,12 @@ protected:
     void loadKITTIStimuli(const std::string& dirPath,
                           const std::string& labelPath);
     void loadKITTITestStimuli(const std::string& dirPath);
+    /// Read only the object types of a label file, when loading
+    static std::vector<std::string> parseLabelNames(
+        const std::string& fileName);
+    /// Parse a label file, on first access to the stimulus ROIs
+    static NamedROIs_T parseLabelFile(const std::string& fileName,
+                                      const std::string& stimulusName);
     double mLearn;
 };
 }
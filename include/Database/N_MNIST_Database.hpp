@@ -37,6 +37,10 @@ public:
                                                 StimulusID id,
                                                 unsigned int batch);
 
+    virtual void loadAerStimulusStream(AerStream& stream,
+                                       StimuliSet set,
+                                       StimulusID id);
+
     virtual void loadAerStimulusData(std::vector<AerReadEvent>& aerData,
                                                     StimuliSet set,
                                                     StimulusID id,
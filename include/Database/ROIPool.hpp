@@ -0,0 +1,183 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_ROIPOOL_H
+#define N2D2_ROIPOOL_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace N2D2 {
+class ROI;
+
+/**
+ * Compact storage for the ROIs of many stimuli.
+ * Each entry holds the ROIs of one stimulus as plain records in shared
+ * arrays, instead of individual heap-allocated ROI objects. ROI objects are
+ * only created on access, and the most recently accessed entries are kept in
+ * a LRU cache of bounded size.
+ * An entry can also be deferred: it is reserved first and its ROIs are
+ * assigned later, typically when they are parsed on first access.
+ * Only the PolygonalROI<int>, RectangularROI<int> and EllipticROI<int> types
+ * can be pooled.
+*/
+class ROIPool {
+public:
+    typedef std::shared_ptr<const std::vector<ROI*> > ROIs_T;
+
+    /// @param cacheSize    Maximum number of entries kept as ROI objects
+    ROIPool(unsigned int cacheSize = 0);
+    /// True if all the ROIs can be stored in a pool
+    static bool isPoolable(const std::vector<ROI*>& ROIs);
+    /// Store a copy of @p ROIs as a new entry and return the entry ID
+    unsigned int push_back(const std::vector<ROI*>& ROIs);
+    /// Reserve a new entry, whose ROIs are given later with assign(), and
+    /// return the entry ID
+    unsigned int push_back_deferred();
+    /// Store a copy of @p ROIs in a deferred entry. The ROIs of an entry can
+    /// only be assigned once.
+    /// This method is thread-safe: it can be called concurrently with the
+    /// accesses to the other entries.
+    void assign(unsigned int entry, const std::vector<ROI*>& ROIs);
+    /// True if the entry is deferred and its ROIs were not assigned yet, in
+    /// which case they cannot be accessed.
+    /// This method is thread-safe.
+    inline bool isPending(unsigned int entry) const;
+    /// Remove an entry. Its ID is not reused and the storage is reclaimed
+    /// when enough entries were removed.
+    void erase(unsigned int entry);
+    unsigned int getNbEntries() const
+    {
+        return mEntries.size();
+    };
+    /// Number of records in the shared arrays, including those of the
+    /// erased entries that were not reclaimed yet
+    std::size_t getNbRecords() const
+    {
+        return mStorage.records.size();
+    };
+    inline unsigned int getSize(unsigned int entry) const;
+    inline int getLabel(unsigned int entry, unsigned int index) const;
+    /// Create new ROI objects for an entry, to be deleted by the caller
+    std::vector<ROI*> create(unsigned int entry) const;
+    /// Read-only ROI objects of an entry, which stay valid as long as the
+    /// returned pointer is held, even if the entry is evicted from the cache.
+    /// This method is thread-safe.
+    ROIs_T get(unsigned int entry) const;
+    /// Same as get(), with the cache size first changed to @p cacheSize.
+    /// This method is thread-safe, including the cache size change.
+    ROIs_T get(unsigned int entry, unsigned int cacheSize) const;
+    void setCacheSize(unsigned int cacheSize);
+    unsigned int getCacheSize() const
+    {
+        return mCacheSize;
+    };
+    void clear();
+
+private:
+    enum ROIType {
+        Polygonal,
+        Rectangular,
+        Elliptic
+    };
+
+    struct Record {
+        int label;
+        ROIType type;
+        /// Number of points for polygons, unused for ellipses
+        unsigned int size;
+        /// Offset in points for polygons, or in ellipses for ellipses
+        std::size_t offset;
+    };
+
+    struct Storage {
+        std::vector<Record> records;
+        /// Polygons points, as (x, y) pairs
+        std::vector<int> points;
+        /// Ellipses center (x, y), major radius, minor radius and angle
+        std::vector<double> ellipses;
+
+        void append(const std::vector<ROI*>& ROIs);
+        void append(const Storage& storage, std::size_t first,
+                    std::size_t size);
+        std::vector<ROI*> create(std::size_t first, std::size_t size) const;
+    };
+
+    struct Entry {
+        /// Index of the first record in mStorage, or of the entry storage in
+        /// mDeferred for deferred entries
+        std::size_t first;
+        /// Number of records, unused for deferred entries
+        unsigned int size;
+        bool deferred;
+    };
+
+    struct DeleteROIs {
+        void operator()(const std::vector<ROI*>* ROIs) const;
+    };
+
+    typedef std::list<unsigned int> LRU_T;
+
+    /// Storage of a deferred entry, which must have been assigned
+    std::shared_ptr<const Storage> getDeferred(unsigned int entry) const;
+    void evict() const;
+    void compact();
+
+    mutable unsigned int mCacheSize;
+    std::vector<Entry> mEntries;
+    Storage mStorage;
+    /// Number of records of the erased entries that are still in mStorage
+    std::size_t mErasedRecords;
+    /// Own storage of each deferred entry, which is null until the entry is
+    /// assigned. They are read and written with the std::atomic_*()
+    /// functions, as they can be assigned concurrently.
+    std::vector<std::shared_ptr<const Storage> > mDeferred;
+
+    /// Entries in access order, the most recent first
+    mutable LRU_T mLRU;
+    mutable std::unordered_map<unsigned int,
+                               std::pair<ROIs_T, LRU_T::iterator> > mCache;
+};
+}
+
+bool N2D2::ROIPool::isPending(unsigned int entry) const
+{
+    return (mEntries[entry].deferred
+            && !std::atomic_load(&mDeferred[mEntries[entry].first]));
+}
+
+unsigned int N2D2::ROIPool::getSize(unsigned int entry) const
+{
+    return (mEntries[entry].deferred)
+        ? getDeferred(entry)->records.size()
+        : mEntries[entry].size;
+}
+
+int N2D2::ROIPool::getLabel(unsigned int entry, unsigned int index) const
+{
+    return (mEntries[entry].deferred)
+        ? getDeferred(entry)->records[index].label
+        : mStorage.records[mEntries[entry].first + index].label;
+}
+
+#endif // N2D2_ROIPOOL_H
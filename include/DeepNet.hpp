@@ -75,6 +75,12 @@ public:
                         const std::shared_ptr<Cell>& parent,
                         const std::shared_ptr<Cell>& child);
     void removeCell(const std::shared_ptr<Cell>& cell, bool reconnect = true);
+    /**
+     * Re-order the cells in layers, for example to change the execution
+     * order of the network. Every cell must appear exactly once, after all
+     * its parents, and the first layer must be "env".
+     */
+    void setLayers(const std::vector<std::vector<std::string> >& layers);
 
     /**
      * Generate a cell name that doesn't exist in the DeepNet. 
@@ -32,6 +32,18 @@ public:
     static const std::string MEMORY_MANAGER_STRATEGY;
     static const MemoryManager::OptimizeStrategy MEMORY_MANAGER_STRATEGY_DEFAULT;
 
+    static const std::string OPTIMIZE_EXECUTION_ORDER;
+    static const bool OPTIMIZE_EXECUTION_ORDER_DEFAULT;
+
+    static const std::string EXECUTION_ORDER_BEAM_WIDTH;
+    static const unsigned int EXECUTION_ORDER_BEAM_WIDTH_DEFAULT;
+
+    static const std::string SPARSE_WEIGHTS_THRESHOLD;
+    static const double SPARSE_WEIGHTS_THRESHOLD_DEFAULT;
+
+    static const std::string SPARSE_WEIGHTS_BLOCK_SIZE;
+    static const unsigned int SPARSE_WEIGHTS_BLOCK_SIZE_DEFAULT;
+
 };
 }
 
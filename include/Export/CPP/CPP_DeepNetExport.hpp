@@ -61,8 +61,17 @@ public:
                                         bool wrapAroundBuffer,
                                         bool noBranchConcatOpt,
                                         bool includeInputInBuffer,
-                                        int memoryAlignment);
+                                        int memoryAlignment,
+                                        bool removeNoBranchConcats = true);
     static void addBranchesCells(DeepNet& deepNet);
+    static bool optimizeExecutionOrder(DeepNet& deepNet,
+                                       bool wrapAroundBuffer,
+                                       bool noBranchConcatOpt,
+                                       bool includeInputInBuffer,
+                                       int memoryAlignment,
+                                       MemoryManager::OptimizeStrategy strategy,
+                                       unsigned int beamWidth,
+                                       const std::string& logFileName = "");
 
 private:
     static std::string getCellModelType(const Cell& cell);
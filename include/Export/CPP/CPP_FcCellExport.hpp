@@ -21,6 +21,8 @@
 #ifndef N2D2_CPP_FCCELLEXPORT_H
 #define N2D2_CPP_FCCELLEXPORT_H
 
+#include <map>
+
 #include "Export/CPP/CPP_CellExport.hpp"
 #include "Cell/Cell_Frame_Top.hpp"
 #include "Export/FcCellExport.hpp"
@@ -40,6 +42,9 @@ public:
     static void generateHeaderBias(const FcCell& cell, std::ofstream& header);
     static void generateHeaderWeights(const FcCell& cell, std::ofstream& header);
     static void generateHeaderWeightsSparse(const FcCell& cell, std::ofstream& header);
+    static void generateHeaderWeightsBlockSparse(const FcCell& cell,
+                                                 std::ofstream& header,
+                                                 std::size_t blockSize);
 
     static std::unique_ptr<CPP_FcCellExport> getInstance(Cell& cell);
     void generateCallCode(const DeepNet& deepNet,
@@ -49,6 +54,13 @@ public:
                                  std::stringstream& functionCalls);
 
 private:
+    static std::vector<double> getWeightsOHWC(const FcCell& cell);
+    static std::size_t getSparseBlockSize(const FcCell& cell);
+    static std::size_t computeSparseBlockSize(const FcCell& cell);
+
+    // Block size of each cell, reset by generate() and computed on first use
+    static std::map<std::string, std::size_t> mSparseBlockSizes;
+
     static Registrar<FcCellExport> mRegistrar;
     static Registrar<CPP_CellExport> mRegistrarType;
 };
@@ -40,6 +40,9 @@ public:
                                              const std::string& fileName);
     static std::shared_ptr<DeepNet> generateFromINI(Network& network,
                                                    const std::string& fileName);
+
+    /// If not empty, directory where the parsed INI files are cached
+    static std::string mIniCachePath;
 #ifdef ONNX
     static std::shared_ptr<DeepNet> generateFromONNX(Network& network,
         const std::string& fileName,
@@ -31,6 +31,7 @@
 #include <deque>
 
 #include "Database/Database.hpp"
+#include "StimuliShards.hpp"
 #include "Transformation/CompositeTransformation.hpp"
 #ifdef CUDA
 #include "containers/CudaTensor.hpp"
@@ -262,6 +263,8 @@ public:
 
     /// Return a random StimulusID from the StimuliSet @p set
     Database::StimulusID getRandomID(Database::StimuliSet set);
+    /// Return a random StimulusID with label @p label (as stimulus or ROI
+    /// label) from the StimuliSet @p set, in constant time
     Database::StimulusID getRandomIDWithLabel(Database::StimuliSet set, int label);
 
     /// Read a whole random batch from the StimuliSet @p set, apply all the
@@ -355,7 +358,24 @@ public:
 
     virtual void setBatchSize(unsigned int batchSize);
     void setTargetSize(const std::vector<size_t>& size);
+    /// If @p path contains shards created with packCache(), the
+    /// pre-processed stimuli are read from these shards
     void setCachePath(const std::string& path = "");
+    /**
+     * Apply the cacheable transformations to the stimuli and pack the result
+     * in shards, to be used as cache with setCachePath(). The stimuli are
+     * processed in parallel and stored in set order.
+     *
+     * @param path          Shards directory
+     * @param setMask       Stimuli sets to pack
+     * @param compression   Matrices compression
+     * @param shardSize     Approximative shard size, in bytes
+    */
+    void packCache(const std::string& path,
+                   Database::StimuliSetMask setMask = Database::All,
+                   StimuliShards::Compression compression
+                        = StimuliShards::None,
+                   std::size_t shardSize = 256 * 1024 * 1024);
 
     /** Set the batchs for reading
      * 
@@ -535,6 +555,12 @@ public:
 
 
 protected:
+    /// Load a stimulus and apply the cacheable transformations
+    void loadCacheableData(Database::StimulusID id,
+                           Database::StimuliSet set,
+                           std::vector<cv::Mat>& rawChannelsData,
+                           std::vector<cv::Mat>& rawChannelsLabels,
+                           std::vector<std::shared_ptr<ROI> >& labelsROI);
     std::vector<cv::Mat> loadDataCache(const std::string& fileName) const;
     void saveDataCache(const std::string& fileName,
                        const std::vector<cv::Mat>& data) const;
@@ -559,6 +585,8 @@ protected:
     bool mCompositeStimuli;
     /// Disk cache path for pre-processed stimuli (no disk cache if empty)
     std::string mCachePath;
+    /// Pre-processed stimuli shards in the cache path, if any
+    std::shared_ptr<StimuliShards> mCacheShards;
     /// Global transformations
     TransformationsSets mTransformations;
     /// Channel transformations
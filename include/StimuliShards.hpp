@@ -0,0 +1,135 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_STIMULISHARDS_H
+#define N2D2_STIMULISHARDS_H
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Database/Database.hpp"
+#include "utils/MemoryMappedFile.hpp"
+
+namespace N2D2 {
+/**
+ * Pre-processed stimuli packed in large sequential shard files.
+ * Each record holds the data and labels matrices of one stimulus, for one
+ * stimuli set, as obtained after the cacheable transformations of a
+ * StimuliProvider. The shards are memory-mapped and read ahead on access,
+ * instead of reading one small file per stimulus.
+*/
+class StimuliShards {
+public:
+    enum Compression {
+        // Raw matrices
+        None,
+        // Lossless PNG encoding for the 8 and 16 bits matrices with 1, 3 or
+        // 4 channels, other matrices are kept raw
+        Png
+    };
+
+    /// Sequential writer for the shards of a directory
+    class Writer {
+    public:
+        /**
+         * @param path          Shards directory
+         * @param compression   Matrices compression
+         * @param shardSize     A new shard is started when the current one
+         *                      exceeds this size, in bytes
+        */
+        Writer(const std::string& path,
+               Compression compression = None,
+               std::size_t shardSize = 256 * 1024 * 1024);
+        /// Encode the matrices of a stimulus as a record. This method is
+        /// thread-safe.
+        static std::vector<char> encode(const std::vector<cv::Mat>& data,
+                                        const std::vector<cv::Mat>& labels,
+                                        Compression compression);
+        /// Append a record, obtained with encode()
+        void append(Database::StimulusID id,
+                    Database::StimuliSet set,
+                    const std::vector<char>& record);
+        Compression getCompression() const
+        {
+            return mCompression;
+        };
+        /// Close the current shard and write the index, which makes the
+        /// shards readable
+        void close();
+        virtual ~Writer();
+
+    private:
+        const std::string mPath;
+        const Compression mCompression;
+        const std::size_t mShardSize;
+        unsigned int mNbShards;
+        std::ofstream mShard;
+        std::size_t mShardOffset;
+        std::vector<char> mIndex;
+        unsigned int mNbEntries;
+        bool mClosed;
+    };
+
+    /// True if @p path contains a shards index
+    static bool exists(const std::string& path);
+
+    /// Open the shards of a directory
+    StimuliShards(const std::string& path);
+    /**
+     * Read the pre-processed matrices of a stimulus. This method is
+     * thread-safe.
+     *
+     * @return false if the stimulus is not in the shards
+    */
+    bool read(Database::StimulusID id,
+              Database::StimuliSet set,
+              std::vector<cv::Mat>& data,
+              std::vector<cv::Mat>& labels) const;
+    const std::string& getPath() const
+    {
+        return mPath;
+    };
+
+    /// Number of bytes read ahead after each record, when the stimuli of a
+    /// set are read in order
+    static std::size_t ReadAhead;
+
+private:
+    struct Entry {
+        unsigned int shard;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    static std::string getShardName(const std::string& path,
+                                    unsigned int shard);
+
+    const std::string mPath;
+    std::vector<std::shared_ptr<MemoryMappedFile> > mShards;
+    /// Record of each stimulus ID (size = 0 if absent), for each set
+    std::vector<std::vector<Entry> > mEntries;
+    /// Last stimulus ID read, for each set, to detect the sequential reads
+    mutable std::vector<Database::StimulusID> mLastIds;
+};
+}
+
+#endif // N2D2_STIMULISHARDS_H
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "ComputerVision/LSL_Box.hpp"
+#include "ComputerVision/ParallelLSL_Box.hpp"
 #include "Target.hpp"
 #include "utils/ConfusionMatrix.hpp"
 
@@ -118,6 +119,8 @@ public:
     virtual void clear(Database::StimuliSet set);
 
 protected:
+    std::vector<ComputerVision::ROI::Roi_T> extractROIs(
+        const Tensor<int>& labels) const;
     std::vector<std::shared_ptr<ROI> > generateLabelsROIs(
         const Tensor<int>& labels) const;
 
@@ -136,6 +139,8 @@ protected:
     std::vector<std::vector<DetectedBB> > mDetectedBB;
     std::map<Database::StimuliSet, Score> mScoreSet;
     std::shared_ptr<Target> mROIsLabelTarget;
+    // Labeling buffers, one per thread
+    mutable std::vector<ComputerVision::ParallelLSL_Box> mLSL;
 
 private:
     static bool scoreCompare(const DetectedBB& lhs, const DetectedBB& rhs)
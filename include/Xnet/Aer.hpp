@@ -49,6 +49,7 @@
 #endif
 
 #include "AerEvent.hpp"
+#include "AerStream.hpp"
 #include "utils/Parameterizable.hpp"
 
 namespace N2D2 {
@@ -170,6 +171,8 @@ private:
     double readVersion(std::ifstream& data) const;
 
     const std::shared_ptr<HeteroEnvironment> mEnvironment;
+    // Last file decoded by read(), kept for successive time window reads
+    AerStream mStream;
 
     // Parameters
     /// Additional standard deviation on spike timing (jitter) when reading an
@@ -0,0 +1,196 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_AERSTREAM_H
+#define N2D2_AERSTREAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AerEvent.hpp"
+#include "Network.hpp"
+
+namespace N2D2 {
+
+struct AerReadEvent;
+
+/**
+ * Structure-of-arrays AER event buffer.
+ * A whole event file is memory-mapped and decoded at once into separate
+ * timestamp, x, y and polarity arrays. When the events are sorted by time,
+ * time windows are obtained by binary search as views on these arrays,
+ * without any copy.
+*/
+class AerStream {
+public:
+    enum StreamFormat {
+        // N2D2 "#!AER-DAT" file (versions 1 to 3), the addresses are decoded
+        // according to an AerEvent::AerFormat
+        AerDat,
+        // ATIS 40 bits events, as used in the N-MNIST database
+        Atis,
+        // Plain text, with one "x y timestamp polarity" event per line
+        Text
+    };
+
+    /**
+     * Zero-copy view on a contiguous range of events of an AerStream.
+     * A window is invalidated when its stream is reloaded or destroyed.
+    */
+    class Window {
+    public:
+        Window();
+        Window(const AerStream& stream, std::size_t begin, std::size_t end);
+        std::size_t size() const
+        {
+            return mSize;
+        };
+        bool empty() const
+        {
+            return (mSize == 0);
+        };
+        Time_T time(std::size_t index) const
+        {
+            return mTimes[index];
+        };
+        unsigned int x(std::size_t index) const
+        {
+            return mX[index];
+        };
+        unsigned int y(std::size_t index) const
+        {
+            return mY[index];
+        };
+        unsigned int polarity(std::size_t index) const
+        {
+            return mPolarity[index];
+        };
+        const Time_T* times() const
+        {
+            return mTimes;
+        };
+
+        /// Append the events of the window to @p events, with the polarity
+        /// used as channel
+        void append(std::vector<AerReadEvent>& events,
+                    unsigned int batch,
+                    int value = 1) const;
+
+    private:
+        const Time_T* mTimes;
+        const unsigned int* mX;
+        const unsigned int* mY;
+        const unsigned char* mPolarity;
+        std::size_t mSize;
+    };
+
+    AerStream();
+
+    /**
+     * Decode an AER file.
+     *
+     * @param fileName      AER file name
+     * @param format        File format
+     * @param aerFormat     Address format, only used for AerDat files. With
+     *                      AerEvent::N2D2Env, x is the node index, y the map
+     *                      and polarity the channel.
+     * @param sortByTime    If true, events are stably sorted by time, which is
+     *                      required by getWindow(). Otherwise, the file
+     *                      order is kept.
+     *
+     * @exception std::runtime_error Unable to read the AER file
+    */
+    void load(const std::string& fileName,
+              StreamFormat format,
+              AerEvent::AerFormat aerFormat = AerEvent::N2D2Env,
+              bool sortByTime = true);
+    void clear();
+
+    /// Events with @p start <= time < @p end (no upper bound if @p end is 0)
+    Window getWindow(Time_T start = 0, Time_T end = 0) const;
+
+    /// Index of the first event with time >= @p time
+    std::size_t lowerBound(Time_T time) const;
+
+    std::size_t size() const
+    {
+        return mTimes.size();
+    };
+    bool empty() const
+    {
+        return mTimes.empty();
+    };
+    bool isSorted() const
+    {
+        return mSorted;
+    };
+    const std::string& getFileName() const
+    {
+        return mFileName;
+    };
+    const std::vector<Time_T>& getTimes() const
+    {
+        return mTimes;
+    };
+    const std::vector<unsigned int>& getX() const
+    {
+        return mX;
+    };
+    const std::vector<unsigned int>& getY() const
+    {
+        return mY;
+    };
+    const std::vector<unsigned char>& getPolarity() const
+    {
+        return mPolarity;
+    };
+    /// Raw addresses, only filled for AerDat files
+    const std::vector<unsigned int>& getAddr() const
+    {
+        return mAddr;
+    };
+
+    /// True if the file was modified since it was loaded
+    bool isOutdated() const;
+
+private:
+    void loadAerDat(const unsigned char* data,
+                    std::size_t size,
+                    AerEvent::AerFormat aerFormat);
+    void loadAtis(const unsigned char* data, std::size_t size);
+    void loadText(const unsigned char* data, std::size_t size);
+    void resize(std::size_t nbEvents);
+    void sort();
+
+    std::string mFileName;
+    std::size_t mFileSize;
+    long long int mFileTime;
+    bool mSorted;
+
+    std::vector<Time_T> mTimes;
+    std::vector<unsigned int> mX;
+    std::vector<unsigned int> mY;
+    std::vector<unsigned char> mPolarity;
+    std::vector<unsigned int> mAddr;
+};
+}
+
+#endif // N2D2_AERSTREAM_H
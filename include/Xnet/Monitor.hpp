@@ -97,10 +97,7 @@ public:
         return mMostActiveRate;
     };
     unsigned int getFiringRate(NodeId_T nodeId) const;
-    unsigned int getFiringRate(NodeId_T nodeId, EventType_T type) const
-    {
-        return mFiringRate.at(nodeId).at(type);
-    };
+    unsigned int getFiringRate(NodeId_T nodeId, EventType_T type) const;
     unsigned int getTotalFiringRate() const;
     unsigned int getTotalFiringRate(EventType_T type) const;
     unsigned int getNbNodes() const
@@ -111,6 +108,11 @@ public:
     {
         return mTotalActivity;
     };
+    /// Returns the activity recorded with update(true)
+    const SpikeLog& getActivity() const
+    {
+        return mActivity;
+    };
     double getSuccessRate(unsigned int avgWindow = 0) const;
     void logSuccessRate(const std::string& fileName,
                         unsigned int avgWindow = 0,
@@ -138,17 +140,32 @@ public:
                             bool plot = false);
 
 protected:
+    void compileNodes();
+    inline int getNodeIndex(NodeId_T nodeId) const;
+    int getTypeIndex(EventType_T type);
+
     /// The network that is monitored.
     Network& mNet;
     /// A vector of pointers to nodes to be recorded
     std::vector<Node*> mNodes;
-    /// A map of spikes records arrays to corresponding neurons' IDs.
-    std::map<NodeId_T, NodeEvents_T> mActivity;
+    /// Log of the spikes recorded with update(true).
+    SpikeLog mActivity;
     std::set<EventType_T> mRecordEventTypes;
     std::set<EventType_T> mEventTypes;
     std::map<NodeId_T, std::map<unsigned int, unsigned int> > mStats;
-    /// Total number of spikes of each neuron.
-    std::map<NodeId_T, std::map<EventType_T, unsigned int> > mFiringRate;
+    /// Sorted IDs of the recorded nodes, which give the node index in
+    /// mFiringRate
+    std::vector<NodeId_T> mNodeIds;
+    /// Direct node ID to node index look-up table, when the IDs span is small
+    std::vector<int> mNodeLookup;
+    NodeId_T mNodeIdOffset;
+    /// Number of nodes of mNodes in mNodeIds
+    std::size_t mNbCompiledNodes;
+    /// Event types, which give the type index in mFiringRate
+    std::vector<EventType_T> mFiringRateTypes;
+    /// Total number of spikes of each neuron, for each event type.
+    std::vector<std::vector<unsigned int> > mFiringRate;
+    bool mValidFiringRate;
     std::deque<bool> mSuccess;
     /// The first neuron to spike (since last update).
     NodeId_T mEarlierId;
@@ -174,6 +191,23 @@ template <class T> void N2D2::Monitor::add(const std::vector<T*>& nodes)
         std::bind(&T::setActivityRecording, std::placeholders::_1, true));
 }
 
+int N2D2::Monitor::getNodeIndex(NodeId_T nodeId) const
+{
+    if (!mNodeLookup.empty()) {
+        return (nodeId >= mNodeIdOffset
+                && nodeId - mNodeIdOffset < mNodeLookup.size())
+            ? mNodeLookup[nodeId - mNodeIdOffset]
+            : -1;
+    }
+
+    const std::vector<NodeId_T>::const_iterator it
+        = std::lower_bound(mNodeIds.begin(), mNodeIds.end(), nodeId);
+
+    return (it != mNodeIds.end() && (*it) == nodeId)
+        ? (int)(it - mNodeIds.begin())
+        : -1;
+}
+
 template <class T>
 void N2D2::Monitor::logDataRate(const std::deque<T>& data,
                                 const std::string& fileName,
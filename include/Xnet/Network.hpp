@@ -22,8 +22,11 @@
 #ifndef N2D2_NETWORK_H
 #define N2D2_NETWORK_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <numeric>
 #include <queue>
 #include <set>
 #include <stack>
@@ -43,6 +46,8 @@
 #include <unistd.h>
 #endif
 
+#include <omp.h>
+
 #include "utils/Utils.hpp"
 
 namespace N2D2 {
@@ -83,6 +88,11 @@ public:
 
     NetworkObserver(Network& net);
     virtual void notify(Time_T timestamp, NotifyType notify) = 0;
+    /// True if the observer may call Network::stop() during the simulation
+    virtual bool canStop() const
+    {
+        return false;
+    };
     virtual ~NetworkObserver();
 
 protected:
@@ -90,6 +100,103 @@ protected:
     Network& mNet;
 };
 
+/**
+ * Append-only, columnar log of the spike events recorded by the network.
+ * The events are stored as contiguous timestamp, node ID and type arrays,
+ * split in chunks of bounded size, so that the log never has to be copied
+ * when it grows, and that the logs of the partitions of the parallel engine
+ * can be appended without moving the events.
+ * The per-node queries use an index of the event positions of each node,
+ * built lazily on the first query after new events were recorded. The
+ * events themselves are never duplicated in the index. Concurrent queries
+ * are thread-safe, but not concurrently with the recording.
+*/
+class SpikeLog {
+public:
+    SpikeLog();
+    inline void push_back(NodeId_T nodeId, Time_T timestamp, EventType_T type);
+    /// Move the events of @p log at the end of this log. @p log is left empty.
+    void append(SpikeLog& log);
+    void clear();
+    std::size_t size() const
+    {
+        return mSize;
+    };
+    bool empty() const
+    {
+        return (mSize == 0);
+    };
+    /// Call @p func(nodeId, timestamp, type) for each event, in recording
+    /// order (which is chronological for a given node).
+    template <class F> void forEach(F func) const;
+    /// Number of events of type @p type of a node, in [@p start, @p stop[
+    /// (no bound if 0)
+    unsigned int getNodeActivity(NodeId_T nodeId,
+                                 Time_T start = 0,
+                                 Time_T stop = 0,
+                                 EventType_T type = 0) const;
+    /// First event of type @p type of a node, in [@p start, @p stop[ (no
+    /// bound if 0). The second element is false if there is none.
+    std::pair<Time_T, bool> getNodeFirstEvent(NodeId_T nodeId,
+                                              Time_T start = 0,
+                                              Time_T stop = 0,
+                                              EventType_T type = 0) const;
+    /// Returns a copy of the events of a node
+    NodeEvents_T getNodeEvents(NodeId_T nodeId) const;
+    /// Returns a copy of the events of all the nodes
+    std::unordered_map<NodeId_T, NodeEvents_T> getNodesEvents() const;
+    /// Save the log in a binary file (not portable): "N2D2SPKL" signature,
+    /// number of events (64 bits), then the timestamps, node IDs and types
+    /// columns.
+    void save(const std::string& fileName) const;
+    /// Load a log saved with save(), replacing the current content.
+    void load(const std::string& fileName);
+
+private:
+    struct Chunk {
+        std::vector<Time_T> timestamps;
+        std::vector<NodeId_T> nodeIds;
+        std::vector<EventType_T> types;
+    };
+
+    /// Position of an event: chunk index in the high bits, offset in the
+    /// chunk in the low ChunkBits bits
+    typedef uint32_t Position_T;
+
+    /// Per-node index. It is a cache of the log: a copy of the log starts
+    /// with an empty index.
+    struct NodesIndex {
+        NodesIndex();
+        NodesIndex(const NodesIndex& /*index*/) : NodesIndex() {};
+        NodesIndex& operator=(const NodesIndex& /*index*/)
+        {
+            clear();
+            return *this;
+        };
+        void clear();
+
+        std::unordered_map<NodeId_T, std::vector<Position_T> > positions;
+        // Position of the first event not yet indexed
+        std::size_t chunk;
+        std::size_t event;
+        /// Number of events indexed, read without lock
+        std::atomic<std::size_t> size;
+    };
+
+    const std::vector<Position_T>* getNodePositions(NodeId_T nodeId) const;
+    void indexNodes() const;
+
+    static const unsigned int ChunkBits = 16;
+    /// Maximum number of events per chunk
+    static const std::size_t MaxChunkSize = (1U << ChunkBits);
+    /// Maximum number of chunks that can be indexed
+    static const std::size_t MaxNbChunks = (1U << (32 - ChunkBits));
+
+    std::vector<Chunk> mChunks;
+    std::size_t mSize;
+    mutable NodesIndex mIndex;
+};
+
 /**
  * This class is the heart of the simulator. It maintains a priority queue of
  *the events scheduled by the nodes of the
@@ -133,11 +240,7 @@ public:
     /// Usefull for debug purpose, or to stop network
     /// simulations containing oscillations.
     bool run(Time_T stop = 0, bool clearActivity = true);
-    void stop(Time_T stop = 0, bool discard = false)
-    {
-        mStop = stop;
-        mDiscard = discard;
-    };
+    inline void stop(Time_T stop = 0, bool discard = false);
     void reset(Time_T timestamp = 0);
     /// Save the entire network state in a given location (binary format, not
     /// portable).
@@ -145,13 +248,20 @@ public:
     /// Load the entire network state from a given location (binary format, not
     /// portable).
     void load(const std::string& dirName);
-    const std::unordered_map<NodeId_T, NodeEvents_T>& getSpikeRecording()
+    /// Returns a copy of the recorded events of all the nodes
+    std::unordered_map<NodeId_T, NodeEvents_T> getSpikeRecording() const
+    {
+        return mSpikeLog.getNodesEvents();
+    };
+    /// Returns a copy of the recorded events of a node
+    NodeEvents_T getSpikeRecording(NodeId_T nodeId) const
     {
-        return mSpikeRecording;
+        return mSpikeLog.getNodeEvents(nodeId);
     };
-    const NodeEvents_T& getSpikeRecording(NodeId_T nodeId)
+    /// Returns the recorded events, in recording order
+    const SpikeLog& getSpikeLog() const
     {
-        return mSpikeRecording[nodeId];
+        return mSpikeLog;
     };
     /// Returns first processed event time after calling Network::run()
     Time_T getFirstEvent() const
@@ -167,6 +277,24 @@ public:
     {
         return mLoadSavePath;
     };
+    /// Set the number of partitions of the parallel engine. The nodes are
+    /// distributed among the partitions, each with its own event queue,
+    /// which are processed concurrently by time windows as large as the
+    /// minimum delay between the partitions (conservative synchronization).
+    /// It produces the same spike trains as the sequential engine, which is
+    /// used if @p nbPartitions <= 1 (default) or if there is no delay to
+    /// exploit (see Node::getMinIncomingDelay()).
+    /// The sequential engine is also used if an observer can stop the
+    /// simulation from within (see NetworkObserver::canStop()), as the other
+    /// partitions may already be past the stop time.
+    void setNbPartitions(unsigned int nbPartitions)
+    {
+        mNbPartitions = nbPartitions;
+    };
+    unsigned int getNbPartitions() const
+    {
+        return mNbPartitions;
+    };
     /// Destructor.
     virtual ~Network();
 
@@ -184,15 +312,35 @@ public:
     recordSpike(NodeId_T nodeId, Time_T timestamp = 0, EventType_T type = 0);
 
 private:
+    typedef std::priority_queue
+        <SpikeEvent*, std::vector<SpikeEvent*>, Utils::PtrLess<SpikeEvent*> >
+    EventQueue_T;
+
+    /// Nodes simulated by a same thread of the parallel engine
+    struct Partition {
+        /// Events of the partition nodes
+        EventQueue_T events;
+        std::stack<SpikeEvent*> eventsPool;
+        /// Events created for the nodes of the other partitions, delivered
+        /// at the end of the current time window
+        std::vector<std::vector<SpikeEvent*> > outbox;
+        SpikeLog spikeLog;
+        Time_T lastEvent;
+    };
+
+    bool runSequential();
+    bool runParallel();
+    Time_T partitionNodes();
+    void runPartition(Partition& partition, Time_T horizon);
+    inline unsigned int getPartition(const SpikeEvent* event) const;
+
     // Internal variables
     std::set<NetworkObserver*> mObservers;
     std::string mLoadSavePath;
     /// The priority queue containing the events to be processed by the
     /// simulator.
-    std::priority_queue
-        <SpikeEvent*, std::vector<SpikeEvent*>, Utils::PtrLess<SpikeEvent*> >
-    mEvents;
-    std::unordered_map<NodeId_T, NodeEvents_T> mSpikeRecording;
+    EventQueue_T mEvents;
+    SpikeLog mSpikeLog;
     bool mInitialized;
     Time_T mFirstEvent;
     Time_T mLastEvent;
@@ -200,13 +348,68 @@ private:
     bool mDiscard;
     std::stack<SpikeEvent*> mEventsPool;
     const std::chrono::high_resolution_clock::time_point mStartTime;
+    unsigned int mNbPartitions;
+    /// Parallel engine state, valid during runParallel()
+    bool mParallel;
+    std::vector<Partition> mPartitions;
+    std::unordered_map<const Node*, unsigned int> mNodePartition;
+    /// Partition processed by each OpenMP thread
+    std::vector<unsigned int> mThreadPartition;
 };
 }
 
+void N2D2::SpikeLog::push_back(NodeId_T nodeId,
+                               Time_T timestamp,
+                               EventType_T type)
+{
+    if (mChunks.empty() || mChunks.back().timestamps.size() >= MaxChunkSize)
+        mChunks.push_back(Chunk());
+
+    Chunk& chunk = mChunks.back();
+    chunk.timestamps.push_back(timestamp);
+    chunk.nodeIds.push_back(nodeId);
+    chunk.types.push_back(type);
+    ++mSize;
+}
+
+template <class F> void N2D2::SpikeLog::forEach(F func) const
+{
+    for (std::vector<Chunk>::const_iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        const std::size_t size = (*it).timestamps.size();
+
+        for (std::size_t i = 0; i < size; ++i)
+            func((*it).nodeIds[i], (*it).timestamps[i], (*it).types[i]);
+    }
+}
+
+void N2D2::Network::stop(Time_T stop, bool discard)
+{
+    if (mParallel) {
+#pragma omp critical(Network__stop)
+        {
+            // Keep the earliest request of the current time window
+            if (mStop == 0 || (stop > 0 && stop < mStop))
+                mStop = stop;
+
+            mDiscard = mDiscard || discard;
+        }
+    }
+    else {
+        mStop = stop;
+        mDiscard = discard;
+    }
+}
+
 void
 N2D2::Network::recordSpike(NodeId_T nodeId, Time_T timestamp, EventType_T type)
 {
-    mSpikeRecording[nodeId].push_back(std::make_pair(timestamp, type));
+    SpikeLog& spikeLog = (mParallel)
+        ? mPartitions[mThreadPartition[omp_get_thread_num()]].spikeLog
+        : mSpikeLog;
+
+    spikeLog.push_back(nodeId, timestamp, type);
 }
 
 #endif // N2D2_NETWORK_H
@@ -101,6 +101,21 @@ public:
     */
     virtual void emitSpike(Time_T timestamp, EventType_T type = 0);
 
+    /**
+     * Minimum delay between the emission of a spike by a parent node and its
+     *reception by this node, through incomingSpike(). It is used as lookahead
+     *by the parallel engine of N2D2::Network.
+     * Nodes reading the state of other nodes, or drawing random numbers, in
+     *incomingSpike() or emitSpike() must return 0, which keeps them in the same
+     *partition as their parent nodes.
+     *
+     * @return Minimum incoming delay, 0 if there is none or it is unknown
+    */
+    virtual Time_T getMinIncomingDelay() const
+    {
+        return 0;
+    };
+
     inline virtual void notify(Time_T timestamp, NotifyType notify);
 
     /// Enable or disable activity recording for this node (used in Monitor).
@@ -158,6 +158,10 @@ public:
     {
         return mLinks.size();
     };
+    const std::vector<NodeNeuron*>& getLateralBranches() const
+    {
+        return mLateralBranches;
+    };
 
     /// Destructor.
     virtual ~NodeNeuron();
@@ -177,6 +181,24 @@ protected:
     virtual void finalize() {};
 
     virtual Synapse* newSynapse() const = 0;
+
+    /**
+     * Freeze the synaptic connectivity in compact arrays, sorted by
+     * pre-synaptic node ID (one CSR row per neuron).
+     * Called upon initialization, and lazily by getLinkIndex() when links were
+     * added afterwards.
+    */
+    virtual void compileLinks();
+
+    /**
+     * Returns the index of the link from @p origin in the compiled arrays
+     * (mLinkNodes and mLinkSynapses), in constant time.
+     *
+     * @param origin        Input node address
+     * @return Link index, or -1 if the neuron has no link from @p origin
+    */
+    inline int getLinkIndex(const Node* origin);
+
     virtual void saveInternal(std::ofstream& /*dataFile*/) const {};
     virtual void loadInternal(std::ifstream& /*dataFile*/) {};
     virtual void logStatePlot() = 0;
@@ -195,6 +217,19 @@ protected:
     /// Map containing the synapses of the neuron, associated to their input
     /// neurons
     std::unordered_map<Node*, Synapse*> mLinks;
+    /// Compiled connectivity: input nodes, sorted by node ID
+    std::vector<Node*> mLinkNodes;
+    /// Compiled connectivity: synapses, in the mLinkNodes order
+    std::vector<Synapse*> mLinkSynapses;
+    /// Compiled connectivity: input node IDs, in the mLinkNodes order
+    std::vector<NodeId_T> mLinkIds;
+    /// Direct look-up table from (node ID - mLinkIdOffset) to link index (-1 if
+    /// not linked). Empty when the input node IDs are too sparse, in which
+    /// case mLinkIds is searched.
+    std::vector<int> mLinkLookup;
+    NodeId_T mLinkIdOffset;
+    /// Indicates whether the compiled connectivity is up to date with mLinks
+    bool mLinksCompiled;
     /// File stream to store the state of the neuron
     std::ofstream mStateLog; // Note: using fstream makes this class
     // automatically non-copyable
@@ -208,4 +243,25 @@ protected:
 };
 }
 
+int N2D2::NodeNeuron::getLinkIndex(const Node* origin)
+{
+    if (!mLinksCompiled)
+        compileLinks();
+
+    const NodeId_T id = origin->getId();
+
+    if (!mLinkLookup.empty()) {
+        return (id >= mLinkIdOffset && id - mLinkIdOffset < mLinkLookup.size())
+            ? mLinkLookup[id - mLinkIdOffset]
+            : -1;
+    }
+
+    const std::vector<NodeId_T>::const_iterator it
+        = std::lower_bound(mLinkIds.begin(), mLinkIds.end(), id);
+
+    return (it != mLinkIds.end() && (*it) == id)
+        ? (int)(it - mLinkIds.begin())
+        : -1;
+}
+
 #endif // N2D2_NODENEURON_H
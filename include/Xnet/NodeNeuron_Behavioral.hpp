@@ -23,7 +23,8 @@
 #define N2D2_NODENEURON_BEHAVIORAL_H
 
 #include <algorithm>
-#include <deque>
+#include <cassert>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -44,6 +45,7 @@ public:
     void emitSpike(Time_T timestamp, EventType_T type = 0);
     void lateralInhibition(Time_T timestamp, EventType_T /*type*/ = 0);
     void reset(Time_T timestamp = 0);
+    Time_T getMinIncomingDelay() const;
     Time_T getRefractoryEnd() const
     {
         return mRefractoryEnd;
@@ -58,7 +60,7 @@ public:
     void logStdpBehavior(const std::string& fileName,
                          unsigned int nbPoints = 100,
                          bool plot = true);
-    virtual ~NodeNeuron_Behavioral() {};
+    virtual ~NodeNeuron_Behavioral();
 
     /**
      * Returns current integration (or membrane potential) of the neuron.
@@ -103,6 +105,10 @@ private:
 
     void initialize();
     virtual Synapse* newSynapse() const;
+    virtual void compileLinks();
+    inline bool isPooledSynapse(const Synapse* synapse) const;
+    void ltpFifoPush(int link);
+    void ltpFifoClear();
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
     virtual void logStatePlot();
@@ -174,8 +180,30 @@ private:
     /// its activation, or lateral inhibition
     Time_T mRefractoryEnd;
     Time_T mLastStdp;
-    std::deque<Synapse_Behavioral*> mLtpFifo;
+    /// Synapses, stored contiguously in the compiled links order
+    std::vector<Synapse_Behavioral> mSynapses;
+    /// STDP FIFO, containing the @p mOrderStdp last activated synapses, most
+    /// recent last. Implemented as a doubly linked list over the link indexes
+    /// (-1 = none), for constant time update.
+    std::vector<int> mLtpFifoPrev;
+    std::vector<int> mLtpFifoNext;
+    std::vector<bool> mLtpFifoIn;
+    int mLtpFifoHead;
+    int mLtpFifoTail;
+    unsigned int mLtpFifoSize;
 };
 }
 
+bool N2D2::NodeNeuron_Behavioral::isPooledSynapse(const Synapse* synapse) const
+{
+    if (mSynapses.empty())
+        return false;
+
+    const Synapse* begin = &mSynapses.front();
+    const Synapse* end = &mSynapses.back() + 1;
+
+    return (!std::less<const Synapse*>()(synapse, begin)
+            && std::less<const Synapse*>()(synapse, end));
+}
+
 #endif // N2D2_NODENEURON_BEHAVIORAL_H
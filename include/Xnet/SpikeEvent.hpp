@@ -60,6 +60,14 @@ public:
     {
         return mType;
     };
+    Node* getOrigin() const
+    {
+        return mOrigin;
+    };
+    Node* getDestination() const
+    {
+        return mDestination;
+    };
     // We really want this function to be inlined for better performances
     inline bool operator<(const SpikeEvent& event) const;
     virtual ~SpikeEvent() {};
@@ -111,9 +119,31 @@ N2D2::Time_T N2D2::SpikeEvent::release()
 
 bool N2D2::SpikeEvent::operator<(const SpikeEvent& event) const
 {
-    return (mTimestamp > event.mTimestamp
-            || (mTimestamp == event.mTimestamp && mDestination == NULL
-                && event.mDestination != NULL));
+    if (mTimestamp != event.mTimestamp)
+        return (mTimestamp > event.mTimestamp);
+
+    if ((mDestination == NULL) != (event.mDestination == NULL))
+        return (mDestination == NULL);
+
+    // Simultaneous events are processed in a total order that does not depend
+    // on the queue history, so that the sequential and parallel engines of
+    // the network process them identically
+    const NodeId_T originId = (mOrigin != NULL) ? mOrigin->getId() : 0;
+    const NodeId_T eventOriginId = (event.mOrigin != NULL)
+        ? event.mOrigin->getId() : 0;
+
+    if (originId != eventOriginId)
+        return (originId > eventOriginId);
+
+    const NodeId_T destinationId = (mDestination != NULL)
+        ? mDestination->getId() : 0;
+    const NodeId_T eventDestinationId = (event.mDestination != NULL)
+        ? event.mDestination->getId() : 0;
+
+    if (destinationId != eventDestinationId)
+        return (destinationId > eventDestinationId);
+
+    return (mType > event.mType);
 }
 
 #endif // N2D2_SPIKEEVENT_H
@@ -30,6 +30,7 @@
 #define N2D2_TENSOR_H
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <complex>
@@ -37,6 +38,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -64,10 +66,12 @@
 #include "CudaUtils.hpp"
 #endif
 
+#include "containers/Tensor_Kernels.hpp"
 #include "third_party/half.hpp"
 
 namespace N2D2 {
 template <class T> class Tensor;
+template <class T> class DataTensor;
 
 /**
  * BaseDataTensor is a simple polymorphic wrapper around std::vector
@@ -75,10 +79,65 @@ template <class T> class Tensor;
  * It is used for storing casted tensor data, in mDataTensors:
  * mutable std::map<const std::type_info*,
  *            std::shared_ptr<BaseDataTensor> > mDataTensors;
+ *
+ * It also keeps track of the modifications of the data, with a version
+ * number, so that tensor_cast() only converts the data again when either the
+ * source or the cached casted data were modified since the last conversion.
+ * Any non-const access to the data is considered as a modification. Writes
+ * through a pointer or iterator that was obtained before a tensor_cast() call
+ * are not tracked.
 */
 class BaseDataTensor {
 public:
+    BaseDataTensor()
+        : mGeneration(newGeneration()),
+          mModified(false),
+          mVersion(0),
+          mCastSourceGeneration(0),
+          mCastOffset(0),
+          mCastSourceVersion(0),
+          mCastVersion(0),
+          mCastRound(false) {}
+    unsigned long long getVersion() {
+        unsigned long long version;
+
+        // The same source may be casted concurrently to several types
+#pragma omp critical(BaseDataTensor__getVersion)
+        {
+            if (mModified.exchange(false, std::memory_order_acq_rel))
+                ++mVersion;
+
+            version = mVersion;
+        }
+
+        return version;
+    }
     virtual ~BaseDataTensor() {};
+
+protected:
+    static unsigned long long newGeneration();
+
+    // Unique identifier of the allocation. Unlike the address of the object,
+    // it is never reused once the object is destroyed.
+    const unsigned long long mGeneration;
+
+    // Set on any non-const access to the data, possibly from several threads
+    // (OpenMP kernels). Relaxed accesses are plain loads and stores on x86.
+    std::atomic<bool> mModified;
+    unsigned long long mVersion;
+
+    // Origin of the data, when used as tensor_cast() cache
+    unsigned long long mCastSourceGeneration;
+    size_t mCastOffset;
+    unsigned long long mCastSourceVersion;
+    unsigned long long mCastVersion;
+    bool mCastRound;
+    // Held during the conversion to this cache
+    std::mutex mCastMutex;
+
+    template <bool ROUND, class T, class U>
+    friend void tensor_cast_data(const Tensor<U>& tensor,
+                                 DataTensor<T>& data);
 };
 
 /**
@@ -91,20 +150,38 @@ public:
     DataTensor(const std::vector<T>& data) : mUnallocatedSize(0), mData(data) {}
     DataTensor(size_t size) : mUnallocatedSize(size), mData() {}
     std::vector<T>& operator()() {
+        // Single test on the fast path: the data is necessarily allocated
+        // once it has been marked as modified
+        if (!mModified.load(std::memory_order_relaxed))
+            setModified();
+
+        return mData;
+    }
+    const std::vector<T>& operator()() const {
+        allocate();
+        return mData;
+    }
+    size_t size() const {
+        return (mUnallocatedSize > 0) ? mUnallocatedSize : mData.size();
+    }
+    virtual ~DataTensor() {};
+
+protected:
+    void setModified() {
+        allocate();
+        mModified.store(true, std::memory_order_relaxed);
+    }
+    void allocate() const {
         if (mUnallocatedSize > 0) {
             // Lazy memory allocation, useful to avoid host memory allocation
             // when casting CudaTensor types on GPU only.
             mData.resize(mUnallocatedSize);
             mUnallocatedSize = 0;
         }
-
-        return mData;
     }
-    virtual ~DataTensor() {};
 
-protected:
-    size_t mUnallocatedSize;
-    std::vector<T> mData;
+    mutable size_t mUnallocatedSize;
+    mutable std::vector<T> mData;
 };
 
 class BaseTensor {
@@ -359,7 +436,7 @@ public:
     }
     const_iterator begin() const
     {
-        return (*mData)().begin() + mDataOffset;
+        return data().begin() + mDataOffset;
     }
     iterator end()
     {
@@ -367,7 +444,7 @@ public:
     }
     const_iterator end() const
     {
-        return (*mData)().begin() + mDataOffset + size();
+        return data().begin() + mDataOffset + size();
     }
     virtual void reserve(const std::vector<size_t>& dims);
     virtual void resize(const std::vector<size_t>& dims);
@@ -389,6 +466,7 @@ public:
     virtual void save(std::ostream& stream) const;
     virtual void load(std::istream& stream);
     void swap(Tensor<T>& tensor);
+    void share(const Tensor<T>& tensor);
     Tensor<T> clone() const;
     // Return type should be "reference" (not T&), in order to ensure it works
     // for std::vector<bool>, which is a special case...
@@ -424,7 +502,8 @@ public:
     };
     const std::vector<T>& data() const
     {
-        return (*mData)();
+        // Read-only access, does not mark the data as modified
+        return static_cast<const DataTensor<T>&>(*mData)();
     };
     const std::type_info* getType() const
     {
@@ -472,15 +551,80 @@ protected:
     
     template <class U>
     friend Tensor<U> tensor_cast_nocopy(const BaseTensor& base);
+    template <bool ROUND, class V, class U>
+    friend void tensor_cast_data(const Tensor<U>& tensor,
+                                 DataTensor<V>& data);
 
     // Needed for Tensor<T>& operator=(const Tensor<U>& tensor)
     template <class U> friend class Tensor;
 
 protected:
-    const std::shared_ptr<DataTensor<T> > mData;
-    const size_t mDataOffset;
+    // Not const, but only share() may rebind mData and mDataOffset (used by
+    // ReshapeCell_Frame to alias its input data). The rebound tensor drops
+    // its own tensor_cast() cache (mDataTensors), and the caches of other
+    // tensors are keyed on the DataTensor generation, so no stale cast can
+    // be returned. The Python NumPy views own a copy of the tensor and thus
+    // keep the previous DataTensor alive. Other raw pointers to the previous
+    // data storage only remain valid as long as another owner keeps it alive.
+    std::shared_ptr<DataTensor<T> > mData;
+    size_t mDataOffset;
 };
 
+template <bool ROUND, class T, class U>
+void tensor_cast_convert(const U* src, std::vector<T>& dst)
+{
+    if (std::is_integral<T>::value && !std::is_integral<U>::value && ROUND)
+        Tensor_Kernels::convertRound(src, &dst[0], dst.size());
+    else
+        Tensor_Kernels::convert(src, &dst[0], dst.size());
+}
+
+template <bool ROUND, class U>
+void tensor_cast_convert(const U* src, std::vector<bool>& dst)
+{
+    for (size_t i = 0; i < dst.size(); ++i) {
+        dst[i] = (!std::is_integral<U>::value && ROUND)
+            ? static_cast<bool>(std::round(static_cast<double>(src[i])))
+            : static_cast<bool>(src[i]);
+    }
+}
+
+/**
+ * Convert the data of @p tensor to @p data, unless @p data already holds the
+ * conversion of the current version of the data of @p tensor, and was not
+ * modified since.
+*/
+template <bool ROUND, class T, class U>
+void tensor_cast_data(const Tensor<U>& tensor, DataTensor<T>& data)
+{
+    std::lock_guard<std::mutex> lock(data.mCastMutex);
+    const unsigned long long sourceVersion = tensor.mData->getVersion();
+
+    if (data.mCastSourceGeneration == tensor.mData->mGeneration
+        && data.mCastOffset == tensor.mDataOffset
+        && data.mCastSourceVersion == sourceVersion
+        && data.mCastRound == ROUND
+        && data.size() == tensor.size()
+        && data.getVersion() == data.mCastVersion)
+    {
+        return;
+    }
+
+    std::vector<T>& dataVec = data();
+    dataVec.resize(tensor.size());
+
+    if (!dataVec.empty()) {
+        tensor_cast_convert<ROUND>(&tensor.data()[tensor.mDataOffset],
+                                   dataVec);
+    }
+
+    data.mCastSourceGeneration = tensor.mData->mGeneration;
+    data.mCastOffset = tensor.mDataOffset;
+    data.mCastSourceVersion = sourceVersion;
+    data.mCastVersion = data.getVersion();
+    data.mCastRound = ROUND;
+}
+
 template <class T, bool ROUND>
 typename std::enable_if<std::is_convertible<float,T>::value
                      || std::is_convertible<half_float::half,T>::value
@@ -490,98 +634,68 @@ tensor_cast(const BaseTensor& base)
     if (base.getType() == &typeid(T))
         return dynamic_cast<const Tensor<T>&>(base);
 
-    std::map<const std::type_info*, std::shared_ptr<BaseDataTensor> >
-        ::const_iterator it = base.mDataTensors.find(&typeid(T));
     std::shared_ptr<DataTensor<T> > dataTensor;
 
-    if (it != base.mDataTensors.end())
-        dataTensor = std::static_pointer_cast<DataTensor<T> >((*it).second);
-    else {
-        dataTensor
-            = std::make_shared<DataTensor<T> >(base.mSize);
-        base.mDataTensors[&typeid(T)] = dataTensor;
+    // Only the lookup of the cache is global: the conversion itself is
+    // serialized per cache, in tensor_cast_data()
+#pragma omp critical(Tensor__tensor_cast)
+    {
+        std::map<const std::type_info*, std::shared_ptr<BaseDataTensor> >
+            ::const_iterator it = base.mDataTensors.find(&typeid(T));
+
+        if (it != base.mDataTensors.end())
+            dataTensor = std::static_pointer_cast<DataTensor<T> >((*it).second);
+        else {
+            dataTensor
+                = std::make_shared<DataTensor<T> >(base.mSize);
+            base.mDataTensors[&typeid(T)] = dataTensor;
+        }
     }
 
     if (base.getType() == &typeid(float)) {
-        const Tensor<float>& tensor
-            = dynamic_cast<const Tensor<float>&>(base);
-
-        if (std::is_integral<T>::value && ROUND) {
-            std::transform(tensor.begin(), tensor.end(),
-                (*dataTensor)().begin(), (float (&)(float)) std::roundf);
-        }
-        else
-            std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<float>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(half_float::half)) {
-        const Tensor<half_float::half>& tensor
-            = dynamic_cast<const Tensor<half_float::half>&>(base);
-
-        if (std::is_integral<T>::value && ROUND) {
-            std::transform(tensor.begin(), tensor.end(),
-                (*dataTensor)().begin(), (float (&)(float)) std::roundf);
-        }
-        else
-            std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<half_float::half>&>(base),
+            *dataTensor);
     }
     else if (base.getType() == &typeid(double)) {
-        const Tensor<double>& tensor
-            = dynamic_cast<const Tensor<double>&>(base);
-
-        if (std::is_integral<T>::value && ROUND) {
-            std::transform(tensor.begin(), tensor.end(),
-                (*dataTensor)().begin(), (double (&)(double)) std::round);
-        }
-        else
-            std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<double>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(int8_t)) {
-        const Tensor<int8_t>& tensor
-            = dynamic_cast<const Tensor<int8_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<int8_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(uint8_t)) {
-        const Tensor<uint8_t>& tensor
-            = dynamic_cast<const Tensor<uint8_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<uint8_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(int16_t)) {
-        const Tensor<int16_t>& tensor
-            = dynamic_cast<const Tensor<int16_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<int16_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(uint16_t)) {
-        const Tensor<uint16_t>& tensor
-            = dynamic_cast<const Tensor<uint16_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<uint16_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(int32_t)) {
-        const Tensor<int32_t>& tensor
-            = dynamic_cast<const Tensor<int32_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<int32_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(uint32_t)) {
-        const Tensor<uint32_t>& tensor
-            = dynamic_cast<const Tensor<uint32_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<uint32_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(int64_t)) {
-        const Tensor<int64_t>& tensor
-            = dynamic_cast<const Tensor<int64_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<int64_t>&>(base), *dataTensor);
     }
     else if (base.getType() == &typeid(uint64_t)) {
-        const Tensor<uint64_t>& tensor
-            = dynamic_cast<const Tensor<uint64_t>&>(base);
-
-        std::copy(tensor.begin(), tensor.end(), (*dataTensor)().begin());
+        tensor_cast_data<ROUND>(
+            dynamic_cast<const Tensor<uint64_t>&>(base), *dataTensor);
     }
     else {
         throw std::runtime_error("tensor_cast(): "
@@ -622,16 +736,20 @@ Tensor<T> tensor_cast_nocopy(const BaseTensor& base)
     if (base.getType() == &typeid(T))
         return dynamic_cast<const Tensor<T>&>(base);
 
-    std::map<const std::type_info*, std::shared_ptr<BaseDataTensor> >
-        ::const_iterator it = base.mDataTensors.find(&typeid(T));
     std::shared_ptr<DataTensor<T> > dataTensor;
 
-    if (it != base.mDataTensors.end())
-        dataTensor = std::static_pointer_cast<DataTensor<T> >((*it).second);
-    else {
-        dataTensor
-            = std::make_shared<DataTensor<T> >(base.mSize);
-        base.mDataTensors[&typeid(T)] = dataTensor;
+#pragma omp critical(Tensor__tensor_cast)
+    {
+        std::map<const std::type_info*, std::shared_ptr<BaseDataTensor> >
+            ::const_iterator it = base.mDataTensors.find(&typeid(T));
+
+        if (it != base.mDataTensors.end())
+            dataTensor = std::static_pointer_cast<DataTensor<T> >((*it).second);
+        else {
+            dataTensor
+                = std::make_shared<DataTensor<T> >(base.mSize);
+            base.mDataTensors[&typeid(T)] = dataTensor;
+        }
     }
 
     return Tensor<T>(
@@ -761,18 +879,18 @@ operator()(Args... args) const
     if (sizeof...(args) == 1) {
         const size_t i[sizeof...(args)] = {static_cast<size_t>(args)...};
         assert(i[0] < size());
-        return (*mData)()[mDataOffset + i[0]];
+        return data()[mDataOffset + i[0]];
     }
     else if (sizeof...(args) == 2) {
         const size_t i[sizeof...(args)] = {static_cast<size_t>(args)...};
         assert(mDims.size() > 1);
         assert(i[0] < mSizeM1);
         assert(i[1] < mDims.back());
-        return (*mData)()[mDataOffset + i[0] + mSizeM1 * i[1]];
+        return data()[mDataOffset + i[0] + mSizeM1 * i[1]];
     }
     else {
         assert(sizeof...(args) == mDims.size());
-        return (*mData)()[mDataOffset + getOffset(0U, args...)];
+        return data()[mDataOffset + getOffset(0U, args...)];
     }
 }
 
@@ -828,7 +946,7 @@ inline typename N2D2::Tensor<T>::const_reference N2D2::Tensor<T>::at(Args... arg
         if (i[0] >= size())
             throw std::runtime_error("Tensor<T>::at(): Out of range!");
 
-        return (*mData)()[mDataOffset + i[0]];
+        return data()[mDataOffset + i[0]];
     }
     else if (sizeof...(args) == 2) {
         const size_t i[sizeof...(args)] = {static_cast<size_t>(args)...};
@@ -848,14 +966,14 @@ inline typename N2D2::Tensor<T>::const_reference N2D2::Tensor<T>::at(Args... arg
         if (i[1] >= mDims.back())
             throw std::runtime_error("Tensor<T>::at(): Out of range!");
 
-        return (*mData)()[mDataOffset + i[0] + mSizeM1 * i[1]];
+        return data()[mDataOffset + i[0] + mSizeM1 * i[1]];
     }
     else {
         if (sizeof...(args) != mDims.size())
             throw std::runtime_error("Tensor<T>::at(): Argument count must "
                                      "match tensor dimension");
 
-        return (*mData)()[mDataOffset + getOffset(0U, args...)];
+        return data()[mDataOffset + getOffset(0U, args...)];
     }
 }
 
@@ -0,0 +1,160 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_TENSOR_KERNELS_H
+#define N2D2_TENSOR_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "third_party/half.hpp"
+
+namespace N2D2 {
+/**
+ * Element-wise type conversion kernels used by tensor_cast().
+ * The half precision kernels are branch-free re-implementations of the
+ * half_float::half conversions and give bit-exact identical results, but
+ * vectorize.
+*/
+namespace Tensor_Kernels {
+    // Minimum number of elements for the conversion to be multi-threaded
+    const std::size_t ParallelThreshold = 16384;
+    // Elements are processed by blocks of BlockSize, the unit of work of
+    // the threads
+    const std::size_t BlockSize = 1024;
+
+    void convert(const float* src, half_float::half* dst, std::size_t size);
+    void convert(const half_float::half* src, float* dst, std::size_t size);
+    void convert(const half_float::half* src,
+                 half_float::half* dst,
+                 std::size_t size);
+
+    template <class T, class U>
+    void convert(const U* src, T* dst, std::size_t size);
+    template <class T>
+    void convert(const T* src, half_float::half* dst, std::size_t size);
+    template <class T>
+    void convert(const half_float::half* src, T* dst, std::size_t size);
+
+    // Round to nearest before converting, for floating point to integral
+    // conversions
+    template <class T, class U>
+    void convertRound(const U* src, T* dst, std::size_t size);
+    template <class T>
+    void convertRound(const half_float::half* src, T* dst, std::size_t size);
+}
+}
+
+template <class T, class U>
+void N2D2::Tensor_Kernels::convert(const U* src, T* dst, std::size_t size)
+{
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const int offset = block * BlockSize;
+        const int end = (int)std::min(offset + BlockSize, size);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = offset; i < end; ++i)
+            dst[i] = static_cast<T>(src[i]);
+    }
+}
+
+template <class T>
+void N2D2::Tensor_Kernels::convert(const T* src,
+                                   half_float::half* dst,
+                                   std::size_t size)
+{
+    // Same rounding as half_float::half(float(x)): convert to float by
+    // blocks, then to half
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const std::size_t offset = block * BlockSize;
+        const std::size_t n = std::min(BlockSize, size - offset);
+        float buffer[BlockSize];
+
+        convert(src + offset, buffer, n);
+        convert(buffer, dst + offset, n);
+    }
+}
+
+template <class T>
+void N2D2::Tensor_Kernels::convert(const half_float::half* src,
+                                   T* dst,
+                                   std::size_t size)
+{
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const std::size_t offset = block * BlockSize;
+        const std::size_t n = std::min(BlockSize, size - offset);
+        float buffer[BlockSize];
+
+        convert(src + offset, buffer, n);
+        convert(buffer, dst + offset, n);
+    }
+}
+
+template <class T, class U>
+void N2D2::Tensor_Kernels::convertRound(const U* src,
+                                        T* dst,
+                                        std::size_t size)
+{
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const int offset = block * BlockSize;
+        const int end = (int)std::min(offset + BlockSize, size);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = offset; i < end; ++i)
+            dst[i] = static_cast<T>(std::round(src[i]));
+    }
+}
+
+template <class T>
+void N2D2::Tensor_Kernels::convertRound(const half_float::half* src,
+                                        T* dst,
+                                        std::size_t size)
+{
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const std::size_t offset = block * BlockSize;
+        const std::size_t n = std::min(BlockSize, size - offset);
+        float buffer[BlockSize];
+
+        convert(src + offset, buffer, n);
+        convertRound(buffer, dst + offset, n);
+    }
+}
+
+#endif // N2D2_TENSOR_KERNELS_H
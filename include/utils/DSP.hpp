@@ -29,6 +29,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -49,6 +50,73 @@ namespace DSP {
         void fft_(std::vector<std::complex<T> >& x);
     }
 
+    /**
+     * Pre-computed FFT of a given size.
+     * The bit-reversal permutation and the twiddle factors of each stage are
+     * computed once, in the constructor. A plan is immutable after
+     * construction: a single plan can be executed concurrently from several
+     * threads.
+     * - Power of two sizes use an iterative DIT algorithm, with radix-4
+     *   stages (and one radix-2 stage first if log2(size) is odd);
+     * - Other sizes use Bluestein's algorithm, on top of a power of two plan.
+    */
+    template <typename T> class FftPlan {
+    public:
+        FftPlan(unsigned int size, bool inverse = false);
+        /// In-place transform of size() values. The inverse transform is
+        /// normalized (divided by size()), as ifft().
+        void execute(std::complex<T>* x) const;
+        void execute(std::vector<std::complex<T> >& x) const;
+        /**
+         * Forward transform of size() real values.
+         * Only the non-redundant size()/2 + 1 first bins are computed, the
+         * others are given by the conjugate symmetry y[size() - k]
+         * = conj(y[k]). For even sizes, this is computed with a complex
+         * transform of half the size.
+         *
+         * @param   x           Input signal (size() values).
+         * @param   y           Output spectrum (size()/2 + 1 values).
+        */
+        void executeReal(const T* x, std::complex<T>* y) const;
+        unsigned int size() const
+        {
+            return mSize;
+        };
+        bool isInverse() const
+        {
+            return mInverse;
+        };
+
+    private:
+        void executePowerOfTwo(std::complex<T>* x) const;
+        void executeBluestein(std::complex<T>* x) const;
+
+        unsigned int mSize;
+        bool mInverse;
+        // Power of two
+        std::vector<std::pair<unsigned int, unsigned int> > mSwaps;
+        bool mRadix2First;
+        // For each radix-4 stage of span 4h, W^k, W^(2k) and W^(3k) for k in
+        // [0, h[, stored contiguously
+        std::vector<std::vector<std::complex<T> > > mTwiddles;
+        // Bluestein
+        std::vector<std::complex<T> > mChirp;
+        std::vector<std::complex<T> > mFilter;
+        std::shared_ptr<FftPlan<T> > mForwardPlan;
+        std::shared_ptr<FftPlan<T> > mInversePlan;
+        // Real input
+        std::vector<std::complex<T> > mRealTwiddles;
+        std::shared_ptr<FftPlan<T> > mHalfPlan;
+    };
+
+    /**
+     * Return a plan for the given size and direction. Plans are created on
+     * first use and kept for the whole program duration.
+     * This function is thread-safe.
+    */
+    template <typename T>
+    const FftPlan<T>& getFftPlan(unsigned int size, bool inverse = false);
+
     template <typename T>
     std::vector<std::complex<T> > toComplex(const std::vector<T>& x);
     template <typename T>
@@ -70,6 +138,22 @@ namespace DSP {
         internal::fft_<T, true>(x);
     }
     template <typename T> void hilbert(std::vector<std::complex<T> >& x);
+    /**
+     * FFT of a real signal, of any size (no zero-padding).
+     * Only the size(x)/2 + 1 non-redundant bins are returned.
+    */
+    template <typename T>
+    std::vector<std::complex<T> > rfft(const std::vector<T>& x);
+    /**
+     * 2D FFT of a width x height row-major array, of any size (no
+     * zero-padding). The inverse transform is normalized.
+     * The rows, then the columns are transformed in parallel.
+    */
+    template <typename T>
+    void fft2(std::vector<std::complex<T> >& x,
+              unsigned int width,
+              unsigned int height,
+              bool inverse = false);
 
     /**
      * Short-time Fourier transform (STFT).
@@ -134,40 +218,301 @@ void N2D2::DSP::internal::fft_(std::vector<std::complex<T> >& x)
         x.resize(size, 0.0);
     }
 
-    const int bits = (int)(std::log((double)size) / std::log(2.0));
-    for (unsigned int j = 1; j < size / 2; j++) {
-        const int swapPos = internal::bitReverse(j, bits);
-        std::swap(x[j], x[swapPos]);
+    if (size > 0)
+        getFftPlan<T>(size, INV).execute(x);
+}
+
+template <typename T>
+N2D2::DSP::FftPlan<T>::FftPlan(unsigned int size, bool inverse)
+    : mSize(size),
+      mInverse(inverse),
+      mRadix2First(false)
+{
+    if (size == 0)
+        throw std::domain_error("FftPlan: size must be > 0");
+
+    const double sign = (inverse) ? 1.0 : -1.0;
+
+    if ((size & (size - 1)) == 0) {
+        unsigned int bits = 0;
+
+        while ((1U << bits) < size)
+            ++bits;
+
+        for (unsigned int j = 1; j < size; ++j) {
+            const unsigned int swapPos = internal::bitReverse(j, bits);
+
+            if (j < swapPos)
+                mSwaps.push_back(std::make_pair(j, swapPos));
+        }
+
+        mRadix2First = (bits % 2 != 0);
+
+        for (unsigned int h = (mRadix2First) ? 2 : 1; 4 * h <= size; h *= 4)
+        {
+            std::vector<std::complex<T> > twiddles(3 * h);
+
+            for (unsigned int k = 0; k < h; ++k) {
+                for (unsigned int j = 1; j <= 3; ++j) {
+                    twiddles[(j - 1) * h + k] = std::polar(1.0,
+                        sign * 2.0 * M_PI * j * k / (4.0 * h));
+                }
+            }
+
+            mTwiddles.push_back(twiddles);
+        }
+    }
+    else {
+        // Bluestein: the DFT is expressed as a convolution with a chirp,
+        // computed with power of two FFTs
+        unsigned int convSize = 1;
+
+        while (convSize < 2 * size - 1)
+            convSize <<= 1;
+
+        mChirp.resize(size);
+
+        for (unsigned int n = 0; n < size; ++n) {
+            // n^2 mod 2*size, to keep the precision for large n
+            const unsigned long long n2
+                = ((unsigned long long)n * n) % (2ULL * size);
+            mChirp[n] = std::polar(1.0, sign * M_PI * n2 / (double)size);
+        }
+
+        mFilter.assign(convSize, 0.0);
+        mFilter[0] = std::conj(mChirp[0]);
+
+        for (unsigned int n = 1; n < size; ++n) {
+            mFilter[n] = std::conj(mChirp[n]);
+            mFilter[convSize - n] = std::conj(mChirp[n]);
+        }
+
+        mForwardPlan = std::make_shared<FftPlan<T> >(convSize, false);
+        mInversePlan = std::make_shared<FftPlan<T> >(convSize, true);
+        mForwardPlan->execute(mFilter);
+    }
+
+    if (!inverse && size % 2 == 0 && size > 2) {
+        const unsigned int halfSize = size / 2;
+
+        mRealTwiddles.resize(halfSize + 1);
+
+        for (unsigned int k = 0; k <= halfSize; ++k)
+            mRealTwiddles[k] = std::polar(1.0, -2.0 * M_PI * k / size);
+
+        mHalfPlan = std::make_shared<FftPlan<T> >(halfSize, false);
+    }
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::execute(std::complex<T>* x) const
+{
+    if (mChirp.empty())
+        executePowerOfTwo(x);
+    else
+        executeBluestein(x);
+
+    if (mInverse) {
+        const T scale = 1.0 / mSize;
+        T* p = reinterpret_cast<T*>(x);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = 0; i < 2 * (int)mSize; ++i)
+            p[i] *= scale;
+    }
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::execute(std::vector<std::complex<T> >& x) const
+{
+    if (x.size() != mSize)
+        throw std::domain_error("FftPlan::execute(): size mismatch");
+
+    execute(&x[0]);
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::executePowerOfTwo(std::complex<T>* x) const
+{
+    for (typename std::vector<std::pair<unsigned int, unsigned int> >
+        ::const_iterator it = mSwaps.begin(), itEnd = mSwaps.end();
+        it != itEnd; ++it)
+    {
+        std::swap(x[(*it).first], x[(*it).second]);
     }
 
-    for (unsigned int N = 2; N <= size; N <<= 1) {
-        for (unsigned int i = 0; i < size; i += N) {
-            for (unsigned int k = 0; k < N / 2; k++) {
-                const int evenIndex = i + k;
-                const int oddIndex = i + k + (N / 2);
-                const std::complex<T> even = x[evenIndex];
-                const std::complex<T> odd = x[oddIndex];
+    // std::complex<T> is guaranteed to be layout-compatible with T[2]: the
+    // butterflies are written on the real and imaginary parts, so that the
+    // inner loops can be vectorized
+    T* p = reinterpret_cast<T*>(x);
+
+    if (mRadix2First) {
+        for (unsigned int i = 0; i < 2 * mSize; i += 4) {
+            const T ar = p[i];
+            const T ai = p[i + 1];
+
+            p[i] = ar + p[i + 2];
+            p[i + 1] = ai + p[i + 3];
+            p[i + 2] = ar - p[i + 2];
+            p[i + 3] = ai - p[i + 3];
+        }
+    }
 
-                const double term = (-2.0 * M_PI * k) / (double)N;
-                const std::complex<T> twiddle
-                    = std::polar(1.0, (INV) ? -term : term) * odd;
+    // -i (forward) or +i (inverse) rotation of the odd terms
+    const T rot = (mInverse) ? 1.0 : -1.0;
+    unsigned int h = (mRadix2First) ? 2 : 1;
 
-                x[evenIndex] = even + twiddle;
-                x[oddIndex] = even - twiddle;
+    for (typename std::vector<std::vector<std::complex<T> > >::const_iterator
+        itStage = mTwiddles.begin(), itStageEnd = mTwiddles.end();
+        itStage != itStageEnd; ++itStage, h *= 4)
+    {
+        const T* w1 = reinterpret_cast<const T*>(&(*itStage)[0]);
+        const T* w2 = w1 + 2 * h;
+        const T* w3 = w2 + 2 * h;
+
+        for (unsigned int i = 0; i < mSize; i += 4 * h) {
+            // The four sub-DFTs of size h, in bit-reversed order: residues
+            // 0, 2, 1 and 3 (mod 4) of the group
+            T* a = p + 2 * i;
+            T* b = a + 2 * h;
+            T* c = b + 2 * h;
+            T* d = c + 2 * h;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for (int k = 0; k < (int)h; ++k) {
+                const int re = 2 * k;
+                const int im = 2 * k + 1;
+
+                // b' = W^(2k).b, c' = W^k.c, d' = W^(3k).d
+                const T br = w2[re] * b[re] - w2[im] * b[im];
+                const T bi = w2[re] * b[im] + w2[im] * b[re];
+                const T cr = w1[re] * c[re] - w1[im] * c[im];
+                const T ci = w1[re] * c[im] + w1[im] * c[re];
+                const T dr = w3[re] * d[re] - w3[im] * d[im];
+                const T di = w3[re] * d[im] + w3[im] * d[re];
+
+                const T t0r = a[re] + br;
+                const T t0i = a[im] + bi;
+                const T t1r = a[re] - br;
+                const T t1i = a[im] - bi;
+                const T t2r = cr + dr;
+                const T t2i = ci + di;
+                // t3 = (-/+ i).(c' - d')
+                const T t3r = -rot * (ci - di);
+                const T t3i = rot * (cr - dr);
+
+                a[re] = t0r + t2r;
+                a[im] = t0i + t2i;
+                b[re] = t1r + t3r;
+                b[im] = t1i + t3i;
+                c[re] = t0r - t2r;
+                c[im] = t0i - t2i;
+                d[re] = t1r - t3r;
+                d[im] = t1i - t3i;
             }
         }
     }
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::executeBluestein(std::complex<T>* x) const
+{
+    const unsigned int convSize = mFilter.size();
+    std::vector<std::complex<T> > y(convSize, 0.0);
+
+    for (unsigned int n = 0; n < mSize; ++n)
+        y[n] = x[n] * mChirp[n];
+
+    mForwardPlan->execute(y);
+
+    for (unsigned int n = 0; n < convSize; ++n)
+        y[n] *= mFilter[n];
+
+    // The inverse plan normalization (1/convSize) is the one required by
+    // the convolution
+    mInversePlan->execute(y);
+
+    for (unsigned int k = 0; k < mSize; ++k)
+        x[k] = y[k] * mChirp[k];
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::executeReal(const T* x, std::complex<T>* y) const
+{
+    if (mInverse)
+        throw std::domain_error("FftPlan::executeReal(): forward plan "
+                                "required");
+
+    if (!mHalfPlan) {
+        // Odd or tiny sizes: plain complex transform
+        std::vector<std::complex<T> > z(x, x + mSize);
+        execute(z);
+        std::copy(z.begin(), z.begin() + mSize / 2 + 1, y);
+        return;
+    }
+
+    // Even samples as real part, odd samples as imaginary part, in y
+    const unsigned int halfSize = mSize / 2;
+
+    for (unsigned int n = 0; n < halfSize; ++n)
+        y[n] = std::complex<T>(x[2 * n], x[2 * n + 1]);
 
-    if (INV) {
-        std::transform(x.begin(),
-                       x.end(),
-                       x.begin(),
-                       std::bind(std::divides<std::complex<T> >(),
-                                 std::placeholders::_1,
-                                 (double)size));
+    mHalfPlan->execute(y);
+
+    // Split the spectra of the even and odd samples, and combine them
+    const std::complex<T> z0 = y[0];
+    y[0] = std::complex<T>(z0.real() + z0.imag(), 0.0);
+    y[halfSize] = std::complex<T>(z0.real() - z0.imag(), 0.0);
+
+    for (unsigned int k = 1; k <= halfSize / 2; ++k) {
+        const unsigned int kc = halfSize - k;
+        const std::complex<T> zk = y[k];
+        const std::complex<T> zkc = std::conj(y[kc]);
+
+        // X[k] = E[k] + W^k.O[k], with E[k] = (Z[k] + conj(Z[N/2-k])) / 2
+        // and O[k] = -i.(Z[k] - conj(Z[N/2-k])) / 2
+        const std::complex<T> even = T(0.5) * (zk + zkc);
+        const std::complex<T> odd
+            = std::complex<T>(0.0, -0.5) * (zk - zkc);
+
+        y[k] = even + mRealTwiddles[k] * odd;
+
+        if (kc != k) {
+            // E[N/2-k] = conj(E[k]), O[N/2-k] = conj(O[k])
+            y[kc] = std::conj(even) + mRealTwiddles[kc] * std::conj(odd);
+        }
     }
 }
 
+template <typename T>
+const N2D2::DSP::FftPlan<T>& N2D2::DSP::getFftPlan(unsigned int size,
+                                                   bool inverse)
+{
+    static std::map<std::pair<unsigned int, bool>,
+                    std::shared_ptr<FftPlan<T> > > plans;
+    std::shared_ptr<FftPlan<T> > plan;
+
+    if (size == 0)
+        throw std::domain_error("getFftPlan(): size must be > 0");
+
+#pragma omp critical(DSP__getFftPlan)
+    {
+        std::shared_ptr<FftPlan<T> >& cachedPlan
+            = plans[std::make_pair(size, inverse)];
+
+        if (!cachedPlan)
+            cachedPlan = std::make_shared<FftPlan<T> >(size, inverse);
+
+        plan = cachedPlan;
+    }
+
+    return *plan;
+}
+
 template <typename T>
 std::vector<std::complex<T> > N2D2::DSP::toComplex(const std::vector<T>& x)
 {
@@ -218,6 +563,50 @@ template <typename T> void N2D2::DSP::hilbert(std::vector<std::complex<T> >& x)
     ifft(x);
 }
 
+template <typename T>
+std::vector<std::complex<T> > N2D2::DSP::rfft(const std::vector<T>& x)
+{
+    if (x.empty())
+        return std::vector<std::complex<T> >();
+
+    std::vector<std::complex<T> > y(x.size() / 2 + 1);
+    getFftPlan<T>(x.size()).executeReal(&x[0], &y[0]);
+    return y;
+}
+
+template <typename T>
+void N2D2::DSP::fft2(std::vector<std::complex<T> >& x,
+                     unsigned int width,
+                     unsigned int height,
+                     bool inverse)
+{
+    if (x.size() != width * height)
+        throw std::domain_error("fft2(): size mismatch");
+
+    if (x.empty())
+        return;
+
+    const FftPlan<T>& rowPlan = getFftPlan<T>(width, inverse);
+    const FftPlan<T>& colPlan = getFftPlan<T>(height, inverse);
+
+#pragma omp parallel for if (height > 4)
+    for (int i = 0; i < (int)height; ++i)
+        rowPlan.execute(&x[i * width]);
+
+    std::vector<std::complex<T> > col(height);
+
+#pragma omp parallel for firstprivate(col) if (width > 4)
+    for (int j = 0; j < (int)width; ++j) {
+        for (unsigned int i = 0; i < height; ++i)
+            col[i] = x[i * width + j];
+
+        colPlan.execute(col);
+
+        for (unsigned int i = 0; i < height; ++i)
+            x[i * width + j] = col[i];
+    }
+}
+
 template <typename T>
 std::vector<std::vector<std::complex<T> > >
 N2D2::DSP::stft(const std::vector<T>& x,
@@ -266,12 +655,14 @@ N2D2::DSP::stft(const std::vector<T>& x,
     std::vector<std::vector<std::complex<T> > > y(
         nFft, std::vector<std::complex<T> >(nFrames, 0.0));
 
+    // The frames are real: only the nFft/2 + 1 first bins are computed
+    const FftPlan<T>& plan = getFftPlan<T>(nFft);
+
     std::vector<T> xt;
-    std::vector<std::complex<T> > yt;
+    std::vector<std::complex<T> > yt(nFft / 2 + 1);
     xt.reserve(nFft);
-    yt.reserve(nFft);
 
-#pragma omp parallel for private(xt, yt) if (nFrames > 4)
+#pragma omp parallel for firstprivate(xt, yt) if (nFrames > 4)
     for (int t = 0; t < nFrames; ++t) {
         const int offset = -((int)wSize / 2) + t * nHop;
 
@@ -293,14 +684,15 @@ N2D2::DSP::stft(const std::vector<T>& x,
         std::rotate(xt.begin(), xt.begin() + wSize / 2, xt.end());
         xt.insert(xt.begin() + wSize / 2, nFft - wSize, 0.0);
 
-        yt = toComplex(xt);
-        fft(yt);
+        plan.executeReal(&xt[0], &yt[0]);
 
-#pragma omp critical(DSP__stft)
-        {
-            for (unsigned int f = 0; f < nFft; ++f)
-                y[f][t] = yt[f];
-        }
+        // Each frame is a distinct column of y: no synchronization needed
+        for (unsigned int f = 0; f <= nFft / 2; ++f)
+            y[f][t] = yt[f];
+
+        // Conjugate symmetry
+        for (unsigned int f = nFft / 2 + 1; f < nFft; ++f)
+            y[f][t] = std::conj(yt[nFft - f]);
     }
 
     return y;
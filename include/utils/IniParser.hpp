@@ -29,6 +29,7 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "utils/Utils.hpp"
 
@@ -212,18 +213,87 @@ public:
         return mFileName;
     };
 
+    /**
+     * Enable the cache of the loaded INI files. The cache holds the property
+     * tree obtained after the templates expansion and the results of the
+     * math expressions. It is used by load() as long as the INI file, its
+     * templates and the files they include are unchanged.
+     *
+     * @param cachePath         Cache directory (empty to disable the cache)
+    */
+    void setCachePath(const std::string& cachePath)
+    {
+        mCachePath = cachePath;
+    };
+
+    /**
+     * Check if the last INI file was loaded from the cache.
+     *
+     * @return True if the cache was used
+    */
+    bool isCached() const
+    {
+        return mCached;
+    };
+
+    /**
+     * Attach a value derived from the INI file content to the cache, in
+     * order to skip its computation when the cache is used.
+     *
+     * @param name              Name of the value
+     * @param value             Value
+    */
+    void setCacheValue(const std::string& name, const std::string& value);
+
+    /**
+     * Get a value attached to the cache.
+     *
+     * @param name              Name of the value
+     * @param value             Value
+     * @return True if the value is in the cache
+    */
+    bool getCacheValue(const std::string& name, std::string& value) const;
+
+    /**
+     * Write the cache of the last loaded INI file, with the math expressions
+     * evaluated and the values attached since it was loaded. Nothing is
+     * written if the cache is disabled or up-to-date.
+    */
+    void saveCache() const;
+
     /// Destructor
     virtual ~IniParser();
 
 private:
+    typedef std::vector<std::map<std::string, std::pair<std::string, bool> > >
+        IniData_T;
+
     std::string getPropertyValue(std::string value) const;
     void loadTplIni(const std::string& tplIni);
+    void addDependency(const std::string& fileName);
+    std::string getCacheFileName() const;
+    bool loadCache();
 
     std::string mFileName;
     unsigned int mCurrentSection;
     bool mCheckForUnknown;
     std::vector<std::string> mIniSections;
-    std::vector<std::map<std::string, std::pair<std::string, bool> > > mIniData;
+    IniData_T mIniData;
+
+    // Cache
+    std::string mCachePath;
+    bool mCached;
+    mutable bool mCacheModified;
+    /// Files read by load(), with the hash of their content
+    std::vector<std::pair<std::string, unsigned long long int> > mDependencies;
+    /// Environment variables used by load(), with their value
+    std::map<std::string, std::string> mEnvDependencies;
+    /// Property tree at the end of load()
+    std::vector<std::string> mLoadedSections;
+    IniData_T mLoadedData;
+    /// Results of the math expressions
+    mutable std::map<std::string, std::string> mExpressions;
+    std::map<std::string, std::string> mCacheValues;
 };
 }
 
@@ -0,0 +1,67 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_MEMORYMAPPEDFILE_H
+#define N2D2_MEMORYMAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace N2D2 {
+/**
+ * Read-only memory mapping of a whole file.
+ * The mapping is released when the object is destroyed, any pointer obtained
+ * with data() must not outlive it.
+*/
+class MemoryMappedFile {
+public:
+    MemoryMappedFile(const std::string& fileName);
+    const unsigned char* data() const
+    {
+        return mData;
+    };
+    std::size_t size() const
+    {
+        return mSize;
+    };
+    const std::string& getFileName() const
+    {
+        return mFileName;
+    };
+    /// Hint that a range of the file will be accessed soon, so that the
+    /// system can read it ahead asynchronously
+    void prefetch(std::size_t offset, std::size_t size) const;
+    virtual ~MemoryMappedFile();
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&); // non construction-copyable
+    MemoryMappedFile& operator=(const MemoryMappedFile&); // non-copyable
+
+    const std::string mFileName;
+    const unsigned char* mData;
+    std::size_t mSize;
+#ifdef WIN32
+    void* mFile;
+    void* mMapping;
+#endif
+};
+}
+
+#endif // N2D2_MEMORYMAPPEDFILE_H
@@ -143,6 +143,11 @@ public:
     void render(std::ostream& output, const std::string& source);
     std::string renderFile(const std::string& fileName);
     void renderFile(std::ostream& output, const std::string& fileName);
+    /// Files included by the rendered templates
+    const std::vector<std::string>& getIncludedFiles() const
+    {
+        return mIncludedFiles;
+    };
 
 private:
     size_t processSection(const std::string& source,
@@ -150,6 +155,7 @@ private:
                           Section* section);
 
     std::map<std::string, std::string> mParameters;
+    std::vector<std::string> mIncludedFiles;
 };
 }
 
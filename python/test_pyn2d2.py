@@ -0,0 +1,226 @@
+#!/usr/bin/python
+# -*- coding: ISO-8859-1 -*-
+################################################################################
+#    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+#    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+#
+#    This software is governed by the CeCILL-C license under French law and
+#    abiding by the rules of distribution of free software.  You can  use,
+#    modify and/ or redistribute the software under the terms of the CeCILL-C
+#    license as circulated by CEA, CNRS and INRIA at the following URL
+#    "http://www.cecill.info".
+#
+#    As a counterpart to the access to the source code and  rights to copy,
+#    modify and redistribute granted by the license, users are provided only
+#    with a limited warranty  and the software's author,  the holder of the
+#    economic rights,  and the successive licensors  have only  limited
+#    liability.
+#
+#    The fact that you are presently reading this means that you have had
+#    knowledge of the CeCILL-C license and that you accept its terms.
+################################################################################
+
+# Unit tests of the NumPy views and of the asynchronous calls of the Python
+# binding. Run them with pyn2d2 in the PYTHONPATH, for example from the build
+# directory:
+#     PYTHONPATH=. python3 -m unittest -v ../python/test_pyn2d2.py
+# It is also run by ctest, after "make tests".
+# The DeepNet tests require the MNIST database in $N2D2_DATA/mnist.
+
+import asyncio
+import gc
+import os
+import shutil
+import sys
+import tempfile
+import threading
+import time
+import unittest
+
+import numpy
+import pyn2d2 as N2D2
+
+
+def n2d2Data(path):
+    # Same default location as N2D2_DATA() in N2D2.cpp
+    base = os.environ.get("N2D2_DATA")
+
+    if base is None:
+        if "USER" in os.environ:
+            base = "/local/" + os.environ["USER"] + "/n2d2_data"
+        else:
+            base = "/local/n2d2_data"
+
+    return os.path.join(base, path)
+
+
+class TensorViewTest(unittest.TestCase):
+    def setUp(self):
+        self.database = N2D2.Database()
+        self.sp = N2D2.StimuliProvider(self.database, [4, 4, 1], 2)
+
+    def test_data_view(self):
+        view = self.sp.getDataView()
+
+        self.assertEqual(view.shape, (2, 1, 4, 4))
+        self.assertEqual(type(view.base).__name__, "PyCapsule")
+
+        # No copy: the view writes into the provider data
+        view[1, 0, 2, 3] = 5.0
+        data = numpy.array(self.sp.getData())
+        self.assertEqual(data[1, 0, 2, 3], 5.0)
+        self.assertEqual(numpy.count_nonzero(data), 1)
+
+    def test_labels_data_view(self):
+        view = self.sp.getLabelsDataView()
+
+        self.assertEqual(view.shape, (2, 1, 1, 1))
+        self.assertEqual(view.dtype, numpy.int32)
+
+        view[0, 0, 0, 0] = 3
+        self.assertEqual(numpy.array(self.sp.getLabelsData())[0, 0, 0, 0], 3)
+
+    def test_view_outlives_owner(self):
+        view = self.sp.getDataView()
+        view[...] = 2.0
+
+        # The view owns the data with the provider
+        del self.sp
+        gc.collect()
+
+        self.assertTrue((view == 2.0).all())
+        view[...] = 3.0
+        self.assertTrue((view == 3.0).all())
+
+    def test_future_rethrows(self):
+        # The empty database has no stimulus to read
+        future = self.sp.readBatchAsync(N2D2.Database.Test, 0)
+
+        with self.assertRaises(RuntimeError):
+            future.wait()
+
+        self.assertTrue(future.ready())
+
+    def test_future_await_rethrows(self):
+        async def readBatch():
+            await self.sp.readBatchAsync(N2D2.Database.Test, 0)
+
+        with self.assertRaises(RuntimeError):
+            asyncio.run(readBatch())
+
+
+@unittest.skipUnless(os.path.isdir(n2d2Data("mnist")), "MNIST is required")
+class DeepNetAsyncTest(unittest.TestCase):
+    def setUp(self):
+        self.dirName = tempfile.mkdtemp()
+        iniFile = os.path.join(self.dirName, "net_test.ini")
+
+        with open(iniFile, "w") as ini:
+            ini.write("DefaultModel=Frame\n"
+                      "\n"
+                      "[database]\n"
+                      "Type=MNIST_IDX_Database\n"
+                      "\n"
+                      "[sp]\n"
+                      "SizeX=28\n"
+                      "SizeY=28\n"
+                      "BatchSize=256\n"
+                      "\n"
+                      "[conv]\n"
+                      "Input=sp\n"
+                      "Type=Conv\n"
+                      "KernelDims=5 5\n"
+                      "NbOutputs=64\n"
+                      "\n"
+                      "[fc]\n"
+                      "Input=conv\n"
+                      "Type=Fc\n"
+                      "NbOutputs=10\n"
+                      "\n"
+                      "[fc.Target]\n")
+
+        self.net = N2D2.Network(1)
+        self.deepNet = N2D2.DeepNetGenerator.generate(self.net, iniFile)
+        self.deepNet.initialize()
+        self.sp = self.deepNet.getStimuliProvider()
+
+    def tearDown(self):
+        shutil.rmtree(self.dirName)
+
+    def test_read_batch_async(self):
+        future = self.sp.readBatchAsync(N2D2.Database.Test, 256)
+        future.wait()
+        self.assertTrue(future.ready())
+
+        dataAsync = numpy.array(self.sp.getData())
+        labelsAsync = numpy.array(self.sp.getLabelsData())
+
+        self.sp.readBatch(N2D2.Database.Test, 256)
+
+        numpy.testing.assert_array_equal(dataAsync,
+                                         numpy.array(self.sp.getData()))
+        numpy.testing.assert_array_equal(labelsAsync,
+                                         numpy.array(self.sp.getLabelsData()))
+
+    def test_read_batch_await(self):
+        async def readBatch():
+            await self.sp.readBatchAsync(N2D2.Database.Test, 0)
+
+        asyncio.run(readBatch())
+
+        dataAsync = numpy.array(self.sp.getData())
+        self.sp.readBatch(N2D2.Database.Test, 0)
+
+        numpy.testing.assert_array_equal(dataAsync,
+                                         numpy.array(self.sp.getData()))
+
+    def test_propagate_async_outputs_view(self):
+        self.sp.readBatch(N2D2.Database.Test, 0)
+        self.deepNet.propagateAsync(N2D2.Database.Test, True).wait()
+
+        cell = self.deepNet.getCell_Frame_Top("fc")
+        outputs = numpy.array(cell.getOutputs())
+        view = cell.getOutputsView()
+
+        self.assertEqual(view.shape, (256, 10, 1, 1))
+        numpy.testing.assert_array_equal(view, outputs)
+
+        # The view follows the next propagations
+        self.sp.readBatch(N2D2.Database.Test, 256)
+        self.deepNet.propagate(N2D2.Database.Test, True)
+
+        self.assertFalse((view == outputs).all())
+        numpy.testing.assert_array_equal(view, numpy.array(cell.getOutputs()))
+
+    def test_wait_releases_gil(self):
+        self.sp.readBatch(N2D2.Database.Test, 0)
+
+        stamps = []
+        done = threading.Event()
+
+        def count():
+            while not done.is_set():
+                stamps.append(time.perf_counter())
+
+        thread = threading.Thread(target=count)
+        thread.start()
+
+        t0 = time.perf_counter()
+        self.deepNet.propagateAsync(N2D2.Database.Test, True).wait()
+        t1 = time.perf_counter()
+
+        done.set()
+        thread.join()
+
+        # The Python thread keeps running during the blocking call, not only
+        # within the interpreter switch interval around their start and end
+        margin = 2.0 * sys.getswitchinterval()
+
+        if t1 - t0 < 4.0 * margin:
+            self.skipTest("propagation too fast to check the GIL release")
+
+        self.assertTrue(any(t0 + margin < t < t1 - margin for t in stamps))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -30,6 +30,7 @@ N2D2::CEnvironment::CEnvironment(Database& database,
       SpikeGenerator(),
       mInitialized(false),
       mStopStimulus(false),
+      mEventIndex(0),
       mNextAerEventTime(0),
       mNoConversion(this, "NoConversion", false),
       mScaling(this, "Scaling", 1.0),
@@ -164,11 +165,11 @@ void N2D2::CEnvironment::tick(Time_T timestamp, Time_T start, Time_T stop)
         mTickData.assign(
             mTickData.dims(), 0);
 
-        while (mEventIterator != mAerData.end() &&
-        (*mEventIterator).time + start <= timestamp) {
-            unsigned int x = (*mEventIterator).x;
-            unsigned int y = (*mEventIterator).y;
-            unsigned int channel = (*mEventIterator).channel;
+        while (mEventIndex < mAerData.size() &&
+        mAerData.time(mEventIndex) + start <= timestamp) {
+            unsigned int x = mAerData.x(mEventIndex);
+            unsigned int y = mAerData.y(mEventIndex);
+            unsigned int channel = mAerData.polarity(mEventIndex);
 
             if (x > mTickData.dimX() || y > mTickData.dimY()
             || channel > mTickData.dimZ()) {
@@ -177,7 +178,7 @@ void N2D2::CEnvironment::tick(Time_T timestamp, Time_T start, Time_T stop)
 
             mTickData(x, y, channel, 0) = 1;
             mTickActivity(x, y, channel, 0) += mTickData(x, y, channel, 0);
-            ++mEventIterator;
+            ++mEventIndex;
         }
     }
 
@@ -192,29 +193,14 @@ void N2D2::CEnvironment::tick(Time_T timestamp, Time_T start, Time_T stop)
 void N2D2::CEnvironment::loadAerStream(Time_T start,
                                         Time_T stop)
 {
-    mAerData.clear();
-
-    std::ifstream data(mStreamPath);
-
-    unsigned int x, y, polarity;
-    unsigned int timestamp;
-
-    if (data.good()) {
-        // By default we use batch of size 1 and all spikes value 1
-        while (data >> x >> y >> timestamp >> polarity){
-            if ((start == 0 && stop == 0) || 
-            (timestamp >= start && timestamp <= stop)){
-                mAerData.push_back(AerReadEvent(x, y, polarity, 0, 1, 
-                                                timestamp));
-            }
-        }
-    }
-    else {
-        throw std::runtime_error("CEnvironment::loadAerStream: "
-                                    "Could not open AER file: " + 
-                                    std::string(mStreamPath));
-    }
-
+    // The whole stream is decoded at once and sorted by time, the
+    // [start, stop] window is then a view on the decoded events
+    mAerStream.load(std::string(mStreamPath), AerStream::Text);
+
+    mAerData = (start == 0 && stop == 0) ? mAerStream.getWindow()
+                                         : mAerStream.getWindow(start,
+                                                                stop + 1);
+    mEventIndex = 0;
 }
 
 
@@ -248,7 +234,7 @@ void N2D2::CEnvironment::initializeSpikeGenerator(Time_T start, Time_T stop)
 
     AER_Database * aerDatabase = dynamic_cast<AER_Database*>(&mDatabase);
     if (aerDatabase) {
-        mEventIterator = mAerData.begin();
+        mEventIndex = 0;
     }
 }
 
@@ -22,6 +22,7 @@
 #include "DeepNet.hpp"
 #include "GradientCheck.hpp"
 #include "Solver/SGDSolver_Frame.hpp"
+#include "containers/Tensor_Kernels.hpp"
 #include "third_party/half.hpp"
 
 template <>
@@ -152,6 +153,268 @@ void N2D2::BatchNormCell_Frame<T>::initialize()
 
 }
 
+namespace {
+// Channel planes are split in chunks small enough to stay in cache between
+// the successive passes over a chunk. The work is distributed over the
+// (channel, batch position, chunk) units, so that a few channels with a large
+// spatial extent still use all the threads.
+const unsigned int chunkSize = 4096;
+
+struct Chunk {
+    unsigned int channel;
+    unsigned int batchPos;
+    unsigned int begin;
+    unsigned int end;
+};
+
+// Units are ordered by channel, so that the partial results of a channel
+// are contiguous and always merged in the same order
+template <class T>
+unsigned int getNbUnits(const N2D2::Tensor<T>& input, unsigned int& nbChunks)
+{
+    const unsigned int planeSize = input.dimX() * input.dimY();
+    nbChunks = (planeSize + chunkSize - 1) / chunkSize;
+    return input.dimZ() * input.dimB() * nbChunks;
+}
+
+template <class T>
+Chunk getChunk(const N2D2::Tensor<T>& input,
+               unsigned int nbChunks,
+               unsigned int unit)
+{
+    const unsigned int planeSize = input.dimX() * input.dimY();
+    const unsigned int chunk = unit % nbChunks;
+
+    Chunk c;
+    c.channel = unit / (nbChunks * input.dimB());
+    c.batchPos = (unit / nbChunks) % input.dimB();
+    c.begin = chunk * chunkSize;
+    c.end = std::min(c.begin + chunkSize, planeSize);
+    return c;
+}
+
+template <class T, class ParamT>
+void normalize(const N2D2::Tensor<T>& input,
+               const N2D2::Tensor<ParamT>& scale,
+               const N2D2::Tensor<ParamT>& bias,
+               const N2D2::Tensor<ParamT>& mean,
+               const N2D2::Tensor<ParamT>& variance,
+               double epsilon,
+               unsigned int paramOffset,
+               unsigned int outputOffset,
+               N2D2::Tensor<T>& outputs)
+{
+    // The division by the standard deviation is done once per channel
+    std::vector<ParamT> alpha(input.dimZ());
+
+    for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
+        const unsigned int param = paramOffset + channel;
+        alpha[channel] = scale(param)
+            / std::sqrt(variance(param) + ParamT(epsilon));
+    }
+
+    unsigned int nbChunks;
+    const int nbUnits = getNbUnits(input, nbChunks);
+
+#pragma omp parallel for if (nbUnits > 16)
+    for (int unit = 0; unit < nbUnits; ++unit) {
+        const Chunk c = getChunk(input, nbChunks, unit);
+        const unsigned int param = paramOffset + c.channel;
+        const unsigned int output = outputOffset + c.channel;
+        const ParamT a = alpha[c.channel];
+        const ParamT m = mean(param);
+        const ParamT b = bias(param);
+        const T* inputPlane = &input(0, 0, c.channel, c.batchPos);
+        T* outputPlane = &outputs(0, 0, output, c.batchPos);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (unsigned int i = c.begin; i < c.end; ++i)
+            outputPlane[i] = T(a * (ParamT(inputPlane[i]) - m) + b);
+    }
+}
+
+template <class T, class ParamT>
+void forwardInference(const N2D2::Tensor<T>& input,
+                      const N2D2::Tensor<ParamT>& scale,
+                      const N2D2::Tensor<ParamT>& bias,
+                      const N2D2::Tensor<ParamT>& mean,
+                      const N2D2::Tensor<ParamT>& variance,
+                      double epsilon,
+                      unsigned int outputOffset,
+                      N2D2::Tensor<T>& outputs)
+{
+    normalize(input, scale, bias, mean, variance, epsilon, outputOffset,
+              outputOffset, outputs);
+}
+
+// Half precision is only used for storage: the inputs are converted in bulk,
+// normalized in single precision and converted back in bulk
+void forwardInference(const N2D2::Tensor<half_float::half>& input,
+                      const N2D2::Tensor<float>& scale,
+                      const N2D2::Tensor<float>& bias,
+                      const N2D2::Tensor<float>& mean,
+                      const N2D2::Tensor<float>& variance,
+                      double epsilon,
+                      unsigned int outputOffset,
+                      N2D2::Tensor<half_float::half>& outputs)
+{
+    // The parameters of the channels of this input start at outputOffset,
+    // while outputsF only holds these channels
+    N2D2::Tensor<float> outputsF(input.dims());
+    normalize(N2D2::tensor_cast<float>(input),
+              scale, bias, mean, variance, epsilon, outputOffset, 0,
+              outputsF);
+
+    // Output channels of a batch position are contiguous
+    const std::size_t batchSize = input.dimX() * input.dimY() * input.dimZ();
+
+    for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+        N2D2::Tensor_Kernels::convert(&outputsF(0, 0, 0, batchPos),
+                                      &outputs(0, 0, outputOffset, batchPos),
+                                      batchSize);
+    }
+}
+
+/**
+ * Mean and biased variance of each channel, in a single pass over the
+ * inputs. The mean and the sum of squared deviations of each chunk are
+ * computed while the chunk is in cache, then merged per channel with the
+ * pairwise update of Chan et al., which does not suffer from the
+ * cancellation of the sum of squares method.
+*/
+template <class T, class ParamT>
+void computeStatistics(const N2D2::Tensor<T>& input,
+                       unsigned int outputOffset,
+                       N2D2::Tensor<ParamT>& mean,
+                       N2D2::Tensor<ParamT>& variance)
+{
+    unsigned int nbChunks;
+    const int nbUnits = getNbUnits(input, nbChunks);
+
+    std::vector<ParamT> chunkMean(nbUnits);
+    std::vector<ParamT> chunkM2(nbUnits);
+
+#pragma omp parallel for if (nbUnits > 16)
+    for (int unit = 0; unit < nbUnits; ++unit) {
+        const Chunk c = getChunk(input, nbChunks, unit);
+        const T* inputPlane = &input(0, 0, c.channel, c.batchPos);
+        ParamT sum(0.0);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif
+        for (unsigned int i = c.begin; i < c.end; ++i)
+            sum += ParamT(inputPlane[i]);
+
+        const ParamT m = sum / ParamT(c.end - c.begin);
+        ParamT m2(0.0);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:m2)
+#endif
+        for (unsigned int i = c.begin; i < c.end; ++i) {
+            const ParamT zeroed = ParamT(inputPlane[i]) - m;
+            m2 += zeroed * zeroed;
+        }
+
+        chunkMean[unit] = m;
+        chunkM2[unit] = m2;
+    }
+
+    const unsigned int nbChannelUnits = input.dimB() * nbChunks;
+
+#pragma omp parallel for if (input.dimZ() > 16)
+    for (int channel = 0; channel < (int)input.dimZ(); ++channel) {
+        ParamT count(0.0);
+        ParamT m(0.0);
+        ParamT m2(0.0);
+
+        for (unsigned int unit = channel * nbChannelUnits;
+             unit < (channel + 1) * nbChannelUnits; ++unit)
+        {
+            const Chunk c = getChunk(input, nbChunks, unit);
+            const ParamT chunkCount = ParamT(c.end - c.begin);
+            const ParamT newCount = count + chunkCount;
+            const ParamT delta = chunkMean[unit] - m;
+
+            m += delta * chunkCount / newCount;
+            m2 += chunkM2[unit] + delta * delta * count * chunkCount / newCount;
+            count = newCount;
+        }
+
+        mean(outputOffset + channel) = m;
+        variance(outputOffset + channel) = m2 / count;
+    }
+}
+
+/**
+ * Sums needed by the BN backward pass, for each channel, in a single pass
+ * over the inputs and the output gradients: sum(dy), sum(dy * (x - mean))
+ * and sum(x - mean).
+*/
+template <class T, class ParamT>
+void computeDiffSums(const N2D2::Tensor<T>& input,
+                     const N2D2::Tensor<T>& diffInputs,
+                     const N2D2::Tensor<ParamT>& mean,
+                     unsigned int outputOffset,
+                     std::vector<ParamT>& sumDiff,
+                     std::vector<ParamT>& sumDiffZeroed,
+                     std::vector<ParamT>& sumZeroed)
+{
+    unsigned int nbChunks;
+    const int nbUnits = getNbUnits(input, nbChunks);
+
+    std::vector<ParamT> chunkSums(3 * nbUnits);
+
+#pragma omp parallel for if (nbUnits > 16)
+    for (int unit = 0; unit < nbUnits; ++unit) {
+        const Chunk c = getChunk(input, nbChunks, unit);
+        const unsigned int output = outputOffset + c.channel;
+        const ParamT m = mean(output);
+        const T* inputPlane = &input(0, 0, c.channel, c.batchPos);
+        const T* diffPlane = &diffInputs(0, 0, output, c.batchPos);
+
+        ParamT sumD(0.0);
+        ParamT sumDZ(0.0);
+        ParamT sumZ(0.0);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sumD,sumDZ,sumZ)
+#endif
+        for (unsigned int i = c.begin; i < c.end; ++i) {
+            const ParamT diff = ParamT(diffPlane[i]);
+            const ParamT zeroed = ParamT(inputPlane[i]) - m;
+
+            sumD += diff;
+            sumDZ += diff * zeroed;
+            sumZ += zeroed;
+        }
+
+        chunkSums[3 * unit] = sumD;
+        chunkSums[3 * unit + 1] = sumDZ;
+        chunkSums[3 * unit + 2] = sumZ;
+    }
+
+    const unsigned int nbChannelUnits = input.dimB() * nbChunks;
+
+    sumDiff.assign(input.dimZ(), ParamT(0.0));
+    sumDiffZeroed.assign(input.dimZ(), ParamT(0.0));
+    sumZeroed.assign(input.dimZ(), ParamT(0.0));
+
+    for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
+        for (unsigned int unit = channel * nbChannelUnits;
+             unit < (channel + 1) * nbChannelUnits; ++unit)
+        {
+            sumDiff[channel] += chunkSums[3 * unit];
+            sumDiffZeroed[channel] += chunkSums[3 * unit + 1];
+            sumZeroed[channel] += chunkSums[3 * unit + 2];
+        }
+    }
+}
+}
+
 template <class T>
 void N2D2::BatchNormCell_Frame<T>::propagate(bool inference)
 {
@@ -160,65 +423,24 @@ void N2D2::BatchNormCell_Frame<T>::propagate(bool inference)
 
     for (unsigned int k = 0, kSize = mInputs.size(); k < kSize; ++k) {
         const Tensor<T>& input = tensor_cast<T>(mInputs[k]);
-        const unsigned int size = mInputs.dimB() * input.dimZ();
 
         if (inference || mMovingAverageMomentum == 0.0) {
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (size > 16)
-#else
-#pragma omp parallel for if (mInputs.dimB() > 4 && size > 16)
-#endif
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int channel = 0; channel < input.dimZ();
-                    ++channel)
-                {
-                    const unsigned int output = outputOffset + channel;
-                    const T var(std::sqrt( T((*mVariance)(output))
-                                                  + T(mEpsilon)));
-
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T normalized
-                                = (input(ox, oy, channel, batchPos)
-                                   - T((*mMean)(output)) )  / var;
-                            mOutputs(ox, oy, output, batchPos)
-                                = T((*mScale)(output)) * normalized
-                                    + T((*mBias)(output));
-                        }
-                    }
-                }
-            }
+            forwardInference(input,
+                             *mScale,
+                             *mBias,
+                             *mMean,
+                             *mVariance,
+                             mEpsilon,
+                             outputOffset,
+                             mOutputs);
         } else {
             const unsigned int size = input.dimX() * input.dimY()
                                       * mInputs.dimB();
 
-#pragma omp parallel for if (input.dimZ() > 16)
-            for (int channel = 0; channel < (int)input.dimZ(); ++channel) {
-                const unsigned int output = outputOffset + channel;
-                ParamT sum(0.0);
-
-                for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox)
-                            sum += input(ox, oy, channel, batchPos);
-                    }
-                }
+            computeStatistics(input, outputOffset, mSavedMean, mSavedVariance);
 
-                mSavedMean(output) = sum / (ParamT)size;
-
-                sum = 0.0;
-
-                for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T zeroed = input(ox, oy, channel, batchPos)
-                                                   - ((T)mSavedMean(output));
-                            sum += (ParamT) (zeroed * zeroed);
-                        }
-                    }
-                }
-
-                mSavedVariance(output) = sum / (ParamT)size;
+            for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
+                const unsigned int output = outputOffset + channel;
 
                 (*mMean)(output) = mSavedMean(output) * mMovingAverageMomentum
                                 + (*mMean)(output) * (1.0 - mMovingAverageMomentum);
@@ -226,27 +448,15 @@ void N2D2::BatchNormCell_Frame<T>::propagate(bool inference)
                                     + (*mVariance)(output) * (1.0 - mMovingAverageMomentum);
             }
 
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (size > 16)
-#else
-#pragma omp parallel for if (mInputs.dimB() > 4 && size > 16)
-#endif
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
-                    const unsigned int output = outputOffset + channel;
-                    const T var(std::sqrt( (T)mSavedVariance(output) + mEpsilon));
-
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T normalized
-                                = (input(ox, oy, channel, batchPos)
-                                   - ( (T) mSavedMean(output)) ) / var;
-                            mOutputs(ox, oy, output, batchPos)
-                                = (T) (*mScale)(output) * normalized + (T) (*mBias)(output);
-                        }
-                    }
-                }
-            }
+            normalize(input,
+                      *mScale,
+                      *mBias,
+                      mSavedMean,
+                      mSavedVariance,
+                      mEpsilon,
+                      outputOffset,
+                      outputOffset,
+                      mOutputs);
 
             ++mNbPropagate;
         }
@@ -276,86 +486,72 @@ void N2D2::BatchNormCell_Frame<T>::backPropagate()
         const Tensor<T>& input = tensor_cast_nocopy<T>(mInputs[k]);
         const unsigned int size = input.dimX() * input.dimY() * mInputs.dimB();
 
-#pragma omp parallel for if (input.dimZ() > 16)
-        for (int channel = 0; channel < (int)input.dimZ(); ++channel) {
+        std::vector<ParamT> sumDiff;
+        std::vector<ParamT> sumDiffZeroed;
+        std::vector<ParamT> sumZeroed;
+        computeDiffSums(input, mDiffInputs, mSavedMean, outputOffset,
+                        sumDiff, sumDiffZeroed, sumZeroed);
+
+        // Per channel coefficients of the gradient:
+        // dx = alpha * dy + beta * (x - mean) + gamma
+        std::vector<ParamT> alpha(input.dimZ());
+        std::vector<ParamT> beta(input.dimZ());
+        std::vector<ParamT> gamma(input.dimZ());
+
+        for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
             const unsigned int output = outputOffset + channel;
-            const T var(std::sqrt((T) mSavedVariance(output) + mEpsilon));
-
-            ParamT sumScale(0.0);
-            ParamT sumBias(0.0);
-            ParamT sumMean1(0.0);
-            ParamT sumMean2(0.0);
-            ParamT sumVariance(0.0);
-
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                        const T normalized((input(ox, oy, channel, batchPos)
-                               - (T)mSavedMean(output)) / var);
-                        const T diffNormalized(
-                            mDiffInputs(ox, oy, output, batchPos)
-                              * (T)(*mScale)(output));
-
-                        sumScale += (ParamT) (mDiffInputs(ox, oy, output, batchPos)
-                                    * normalized);
-                        sumBias += (ParamT) (mDiffInputs(ox, oy, output, batchPos));
-
-                        sumMean1 += (ParamT)diffNormalized;
-                        sumMean2 += (ParamT) (-2.0 * (input(ox, oy, channel, batchPos)
-                                            - mSavedMean(output)));
-                        sumVariance += (ParamT) (diffNormalized
-                                       * (input(ox, oy, channel, batchPos)
-                                          - mSavedMean(output)) );
-                    }
-                }
-            }
+            const ParamT var
+                = std::sqrt(mSavedVariance(output) + ParamT(mEpsilon));
 
             mDiffSavedVariance(output)
-                = sumVariance * (-1.0 / 2.0)
+                = (*mScale)(output) * sumDiffZeroed[channel] * (-1.0 / 2.0)
                   * std::pow(mSavedVariance(output) + mEpsilon, -3.0 / 2.0);
-            mDiffSavedMean(output) = sumMean1 * (-1.0 / (ParamT)var)
-                                     + mDiffSavedVariance(output) * sumMean2
-                                       / (ParamT)size;
-
-            mDiffScale(output) = sumScale + betaScale * mDiffScale(output);
-            mDiffBias(output) = sumBias + betaBias * mDiffBias(output);
+            mDiffSavedMean(output)
+                = (*mScale)(output) * sumDiff[channel] * (-1.0 / var)
+                  + mDiffSavedVariance(output) * (-2.0 * sumZeroed[channel])
+                    / (ParamT)size;
+
+            mDiffScale(output) = sumDiffZeroed[channel] / var
+                                 + betaScale * mDiffScale(output);
+            mDiffBias(output) = sumDiff[channel]
+                                + betaBias * mDiffBias(output);
+
+            alpha[channel] = (*mScale)(output) / var;
+            beta[channel] = mDiffSavedVariance(output) * 2.0 / (ParamT)size;
+            gamma[channel] = mDiffSavedMean(output) / (ParamT)size;
         }
 
         if (!mDiffOutputs.empty() && mBackPropagate) {
-            const unsigned int size = mInputs.dimB() * getNbOutputs();
             const bool isValid = mDiffOutputs[k].isValid();
             Tensor<T> diffOutput = (isValid)
                 ? tensor_cast<T>(mDiffOutputs[k])
                 : tensor_cast_nocopy<T>(mDiffOutputs[k]);
 
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (size > 16)
-#else
-#pragma omp parallel for if (mInputs.dimB() > 4 && size > 16)
+            unsigned int nbChunks;
+            const int nbUnits = getNbUnits(input, nbChunks);
+
+#pragma omp parallel for if (nbUnits > 16)
+            for (int unit = 0; unit < nbUnits; ++unit) {
+                const Chunk c = getChunk(input, nbChunks, unit);
+                const unsigned int output = outputOffset + c.channel;
+                const ParamT a = alpha[c.channel];
+                const ParamT b = beta[c.channel];
+                const ParamT g = gamma[c.channel];
+                const ParamT m = mSavedMean(output);
+                const T* inputPlane = &input(0, 0, c.channel, c.batchPos);
+                const T* diffPlane = &mDiffInputs(0, 0, output, c.batchPos);
+                T* diffOutputPlane = &diffOutput(0, 0, c.channel, c.batchPos);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
 #endif
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int channel = 0; channel < input.dimZ();
-                    ++channel)
-                {
-                    const unsigned int output = outputOffset + channel;
-                    const T var(std::sqrt( (T)mSavedVariance(output) + mEpsilon));
-
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T diffNormalized(
-                                mDiffInputs(ox, oy, output, batchPos)
-                                  * (T)(*mScale)(output));
-                            const T gradient( diffNormalized / var
-                                  + (T)mDiffSavedVariance(output) * 2.0
-                                    * (input(ox, oy, channel, batchPos)
-                                       -(T) mSavedMean(output)) / (T)size
-                                  + (T)mDiffSavedMean(output) / (T)size);
-
-                            diffOutput(ox, oy, channel, batchPos)
-                                = (gradient
-                                + isValid * diffOutput(ox, oy, channel, batchPos));
-                        }
-                    }
+                for (unsigned int i = c.begin; i < c.end; ++i) {
+                    const ParamT gradient = a * ParamT(diffPlane[i])
+                        + b * (ParamT(inputPlane[i]) - m) + g;
+
+                    diffOutputPlane[i] = (isValid)
+                        ? T(gradient + ParamT(diffOutputPlane[i]))
+                        : T(gradient);
                 }
             }
 
@@ -98,10 +98,11 @@ void N2D2::Cell_Frame_CUDA<T>::addInput(StimuliProvider& sp,
 
     setOutputsDims();
 
-    if (mOutputs.empty()) {
-        std::vector<size_t> outputsDims(mOutputsDims);
-        outputsDims.push_back(sp.getBatchSize());
+    std::vector<size_t> outputsDims(mOutputsDims);
+    outputsDims.push_back(sp.getBatchSize());
 
+    // The outputs may grow with the inputs channels (e.g. BatchNorm)
+    if (mOutputs.dims() != outputsDims) {
         mOutputs.resize(outputsDims);
         mDiffInputs.resize(outputsDims);
     }
@@ -138,10 +139,11 @@ void N2D2::Cell_Frame_CUDA<T>::addInput(Cell* cell, const Tensor<bool>& mapping)
 
     setOutputsDims();
 
-    if (mOutputs.empty()) {
-        std::vector<size_t> outputsDims(mOutputsDims);
-        outputsDims.push_back(mInputs.dimB());
+    std::vector<size_t> outputsDims(mOutputsDims);
+    outputsDims.push_back(mInputs.dimB());
 
+    // The outputs may grow with the inputs channels (e.g. BatchNorm)
+    if (mOutputs.dims() != outputsDims) {
         mOutputs.resize(outputsDims);
         mDiffInputs.resize(outputsDims);
     }
@@ -196,10 +198,11 @@ void N2D2::Cell_Frame_CUDA<T>::addInput(BaseTensor& inputs,
 
     setOutputsDims();
 
-    if (mOutputs.empty()) {
-        std::vector<size_t> outputsDims(mOutputsDims);
-        outputsDims.push_back(mInputs.dimB());
+    std::vector<size_t> outputsDims(mOutputsDims);
+    outputsDims.push_back(mInputs.dimB());
 
+    // The outputs may grow with the inputs channels (e.g. BatchNorm)
+    if (mOutputs.dims() != outputsDims) {
         mOutputs.resize(outputsDims);
         mDiffInputs.resize(outputsDims);
     }
@@ -20,6 +20,7 @@
 
 #include "Cell/ConvCell_Frame_Kernels.hpp"
 #include "containers/Tensor.hpp"
+#include "containers/Tensor_Kernels.hpp"
 #include "third_party/half.hpp"
 #include "utils/Utils.hpp"
 
@@ -431,15 +432,60 @@ void N2D2::ConvCell_Frame_Kernels::backwardBias(const T* alpha,
     }
 }
 
+template <>
+void N2D2::ConvCell_Frame_Kernels::forward<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs,
+    const Tensor<bool>& maps)
+{
+    // Half precision is only used for storage: the operands are converted in
+    // bulk and the computation is done in single precision. The converted
+    // synapses are kept by tensor_cast() as long as they are not modified.
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+    const bool subSample = (desc.subSample[0] > 1 || desc.subSample[1] > 1);
+
+    Tensor<float> outputsF(outputs.dims());
+
+    if (betaF != 0.0f || subSample)
+        Tensor_Kernels::convert(&outputs(0), &outputsF(0), outputs.size());
+
+    forward<float>(&alphaF,
+                   tensor_cast<float>(inputs),
+                   tensor_cast<float>(sharedSynapses),
+                   desc,
+                   &betaF,
+                   outputsF,
+                   maps);
+
+    Tensor_Kernels::convert(&outputsF(0), &outputs(0), outputs.size());
+}
+
+template <>
+void N2D2::ConvCell_Frame_Kernels::forwardBias<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& bias,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float> outputsF(outputs.dims());
+
+    if (betaF != 0.0f)
+        Tensor_Kernels::convert(&outputs(0), &outputsF(0), outputs.size());
+
+    forwardBias<float>(&alphaF, tensor_cast<float>(bias), &betaF, outputsF);
+
+    Tensor_Kernels::convert(&outputsF(0), &outputs(0), outputs.size());
+}
+
 namespace N2D2 {
-    template void ConvCell_Frame_Kernels::forward<half_float::half>(const half_float::half* alpha,
-                                           const Tensor<half_float::half>& inputs,
-                                           const Tensor
-                                           <half_float::half>& sharedSynapses,
-                                           const Descriptor& desc,
-                                           const half_float::half* beta,
-                                           Tensor<half_float::half>& outputs,
-                                           const Tensor<bool>& maps);
     template void ConvCell_Frame_Kernels::forward<float>(const float* alpha,
                                            const Tensor<float>& inputs,
                                            const Tensor
@@ -457,10 +503,6 @@ namespace N2D2 {
                                            Tensor<double>& outputs,
                                            const Tensor<bool>& maps);
 
-    template void ConvCell_Frame_Kernels::forwardBias<half_float::half>(const half_float::half* alpha,
-                                               const Tensor<half_float::half>& bias,
-                                               const half_float::half* beta,
-                                               Tensor<half_float::half>& outputs);
     template void ConvCell_Frame_Kernels::forwardBias<float>(const float* alpha,
                                                const Tensor<float>& bias,
                                                const float* beta,
@@ -186,9 +186,9 @@ void N2D2::DeconvCell_Frame<T>::propagate(bool inference)
 
         const Tensor<T>& input = tensor_cast<T>(mInputs[k]);
 
-        ConvCell_Frame_Kernels::backwardData<T>(&alpha,
-                                             mSharedSynapses[k],
+        DeconvCell_Frame_Kernels::forward<T>(&alpha,
                                              input,
+                                             mSharedSynapses[k],
                                              mConvDesc,
                                              &beta,
                                              mOutputs,
@@ -225,9 +225,9 @@ void N2D2::DeconvCell_Frame<T>::backPropagate()
 
         const Tensor<T>& input = tensor_cast_nocopy<T>(mInputs[k]);
 
-        ConvCell_Frame_Kernels::backwardFilter<T>(&alpha,
-                                               mDiffInputs,
+        DeconvCell_Frame_Kernels::backwardFilter<T>(&alpha,
                                                input,
+                                               mDiffInputs,
                                                mConvDesc,
                                                &beta,
                                                mDiffSharedSynapses[k],
@@ -257,9 +257,9 @@ void N2D2::DeconvCell_Frame<T>::backPropagate()
                 ? tensor_cast<T>(mDiffOutputs[k])
                 : tensor_cast_nocopy<T>(mDiffOutputs[k]);
 
-            ConvCell_Frame_Kernels::forward<T>(&alpha,
-                                            mDiffInputs,
+            DeconvCell_Frame_Kernels::backwardData<T>(&alpha,
                                             mSharedSynapses[k],
+                                            mDiffInputs,
                                             mConvDesc,
                                             &beta,
                                             diffOutput,
@@ -0,0 +1,525 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Cell/DeconvCell_Frame_Kernels.hpp"
+#include "containers/Tensor_Kernels.hpp"
+#include "third_party/half.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// Number of columns of a GEMM block, so that the rows of the right-hand
+// matrix used by a block stay in cache while the block is computed
+const unsigned int gemmBlockSize = 256;
+// Number of positions of a block of the weights gradient reduction
+const unsigned int reduceBlockSize = 1024;
+
+struct Geometry {
+    unsigned int kernelWidth;
+    unsigned int kernelHeight;
+    // Transposed convolution inputs and outputs (convolution outputs and
+    // inputs)
+    unsigned int inputsWidth;
+    unsigned int inputsHeight;
+    unsigned int outputsWidth;
+    unsigned int outputsHeight;
+    unsigned int nbOutputs;
+
+    template <class T>
+    Geometry(const N2D2::Tensor<T>& sharedSynapses,
+             const N2D2::Tensor<T>& inputs,
+             const N2D2::Tensor<T>& outputs)
+        : kernelWidth(sharedSynapses.dimX()),
+          kernelHeight(sharedSynapses.dimY()),
+          inputsWidth(inputs.dimX()),
+          inputsHeight(inputs.dimY()),
+          outputsWidth(outputs.dimX()),
+          outputsHeight(outputs.dimY()),
+          nbOutputs(sharedSynapses.dimZ())
+    {}
+
+    // Number of rows of the columns matrix: (output, ky, kx)
+    unsigned int getNbRows() const
+    {
+        return nbOutputs * kernelHeight * kernelWidth;
+    }
+};
+
+/**
+ * Range [begin, end[ of input positions i for which the output position
+ * i * stride + offset is in [0, outputsSize[.
+*/
+void getRange(int offset,
+              unsigned int stride,
+              unsigned int outputsSize,
+              unsigned int inputsSize,
+              unsigned int& begin,
+              unsigned int& end)
+{
+    begin = (offset >= 0) ? 0
+        : (unsigned int)((-offset + (int)stride - 1) / (int)stride);
+
+    const int last = (int)outputsSize - offset;
+
+    end = (last <= 0) ? 0
+        : std::min((unsigned int)((last + (int)stride - 1) / (int)stride),
+                   inputsSize);
+
+    if (end < begin)
+        end = begin;
+}
+
+/**
+ * C = A x B, with C (M x N) and B (K x N) contiguous row-major matrices, and
+ * A(m, k) = A[m * aStrideM + k * aStrideK].
+*/
+template <class T>
+void gemm(unsigned int M,
+          unsigned int N,
+          unsigned int K,
+          const T* A,
+          std::size_t aStrideM,
+          std::size_t aStrideK,
+          const T* B,
+          T* C)
+{
+    const unsigned int nbBlocks = (N + gemmBlockSize - 1) / gemmBlockSize;
+    const int size = M * nbBlocks;
+
+    // Consecutive indexes share the same block of B
+#pragma omp parallel for if (size > 16)
+    for (int index = 0; index < size; ++index) {
+        const unsigned int m = index % M;
+        const unsigned int nBegin = (index / M) * gemmBlockSize;
+        const unsigned int nEnd = std::min(nBegin + gemmBlockSize, N);
+        T* rowC = C + (std::size_t)m * N;
+
+        std::fill(rowC + nBegin, rowC + nEnd, T(0.0));
+
+        for (unsigned int k = 0; k < K; ++k) {
+            // Zero weights are not skipped: a NaN or infinite value in B
+            // propagates to C as with any other weight, including through
+            // the (zeroed) unmapped connections
+            const T a = A[m * aStrideM + k * aStrideK];
+            const T* rowB = B + (std::size_t)k * N;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for (unsigned int n = nBegin; n < nEnd; ++n)
+                rowC[n] += a * rowB[n];
+        }
+    }
+}
+
+/**
+ * Weights as a (nb. inputs x rows) matrix, with the unmapped connections
+ * set to zero. Returns the weights themselves if there is no mapping.
+*/
+template <class T>
+const T* getWeights(const N2D2::Tensor<T>& sharedSynapses,
+                    const Geometry& g,
+                    const N2D2::Tensor<bool>& maps,
+                    std::vector<T>& mappedWeights)
+{
+    if (maps.empty())
+        return &sharedSynapses(0);
+
+    const unsigned int kernelSize = g.kernelWidth * g.kernelHeight;
+
+    mappedWeights.assign(&sharedSynapses(0),
+                         &sharedSynapses(0) + sharedSynapses.size());
+
+    for (unsigned int channel = 0; channel < sharedSynapses.dimB();
+         ++channel)
+    {
+        for (unsigned int output = 0; output < g.nbOutputs; ++output) {
+            if (!maps(output, channel)) {
+                std::fill(mappedWeights.begin()
+                            + (channel * g.nbOutputs + output) * kernelSize,
+                          mappedWeights.begin()
+                            + (channel * g.nbOutputs + output + 1)
+                                * kernelSize,
+                          T(0.0));
+            }
+        }
+    }
+
+    return &mappedWeights[0];
+}
+
+/**
+ * Scatter the columns matrix (rows x input positions) to the outputs of a
+ * batch position: outputs = alpha * col2im(cols) + beta * outputs.
+ * Each output map only receives the rows of its own kernels, the outputs
+ * are therefore processed in parallel without conflicts.
+*/
+template <class T>
+void col2im(const T* cols,
+            const Geometry& g,
+            const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+            T alpha,
+            T beta,
+            T* outputs)
+{
+    const unsigned int inputsSize = g.inputsWidth * g.inputsHeight;
+    const unsigned int outputsSize = g.outputsWidth * g.outputsHeight;
+
+#pragma omp parallel for if (g.nbOutputs > 1)
+    for (int output = 0; output < (int)g.nbOutputs; ++output) {
+        T* outputPlane = outputs + (std::size_t)output * outputsSize;
+
+        if (beta == T(0.0))
+            std::fill(outputPlane, outputPlane + outputsSize, T(0.0));
+        else if (beta != T(1.0)) {
+            for (unsigned int i = 0; i < outputsSize; ++i)
+                outputPlane[i] *= beta;
+        }
+
+        for (unsigned int ky = 0; ky < g.kernelHeight; ++ky) {
+            const int yOffset = (int)(ky * desc.dilation[1]) - desc.padding[1];
+            unsigned int iyBegin, iyEnd;
+            getRange(yOffset, desc.stride[1], g.outputsHeight, g.inputsHeight,
+                     iyBegin, iyEnd);
+
+            for (unsigned int kx = 0; kx < g.kernelWidth; ++kx) {
+                const int xOffset = (int)(kx * desc.dilation[0])
+                                    - desc.padding[0];
+                unsigned int ixBegin, ixEnd;
+                getRange(xOffset, desc.stride[0], g.outputsWidth,
+                         g.inputsWidth, ixBegin, ixEnd);
+
+                const T* row = cols + (std::size_t)((output * g.kernelHeight
+                    + ky) * g.kernelWidth + kx) * inputsSize;
+
+                for (unsigned int iy = iyBegin; iy < iyEnd; ++iy) {
+                    T* outputLine = outputPlane
+                        + (iy * desc.stride[1] + yOffset) * g.outputsWidth
+                        + xOffset;
+                    const T* rowLine = row + iy * g.inputsWidth;
+
+                    for (unsigned int ix = ixBegin; ix < ixEnd; ++ix)
+                        outputLine[ix * desc.stride[0]] += alpha * rowLine[ix];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Gather the outputs of a batch position in the columns matrix
+ * (rows x input positions), with zeros for the padding.
+*/
+template <class T>
+void im2col(const T* outputs,
+            const Geometry& g,
+            const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+            T* cols)
+{
+    const unsigned int inputsSize = g.inputsWidth * g.inputsHeight;
+    const unsigned int outputsSize = g.outputsWidth * g.outputsHeight;
+    const int nbRows = g.getNbRows();
+
+#pragma omp parallel for if (nbRows > 16)
+    for (int r = 0; r < nbRows; ++r) {
+        const unsigned int kx = r % g.kernelWidth;
+        const unsigned int ky = (r / g.kernelWidth) % g.kernelHeight;
+        const unsigned int output = r / (g.kernelWidth * g.kernelHeight);
+
+        const int xOffset = (int)(kx * desc.dilation[0]) - desc.padding[0];
+        const int yOffset = (int)(ky * desc.dilation[1]) - desc.padding[1];
+        unsigned int ixBegin, ixEnd, iyBegin, iyEnd;
+        getRange(xOffset, desc.stride[0], g.outputsWidth, g.inputsWidth,
+                 ixBegin, ixEnd);
+        getRange(yOffset, desc.stride[1], g.outputsHeight, g.inputsHeight,
+                 iyBegin, iyEnd);
+
+        const T* outputPlane = outputs + (std::size_t)output * outputsSize;
+        T* row = cols + (std::size_t)r * inputsSize;
+
+        std::fill(row, row + inputsSize, T(0.0));
+
+        for (unsigned int iy = iyBegin; iy < iyEnd; ++iy) {
+            const T* outputLine = outputPlane
+                + (iy * desc.stride[1] + yOffset) * g.outputsWidth + xOffset;
+            T* rowLine = row + iy * g.inputsWidth;
+
+            for (unsigned int ix = ixBegin; ix < ixEnd; ++ix)
+                rowLine[ix] = outputLine[ix * desc.stride[0]];
+        }
+    }
+}
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::forward(const T* alpha,
+                                             const Tensor<T>& inputs,
+                                             const Tensor<T>& sharedSynapses,
+                                             const Descriptor& desc,
+                                             const T* beta,
+                                             Tensor<T>& outputs,
+                                             const Tensor<bool>& maps)
+{
+    const Geometry g(sharedSynapses, inputs, outputs);
+    const unsigned int nbRows = g.getNbRows();
+    const unsigned int inputsSize = g.inputsWidth * g.inputsHeight;
+
+    std::vector<T> mappedWeights;
+    const T* weights = getWeights(sharedSynapses, g, maps, mappedWeights);
+    std::vector<T> cols((std::size_t)nbRows * inputsSize);
+
+    for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos) {
+        // cols(r, i) = sum_c weights(c, r) * inputs(c, i)
+        gemm(nbRows, inputsSize, inputs.dimZ(),
+             weights, 1, nbRows,
+             &inputs(0, 0, 0, batchPos), &cols[0]);
+        col2im(&cols[0], g, desc, *alpha, *beta,
+               &outputs(0, 0, 0, batchPos));
+    }
+}
+
+template <>
+void N2D2::DeconvCell_Frame_Kernels::forward<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs,
+    const Tensor<bool>& maps)
+{
+    // Same as ConvCell_Frame_Kernels::forward<half_float::half>()
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float> outputsF(outputs.dims());
+
+    if (betaF != 0.0f)
+        Tensor_Kernels::convert(&outputs(0), &outputsF(0), outputs.size());
+
+    // Qualified, as the descriptor would also bring in the convolution
+    // kernels by argument-dependent lookup
+    DeconvCell_Frame_Kernels::forward<float>(&alphaF,
+                                             tensor_cast<float>(inputs),
+                                             tensor_cast<float>(sharedSynapses),
+                                             desc,
+                                             &betaF,
+                                             outputsF,
+                                             maps);
+
+    Tensor_Kernels::convert(&outputsF(0), &outputs(0), outputs.size());
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::backwardData(const T* alpha,
+                                                  const Tensor
+                                                  <T>& sharedSynapses,
+                                                  const Tensor<T>& diffInputs,
+                                                  const Descriptor& desc,
+                                                  const T* beta,
+                                                  Tensor<T>& diffOutputs,
+                                                  const Tensor<bool>& maps)
+{
+    const Geometry g(sharedSynapses, diffOutputs, diffInputs);
+    const unsigned int nbRows = g.getNbRows();
+    const unsigned int inputsSize = g.inputsWidth * g.inputsHeight;
+    const unsigned int nbChannels = diffOutputs.dimZ();
+
+    std::vector<T> mappedWeights;
+    const T* weights = getWeights(sharedSynapses, g, maps, mappedWeights);
+    std::vector<T> cols((std::size_t)nbRows * inputsSize);
+    std::vector<T> gradient((std::size_t)nbChannels * inputsSize);
+
+    for (unsigned int batchPos = 0; batchPos < diffOutputs.dimB();
+         ++batchPos)
+    {
+        im2col(&diffInputs(0, 0, 0, batchPos), g, desc, &cols[0]);
+
+        // gradient(c, i) = sum_r weights(c, r) * cols(r, i)
+        gemm(nbChannels, inputsSize, nbRows,
+             weights, nbRows, 1,
+             &cols[0], &gradient[0]);
+
+        T* diffOutput = &diffOutputs(0, 0, 0, batchPos);
+        const int size = nbChannels * inputsSize;
+
+        if (*beta == T(0.0)) {
+#pragma omp parallel for if (size > 1024)
+            for (int i = 0; i < size; ++i)
+                diffOutput[i] = (*alpha) * gradient[i];
+        }
+        else {
+#pragma omp parallel for if (size > 1024)
+            for (int i = 0; i < size; ++i) {
+                diffOutput[i] = (*alpha) * gradient[i]
+                                + (*beta) * diffOutput[i];
+            }
+        }
+    }
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::backwardFilter(const T* alpha,
+                                                    const Tensor<T>& inputs,
+                                                    const Tensor
+                                                    <T>& diffInputs,
+                                                    const Descriptor& desc,
+                                                    const T* beta,
+                                                    Tensor
+                                                    <T>& diffSharedSynapses,
+                                                    const Tensor<bool>& maps)
+{
+    const Geometry g(diffSharedSynapses, inputs, diffInputs);
+    const unsigned int nbRows = g.getNbRows();
+    const unsigned int inputsSize = g.inputsWidth * g.inputsHeight;
+    const unsigned int nbChannels = inputs.dimZ();
+
+    typedef typename Utils::scaling_type<T>::type SumT;
+
+    std::vector<T> cols((std::size_t)nbRows * inputsSize);
+    // gradient(c, r), in the same order as the weights
+    std::vector<SumT> gradient((std::size_t)nbChannels * nbRows, SumT(0.0));
+
+    for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos) {
+        im2col(&diffInputs(0, 0, 0, batchPos), g, desc, &cols[0]);
+
+        const T* input = &inputs(0, 0, 0, batchPos);
+
+        // gradient(c, r) += sum_i inputs(c, i) * cols(r, i), by blocks of
+        // positions shared by all the threads
+        for (unsigned int iBegin = 0; iBegin < inputsSize;
+             iBegin += reduceBlockSize)
+        {
+            const unsigned int iEnd = std::min(iBegin + reduceBlockSize,
+                                               inputsSize);
+
+#pragma omp parallel for if (nbRows > 16)
+            for (int r = 0; r < (int)nbRows; ++r) {
+                const T* row = &cols[0] + (std::size_t)r * inputsSize;
+
+                for (unsigned int channel = 0; channel < nbChannels;
+                     ++channel)
+                {
+                    const T* inputPlane = input
+                        + (std::size_t)channel * inputsSize;
+                    SumT sum(0.0);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif
+                    for (unsigned int i = iBegin; i < iEnd; ++i)
+                        sum += SumT(inputPlane[i]) * SumT(row[i]);
+
+                    gradient[(std::size_t)channel * nbRows + r] += sum;
+                }
+            }
+        }
+    }
+
+    const unsigned int kernelSize = g.kernelWidth * g.kernelHeight;
+    T* diffWeights = &diffSharedSynapses(0);
+
+    for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+        for (unsigned int output = 0; output < g.nbOutputs; ++output) {
+            if (!maps.empty() && !maps(output, channel))
+                continue;
+
+            const std::size_t offset
+                = (channel * g.nbOutputs + output) * kernelSize;
+
+            for (unsigned int k = offset; k < offset + kernelSize; ++k) {
+                diffWeights[k] = (*beta == T(0.0))
+                    ? T((*alpha) * gradient[k])
+                    : T((*alpha) * gradient[k] + (*beta) * diffWeights[k]);
+            }
+        }
+    }
+}
+
+namespace N2D2 {
+    template void DeconvCell_Frame_Kernels::forward<float>(
+        const float* alpha,
+        const Tensor<float>& inputs,
+        const Tensor<float>& sharedSynapses,
+        const Descriptor& desc,
+        const float* beta,
+        Tensor<float>& outputs,
+        const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::forward<double>(
+        const double* alpha,
+        const Tensor<double>& inputs,
+        const Tensor<double>& sharedSynapses,
+        const Descriptor& desc,
+        const double* beta,
+        Tensor<double>& outputs,
+        const Tensor<bool>& maps);
+
+    template void DeconvCell_Frame_Kernels::backwardData<half_float::half>(
+        const half_float::half* alpha,
+        const Tensor<half_float::half>& sharedSynapses,
+        const Tensor<half_float::half>& diffInputs,
+        const Descriptor& desc,
+        const half_float::half* beta,
+        Tensor<half_float::half>& diffOutputs,
+        const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardData<float>(
+        const float* alpha,
+        const Tensor<float>& sharedSynapses,
+        const Tensor<float>& diffInputs,
+        const Descriptor& desc,
+        const float* beta,
+        Tensor<float>& diffOutputs,
+        const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardData<double>(
+        const double* alpha,
+        const Tensor<double>& sharedSynapses,
+        const Tensor<double>& diffInputs,
+        const Descriptor& desc,
+        const double* beta,
+        Tensor<double>& diffOutputs,
+        const Tensor<bool>& maps);
+
+    template void DeconvCell_Frame_Kernels::backwardFilter<half_float::half>(
+        const half_float::half* alpha,
+        const Tensor<half_float::half>& inputs,
+        const Tensor<half_float::half>& diffInputs,
+        const Descriptor& desc,
+        const half_float::half* beta,
+        Tensor<half_float::half>& diffSharedSynapses,
+        const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardFilter<float>(
+        const float* alpha,
+        const Tensor<float>& inputs,
+        const Tensor<float>& diffInputs,
+        const Descriptor& desc,
+        const float* beta,
+        Tensor<float>& diffSharedSynapses,
+        const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardFilter<double>(
+        const double* alpha,
+        const Tensor<double>& inputs,
+        const Tensor<double>& diffInputs,
+        const Descriptor& desc,
+        const double* beta,
+        Tensor<double>& diffSharedSynapses,
+        const Tensor<bool>& maps);
+}
@@ -33,7 +33,8 @@ N2D2::ElemWiseCell::ElemWiseCell(const DeepNet& deepNet, const std::string& name
       mOperation(operation),
       mCoeffMode(mode),
       mWeights(weights),
-      mShifts(shifts)
+      mShifts(shifts),
+      mInPlace(this, "InPlace", false)
 {
     // ctor
 }
@@ -20,11 +20,160 @@
 
 #include "GradientCheck.hpp"
 #include "Cell/ElemWiseCell_Frame.hpp"
+#include "Cell/ReshapeCell.hpp"
 #include "DeepNet.hpp"
 
 N2D2::Registrar<N2D2::ElemWiseCell>
 N2D2::ElemWiseCell_Frame::mRegistrar("Frame", N2D2::ElemWiseCell_Frame::create);
 
+namespace {
+const unsigned int chunkSize = 4096;
+
+// Plane-wise Sum, with per-channel or per-input coefficients broadcasting.
+// outputs may alias inputs[0].
+void sum(const std::vector<const N2D2::Float_T*>& inputs,
+         const std::vector<N2D2::Float_T>& weights,
+         const std::vector<N2D2::Float_T>& shifts,
+         bool perChannel,
+         unsigned int planeSize,
+         unsigned int nbChannels,
+         unsigned int nbPlanes,
+         N2D2::Float_T* outputs)
+{
+#pragma omp parallel for if (nbPlanes > 1 && nbPlanes * planeSize > 16384)
+    for (int plane = 0; plane < (int)nbPlanes; ++plane) {
+        const unsigned int channel = plane % nbChannels;
+        const std::size_t offset = (std::size_t)plane * planeSize;
+        N2D2::Float_T* output = outputs + offset;
+
+        for (unsigned int k = 0; k < inputs.size(); ++k) {
+            const unsigned int c = (perChannel) ? channel : k;
+            const N2D2::Float_T w = weights[c];
+            const N2D2::Float_T s = shifts[c];
+            const N2D2::Float_T* input = inputs[k] + offset;
+
+            if (k == 0) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int i = 0; i < planeSize; ++i)
+                    output[i] = w * input[i] + s;
+            }
+            else {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int i = 0; i < planeSize; ++i)
+                    output[i] += w * input[i] + s;
+            }
+        }
+    }
+}
+
+// Chunk-wise AbsSum, EuclideanSum, Prod and Max: all the inputs of a chunk
+// are reduced while the chunk is in cache. outputs may alias inputs[0].
+void reduce(N2D2::ElemWiseCell::Operation operation,
+            const std::vector<const N2D2::Float_T*>& inputs,
+            const std::vector<N2D2::Float_T>& weights,
+            const std::vector<N2D2::Float_T>& shifts,
+            unsigned int nbElems,
+            N2D2::Float_T* interTerm,
+            unsigned int* argMax,
+            N2D2::Float_T* outputs)
+{
+    const int nbChunks = (nbElems + chunkSize - 1) / chunkSize;
+
+#pragma omp parallel for if (nbChunks > 1)
+    for (int chunk = 0; chunk < nbChunks; ++chunk) {
+        const unsigned int begin = chunk * chunkSize;
+        const unsigned int end = std::min(begin + chunkSize, nbElems);
+
+        if (operation == N2D2::ElemWiseCell::AbsSum) {
+            for (unsigned int k = 0; k < inputs.size(); ++k) {
+                const N2D2::Float_T w = weights[k];
+                const N2D2::Float_T* input = inputs[k];
+
+                if (k == 0) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                    for (unsigned int n = begin; n < end; ++n)
+                        outputs[n] = w * std::abs(input[n]);
+                }
+                else {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                    for (unsigned int n = begin; n < end; ++n)
+                        outputs[n] += w * std::abs(input[n]);
+                }
+            }
+        }
+        else if (operation == N2D2::ElemWiseCell::EuclideanSum) {
+            for (unsigned int k = 0; k < inputs.size(); ++k) {
+                const N2D2::Float_T w2 = weights[k] * weights[k];
+                const N2D2::Float_T s2 = shifts[k] * shifts[k];
+                const N2D2::Float_T* input = inputs[k];
+
+                if (k == 0) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                    for (unsigned int n = begin; n < end; ++n)
+                        interTerm[n] = w2 * (input[n] * input[n]) + s2;
+                }
+                else {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                    for (unsigned int n = begin; n < end; ++n)
+                        interTerm[n] += w2 * (input[n] * input[n]) + s2;
+                }
+            }
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for (unsigned int n = begin; n < end; ++n) {
+                interTerm[n] = std::sqrt(interTerm[n]);
+                outputs[n] = interTerm[n];
+            }
+        }
+        else if (operation == N2D2::ElemWiseCell::Prod) {
+            if (outputs != inputs[0])
+                std::copy(inputs[0] + begin, inputs[0] + end, outputs + begin);
+
+            for (unsigned int k = 1; k < inputs.size(); ++k) {
+                const N2D2::Float_T* input = inputs[k];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int n = begin; n < end; ++n)
+                    outputs[n] *= input[n];
+            }
+        }
+        else if (operation == N2D2::ElemWiseCell::Max) {
+            if (outputs != inputs[0])
+                std::copy(inputs[0] + begin, inputs[0] + end, outputs + begin);
+
+            std::fill(argMax + begin, argMax + end, 0U);
+
+            for (unsigned int k = 1; k < inputs.size(); ++k) {
+                const N2D2::Float_T* input = inputs[k];
+
+                for (unsigned int n = begin; n < end; ++n) {
+                    if (input[n] > outputs[n]) {
+                        outputs[n] = input[n];
+                        argMax[n] = k;
+                    }
+                }
+            }
+        }
+    }
+}
+}
+
 N2D2::ElemWiseCell_Frame::ElemWiseCell_Frame(const DeepNet& deepNet, const std::string& name,
                                      unsigned int nbOutputs,
                                      Operation operation,
@@ -40,7 +189,8 @@ N2D2::ElemWiseCell_Frame::ElemWiseCell_Frame(const DeepNet& deepNet, const std::
                mode,
                weights,
                shifts),
-      Cell_Frame<Float_T>(deepNet, name, nbOutputs, activation)
+      Cell_Frame<Float_T>(deepNet, name, nbOutputs, activation),
+      mInPlaceOutputs(false)
 {
     // ctor
 }
@@ -93,6 +243,38 @@ void N2D2::ElemWiseCell_Frame::initialize()
         mInterTerm.resize(mOutputs.dims());
 }
 
+bool N2D2::ElemWiseCell_Frame::canPropagateInPlace() const
+{
+    if (mInputs[0].getType() != &typeid(Float_T)
+        || mInputs[0].size() != mOutputs.size())
+    {
+        return false;
+    }
+
+    // The first input must be the outputs of a parent cell whose only
+    // child is this cell, so that nothing else reads them afterwards.
+    // A Reshape cell outputs may be a view of its own input, which can have
+    // other readers.
+    const std::vector<std::shared_ptr<Cell> > parents = getParentsCells();
+
+    for (std::vector<std::shared_ptr<Cell> >::const_iterator it
+         = parents.begin(), itEnd = parents.end(); it != itEnd; ++it)
+    {
+        if (!(*it))
+            continue;
+
+        const std::shared_ptr<Cell_Frame_Top> parentFrame
+            = std::dynamic_pointer_cast<Cell_Frame_Top>(*it);
+
+        if (parentFrame && &parentFrame->getOutputs() == &mInputs[0]) {
+            return ((*it)->getType() != ReshapeCell::Type
+                    && (*it)->getChildrenCells().size() == 1);
+        }
+    }
+
+    return false;
+}
+
 void N2D2::ElemWiseCell_Frame::propagate(bool inference)
 {
     const unsigned int nbInputs = mInputs.size();
@@ -101,78 +283,55 @@ void N2D2::ElemWiseCell_Frame::propagate(bool inference)
     mInputs.synchronizeDBasedToH();
 
     std::vector<Tensor<Float_T> > inputs;
+    std::vector<const Float_T*> inputsData;
 
-    for (unsigned int k = 0; k < nbInputs; ++k)
+    for (unsigned int k = 0; k < nbInputs; ++k) {
         inputs.push_back(tensor_cast<Float_T>(mInputs[k]));
 
-    if (mOperation == Sum) {
-        for(unsigned int b = 0; b < inputs[0].dimB(); ++b) {
-            for(std::size_t ch = 0; ch < inputs[0].dimZ(); ++ch) {
-                for(std::size_t y = 0; y < inputs[0].dimY(); ++y) {
-                    for(std::size_t x = 0; x < inputs[0].dimX(); ++x) {
-                        std::size_t c0 = (mCoeffMode == ElemWiseCell::PerChannel) ? 
-                                                ch : 0;
-                        mOutputs(x,y,ch,b) = mWeights[c0] * inputs[0](x,y,ch,b)
-                                            + mShifts[c0];
-                        
-                        for (unsigned int k = 1; k < nbInputs; ++k) {
-                            std::size_t c1 = (mCoeffMode == ElemWiseCell::PerChannel) ? 
-                                                c0 : k;
-                            mOutputs(x,y,ch,b) += mWeights[c1] * inputs[k](x,y,ch,b)
-                                                + mShifts[c1];
-                        }
-                    }
-                }
-            }
-        }
+        const Tensor<Float_T>& input = inputs.back();
+        inputsData.push_back(&input(0));
     }
-    else if (mOperation == AbsSum) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mOutputs(n) = mWeights[0] * std::abs(inputs[0](n));
 
-            for (unsigned int k = 1; k < nbInputs; ++k)
-                mOutputs(n) += mWeights[k] * std::abs(inputs[k](n));
-        }
-    }
-    else if (mOperation == EuclideanSum) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mInterTerm(n) = (mWeights[0] * mWeights[0])
-                * (inputs[0](n) * inputs[0](n))
-                + (mShifts[0]*mShifts[0]);
-
-            for (unsigned int k = 1; k < nbInputs; ++k) {
-                mInterTerm(n) += (mWeights[k] * mWeights[k])
-                    * (inputs[k](n) * inputs[k](n))
-                    + (mShifts[k]*mShifts[k]);
-            }
+    // In inference, the result can be accumulated directly in the first
+    // input buffer, which avoids streaming a separate output tensor.
+    const bool inPlace = (inference && mInPlace && canPropagateInPlace());
 
-            mInterTerm(n) = std::sqrt(mInterTerm(n));
-            mOutputs(n) = mInterTerm(n);
-        }
-    }
-    else if (mOperation == Prod) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mOutputs(n) = inputs[0](n);
+    if (inPlace)
+        mOutputs.share(inputs[0]);
+    else if (mInPlaceOutputs) {
+        if (mOutputsStorage.empty())
+            mOutputsStorage.resize(mOutputs.dims());
 
-            for (unsigned int k = 1; k < nbInputs; ++k)
-                mOutputs(n) *= inputs[k](n);
-        }
+        mOutputs.share(mOutputsStorage);
     }
-    else if (mOperation == Max) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            Float_T maxVal = inputs[0](n);
-            unsigned int argMax = 0;
-
-            for (unsigned int k = 1; k < nbInputs; ++k) {
-                if (inputs[k](n) > maxVal) {
-                    maxVal = inputs[k](n);
-                    argMax = k;
-                }
-            }
 
-            mOutputs(n) = maxVal;
-            mArgMax(n) = argMax;
-        }
+    mInPlaceOutputs = inPlace;
+
+    if (mOperation == Sum) {
+        const unsigned int planeSize = mOutputs.dimX() * mOutputs.dimY();
+
+        sum(inputsData,
+            mWeights,
+            mShifts,
+            (mCoeffMode == ElemWiseCell::PerChannel),
+            planeSize,
+            mOutputs.dimZ(),
+            mOutputs.dimZ() * mOutputs.dimB(),
+            &mOutputs(0));
+    }
+    else if (mOperation == AbsSum
+        || mOperation == EuclideanSum
+        || mOperation == Prod
+        || mOperation == Max)
+    {
+        reduce(mOperation,
+               inputsData,
+               mWeights,
+               mShifts,
+               nbElems,
+               (mOperation == EuclideanSum) ? &mInterTerm(0) : NULL,
+               (mOperation == Max) ? &mArgMax(0) : NULL,
+               &mOutputs(0));
     }
     else {
         throw std::runtime_error("ElemWiseCell_Frame::propagate(): "
@@ -190,70 +349,125 @@ void N2D2::ElemWiseCell_Frame::backPropagate()
 
     const unsigned int nbInputs = mInputs.size();
     const unsigned int nbElems = mInputs[0].size();
+    const unsigned int planeSize = mDiffInputs.dimX() * mDiffInputs.dimY();
+    const unsigned int nbChannels = mDiffInputs.dimZ();
+    const int nbPlanes = mDiffInputs.dimZ() * mDiffInputs.dimB();
+    const int nbChunks = (nbElems + chunkSize - 1) / chunkSize;
 
     Cell_Frame<Float_T>::backPropagate();
 
     std::vector<Tensor<Float_T> > inputs;
+    std::vector<const Float_T*> inputsData;
 
-    for (unsigned int k = 0; k < nbInputs; ++k)
+    for (unsigned int k = 0; k < nbInputs; ++k) {
         inputs.push_back(tensor_cast_nocopy<Float_T>(mInputs[k]));
 
-    #pragma omp parallel for
-    for (int k = 0; k < (int)nbInputs; ++k) {
-        const float beta = (mDiffOutputs[k].isValid()) ? 1.0f : 0.0f;
+        const Tensor<Float_T>& input = inputs.back();
+        inputsData.push_back(&input(0));
+    }
+
+    const Tensor<Float_T>& cDiffInputs = mDiffInputs;
+    const Float_T* diffInputs = &cDiffInputs(0);
+
+    for (unsigned int k = 0; k < nbInputs; ++k) {
+        const Float_T beta = (mDiffOutputs[k].isValid()) ? 1.0f : 0.0f;
 
         Tensor<Float_T> diffOutput = (mDiffOutputs[k].isValid())
             ? tensor_cast<Float_T>(mDiffOutputs[k])
             : tensor_cast_nocopy<Float_T>(mDiffOutputs[k]);
 
+        Float_T* diffOutputs = &diffOutput(0);
+        const Float_T* input = inputsData[k];
+
         if (mOperation == Sum) {
-            for(unsigned int b = 0; b < inputs[k].dimB(); ++b) {
-                for(std::size_t ch = 0; ch < inputs[k].dimZ(); ++ch) {
-                    for(std::size_t y = 0; y < inputs[k].dimY(); ++y) {
-                        for(std::size_t x = 0; x < inputs[k].dimX(); ++x) {
-                            std::size_t coeffIdx = mCoeffMode == ElemWiseCell::PerChannel ? 
-                                                    ch : k;
-                            diffOutput(x,y,ch,b) = mWeights[coeffIdx] * mDiffInputs(x,y,ch,b)
-                                                + beta * diffOutput(x,y,ch,b);
-                        }
-                    }
+#pragma omp parallel for if (nbPlanes > 1 && nbPlanes * planeSize > 16384)
+            for (int plane = 0; plane < nbPlanes; ++plane) {
+                const unsigned int c = (mCoeffMode == ElemWiseCell::PerChannel)
+                    ? (plane % nbChannels) : k;
+                const Float_T w = mWeights[c];
+                const std::size_t offset = (std::size_t)plane * planeSize;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int i = offset; i < offset + planeSize; ++i) {
+                    diffOutputs[i] = w * diffInputs[i]
+                                        + beta * diffOutputs[i];
                 }
             }
         }
         else if (mOperation == AbsSum) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                const Float_T sign = (inputs[k](n) >= 0.0) ? 1.0 : -1.0;
-                diffOutput(n) = mWeights[k] * sign * mDiffInputs(n)
-                                    + beta * diffOutput(n);
+            const Float_T w = mWeights[k];
+
+#pragma omp parallel for if (nbChunks > 1)
+            for (int chunk = 0; chunk < nbChunks; ++chunk) {
+                const unsigned int begin = chunk * chunkSize;
+                const unsigned int end = std::min(begin + chunkSize, nbElems);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int n = begin; n < end; ++n) {
+                    const Float_T sign = (input[n] >= 0.0) ? 1.0 : -1.0;
+                    diffOutputs[n] = w * sign * diffInputs[n]
+                                        + beta * diffOutputs[n];
+                }
             }
         }
         else if (mOperation == EuclideanSum) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                diffOutput(n) = (mInterTerm(n) != 0.0)
-                    ? (mWeights[k] * mWeights[k])
-                        * (inputs[k](n) / mInterTerm(n))
-                        * mDiffInputs(n) + beta * diffOutput(n)
-                    : beta * diffOutput(n);
+            const Float_T w2 = mWeights[k] * mWeights[k];
+            const Tensor<Float_T>& cInterTerm = mInterTerm;
+            const Float_T* interTerm = &cInterTerm(0);
+
+#pragma omp parallel for if (nbChunks > 1)
+            for (int chunk = 0; chunk < nbChunks; ++chunk) {
+                const unsigned int begin = chunk * chunkSize;
+                const unsigned int end = std::min(begin + chunkSize, nbElems);
+
+                for (unsigned int n = begin; n < end; ++n) {
+                    diffOutputs[n] = (interTerm[n] != 0.0)
+                        ? w2 * (input[n] / interTerm[n]) * diffInputs[n]
+                            + beta * diffOutputs[n]
+                        : beta * diffOutputs[n];
+                }
             }
         }
         else if (mOperation == Prod) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                Float_T prodTerm = 1.0;
+#pragma omp parallel for if (nbChunks > 1)
+            for (int chunk = 0; chunk < nbChunks; ++chunk) {
+                const unsigned int begin = chunk * chunkSize;
+                const unsigned int end = std::min(begin + chunkSize, nbElems);
 
-                for (unsigned int i = 0; i < nbInputs; ++i) {
-                    if (i != (unsigned int)k)
-                        prodTerm *= inputs[i](n);
-                }
+                for (unsigned int n = begin; n < end; ++n) {
+                    Float_T prodTerm = 1.0;
 
-                diffOutput(n) = prodTerm * mDiffInputs(n)
-                                    + beta * diffOutput(n);
+                    for (unsigned int i = 0; i < nbInputs; ++i) {
+                        if (i != k)
+                            prodTerm *= inputsData[i][n];
+                    }
+
+                    diffOutputs[n] = prodTerm * diffInputs[n]
+                                        + beta * diffOutputs[n];
+                }
             }
         }
         else if (mOperation == Max) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                diffOutput(n) = (mArgMax(n) == (unsigned int)k)
-                    ? (mDiffInputs(n) + beta * diffOutput(n))
-                    : beta * diffOutput(n);
+            const Tensor<unsigned int>& cArgMax = mArgMax;
+            const unsigned int* argMax = &cArgMax(0);
+
+#pragma omp parallel for if (nbChunks > 1)
+            for (int chunk = 0; chunk < nbChunks; ++chunk) {
+                const unsigned int begin = chunk * chunkSize;
+                const unsigned int end = std::min(begin + chunkSize, nbElems);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                for (unsigned int n = begin; n < end; ++n) {
+                    diffOutputs[n] = (argMax[n] == k)
+                        ? (diffInputs[n] + beta * diffOutputs[n])
+                        : beta * diffOutputs[n];
+                }
             }
         }
         else {
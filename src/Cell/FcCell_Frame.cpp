@@ -159,6 +159,12 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
                                     * mOutputs.dimZ();
     const unsigned int count = mInputs.dimB() * outputSize;
 
+    // Half precision is only used for storage: the inputs and synapses are
+    // converted in bulk and the weighted sums are computed in single
+    // precision. The converted synapses are kept by tensor_cast() as long as
+    // they are not modified.
+    typedef typename Utils::scaling_type<T>::type SumT;
+
     T beta(0.0);
 
     for (unsigned int k = 0, size = mInputs.size(); k < size; ++k) {
@@ -173,8 +179,9 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
                     = Random::randBernoulli(mDropConnect);
         }
 
-        const Tensor<T>& synapses = mSynapses[k];
-        const Tensor<T>& input = tensor_cast<T>(mInputs[k]);
+        const Tensor<SumT>& synapses = tensor_cast<SumT>(mSynapses[k]);
+        const Tensor<SumT>& input
+            = tensor_cast<SumT>(tensor_cast<T>(mInputs[k]));
         const unsigned int inputSize = input.dimX() * input.dimY()
                                         * input.dimZ();
 
@@ -186,7 +193,7 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
         for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
             for (unsigned int output = 0; output < outputSize; ++output) {
                 // Compute the weighted sum
-                T weightedSum((!mNoBias) ? mBias(output) : 0.0);
+                SumT weightedSum((!mNoBias) ? (SumT)mBias(output) : 0.0f);
 
                 if (mDropConnect < 1.0 && !inference) {
                     for (unsigned int channel = 0; channel < inputSize;
@@ -208,7 +215,8 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
                 }
 
                 mOutputs(output, batchPos)
-                    = weightedSum + beta * mOutputs(output, batchPos);
+                    = T(weightedSum
+                        + (SumT)(beta * mOutputs(output, batchPos)));
             }
         }
     }
@@ -0,0 +1,642 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Cell/LSTMCell_Frame.hpp"
+#include "DeepNet.hpp"
+#include "Filler/Filler.hpp"
+#include "utils/Random.hpp"
+
+template <>
+N2D2::Registrar<N2D2::LSTMCell>
+N2D2::LSTMCell_Frame<float>::mRegistrar("Frame",
+    N2D2::LSTMCell_Frame<float>::create,
+    N2D2::Registrar<N2D2::LSTMCell>::Type<float>());
+
+template <>
+N2D2::Registrar<N2D2::LSTMCell>
+N2D2::LSTMCell_Frame<double>::mRegistrar("Frame",
+    N2D2::LSTMCell_Frame<double>::create,
+    N2D2::Registrar<N2D2::LSTMCell>::Type<double>());
+
+namespace {
+    /**
+     * C[M][N] += A[M][K] * B[K][N], row-major.
+     * The work is split in row x column blocks, so that there is enough
+     * parallelism even for a single row (recurrent projection of a batch of
+     * 1).
+    */
+    template <class T>
+    void gemmAccumulate(unsigned int M,
+                        unsigned int N,
+                        unsigned int K,
+                        const T* A,
+                        const T* B,
+                        T* C)
+    {
+        const int blockSize = 64;
+        const int nbBlocks = (N + blockSize - 1) / blockSize;
+
+#pragma omp parallel for collapse(2) if ((size_t)M * N * K > 16384)
+        for (int i = 0; i < (int)M; ++i) {
+            for (int block = 0; block < nbBlocks; ++block) {
+                const int jBegin = block * blockSize;
+                const int jEnd = std::min((int)N, jBegin + blockSize);
+                const T* a = A + (size_t)i * K;
+                T* c = C + (size_t)i * N;
+
+                for (unsigned int k = 0; k < K; ++k) {
+                    const T aik = a[k];
+                    const T* b = B + (size_t)k * N;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+                    for (int j = jBegin; j < jEnd; ++j)
+                        c[j] += aik * b[j];
+                }
+            }
+        }
+    }
+
+    template <class T>
+    inline T sigmoid(T x)
+    {
+        return T(1.0) / (T(1.0) + std::exp(-x));
+    }
+}
+
+template <class T>
+N2D2::LSTMCell_Frame<T>::LSTMCell_Frame(const DeepNet& deepNet,
+    const std::string& name,
+    unsigned int seqLength,
+    unsigned int batchSize,
+    unsigned int inputDim,
+    unsigned int numberLayers,
+    unsigned int hiddenSize,
+    unsigned int algo,
+    unsigned int nbOutputs,
+    unsigned int bidirectional,
+    unsigned int inputMode,
+    float dropout,
+    bool singleBackpropFeeding)
+    : Cell(deepNet, name, nbOutputs),
+      LSTMCell(deepNet, name,
+               seqLength,
+               batchSize,
+               inputDim,
+               numberLayers,
+               hiddenSize,
+               algo,
+               nbOutputs,
+               bidirectional,
+               inputMode,
+               dropout,
+               singleBackpropFeeding),
+      Cell_Frame<T>(deepNet, name, nbOutputs),
+      mWeights(std::make_shared<Tensor<T> >()),
+      mPackedValid(false),
+      mhx(std::make_shared<Tensor<T> >()),
+      mcx(std::make_shared<Tensor<T> >()),
+      mContinousBatch(false)
+{
+    // ctor
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::initialize()
+{
+    if (mInputMode > 1) {
+        throw std::runtime_error("LSTMCell_Frame InputMode invalid, LSTM name : "
+            + mName + " should be 0 to skip or 1 for Linear");
+    }
+
+    if (mInputMode == 0 && mInputDim != mHiddenSize) {
+        throw std::runtime_error("LSTMCell_Frame: InputDim must be equal to "
+            "HiddenSize with InputMode 0 (skip), LSTM name : " + mName);
+    }
+
+    if (mInputs.size() != 1
+        || mInputs[0].size() != mInputDim * mBatchSize * mSeqLength)
+    {
+        throw std::runtime_error("LSTMCell_Frame: inputs size must be "
+            "InputDim x BatchSize x SeqLength, LSTM name : " + mName);
+    }
+
+    const std::vector<size_t> statesDims
+        = {1, mHiddenSize, mBatchSize, mNumberLayers * biDirScale};
+
+    // Previous time step ("time -1") hidden & cell states
+    if (mhx->empty()) {
+        mhx->resize(statesDims, T(0.0));
+
+        if (mhxFiller)
+            mhxFiller->apply(*mhx);
+    }
+    else if (mhx->dims() != statesDims)
+        throw std::runtime_error("Cell " + mName + ", wrong size for hx");
+
+    if (mcx->empty()) {
+        mcx->resize(statesDims, T(0.0));
+
+        if (mcxFiller)
+            mcxFiller->apply(*mcx);
+    }
+    else if (mcx->dims() != statesDims)
+        throw std::runtime_error("Cell " + mName + ", wrong size for cx");
+
+    // Last time step hidden & cell states
+    mhy.resize(statesDims, T(0.0));
+    mcy.resize(statesDims, T(0.0));
+
+    mOutputsLocal.resize({1, mHiddenSize * biDirScale, mBatchSize,
+                          mSeqLength}, T(0.0));
+
+    // Same size as the cuDNN parameters
+    const unsigned int layer0Size
+        = 4 * mInputDim * mHiddenSize + 4 * mHiddenSize * mHiddenSize;
+    const unsigned int layerxSize
+        = 4 * mHiddenSize * biDirScale * mHiddenSize
+            + 4 * mHiddenSize * mHiddenSize;
+    const unsigned int nbWeights
+        = biDirScale * (layer0Size + (mNumberLayers - 1) * layerxSize)
+            + mNumberLayers * biDirScale * 8 * mHiddenSize;
+
+    if (mWeights->empty()) {
+        mWeights->resize({1, 1, 1, nbWeights}, T(0.0));
+
+        // Same fillers and seeds as LSTMCell_Frame_CUDA::initialize(), so
+        // that both implementations are initialized identically
+        for (unsigned int layer = 0; layer < mNumberLayers * biDirScale;
+            ++layer)
+        {
+            const bool firstLayer = (layer < biDirScale);
+
+            for (unsigned int gate = 0; gate < 8; ++gate) {
+                std::shared_ptr<Filler> weightsFiller;
+                std::shared_ptr<Filler> biasFiller;
+
+                if (gate == 0) {
+                    weightsFiller = (firstLayer)
+                        ? mWeightsPreviousLayerInputGateFiller_1stLayer
+                        : mWeightsPreviousLayerInputGateFiller;
+                    biasFiller = mBiasPreviousLayerInputGateFiller;
+                }
+                else if (gate == 1) {
+                    weightsFiller = (firstLayer)
+                        ? mWeightsPreviousLayerForgetGateFiller_1stLayer
+                        : mWeightsPreviousLayerForgetGateFiller;
+                    biasFiller = mBiasPreviousLayerForgetGateFiller;
+                }
+                else if (gate == 2) {
+                    weightsFiller = (firstLayer)
+                        ? mWeightsPreviousLayerCellGateFiller_1stLayer
+                        : mWeightsPreviousLayerCellGateFiller;
+                    biasFiller = mBiasPreviousLayerCellGateFiller;
+                }
+                else if (gate == 3) {
+                    weightsFiller = (firstLayer)
+                        ? mWeightsPreviousLayerOutputGateFiller_1stLayer
+                        : mWeightsPreviousLayerOutputGateFiller;
+                    biasFiller = mBiasPreviousLayerOutputGateFiller;
+                }
+                else if (gate == 4) {
+                    weightsFiller = mWeightsRecurrentInputGateFiller;
+                    biasFiller = mBiasRecurrentInputGateFiller;
+                }
+                else if (gate == 5) {
+                    weightsFiller = mWeightsRecurrentForgetGateFiller;
+                    biasFiller = mBiasRecurrentForgetGateFiller;
+                }
+                else if (gate == 6) {
+                    weightsFiller = mWeightsRecurrentCellGateFiller;
+                    biasFiller = mBiasRecurrentCellGateFiller;
+                }
+                else {
+                    weightsFiller = mWeightsRecurrentOutputGateFiller;
+                    biasFiller = mBiasRecurrentOutputGateFiller;
+                }
+
+                const unsigned int inputSize = (gate >= 4)
+                    ? mHiddenSize
+                    : (firstLayer) ? mInputDim : mHiddenSize * biDirScale;
+                const unsigned int weightsPos
+                    = getStartPosition(layer, gate, true);
+
+                Random::mtSeed(4 + gate);
+
+                if (weightsFiller && !(firstLayer && gate < 4
+                                       && mInputMode == 0))
+                {
+                    Tensor<T> weights({1, 1, inputSize * mHiddenSize, 1});
+                    weightsFiller->apply(weights);
+                    std::copy(weights.begin(), weights.end(),
+                              mWeights->begin() + weightsPos);
+                }
+
+                if (biasFiller) {
+                    Tensor<T> bias({1, 1, mHiddenSize, 1});
+                    biasFiller->apply(bias);
+                    std::copy(bias.begin(), bias.end(),
+                        mWeights->begin() + getStartPosition(layer, gate,
+                                                             false));
+                }
+            }
+        }
+    }
+    else if (mWeights->size() != nbWeights)
+        throw std::runtime_error("Cell " + mName + ", wrong size for Weights");
+
+    mPackedValid = false;
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::propagate(bool /*inference*/)
+{
+    mInputs.synchronizeDBasedToH();
+
+    const Tensor<T> input = tensor_cast<T>(mInputs[0]);
+
+    if (!mPackedValid)
+        packWeights();
+
+    const unsigned int nbRows = mSeqLength * mBatchSize;
+    const unsigned int gatesSize = 4 * mHiddenSize;
+    const unsigned int outputSize = mHiddenSize * biDirScale;
+    const unsigned int statesSize = mHiddenSize * mBatchSize;
+
+    mGates.resize(nbRows * gatesSize);
+    mHidden.resize(statesSize);
+    mCellState.resize(statesSize);
+
+    const T* layerInput = &input(0);
+    unsigned int layerInputSize = mInputDim;
+
+    for (unsigned int layer = 0; layer < mNumberLayers; ++layer) {
+        T* layerOutput;
+
+        if (layer == mNumberLayers - 1)
+            layerOutput = &mOutputsLocal(0);
+        else {
+            mLayerOutputs[layer % 2].resize(nbRows * outputSize);
+            layerOutput = &mLayerOutputs[layer % 2][0];
+        }
+
+        for (unsigned int dir = 0; dir < biDirScale; ++dir) {
+            const unsigned int pseudoLayer = layer * biDirScale + dir;
+            const std::vector<T>& bias = mPackedBias[pseudoLayer];
+            T* gates = &mGates[0];
+
+            // 1. Input projection, for all the time steps at once
+            for (unsigned int row = 0; row < nbRows; ++row) {
+                std::copy(bias.begin(), bias.end(),
+                          mGates.begin() + row * gatesSize);
+            }
+
+            if (layer == 0 && mInputMode == 0) {
+                // Skip input: the input is used directly for each gate
+#pragma omp parallel for if (nbRows > 16)
+                for (int row = 0; row < (int)nbRows; ++row) {
+                    for (unsigned int gate = 0; gate < 4; ++gate) {
+                        T* g = gates + row * gatesSize + gate * mHiddenSize;
+                        const T* x = layerInput + row * layerInputSize;
+
+                        for (unsigned int h = 0; h < mHiddenSize; ++h)
+                            g[h] += x[h];
+                    }
+                }
+            }
+            else {
+                gemmAccumulate(nbRows, gatesSize, layerInputSize,
+                               layerInput,
+                               &mPackedInputWeights[pseudoLayer][0],
+                               gates);
+            }
+
+            // 2. Recurrence
+            std::copy(mhx->begin() + pseudoLayer * statesSize,
+                      mhx->begin() + (pseudoLayer + 1) * statesSize,
+                      mHidden.begin());
+            std::copy(mcx->begin() + pseudoLayer * statesSize,
+                      mcx->begin() + (pseudoLayer + 1) * statesSize,
+                      mCellState.begin());
+
+            for (unsigned int step = 0; step < mSeqLength; ++step) {
+                const unsigned int t = (dir == 0) ? step
+                                                  : mSeqLength - 1 - step;
+                T* gatesT = gates + t * mBatchSize * gatesSize;
+
+                gemmAccumulate(mBatchSize, gatesSize, mHiddenSize,
+                               &mHidden[0],
+                               &mPackedRecurrentWeights[pseudoLayer][0],
+                               gatesT);
+
+                // Fused gates nonlinearities and states update
+#pragma omp parallel for if (statesSize > 256)
+                for (int index = 0; index < (int)statesSize; ++index) {
+                    const unsigned int batchPos = index / mHiddenSize;
+                    const unsigned int h = index % mHiddenSize;
+                    const T* g = gatesT + batchPos * gatesSize;
+
+                    const T inputGate = sigmoid(g[h]);
+                    const T forgetGate = sigmoid(g[mHiddenSize + h]);
+                    const T cellGate = std::tanh(g[2 * mHiddenSize + h]);
+                    const T outputGate = sigmoid(g[3 * mHiddenSize + h]);
+
+                    const T cellState = forgetGate * mCellState[index]
+                                        + inputGate * cellGate;
+                    const T hidden = outputGate * std::tanh(cellState);
+
+                    mCellState[index] = cellState;
+                    mHidden[index] = hidden;
+                    layerOutput[(t * mBatchSize + batchPos) * outputSize
+                                + dir * mHiddenSize + h] = hidden;
+                }
+            }
+
+            std::copy(mHidden.begin(), mHidden.end(),
+                      mhy.begin() + pseudoLayer * statesSize);
+            std::copy(mCellState.begin(), mCellState.end(),
+                      mcy.begin() + pseudoLayer * statesSize);
+        }
+
+        layerInput = layerOutput;
+        layerInputSize = outputSize;
+    }
+
+    if (mSingleBackpropFeeding) {
+        // Last time step only
+        std::copy(mOutputsLocal.begin() + (mSeqLength - 1) * mBatchSize
+                                            * outputSize,
+                  mOutputsLocal.end(),
+                  mOutputs.begin());
+    }
+    else
+        std::copy(mOutputsLocal.begin(), mOutputsLocal.end(), mOutputs.begin());
+
+    Cell_Frame<T>::propagate();
+    mDiffInputs.clearValid();
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::backPropagate()
+{
+    throw std::runtime_error(
+        "LSTMCell_Frame<T>::backPropagate(): not implemented.");
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::update()
+{
+    if (mContinousBatch) {
+        std::copy(mhy.begin(), mhy.end(), mhx->begin());
+        std::copy(mcy.begin(), mcy.end(), mcx->begin());
+    }
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::addInput(Cell* cell, const Tensor<bool>& mapping)
+{
+    Cell_Frame<T>::addInput(cell, mapping);
+
+    // Share the previous time step hidden & cell states with the parent LSTM
+    // cell, if the dimensions match
+    LSTMCell_Frame<T>* cellLSTM = dynamic_cast<LSTMCell_Frame<T>*>(cell);
+
+    if (cellLSTM != NULL
+        && cellLSTM->getHiddenSize() == mHiddenSize
+        && cellLSTM->getBatchSize() == mBatchSize
+        && cellLSTM->getNumberLayers() == mNumberLayers
+        && cellLSTM->getBidirectional() == mBidirectional)
+    {
+        mhx = cellLSTM->getmhx();
+        mcx = cellLSTM->getmcx();
+    }
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::addInput(StimuliProvider& sp,
+                                       unsigned int x0,
+                                       unsigned int y0,
+                                       unsigned int width,
+                                       unsigned int height,
+                                       const Tensor<bool>& mapping)
+{
+    Cell_Frame<T>::addInput(sp, x0, y0, width, height, mapping);
+
+    if (mSingleBackpropFeeding) {
+        mOutputs.resize({1, 1, mHiddenSize * biDirScale, mBatchSize});
+        mDiffInputs.resize({1, 1, mHiddenSize * biDirScale, mBatchSize});
+    }
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::setWeights(
+    const std::shared_ptr<Tensor<T> >& weights)
+{
+    mWeights = weights;
+    mPackedValid = false;
+}
+
+template <class T>
+unsigned int N2D2::LSTMCell_Frame<T>::getStartPosition(unsigned int layer,
+                                                       unsigned int gate,
+                                                       bool weight) const
+{
+    if (gate >= 8) {
+        throw std::runtime_error("LSTMCell_Frame::getStartPosition(): gate "
+                                 "invalid");
+    }
+
+    const unsigned int layer0PLSize = 4 * mInputDim * mHiddenSize;
+    const unsigned int layer0RSize = 4 * mHiddenSize * mHiddenSize;
+    const unsigned int layer0Size = layer0PLSize + layer0RSize;
+    const unsigned int layerxPLSize = 4 * mHiddenSize * biDirScale
+                                        * mHiddenSize;
+    const unsigned int layerxRSize = 4 * mHiddenSize * mHiddenSize;
+    const unsigned int layerxSize = layerxPLSize + layerxRSize;
+    const unsigned int allLayerSize = layer0Size
+                                        + (mNumberLayers - 1) * layerxSize;
+
+    if (!weight)
+        return (biDirScale * allLayerSize + layer * 8 * mHiddenSize
+                + gate * mHiddenSize);
+
+    if (layer < biDirScale) {
+        return (gate < 4)
+            ? layer * layer0Size + gate * mInputDim * mHiddenSize
+            : layer * layer0Size + layer0PLSize
+                + (gate - 4) * mHiddenSize * mHiddenSize;
+    }
+
+    const unsigned int layerStart = biDirScale * layer0Size
+                                    + (layer - biDirScale) * layerxSize;
+
+    return (gate < 4)
+        ? layerStart + gate * mHiddenSize * biDirScale * mHiddenSize
+        : layerStart + layerxPLSize + (gate - 4) * mHiddenSize * mHiddenSize;
+}
+
+template <class T>
+unsigned int N2D2::LSTMCell_Frame<T>::getInputWeightPosition_1stLayer(
+    unsigned int inputidx,
+    unsigned int hiddenidx,
+    unsigned int bidir,
+    unsigned int gate) const
+{
+    if (inputidx >= mInputDim || hiddenidx >= mHiddenSize
+        || bidir >= biDirScale)
+    {
+        throw std::runtime_error("LSTMCell_Frame::"
+            "getInputWeightPosition_1stLayer(): index invalid");
+    }
+
+    // Gate matrices are [mHiddenSize][inputSize], as in packWeights()
+    return getStartPosition(bidir, gate, true)
+        + hiddenidx * mInputDim + inputidx;
+}
+
+template <class T>
+unsigned int N2D2::LSTMCell_Frame<T>::getInputWeightPosition(
+    unsigned int channelhiddenidx,
+    unsigned int outputhiddenidx,
+    unsigned int nlbidir,
+    unsigned int gate) const
+{
+    if (channelhiddenidx >= mHiddenSize * biDirScale
+        || outputhiddenidx >= mHiddenSize
+        || nlbidir + biDirScale >= mNumberLayers * biDirScale)
+    {
+        throw std::runtime_error("LSTMCell_Frame::"
+            "getInputWeightPosition(): index invalid");
+    }
+
+    return getStartPosition(nlbidir + biDirScale, gate, true)
+        + outputhiddenidx * mHiddenSize * biDirScale + channelhiddenidx;
+}
+
+template <class T>
+unsigned int N2D2::LSTMCell_Frame<T>::getRecurrentWeightPosition(
+    unsigned int channelhiddenidx,
+    unsigned int outputhiddenidx,
+    unsigned int nlbidir,
+    unsigned int gate) const
+{
+    if (channelhiddenidx >= mHiddenSize || outputhiddenidx >= mHiddenSize
+        || nlbidir >= mNumberLayers * biDirScale)
+    {
+        throw std::runtime_error("LSTMCell_Frame::"
+            "getRecurrentWeightPosition(): index invalid");
+    }
+
+    return getStartPosition(nlbidir, gate, true)
+        + outputhiddenidx * mHiddenSize + channelhiddenidx;
+}
+
+template <class T>
+unsigned int N2D2::LSTMCell_Frame<T>::getBiasPosition(
+    unsigned int hiddenidx,
+    unsigned int nlbidir,
+    unsigned int gate) const
+{
+    if (hiddenidx >= mHiddenSize || nlbidir >= mNumberLayers * biDirScale) {
+        throw std::runtime_error("LSTMCell_Frame::"
+            "getBiasPosition(): index invalid");
+    }
+
+    return getStartPosition(nlbidir, gate, false) + hiddenidx;
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::getParameter(unsigned int pos,
+                                           BaseTensor& value) const
+{
+    value.resize({1});
+    value = Tensor<T>({1}, (*mWeights)(pos));
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::setParameter(unsigned int pos,
+                                           BaseTensor& value)
+{
+    (*mWeights)(pos) = tensor_cast<T>(value)(0);
+    mPackedValid = false;
+}
+
+template <class T>
+void N2D2::LSTMCell_Frame<T>::packWeights()
+{
+    const unsigned int nbPseudoLayers = mNumberLayers * biDirScale;
+    const unsigned int gatesSize = 4 * mHiddenSize;
+
+    mPackedInputWeights.resize(nbPseudoLayers);
+    mPackedRecurrentWeights.resize(nbPseudoLayers);
+    mPackedBias.resize(nbPseudoLayers);
+
+    // Each cuDNN gate matrix is [mHiddenSize][inputSize], row-major.
+    // The packed matrices are [inputSize][4 x mHiddenSize], so that the
+    // projection for all the gates is a single GEMM.
+    for (unsigned int layer = 0; layer < nbPseudoLayers; ++layer) {
+        const bool firstLayer = (layer < biDirScale);
+        const unsigned int inputSize = (firstLayer)
+            ? mInputDim : mHiddenSize * biDirScale;
+
+        std::vector<T>& inputWeights = mPackedInputWeights[layer];
+        std::vector<T>& recurrentWeights = mPackedRecurrentWeights[layer];
+        std::vector<T>& bias = mPackedBias[layer];
+
+        inputWeights.resize(inputSize * gatesSize);
+        recurrentWeights.resize(mHiddenSize * gatesSize);
+        bias.resize(gatesSize);
+
+        for (unsigned int gate = 0; gate < 4; ++gate) {
+            const unsigned int inputPos = getStartPosition(layer, gate, true);
+            const unsigned int recurrentPos
+                = getStartPosition(layer, gate + 4, true);
+            const unsigned int inputBiasPos
+                = getStartPosition(layer, gate, false);
+            const unsigned int recurrentBiasPos
+                = getStartPosition(layer, gate + 4, false);
+
+            for (unsigned int h = 0; h < mHiddenSize; ++h) {
+                const unsigned int col = gate * mHiddenSize + h;
+
+                for (unsigned int i = 0; i < inputSize; ++i) {
+                    inputWeights[i * gatesSize + col]
+                        = (*mWeights)(inputPos + h * inputSize + i);
+                }
+
+                for (unsigned int i = 0; i < mHiddenSize; ++i) {
+                    recurrentWeights[i * gatesSize + col]
+                        = (*mWeights)(recurrentPos + h * mHiddenSize + i);
+                }
+
+                bias[col] = (*mWeights)(inputBiasPos + h)
+                            + (*mWeights)(recurrentBiasPos + h);
+            }
+        }
+    }
+
+    mPackedValid = true;
+}
+
+namespace N2D2 {
+    template class LSTMCell_Frame<float>;
+    template class LSTMCell_Frame<double>;
+}
@@ -100,146 +100,100 @@ void N2D2::ObjectDetCell_Frame::propagate(bool inference)
 
     for(unsigned int batchPos = 0; batchPos < inputBatch; ++batchPos)
     {
-        std::vector< std::vector<std::pair< Tensor<int>::Index, Float_T> >> ROIs;
         std::vector< std::vector<BBox_T >> ROIsPredicted;
-
-        ROIs.resize(mNbClass);
         ROIsPredicted.resize(mNbClass);
-        for(unsigned int cls = 0; cls < mNbClass; ++ cls)
+
+        if(inference)
         {
-            //Keep ROIs with scores superior to the class threshold
-            for (unsigned int anchor = 0; anchor < mNbAnchors; ++anchor)
-            {
-                for (unsigned int y = 0; y < input.dimY(); ++y) {
-                    for (unsigned int x = 0; x < input.dimX(); ++x) {
+            // Keep ROIs with scores superior to the class threshold, and
+            // apply Non Maximal Suppression on all the classes at once
+            std::vector<Tensor<int>::Index> candidates;
 
-                        const Float_T value = input( x,
-                                                     y,
-                                                     anchor + cls*mNbAnchors,
-                                                     batchPos);
+            mNMS.setIoUThreshold(mNMS_IoU_Threshold);
+            mNMS.clear();
 
-                        if(value >= mScoreThreshold[cls] && inference)
-                        {
-                            ROIs[cls].push_back(std::make_pair(Tensor<int>::Index(x, y, anchor, batchPos), value));
-                        }
-                        else if(value >= 0.0 && !inference)
-                        {
-                            ROIs[cls].push_back(std::make_pair(Tensor<int>::Index(x, y, anchor, batchPos),
-                                                                value));
+            for(unsigned int cls = 0; cls < mNbClass; ++ cls)
+            {
+                for (unsigned int anchor = 0; anchor < mNbAnchors; ++anchor)
+                {
+                    const unsigned int k = anchor + cls*mNbAnchors;
+
+                    for (unsigned int y = 0; y < input.dimY(); ++y) {
+                        for (unsigned int x = 0; x < input.dimX(); ++x) {
+                            const Float_T value = input(x, y, k, batchPos);
+
+                            if(value >= mScoreThreshold[cls])
+                            {
+                                mNMS.push_back(input(x, y, k + offset, batchPos),
+                                               input(x, y, k + 2*offset, batchPos),
+                                               input(x, y, k + 3*offset, batchPos),
+                                               input(x, y, k + 4*offset, batchPos),
+                                               value,
+                                               cls);
+                                candidates.push_back(
+                                    Tensor<int>::Index(x, y, anchor, batchPos));
+                            }
                         }
                     }
                 }
             }
 
-            //Sort ROIs highest to lowest score
-            std::sort(ROIs[cls].begin(),
-                      ROIs[cls].end(),
-                      Utils::PairSecondPred<Tensor<int>::Index, Float_T,
-                        std::greater<Float_T> >());
+            const std::vector<unsigned int>& kept
+                = mNMS.process(mNbProposals);
+
+            for(unsigned int i = 0; i < kept.size(); ++i)
+            {
+                const Tensor<int>::Index& index = candidates[kept[i]];
 
-            if(inference)
+                ROIsPredicted[mNMS.getCls(kept[i])].push_back(
+                    BBox_T(index[0], index[1], index[2], index[3],
+                           mNMS.getScore(kept[i])));
+            }
+        }
+        else
+        {
+            for(unsigned int cls = 0; cls < mNbClass; ++ cls)
             {
-                std::vector<BBox_T> final_rois;
-                BBox_T next_candidate;
-                //Apply efficient Non Maximal Suppression
-                std::reverse(ROIs[cls].begin(),ROIs[cls].end());
-                while (final_rois.size() < mNbProposals && !ROIs[cls].empty()) {
-                    next_candidate.x = ROIs[cls].back().first[0];
-                    next_candidate.y = ROIs[cls].back().first[1];
-                    next_candidate.w = ROIs[cls].back().first[2];
-                    next_candidate.h = ROIs[cls].back().first[3];
-                    next_candidate.s = ROIs[cls].back().second;
-                    ROIs[cls].pop_back();
-
-                    bool should_select = true;
-                    const float x0 = input(   next_candidate.x, 
-                                            next_candidate.y, 
-                                            next_candidate.w + cls*mNbAnchors + offset, 
-                                            next_candidate.h);
-                    const float y0 = input(   next_candidate.x, 
-                                            next_candidate.y, 
-                                            next_candidate.w + cls*mNbAnchors + 2*offset, 
-                                            next_candidate.h);
-                    const float w0 = input(   next_candidate.x, 
-                                            next_candidate.y, 
-                                            next_candidate.w + cls*mNbAnchors + 3*offset, 
-                                            next_candidate.h);
-                    const float h0 = input(   next_candidate.x, 
-                                            next_candidate.y, 
-                                            next_candidate.w + cls*mNbAnchors + 4*offset, 
-                                            next_candidate.h);
-
-                    for (int j = static_cast<int>(final_rois.size()) - 1; j >= 0; --j) {
-
-                        const float x = input(final_rois[j].x, 
-                                            final_rois[j].y, 
-                                            final_rois[j].w + cls*mNbAnchors + offset, 
-                                            final_rois[j].h);
-
-                        const float y = input(final_rois[j].x, 
-                                            final_rois[j].y, 
-                                            final_rois[j].w + cls*mNbAnchors + 2*offset, 
-                                            final_rois[j].h);
-                        const float w = input(final_rois[j].x, 
-                                            final_rois[j].y, 
-                                            final_rois[j].w + cls*mNbAnchors + 3*offset, 
-                                            final_rois[j].h);
-                        const float h = input(final_rois[j].x, 
-                                            final_rois[j].y, 
-                                            final_rois[j].w + cls*mNbAnchors + 4*offset, 
-                                            final_rois[j].h);
-
-                        const float interLeft = std::max(x0, x);
-                        const float interRight = std::min(x0 + w0, x + w);
-                        const float interTop = std::max(y0, y);
-                        const float interBottom = std::min(y0 + h0, y + h);
-
-                        if (interLeft < interRight && interTop < interBottom) {
-                            const float interArea = (interRight - interLeft)
-                                                        * (interBottom - interTop);
-                            const float unionArea = w0 * h0 + w * h - interArea;
-                            const float IoU = interArea / unionArea;
-
-                            if (IoU > mNMS_IoU_Threshold) {
-                                should_select = false;
-                                break;
+                std::vector<std::pair< Tensor<int>::Index, Float_T> > ROIs;
 
+                for (unsigned int anchor = 0; anchor < mNbAnchors; ++anchor)
+                {
+                    for (unsigned int y = 0; y < input.dimY(); ++y) {
+                        for (unsigned int x = 0; x < input.dimX(); ++x) {
+                            const Float_T value = input( x,
+                                                         y,
+                                                         anchor + cls*mNbAnchors,
+                                                         batchPos);
+
+                            if(value >= 0.0)
+                            {
+                                ROIs.push_back(std::make_pair(Tensor<int>::Index(x, y, anchor, batchPos),
+                                                              value));
                             }
                         }
-
                     }
-                    if (should_select) 
-                        final_rois.push_back(next_candidate);
                 }
 
+                // Only the highest scores are required
+                const unsigned int nbProposals
+                    = std::min((unsigned int)ROIs.size(), mNbProposals);
 
-                ROIsPredicted[cls].resize(final_rois.size());
+                std::partial_sort(ROIs.begin(),
+                                  ROIs.begin() + nbProposals,
+                                  ROIs.end(),
+                                  Utils::PairSecondPred<Tensor<int>::Index, Float_T,
+                                    std::greater<Float_T> >());
 
-                for(unsigned int proposal = 0; proposal < final_rois.size(); ++ proposal )
+                for(unsigned int proposal = 0; proposal < nbProposals; ++ proposal )
                 {
-                    ROIsPredicted[cls][proposal].x = final_rois[proposal].x;
-                    ROIsPredicted[cls][proposal].y = final_rois[proposal].y;
-                    ROIsPredicted[cls][proposal].w = final_rois[proposal].w;
-                    ROIsPredicted[cls][proposal].h = final_rois[proposal].h;
-                    ROIsPredicted[cls][proposal].s = final_rois[proposal].s;
+                    ROIsPredicted[cls].push_back(
+                        BBox_T(ROIs[proposal].first[0],
+                               ROIs[proposal].first[1],
+                               ROIs[proposal].first[2],
+                               ROIs[proposal].first[3],
+                               ROIs[proposal].second));
                 }
             }
-            else
-            {
-                for(unsigned int proposal = 0; proposal < mNbProposals; ++ proposal )
-                {
-                    BBox_T final_rois;
-                    final_rois.x = ROIs[cls][proposal].first[0];
-                    final_rois.y = ROIs[cls][proposal].first[1];
-                    final_rois.w = ROIs[cls][proposal].first[2];
-                    final_rois.h = ROIs[cls][proposal].first[3];
-                    final_rois.s = ROIs[cls][proposal].second;
-
-                    ROIsPredicted[cls].push_back(final_rois);
-                }
-
-            }
-
         }
 
         for (unsigned int cls = 0; cls < mNbClass; ++cls)
@@ -22,6 +22,8 @@
 #include "containers/Tensor.hpp"
 #include "FloatT.hpp"
 
+#include <algorithm>
+
 void N2D2::PaddingCell_Frame_Kernels::forward(const Tensor<Float_T>& inputs,
                                            const Descriptor& desc,
                                            const unsigned int nbChannels,
@@ -29,40 +31,55 @@ void N2D2::PaddingCell_Frame_Kernels::forward(const Tensor<Float_T>& inputs,
                                            const unsigned int outputOffset,
                                            Tensor<Float_T>& outputs)
 {
-    const unsigned int size = inputs.dimB() * outputs.dimZ();
+    const int inputsWidth = inputs.dimX();
+    const int inputsHeight = inputs.dimY();
+    const int outputsWidth = outputs.dimX();
+    const int outputsHeight = outputs.dimY();
+    const std::size_t inputsSize = (std::size_t)inputsWidth * inputsHeight;
+    const std::size_t outputsSize = (std::size_t)outputsWidth * outputsHeight;
 
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (size > 16)
-#else
-#pragma omp parallel for if (inputs.dimB() > 4 && size > 16)
-#endif
-    for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
-        for (unsigned int output = 0; output < nbChannels; ++output) {
-            for (unsigned int oy = 0; oy < outputs.dimY(); ++oy) {
-                for (unsigned int ox = 0; ox < outputs.dimX(); ++ox) {
+    // Columns range receiving input data, identical for every row.
+    // Negative paddings (cropping, used for the backward pass) are handled
+    // the same way.
+    const int ixStart = std::max(0, -desc.leftPad);
+    const int oxStart = std::min(outputsWidth, ixStart + desc.leftPad);
+    const int nbCols = std::max(0, std::min(inputsWidth - ixStart,
+                                            outputsWidth - oxStart));
+    const int oxEnd = oxStart + nbCols;
 
-                    float outputValue = 0.0;
+    const Float_T* inputsData = &inputs(0);
+    Float_T* outputsData = &outputs(0);
 
-                    int ix = (int) ox - desc.leftPad;
-                    int iy = (int) oy - desc.topPad;
+    const int size = inputs.dimB() * nbChannels;
 
-                    if( ix >= 0  && ix < (int) inputs.dimX()
-                        && iy >= 0  && iy < (int) inputs.dimY())
-                    {
-                        outputValue = inputs(ix,
-                                             iy,
-                                             output + inputOffset,
-                                             batchPos);
+#pragma omp parallel for if (size > 1 && outputsSize * size > 16384)
+    for (int index = 0; index < size; ++index) {
+        const unsigned int batchPos = index / nbChannels;
+        const unsigned int channel = index % nbChannels;
 
-                    }
+        const Float_T* inputPlane = inputsData
+            + (std::size_t)(channel + inputOffset
+                            + batchPos * inputs.dimZ()) * inputsSize;
+        Float_T* outputPlane = outputsData
+            + (std::size_t)(channel + outputOffset
+                            + batchPos * outputs.dimZ()) * outputsSize;
 
-                    outputs(ox,
-                            oy,
-                            output + outputOffset,
-                            batchPos) = outputValue;
+        for (int oy = 0; oy < outputsHeight; ++oy) {
+            const int iy = oy - desc.topPad;
+            Float_T* outputLine = outputPlane + (std::size_t)oy * outputsWidth;
 
-                }
+            if (iy < 0 || iy >= inputsHeight || nbCols == 0) {
+                std::fill(outputLine, outputLine + outputsWidth, Float_T(0.0));
+                continue;
             }
+
+            const Float_T* inputLine = inputPlane
+                + (std::size_t)iy * inputsWidth + ixStart;
+
+            std::fill(outputLine, outputLine + oxStart, Float_T(0.0));
+            std::copy(inputLine, inputLine + nbCols, outputLine + oxStart);
+            std::fill(outputLine + oxEnd, outputLine + outputsWidth,
+                      Float_T(0.0));
         }
     }
 }
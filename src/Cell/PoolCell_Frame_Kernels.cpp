@@ -21,6 +21,7 @@
 #include "Cell/Cell_Frame.hpp"
 #include "Cell/PoolCell_Frame_Kernels.hpp"
 #include "Cell/PoolCell_Frame_Kernels_struct.hpp"
+#include "containers/Tensor_Kernels.hpp"
 #include "third_party/half.hpp"
 
 template <class T>
@@ -378,16 +379,40 @@ void N2D2::PoolCell_Frame_Kernels::backwardMax(const T* alpha,
     }
 }
 
+template <>
+void N2D2::PoolCell_Frame_Kernels::forwardAverage<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs,
+    bool isQuantized,
+    bool countIncludePadding,
+    const Tensor<bool>& maps)
+{
+    // Half precision is only used for storage: the operands are converted in
+    // bulk and the pooling sums are done in single precision
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float> outputsF(outputs.dims());
+
+    if (betaF != 0.0f)
+        Tensor_Kernels::convert(&outputs(0), &outputsF(0), outputs.size());
+
+    forwardAverage<float>(&alphaF,
+                          tensor_cast<float>(inputs),
+                          desc,
+                          &betaF,
+                          outputsF,
+                          isQuantized,
+                          countIncludePadding,
+                          maps);
+
+    Tensor_Kernels::convert(&outputsF(0), &outputs(0), outputs.size());
+}
+
 namespace N2D2 {
-    template void PoolCell_Frame_Kernels::forwardAverage<half_float::half>(
-        const half_float::half* alpha,
-        const Tensor<half_float::half>& inputs,
-        const Descriptor& desc,
-        const half_float::half* beta,
-        Tensor<half_float::half>& outputs,
-        bool isQuantized,
-        bool countIncludePadding,
-        const Tensor<bool>& maps);
     template void PoolCell_Frame_Kernels::forwardAverage<float>(
         const float* alpha,
         const Tensor<float>& inputs,
@@ -287,70 +287,81 @@ void N2D2::ProposalCell_Frame::propagate(bool inference)
                         }
                     }
                 }
+            }
+
+            if(mApplyNMS)
+            {
+                // Non-Maximum Suppression (NMS), in proposals order, all
+                // the classes at once
+                mNMS.setIoUThreshold(mNMS_IoU_Threshold);
+                mNMS.clear();
 
-                if(mApplyNMS)
+                for(unsigned int cls = mScoreIndex; cls < mNbClass; ++cls)
                 {
+                    for(unsigned int i = 0; i < ROIs[n][cls].size(); ++i)
+                    {
+                        mNMS.push_back(ROIs[n][cls][i].x,
+                                       ROIs[n][cls][i].y,
+                                       ROIs[n][cls][i].w,
+                                       ROIs[n][cls][i].h,
+                                       1.0f,
+                                       cls);
+                    }
+                }
+
+                const std::vector<unsigned int>& kept
+                    = mNMS.process(0, false);
 
-                    if(ROIs[n][cls].size() > 0)
+                std::vector<bool> isKept(mNMS.size(), false);
+
+                for(unsigned int k = 0; k < kept.size(); ++k)
+                    isKept[kept[k]] = true;
+
+                unsigned int index = 0;
+
+                for(unsigned int cls = mScoreIndex; cls < mNbClass; ++cls)
+                {
+                    unsigned int nbKept = 0;
+
+                    for(unsigned int i = 0; i < ROIs[n][cls].size();
+                        ++i, ++index)
                     {
-                        // Non-Maximum Suppression (NMS)
-                        for (unsigned int i = 0; i < ROIs[n][cls].size() - 1;
-                            ++i)
+                        if(isKept[index])
+                        {
+                            ROIs[n][cls][nbKept] = ROIs[n][cls][i];
+
+                            if(mMaxParts > 0)
+                                indexP[cls][nbKept] = indexP[cls][i];
+
+                            ++nbKept;
+                        }
+                        else if(mMaxParts > 0)
                         {
-                            const Float_T x0 = ROIs[n][cls][i].x;
-                            const Float_T y0 = ROIs[n][cls][i].y;
-                            const Float_T w0 = ROIs[n][cls][i].w;
-                            const Float_T h0 = ROIs[n][cls][i].h;
-
-                            for (unsigned int j = i + 1; j < ROIs[n][cls].size(); ) {
-
-                                const Float_T x = ROIs[n][cls][j].x;
-                                const Float_T y = ROIs[n][cls][j].y;
-                                const Float_T w = ROIs[n][cls][j].w;
-                                const Float_T h = ROIs[n][cls][j].h;
-
-                                const Float_T interLeft = std::max(x0, x);
-                                const Float_T interRight = std::min(x0 + w0, x + w);
-                                const Float_T interTop = std::max(y0, y);
-                                const Float_T interBottom = std::min(y0 + h0, y + h);
-
-                                if (interLeft < interRight && interTop < interBottom) {
-                                    const Float_T interArea = (interRight - interLeft)
-                                                                * (interBottom - interTop);
-                                    const Float_T unionArea = w0 * h0 + w * h - interArea;
-                                    const Float_T IoU = interArea / unionArea;
-
-                                    if (IoU > mNMS_IoU_Threshold) {
-                                        // Suppress ROI
-                                        ROIs[n][cls].erase(ROIs[n][cls].begin() + j);
-
-                                        if(mMaxParts > 0)
-                                        {
-                                            for(unsigned int part = 0; part < mNumParts[cls]; ++part)
-                                            {
-                                                mPartsPrediction(0, part, cls, indexP[cls][j]) = 0.0;
-                                                mPartsPrediction(1, part, cls, indexP[cls][j]) = 0.0;
-                                            }
-                                            for(unsigned int tpl = 0; tpl < mNumTemplates[cls]; ++tpl)
-                                            {
-                                                mTemplatesPrediction(0, tpl, cls, indexP[cls][j]) = 0.0;
-                                                mTemplatesPrediction(1, tpl, cls, indexP[cls][j]) = 0.0;
-                                                mTemplatesPrediction(2, tpl, cls, indexP[cls][j]) = 0.0;
-                                            }
-                                        }
-
-                                        indexP[cls].erase(indexP[cls].begin() + j);
-                                        continue;
-                                    }
-                                }
-                                ++j;
+                            // Suppressed ROI
+                            for(unsigned int part = 0; part < mNumParts[cls]; ++part)
+                            {
+                                mPartsPrediction(0, part, cls, indexP[cls][i]) = 0.0;
+                                mPartsPrediction(1, part, cls, indexP[cls][i]) = 0.0;
+                            }
+                            for(unsigned int tpl = 0; tpl < mNumTemplates[cls]; ++tpl)
+                            {
+                                mTemplatesPrediction(0, tpl, cls, indexP[cls][i]) = 0.0;
+                                mTemplatesPrediction(1, tpl, cls, indexP[cls][i]) = 0.0;
+                                mTemplatesPrediction(2, tpl, cls, indexP[cls][i]) = 0.0;
                             }
                         }
                     }
+
+                    ROIs[n][cls].resize(nbKept);
+
+                    if(mMaxParts > 0)
+                        indexP[cls].resize(nbKept);
                 }
-                nbRoiDetected += ROIs[n][cls].size();
             }
 
+            for(unsigned int cls = mScoreIndex; cls < mNbClass; ++cls)
+                nbRoiDetected += ROIs[n][cls].size();
+
             unsigned int totalIdx = 0;
             //unsigned int cls = mScoreIndex;
             for (unsigned int cls = mScoreIndex; cls < mNbClass && totalIdx < mNbProposals; ++cls)
@@ -67,8 +67,15 @@ void N2D2::ReshapeCell_Frame<T>::propagate(bool inference)
     mInputs.synchronizeDBasedToH();
 
     const Tensor<T>& input = tensor_cast<T>(mInputs[0]);
-    // TODO: replace copy with DataTensor pointer copy
-    std::copy(input.begin(), input.end(), mOutputs.begin());
+
+    if (!mActivation) {
+        // Reshape is a pure view of the input data: no copy is needed.
+        // The activation would be applied in-place on the outputs, which
+        // would modify the input cell outputs as well, hence the copy below.
+        mOutputs.share(input);
+    }
+    else
+        std::copy(input.begin(), input.end(), mOutputs.begin());
 
     Cell_Frame<T>::propagate(inference);
     mDiffInputs.clearValid();
@@ -20,6 +20,7 @@
 
 #include "GradientCheck.hpp"
 #include "Cell/TransposeCell_Frame.hpp"
+#include "Cell/TransposeCell_Frame_Kernels.hpp"
 #include "DeepNet.hpp"
 #include "third_party/half.hpp"
 
@@ -68,18 +69,8 @@ void N2D2::TransposeCell_Frame<T>::propagate(bool inference)
 
     const Tensor<T>& input = tensor_cast<T>(mInputs[0]);
 
-    std::size_t coords[4];
-    for (coords[3] = 0; coords[3] < input.dims()[3]; ++coords[3]) {
-        for (coords[2] = 0; coords[2] < input.dims()[2]; ++coords[2]) {
-            for (coords[1] = 0; coords[1] < input.dims()[1]; ++coords[1]) {
-                for (coords[0] = 0; coords[0] < input.dims()[0]; ++coords[0]) {
-                    mOutputs(coords[mPerm[0]], coords[mPerm[1]],
-                             coords[mPerm[2]], coords[mPerm[3]])
-                        = input(coords[0], coords[1], coords[2], coords[3]);
-                }
-            }
-        }
-    }
+    TransposeCell_Frame_Kernels::transpose(&input(0), input.dims(), mPerm,
+                                           &mOutputs(0));
 
     Cell_Frame<T>::propagate(inference);
     mDiffInputs.clearValid();
@@ -98,23 +89,9 @@ void N2D2::TransposeCell_Frame<T>::backPropagate()
 
         Tensor<T> diffOutputs = tensor_cast<T>(mDiffOutputs[0]);
 
-        std::size_t coords[4];
-        for (coords[3] = 0; coords[3] < mDiffInputs.dims()[3]; ++coords[3]) {
-            for (coords[2] = 0; coords[2] < mDiffInputs.dims()[2]; ++coords[2]) {
-                for (coords[1] = 0; coords[1] < mDiffInputs.dims()[1];
-                    ++coords[1])
-                {
-                    for (coords[0] = 0; coords[0] < mDiffInputs.dims()[0];
-                        ++coords[0])
-                    {
-                        diffOutputs(coords[invPerm[0]], coords[invPerm[1]],
-                                    coords[invPerm[2]], coords[invPerm[3]])
-                            = mDiffInputs(coords[0], coords[1],
-                                          coords[2], coords[3]);
-                    }
-                }
-            }
-        }
+        TransposeCell_Frame_Kernels::transpose(&mDiffInputs(0),
+                                               mDiffInputs.dims(), invPerm,
+                                               &diffOutputs(0));
 
         mDiffOutputs[0] = diffOutputs;
 
@@ -0,0 +1,155 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+
+#include "Cell/TransposeCell_Frame_Kernels.hpp"
+#include "third_party/half.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// Tile size, in elements, of the blocked transposition
+const int tileSize = 32;
+}
+
+template <class T>
+void N2D2::TransposeCell_Frame_Kernels::transpose(
+    const T* inputs,
+    const std::vector<size_t>& dims,
+    const std::vector<int>& perm,
+    T* outputs)
+{
+    assert(dims.size() == 4);
+    assert(perm.size() == 4);
+
+    // Output dimensions and strides, and stride in the inputs of each
+    // output dimension
+    size_t inputsStride[4];
+    size_t outputsDims[4];
+    size_t outputsStride[4];
+    size_t stride[4];
+
+    inputsStride[0] = 1;
+    outputsStride[0] = 1;
+
+    for (int dim = 1; dim < 4; ++dim)
+        inputsStride[dim] = inputsStride[dim - 1] * dims[dim - 1];
+
+    for (int dim = 0; dim < 4; ++dim) {
+        outputsDims[dim] = dims[perm[dim]];
+        stride[dim] = inputsStride[perm[dim]];
+
+        if (dim > 0) {
+            outputsStride[dim] = outputsStride[dim - 1]
+                                    * outputsDims[dim - 1];
+        }
+    }
+
+    if (perm[0] == 0) {
+        // Rows are contiguous in both inputs and outputs
+        const size_t rowSize = outputsDims[0];
+        const int nbRows = outputsDims[1] * outputsDims[2] * outputsDims[3];
+
+#pragma omp parallel for if (nbRows > 16 && nbRows * rowSize > 16384)
+        for (int row = 0; row < nbRows; ++row) {
+            const size_t o1 = row % outputsDims[1];
+            const size_t o2 = (row / outputsDims[1]) % outputsDims[2];
+            const size_t o3 = row / (outputsDims[1] * outputsDims[2]);
+
+            const T* inputRow = inputs
+                + o1 * stride[1] + o2 * stride[2] + o3 * stride[3];
+
+            std::copy(inputRow, inputRow + rowSize,
+                      outputs + (size_t)row * rowSize);
+        }
+
+        return;
+    }
+
+    // The output dimension which is contiguous in the inputs (stride 1) is
+    // tiled together with the output dimension 0, which is contiguous in the
+    // outputs, so that both the reads and the writes stay in cache.
+    int inner = 1;
+
+    while (perm[inner] != 0)
+        ++inner;
+
+    int others[2];
+    int nbOthers = 0;
+
+    for (int dim = 1; dim < 4; ++dim) {
+        if (dim != inner)
+            others[nbOthers++] = dim;
+    }
+
+    const size_t dimA = outputsDims[others[0]];
+    const size_t dimB = outputsDims[others[1]];
+    const size_t nbTilesX = (outputsDims[0] + tileSize - 1) / tileSize;
+    const size_t nbTilesY = (outputsDims[inner] + tileSize - 1) / tileSize;
+    const int nbTiles = nbTilesX * nbTilesY * dimA * dimB;
+
+#pragma omp parallel for if (nbTiles > 16)
+    for (int tile = 0; tile < nbTiles; ++tile) {
+        size_t index = tile;
+        const size_t tx = index % nbTilesX;
+        index /= nbTilesX;
+        const size_t ty = index % nbTilesY;
+        index /= nbTilesY;
+        const size_t a = index % dimA;
+        const size_t b = index / dimA;
+
+        const size_t x0 = tx * tileSize;
+        const size_t x1 = std::min(x0 + tileSize, outputsDims[0]);
+        const size_t y0 = ty * tileSize;
+        const size_t y1 = std::min(y0 + tileSize, outputsDims[inner]);
+
+        const T* inputTile = inputs + a * stride[others[0]]
+                                    + b * stride[others[1]];
+        T* outputTile = outputs + a * outputsStride[others[0]]
+                                + b * outputsStride[others[1]];
+
+        for (size_t y = y0; y < y1; ++y) {
+            const T* inputLine = inputTile + y;
+            T* outputLine = outputTile + y * outputsStride[inner];
+
+            for (size_t x = x0; x < x1; ++x)
+                outputLine[x] = inputLine[x * stride[0]];
+        }
+    }
+}
+
+namespace N2D2 {
+    template void TransposeCell_Frame_Kernels::transpose<half_float::half>(
+        const half_float::half* inputs,
+        const std::vector<size_t>& dims,
+        const std::vector<int>& perm,
+        half_float::half* outputs);
+    template void TransposeCell_Frame_Kernels::transpose<float>(
+        const float* inputs,
+        const std::vector<size_t>& dims,
+        const std::vector<int>& perm,
+        float* outputs);
+    template void TransposeCell_Frame_Kernels::transpose<double>(
+        const double* inputs,
+        const std::vector<size_t>& dims,
+        const std::vector<int>& perm,
+        double* outputs);
+}
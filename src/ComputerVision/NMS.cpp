@@ -0,0 +1,346 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "ComputerVision/NMS.hpp"
+
+namespace {
+    // Decreasing score order, ties broken by insertion order so that the
+    // result does not depend on the (partial) sorting strategy
+    struct ScoreGreater {
+        ScoreGreater(const std::vector<float>& score_) : score(score_) {}
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            return (score[a] > score[b] || (score[a] == score[b] && a < b));
+        }
+
+        const std::vector<float>& score;
+    };
+}
+
+N2D2::ComputerVision::NMS::NMS(double IoUThreshold,
+                               Method method,
+                               double sigma,
+                               double scoreThreshold)
+    : mIoUThreshold(IoUThreshold),
+      mMethod(method),
+      mSigma(sigma),
+      mScoreThreshold(scoreThreshold)
+{
+    // ctor
+}
+
+void N2D2::ComputerVision::NMS::clear()
+{
+    mX0.clear();
+    mY0.clear();
+    mX1.clear();
+    mY1.clear();
+    mScore.clear();
+    mCls.clear();
+    mKept.clear();
+}
+
+void N2D2::ComputerVision::NMS::reserve(unsigned int size)
+{
+    mX0.reserve(size);
+    mY0.reserve(size);
+    mX1.reserve(size);
+    mY1.reserve(size);
+    mScore.reserve(size);
+    mCls.reserve(size);
+}
+
+unsigned int N2D2::ComputerVision::NMS::push_back(float x,
+                                                  float y,
+                                                  float w,
+                                                  float h,
+                                                  float score,
+                                                  int cls)
+{
+    mX0.push_back(x);
+    mY0.push_back(y);
+    mX1.push_back(x + w);
+    mY1.push_back(y + h);
+    mScore.push_back(score);
+    mCls.push_back(cls);
+    return (mScore.size() - 1);
+}
+
+const std::vector<unsigned int>&
+N2D2::ComputerVision::NMS::process(unsigned int maxKeep, bool sortByScore)
+{
+    mKept.clear();
+
+    if (mScore.empty())
+        return mKept;
+
+    groupByClass();
+
+    const int nbGroups = (int)mGroups.size() - 1;
+    mGroupKept.resize(nbGroups);
+
+#pragma omp parallel for schedule(dynamic) if (nbGroups > 1)
+    for (int g = 0; g < nbGroups; ++g) {
+        mGroupKept[g].clear();
+
+        if (mMethod == Greedy) {
+            processGreedy(mGroups[g], mGroups[g + 1], maxKeep, sortByScore,
+                          mGroupKept[g]);
+        }
+        else
+            processSoft(mGroups[g], mGroups[g + 1], maxKeep, mGroupKept[g]);
+    }
+
+    for (int g = 0; g < nbGroups; ++g)
+        mKept.insert(mKept.end(), mGroupKept[g].begin(), mGroupKept[g].end());
+
+    return mKept;
+}
+
+float N2D2::ComputerVision::NMS::IoU(float x0, float y0, float w0, float h0,
+                                     float x1, float y1, float w1, float h1)
+{
+    const float interLeft = std::max(x0, x1);
+    const float interRight = std::min(x0 + w0, x1 + w1);
+    const float interTop = std::max(y0, y1);
+    const float interBottom = std::min(y0 + h0, y1 + h1);
+
+    if (interLeft < interRight && interTop < interBottom) {
+        const float interArea = (interRight - interLeft)
+                                * (interBottom - interTop);
+        const float unionArea = w0 * h0 + w1 * h1 - interArea;
+        return interArea / unionArea;
+    }
+
+    return 0.0f;
+}
+
+void N2D2::ComputerVision::NMS::groupByClass()
+{
+    const unsigned int size = mScore.size();
+    const int minCls = *std::min_element(mCls.begin(), mCls.end());
+    const int maxCls = *std::max_element(mCls.begin(), mCls.end());
+
+    // mWOrder is used here as the class-grouped permutation
+    mWOrder.resize(size);
+    mGroups.clear();
+    mGroups.push_back(0);
+
+    if (minCls == maxCls) {
+        for (unsigned int i = 0; i < size; ++i)
+            mWOrder[i] = i;
+    }
+    else if ((unsigned int)(maxCls - minCls) <= size + 256) {
+        // Counting sort (stable)
+        std::vector<unsigned int> offsets(maxCls - minCls + 2, 0);
+
+        for (unsigned int i = 0; i < size; ++i)
+            ++offsets[mCls[i] - minCls + 1];
+
+        for (unsigned int c = 1; c < offsets.size(); ++c)
+            offsets[c] += offsets[c - 1];
+
+        for (unsigned int i = 0; i < size; ++i)
+            mWOrder[offsets[mCls[i] - minCls]++] = i;
+    }
+    else {
+        for (unsigned int i = 0; i < size; ++i)
+            mWOrder[i] = i;
+
+        std::stable_sort(mWOrder.begin(), mWOrder.end(),
+            [this](unsigned int a, unsigned int b)
+                { return (mCls[a] < mCls[b]); });
+    }
+
+    mWX0.resize(size);
+    mWY0.resize(size);
+    mWX1.resize(size);
+    mWY1.resize(size);
+    mWArea.resize(size);
+    mWScore.resize(size);
+    mWIndex.resize(size);
+    mWRemoved.resize(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        const unsigned int index = mWOrder[i];
+
+        mWX0[i] = mX0[index];
+        mWY0[i] = mY0[index];
+        mWX1[i] = mX1[index];
+        mWY1[i] = mY1[index];
+        mWArea[i] = (mX1[index] - mX0[index]) * (mY1[index] - mY0[index]);
+        mWScore[i] = mScore[index];
+        mWIndex[i] = index;
+        mWRemoved[i] = 0;
+
+        if (i > 0 && mCls[index] != mCls[mWOrder[i - 1]])
+            mGroups.push_back(i);
+    }
+
+    mGroups.push_back(size);
+}
+
+void N2D2::ComputerVision::NMS::processGreedy(unsigned int begin,
+                                              unsigned int end,
+                                              unsigned int maxKeep,
+                                              bool sortByScore,
+                                              std::vector<unsigned int>& kept)
+{
+    const float* x0 = &mWX0[0];
+    const float* y0 = &mWY0[0];
+    const float* x1 = &mWX1[0];
+    const float* y1 = &mWY1[0];
+    const float* area = &mWArea[0];
+    unsigned char* removed = &mWRemoved[0];
+    const float threshold = mIoUThreshold;
+
+    // Candidates processing order
+    for (unsigned int i = begin; i < end; ++i)
+        mWOrder[i] = i;
+
+    const std::vector<unsigned int>::iterator itOrder = mWOrder.begin();
+    const ScoreGreater scoreGreater(mWScore);
+    unsigned int sortedEnd = end;
+
+    if (sortByScore) {
+        if (maxKeep > 0 && maxKeep < end - begin)
+            sortedEnd = begin;  // sorted on demand, see below
+        else
+            std::sort(itOrder + begin, itOrder + end, scoreGreater);
+    }
+
+    for (unsigned int pos = begin; pos < end; ++pos) {
+        if (pos == sortedEnd) {
+            // Partial selection: only sort the next top-scored candidates
+            const unsigned int nbMissing = maxKeep - kept.size();
+            const unsigned int chunkEnd
+                = std::min(end, sortedEnd + std::max(2 * nbMissing, 64U));
+
+            if (chunkEnd < end) {
+                std::nth_element(itOrder + sortedEnd, itOrder + chunkEnd,
+                                 itOrder + end, scoreGreater);
+            }
+
+            std::sort(itOrder + sortedEnd, itOrder + chunkEnd, scoreGreater);
+            sortedEnd = chunkEnd;
+        }
+
+        const unsigned int i = mWOrder[pos];
+
+        if (removed[i])
+            continue;
+
+        kept.push_back(mWIndex[i]);
+
+        if (maxKeep > 0 && kept.size() >= maxKeep)
+            break;
+
+        const float ax0 = x0[i];
+        const float ay0 = y0[i];
+        const float ax1 = x1[i];
+        const float ay1 = y1[i];
+        const float aArea = area[i];
+
+        // IoU > threshold <=> interArea > threshold * unionArea, which
+        // avoids the division and the 0/0 case for empty boxes
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int j = (int)begin; j < (int)end; ++j) {
+            const float interWidth = std::max(0.0f,
+                std::min(ax1, x1[j]) - std::max(ax0, x0[j]));
+            const float interHeight = std::max(0.0f,
+                std::min(ay1, y1[j]) - std::max(ay0, y0[j]));
+            const float interArea = interWidth * interHeight;
+            const float unionArea = aArea + area[j] - interArea;
+
+            removed[j] |= (unsigned char)(interArea > threshold * unionArea);
+        }
+    }
+}
+
+void N2D2::ComputerVision::NMS::processSoft(unsigned int begin,
+                                            unsigned int end,
+                                            unsigned int maxKeep,
+                                            std::vector<unsigned int>& kept)
+{
+    const float* x0 = &mWX0[0];
+    const float* y0 = &mWY0[0];
+    const float* x1 = &mWX1[0];
+    const float* y1 = &mWY1[0];
+    const float* area = &mWArea[0];
+    float* score = &mWScore[0];
+    unsigned char* removed = &mWRemoved[0];
+    const float threshold = mIoUThreshold;
+    const float scoreThreshold = mScoreThreshold;
+    const float invSigma = 1.0 / mSigma;
+    const bool linear = (mMethod == SoftLinear);
+
+    for (unsigned int j = begin; j < end; ++j)
+        removed[j] |= (unsigned char)(score[j] < scoreThreshold);
+
+    while (maxKeep == 0 || kept.size() < maxKeep) {
+        int best = -1;
+
+        for (unsigned int j = begin; j < end; ++j) {
+            if (!removed[j] && (best < 0 || score[j] > score[best]))
+                best = j;
+        }
+
+        if (best < 0)
+            break;
+
+        removed[best] = 1;
+        kept.push_back(mWIndex[best]);
+
+        const float ax0 = x0[best];
+        const float ay0 = y0[best];
+        const float ax1 = x1[best];
+        const float ay1 = y1[best];
+        const float aArea = area[best];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int j = (int)begin; j < (int)end; ++j) {
+            const float interWidth = std::max(0.0f,
+                std::min(ax1, x1[j]) - std::max(ax0, x0[j]));
+            const float interHeight = std::max(0.0f,
+                std::min(ay1, y1[j]) - std::max(ay0, y0[j]));
+            const float interArea = interWidth * interHeight;
+            const float unionArea = std::max(aArea + area[j] - interArea,
+                                             1.0e-12f);
+            const float iou = interArea / unionArea;
+            const float weight = (linear)
+                ? ((iou > threshold) ? (1.0f - iou) : 1.0f)
+                : std::exp(-iou * iou * invSigma);
+            const float decayed = (removed[j]) ? score[j] : score[j] * weight;
+
+            score[j] = decayed;
+            removed[j] |= (unsigned char)(decayed < scoreThreshold);
+        }
+    }
+
+    for (unsigned int j = begin; j < end; ++j)
+        mScore[mWIndex[j]] = score[j];
+}
@@ -0,0 +1,147 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "ComputerVision/ParallelLSL_Box.hpp"
+
+void N2D2::ComputerVision::ParallelLSL_Box::mergeTiles()
+{
+    const unsigned int nbTiles = mTileOffset.size() - 1;
+    const unsigned int nbSegments = mTileOffset.back();
+
+    // Step #3: global equivalence table
+    mParent.resize(nbSegments);
+
+#pragma omp parallel for schedule(static) if (nbTiles > 1)
+    for (int tile = 0; tile < (int)nbTiles; ++tile) {
+        const std::vector<unsigned int>& parent = mTileParent[tile];
+        const unsigned int offset = mTileOffset[tile];
+
+        for (unsigned int k = 0; k < parent.size(); ++k)
+            mParent[offset + k] = offset + parent[k];
+    }
+
+    // Step #4: equivalences across the tiles boundaries (last line of the
+    // previous tile with the first line of the next tile)
+    for (unsigned int tile = 1; tile < nbTiles; ++tile) {
+        const std::vector<unsigned int>& prevRowBegin = mTileRowBegin[tile - 1];
+        const std::vector<unsigned int>& curRowBegin = mTileRowBegin[tile];
+
+        if (prevRowBegin.size() < 2 || curRowBegin.size() < 2)
+            continue;   // empty tile
+
+        connect(mParent,
+                mTileSegments[tile - 1],
+                prevRowBegin[prevRowBegin.size() - 2],
+                prevRowBegin.back(),
+                mTileOffset[tile - 1],
+                mTileSegments[tile],
+                curRowBegin[0],
+                curRowBegin[1],
+                mTileOffset[tile]);
+    }
+
+    // Step #5: ROIs construction. Segments are visited in raster order, so
+    // that the components are created in the same order as LSL_Box.
+    mComponent.assign(nbSegments, -1);
+    mRoi.clear();
+
+    for (unsigned int tile = 0; tile < nbTiles; ++tile) {
+        const std::vector<Segment_T>& segments = mTileSegments[tile];
+        const unsigned int offset = mTileOffset[tile];
+
+        for (unsigned int k = 0; k < segments.size(); ++k) {
+            const Segment_T& segment = segments[k];
+            const ROI::Roi_T lineRoi(segment.i, segment.j0,
+                                     segment.i, segment.j1, segment.cls);
+            const unsigned int root = find(mParent, offset + k);
+
+            if (mComponent[root] < 0) {
+                mComponent[root] = mRoi.size();
+                mRoi.push_back(lineRoi);
+            }
+            else {
+                ROI::Roi_T& roi = mRoi[mComponent[root]];
+                roi = ROI::merge(roi, lineRoi);
+            }
+        }
+    }
+
+    std::stable_sort(mRoi.begin(), mRoi.end(),
+        [](const ROI::Roi_T& a, const ROI::Roi_T& b)
+            { return (a.cls < b.cls); });
+}
+
+unsigned int
+N2D2::ComputerVision::ParallelLSL_Box::find(std::vector<unsigned int>& parent,
+                                            unsigned int label)
+{
+    // Path halving
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+
+    return label;
+}
+
+void
+N2D2::ComputerVision::ParallelLSL_Box::unite(std::vector<unsigned int>& parent,
+                                             unsigned int labelA,
+                                             unsigned int labelB)
+{
+    const unsigned int rootA = find(parent, labelA);
+    const unsigned int rootB = find(parent, labelB);
+
+    // The smallest label (first in raster order) is kept as root
+    if (rootA < rootB)
+        parent[rootB] = rootA;
+    else if (rootB < rootA)
+        parent[rootA] = rootB;
+}
+
+void N2D2::ComputerVision::ParallelLSL_Box::connect(
+    std::vector<unsigned int>& parent,
+    const std::vector<Segment_T>& prevSegments,
+    unsigned int prevBegin,
+    unsigned int prevEnd,
+    unsigned int prevOffset,
+    const std::vector<Segment_T>& curSegments,
+    unsigned int curBegin,
+    unsigned int curEnd,
+    unsigned int curOffset)
+{
+    // Segments of a line are sorted and disjoint: a single pass over both
+    // lines is sufficient (8-connectivity)
+    unsigned int prev = prevBegin;
+
+    for (unsigned int cur = curBegin; cur < curEnd; ++cur) {
+        const Segment_T& segment = curSegments[cur];
+
+        while (prev < prevEnd && prevSegments[prev].j1 + 1 < segment.j0)
+            ++prev;
+
+        for (unsigned int p = prev;
+            p < prevEnd && prevSegments[p].j0 <= segment.j1 + 1; ++p)
+        {
+            if (prevSegments[p].cls == segment.cls)
+                unite(parent, prevOffset + p, curOffset + cur);
+        }
+    }
+}
@@ -26,17 +26,22 @@ void N2D2::ComputerVision::ROI::filterSize(std::vector<Roi_T>& roi,
                                            double minAspectRatio,
                                            double maxAspectRatio)
 {
-    for (int i = roi.size() - 1; i >= 0; --i) {
+    // In-place compaction, in a single pass
+    unsigned int nbKept = 0;
+
+    for (unsigned int i = 0; i < roi.size(); ++i) {
         const unsigned int height = roi[i].i1 - roi[i].i0 + 1;
         const unsigned int width = roi[i].j1 - roi[i].j0 + 1;
         const double aspectRatio = width / (double)height;
 
-        if (height < minHeight || width < minWidth
+        if (!(height < minHeight || width < minWidth
             || (minAspectRatio > 0.0 && aspectRatio < minAspectRatio)
-            || (maxAspectRatio > 0.0 && aspectRatio > maxAspectRatio)) {
-            roi.erase(roi.begin() + i);
+            || (maxAspectRatio > 0.0 && aspectRatio > maxAspectRatio))) {
+            roi[nbKept++] = roi[i];
         }
     }
+
+    roi.erase(roi.begin() + nbKept, roi.end());
 }
 
 void N2D2::ComputerVision::ROI::filterOverlapping(std::vector<Roi_T>& roi,
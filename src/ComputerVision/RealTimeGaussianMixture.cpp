@@ -0,0 +1,344 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <limits>
+
+#include "ComputerVision/RealTimeGaussianMixture.hpp"
+#include "utils/Utils.hpp"
+
+N2D2::ComputerVision::RealTimeGaussianMixture::RealTimeGaussianMixture(
+    unsigned int k)
+    : mAlpha(this, "Alpha", 1.0e-3),
+      mMatchThreshold(this, "MatchThreshold", 2.5),
+      mBackgroundPortion(this, "BackgroundPortion", 0.5),
+      mSigmaInit(this, "SigmaInit", 0.12),
+      mSigmaMin(this, "SigmaMin", 0.075),
+      mK(k),
+      mWidth(0),
+      mHeight(0)
+{
+    // ctor
+}
+
+N2D2::Matrix<unsigned char>
+N2D2::ComputerVision::RealTimeGaussianMixture::process(const Matrix
+                                                       <float>& frame)
+{
+    Matrix<unsigned char> foreground(frame.rows(), frame.cols(), 0);
+    process(&frame.data()[0], frame.cols(), frame.rows(),
+            &foreground.data()[0]);
+    return foreground;
+}
+
+void N2D2::ComputerVision::RealTimeGaussianMixture::process(
+    const float* frame,
+    unsigned int width,
+    unsigned int height,
+    unsigned char* foreground)
+{
+    initialize(width, height);
+
+    // Dispatch to an unrolled kernel for the usual number of gaussians
+    switch (mK) {
+    case 2:
+        processKernel<2>(frame, foreground);
+        break;
+    case 3:
+        processKernel<3>(frame, foreground);
+        break;
+    case 4:
+        processKernel<4>(frame, foreground);
+        break;
+    case 5:
+        processKernel<5>(frame, foreground);
+        break;
+    default:
+        processKernel<0>(frame, foreground);
+    }
+}
+
+template <unsigned int K>
+void N2D2::ComputerVision::RealTimeGaussianMixture::processKernel(
+    const float* frame,
+    unsigned char* foreground)
+{
+    const unsigned int nbModels = (K > 0) ? K : mK;
+    const int size = mWidth * mHeight;
+    const float alpha = mAlpha;
+    const float matchThreshold = mMatchThreshold;
+    const float backgroundPortion = mBackgroundPortion;
+    const float sigmaInit = mSigmaInit;
+    const float sigmaMin = mSigmaMin;
+    const float invSqrt2Pi = 1.0 / std::sqrt(2.0 * M_PI);
+
+    float* w = &mW[0];
+    float* mu = &mMu[0];
+    float* sigma = &mSigma[0];
+    unsigned char* excluded = &mExcluded[0];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp parallel for simd schedule(static) if (size > 16)
+#else
+#pragma omp parallel for schedule(static) if (size > 16)
+#endif
+    for (int index = 0; index < size; ++index) {
+        const float x = frame[index];
+
+        // Matching gaussian = highest w/sigma among the matching ones;
+        // least probable gaussian = lowest w/sigma.
+        // Everything below is written with selects rather than branches and
+        // a single exp() and sqrt() per pixel, so that the loop over the
+        // pixels is vectorizable.
+        int matchingModel = -1;
+        float matchingKey = -1.0f;
+        float matchingMu = x;
+        float matchingSigma = sigmaInit;
+        int leastModel = 0;
+        float leastKey = std::numeric_limits<float>::max();
+
+        for (unsigned int model = 0; model < nbModels; ++model) {
+            const int m = model * size + index;
+            const float key = w[m] / sigma[m];
+            const bool better = (std::fabs(x - mu[m])
+                                    < matchThreshold * sigma[m])
+                                && (key > matchingKey);
+            const bool least = (key <= leastKey);
+
+            matchingModel = (better) ? (int)model : matchingModel;
+            matchingKey = (better) ? key : matchingKey;
+            matchingMu = (better) ? mu[m] : matchingMu;
+            matchingSigma = (better) ? sigma[m] : matchingSigma;
+            leastModel = (least) ? (int)model : leastModel;
+            leastKey = (least) ? key : leastKey;
+        }
+
+        const bool matched = (matchingModel >= 0);
+
+        // The matching gaussian belongs to the background if the gaussians
+        // ranked before it account for less than mBackgroundPortion
+        float wBefore = 0.0f;
+
+        for (unsigned int model = 0; model < nbModels; ++model) {
+            const int m = model * size + index;
+            wBefore += (w[m] / sigma[m] > matchingKey) ? w[m] : 0.0f;
+        }
+
+        foreground[index] = (!matched || wBefore > backgroundPortion);
+
+        // Model update: the matching gaussian is updated, or the least
+        // probable one is replaced if there is no match
+        const bool learn = !excluded[index];
+        const float d = x - matchingMu;
+        const float sigma2 = matchingSigma * matchingSigma;
+        const float rho = alpha * invSqrt2Pi / matchingSigma
+                          * std::exp(-(d * d) / (2.0f * sigma2));
+        const float newMu = (1.0f - rho) * matchingMu + rho * x;
+        const float newD = x - newMu;
+        const float newSigma = std::max(sigmaMin,
+            std::sqrt((1.0f - rho) * sigma2 + rho * newD * newD));
+        float wSum = 0.0f;
+
+        for (unsigned int model = 0; model < nbModels; ++model) {
+            const int m = model * size + index;
+            const bool isMatching = ((int)model == matchingModel);
+            const bool isReplaced = (!matched && (int)model == leastModel);
+
+            const float newW = (matched)
+                ? (1.0f - alpha) * w[m] + ((isMatching) ? alpha : 0.0f)
+                : ((isReplaced) ? alpha : w[m]);
+
+            mu[m] = (learn && isMatching) ? newMu
+                  : (learn && isReplaced) ? x : mu[m];
+            sigma[m] = (learn && isMatching) ? newSigma
+                     : (learn && isReplaced) ? sigmaInit : sigma[m];
+            w[m] = (learn) ? newW : w[m];
+            wSum += w[m];
+        }
+
+        // Weights re-normalization
+        const float invWSum = (learn) ? 1.0f / wSum : 1.0f;
+
+        for (unsigned int model = 0; model < nbModels; ++model)
+            w[model * size + index] *= invWSum;
+
+        excluded[index] = 0;
+    }
+}
+
+void N2D2::ComputerVision::RealTimeGaussianMixture::excludeRoi(
+    const ROI::Roi_T& roi)
+{
+    if (mExcluded.empty())
+        return;
+
+    for (unsigned int i = roi.i0; i <= roi.i1; ++i) {
+        std::fill(mExcluded.begin() + i * mWidth + roi.j0,
+                  mExcluded.begin() + i * mWidth + roi.j1 + 1,
+                  1);
+    }
+}
+
+N2D2::Matrix<float>
+N2D2::ComputerVision::RealTimeGaussianMixture::getBaseBackground(
+    unsigned int level) const
+{
+    if (level >= mK)
+        throw std::out_of_range("Background level is out of range");
+
+    const unsigned int size = mWidth * mHeight;
+    Matrix<float> background(mHeight, mWidth);
+
+#pragma omp parallel for if (size > 16)
+    for (int index = 0; index < (int)size; ++index) {
+        // Gaussian of rank "level" in decreasing w/sigma order
+        std::vector<std::pair<unsigned int, float> > keys;
+        keys.reserve(mK);
+
+        for (unsigned int model = 0; model < mK; ++model) {
+            const unsigned int m = model * size + index;
+            keys.push_back(std::make_pair(model, mW[m] / mSigma[m]));
+        }
+
+        std::nth_element(keys.begin(), keys.begin() + level, keys.end(),
+                         Utils::PairSecondPred<unsigned int, float,
+                                               std::greater<float> >());
+
+        background(index) = mMu[keys[level].first * size + index];
+    }
+
+    return background;
+}
+
+void N2D2::ComputerVision::RealTimeGaussianMixture::load(
+    const std::string& fileName,
+    bool ignoreNotExists)
+{
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good()) {
+        if (ignoreNotExists) {
+            std::cout << "Notice: Could not open data file: " << fileName
+                      << std::endl;
+            return;
+        } else
+            throw std::runtime_error("Could not open data file: " + fileName);
+    }
+
+    unsigned int width, height;
+    data.read(reinterpret_cast<char*>(&width), sizeof(width));
+    data.read(reinterpret_cast<char*>(&height), sizeof(height));
+    data.read(reinterpret_cast<char*>(&mK), sizeof(mK));
+
+    if (!data.good())
+        throw std::runtime_error("Error while reading data file: " + fileName);
+
+    mW.clear();
+    initialize(width, height);
+
+    // Same format as GaussianMixture: for each pixel, mK (w, mu, sigma)
+    // double precision triplets
+    const unsigned int size = width * height;
+    std::vector<double> pixelModel(3 * mK);
+
+    for (unsigned int index = 0; index < size; ++index) {
+        data.read(reinterpret_cast<char*>(&pixelModel[0]),
+                  pixelModel.size() * sizeof(double));
+
+        for (unsigned int model = 0; model < mK; ++model) {
+            mW[model * size + index] = pixelModel[3 * model];
+            mMu[model * size + index] = pixelModel[3 * model + 1];
+            mSigma[model * size + index] = pixelModel[3 * model + 2];
+        }
+    }
+
+    if (data.eof())
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + fileName);
+    else if (!data.good())
+        throw std::runtime_error("Error while reading data file: " + fileName);
+    else if (data.get() != std::fstream::traits_type::eof())
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + fileName);
+}
+
+void N2D2::ComputerVision::RealTimeGaussianMixture::save(const std::string
+                                                         & fileName) const
+{
+    if (mW.empty())
+        throw std::runtime_error("No model to save: model is empty");
+
+    std::ofstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        throw std::runtime_error("Could not create data file: " + fileName);
+
+    data.write(reinterpret_cast<const char*>(&mWidth), sizeof(mWidth));
+    data.write(reinterpret_cast<const char*>(&mHeight), sizeof(mHeight));
+    data.write(reinterpret_cast<const char*>(&mK), sizeof(mK));
+
+    const unsigned int size = mWidth * mHeight;
+    std::vector<double> pixelModel(3 * mK);
+
+    for (unsigned int index = 0; index < size; ++index) {
+        for (unsigned int model = 0; model < mK; ++model) {
+            pixelModel[3 * model] = mW[model * size + index];
+            pixelModel[3 * model + 1] = mMu[model * size + index];
+            pixelModel[3 * model + 2] = mSigma[model * size + index];
+        }
+
+        data.write(reinterpret_cast<const char*>(&pixelModel[0]),
+                   pixelModel.size() * sizeof(double));
+    }
+
+    if (!data.good())
+        throw std::runtime_error(
+            "RealTimeGaussianMixture::save(): error writing data file"
+            + fileName);
+}
+
+void N2D2::ComputerVision::RealTimeGaussianMixture::initialize(
+    unsigned int width,
+    unsigned int height)
+{
+    if (mW.empty()) {
+        mWidth = width;
+        mHeight = height;
+
+        const unsigned int size = width * height;
+
+        mW.resize(mK * size);
+        mMu.resize(mK * size);
+        mSigma.resize(mK * size);
+        mExcluded.assign(size, 0);
+
+        for (unsigned int model = 0; model < mK; ++model) {
+            std::fill(mW.begin() + model * size,
+                      mW.begin() + (model + 1) * size,
+                      1.0 / mK);
+            std::fill(mMu.begin() + model * size,
+                      mMu.begin() + (model + 1) * size,
+                      (model + 1) / (double)(mK + 1));
+            std::fill(mSigma.begin() + model * size,
+                      mSigma.begin() + (model + 1) * size,
+                      (double)mSigmaInit);
+        }
+    } else if (mWidth != width || mHeight != height)
+        throw std::runtime_error("Frame size does not match model size");
+}
@@ -46,3 +46,10 @@ N2D2::AER_Database::AER_Database(bool loadDataInMemory)
     // ctor
 }
 
+void N2D2::AER_Database::loadAerStimulusStream(AerStream& /*stream*/,
+                                               StimuliSet /*set*/,
+                                               StimulusID /*id*/)
+{
+    throw std::runtime_error("AER_Database::loadAerStimulusStream(): not"
+                             " supported by this database");
+}
@@ -50,74 +50,69 @@ void N2D2::CIFAR_Database::loadCIFAR(const std::string& dataFile,
     labels.close();
 
     // Images
-    std::ifstream images(dataFile.c_str(), std::fstream::binary);
+    // The file is memory mapped and the frames are built directly in memory,
+    // without intermediate image files
+    const MemoryMappedFile images(dataFile);
 
-    if (!images.good())
-        throw std::runtime_error("Could not open images file: " + dataFile);
+    const std::size_t imageSize = 3 * nbRows * nbColumns;
+    const std::size_t recordSize = 1 + coarseAndFine + imageSize;
+    const unsigned int nbImages = images.size() / recordSize;
 
-    const std::ifstream::pos_type size
-        = images.seekg(0, std::ifstream::end).tellg();
-    images.seekg(0, std::ifstream::beg);
+    if (images.size() % recordSize != 0)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataFile);
+
+    // Stimuli data must be kept aligned with mStimuli
+    mStimuliData.resize(mStimuli.size());
 
-    const unsigned int nbImages
-        = size / (1 + coarseAndFine + 3 * nbRows * nbColumns);
+    const unsigned int offset = mStimuli.size();
+    mStimuli.reserve(offset + nbImages);
+    mStimuliData.resize(offset + nbImages);
 
     // For each image...
     for (unsigned int i = 0; i < nbImages; ++i) {
         // Read label
-        unsigned char label;
-        images.read(reinterpret_cast<char*>(&label), sizeof(label));
+        const unsigned char* record = images.data() + i * recordSize;
+        const unsigned char label = (coarseAndFine && !useCoarse)
+            ? record[1] : record[0];
 
-        if (coarseAndFine) {
-            unsigned char fineLabel;
-            images.read(reinterpret_cast<char*>(&fineLabel), sizeof(fineLabel));
+        if (label >= labelsName.size()) {
+            std::ostringstream errorStr;
+            errorStr << "Invalid label " << (unsigned int)label
+                << " for stimulus #" << i << " in data file: " << dataFile;
 
-            if (!useCoarse)
-                label = fineLabel;
+            throw std::runtime_error(errorStr.str());
         }
 
+        // The name is only used to identify the stimulus, there is no file
         std::ostringstream nameStr;
         nameStr << dataFile << "[" << std::setfill('0') << std::setw(5) << i
                 << "].ppm";
 
-        // ... generate the stimuli
-        if (!std::ifstream(nameStr.str()).good()) {
-            cv::Mat frame(
-                cv::Size(nbColumns, nbRows), CV_8UC3, cv::Scalar(0, 0, 0));
-
-            for (int c = 2; c >= 0; --c) {
-                for (unsigned int y = 0; y < nbRows; ++y) {
-                    for (unsigned int x = 0; x < nbColumns; ++x) {
-                        unsigned char color;
-                        images.read(reinterpret_cast<char*>(&color),
-                                    sizeof(color));
-
-                        // Vec3b color order: blue, green, red
-                        frame.at<cv::Vec3b>(y, x)[c] = color;
-                    }
-                }
-            }
-
-            if (!cv::imwrite(nameStr.str(), frame))
-                throw std::runtime_error("Unable to write image: "
-                                         + nameStr.str());
-        } else {
-            // Skip image data (to grab labels only)
-            images.seekg(3 * nbColumns * nbRows, images.cur);
-        }
-
         mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelsName[label])));
         mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
     }
 
-    if (images.eof())
-        throw std::runtime_error(
-            "End-of-file reached prematurely in data file: " + dataFile);
-    else if (!images.good())
-        throw std::runtime_error("Error while reading data file: " + dataFile);
-    else if (images.get() != std::fstream::traits_type::eof())
-        throw std::runtime_error("Data file size larger than expected: "
-                                 + dataFile);
+    // ... generate the stimuli
+#pragma omp parallel for if (nbImages > 16)
+    for (int i = 0; i < (int)nbImages; ++i) {
+        unsigned char* planes = const_cast<unsigned char*>(images.data())
+            + i * recordSize + 1 + coarseAndFine;
+
+        // Planes are stored in red, green, blue order and
+        // Vec3b color order is blue, green, red
+        std::vector<cv::Mat> channels;
+        channels.push_back(cv::Mat(nbRows, nbColumns, CV_8UC1,
+                                   planes + 2 * nbRows * nbColumns));
+        channels.push_back(cv::Mat(nbRows, nbColumns, CV_8UC1,
+                                   planes + nbRows * nbColumns));
+        channels.push_back(cv::Mat(nbRows, nbColumns, CV_8UC1, planes));
+
+        cv::merge(channels, mStimuliData[offset + i]);
+    }
+
+    // The data must stay in memory, as the files are not written anymore
+    mLoadDataInMemory = true;
 }
 
 N2D2::CIFAR10_Database::CIFAR10_Database(double validation, bool useTestForVal)
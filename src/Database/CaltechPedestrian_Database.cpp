@@ -130,6 +130,7 @@ void N2D2::CaltechPedestrian_Database::loadSet(const std::string& dataPath,
 
             loadBackStimulusROIs(labelPath + "/" + Utils::fileBaseName(*it)
                                  + ".txt");
+            poolStimulusROIs(mStimuli.size() - 1);
         }
     }
 
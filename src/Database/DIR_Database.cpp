@@ -20,12 +20,18 @@
 
 #include "Database/DIR_Database.hpp"
 #include "DataFile/DataFile.hpp"
+#include "utils/MemoryMappedFile.hpp"
 #include "utils/Registrar.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
 #include <regex>
 
 N2D2::DIR_Database::DIR_Database(bool loadDataInMemory)
-    : Database(loadDataInMemory)
+    : Database(loadDataInMemory),
+      mManifestPath(this, "ManifestPath", "")
 {
     // ctor
 }
@@ -60,26 +66,147 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
                                  const std::string& labelName,
                                  int labelDepth)
 {
+    loadDirs(std::vector<std::string>(1, dirPath),
+             depth,
+             std::vector<std::string>(1, labelName),
+             labelDepth);
+}
+
+void N2D2::DIR_Database::loadDirs(const std::vector<std::string>& dirPaths,
+                                  int depth,
+                                  const std::vector<std::string>& labelNames,
+                                  int labelDepth)
+{
+    if (labelNames.size() != dirPaths.size()) {
+        throw std::runtime_error("DIR_Database::loadDirs(): the number of"
+                                 " label names must match the number of"
+                                 " directories");
+    }
+
     if (!((std::string)mDefaultLabel).empty())
         labelID(mDefaultLabel);
 
-    DIR* pDir = opendir(dirPath.c_str());
+    std::vector<DirIndex> index(dirPaths.size());
 
-    if (pDir == NULL)
-        throw std::runtime_error("Couldn't open database directory: "
-                                 + dirPath);
+    for (std::size_t i = 0; i < dirPaths.size(); ++i) {
+        index[i].path = dirPaths[i];
+        index[i].depth = depth;
+        index[i].labelName = labelNames[i];
+        index[i].labelDepth = labelDepth;
+        index[i].time = 0;
+    }
 
-    struct dirent* pFile;
+    const std::string manifestPath = mManifestPath;
+
+    if (!manifestPath.empty()) {
+        const std::string key = getManifestKey(index);
+
+        std::ostringstream fileName;
+        fileName << manifestPath << "/" << std::hex
+            << std::hash<std::string>()(key) << ".manifest";
+
+        if (!loadManifest(fileName.str(), key, index)) {
+            const long long int indexTime = (long long int)std::time(NULL);
+            indexDirs(index);
+
+            // Directories modified during the indexing cannot be validated
+            // with their (1 s resolution) modification time
+            bool stable = true;
+
+            for (std::vector<DirIndex>::const_iterator it = index.begin(),
+                itEnd = index.end(); it != itEnd; ++it)
+            {
+                if (!(*it).error.empty() || (*it).time >= indexTime - 1)
+                    stable = false;
+            }
+
+            if (stable)
+                saveManifest(fileName.str(), key, index);
+        }
+    }
+    else
+        indexDirs(index);
+
+    for (std::size_t i = 0; i < dirPaths.size(); ++i)
+        loadDirIndex(index, i);
+}
+
+void N2D2::DIR_Database::indexDirs(std::vector<DirIndex>& index) const
+{
+    // Breadth-first traversal, all the directories of the same level are
+    // scanned in parallel. The stimuli are loaded afterward by
+    // loadDirIndex(), in the same order as a sequential depth-first
+    // traversal.
+    std::vector<std::size_t> level;
+
+    for (std::size_t i = 0; i < index.size(); ++i)
+        level.push_back(i);
+
+    while (!level.empty()) {
+        std::vector<std::vector<std::string> > subDirs(level.size());
+
+#pragma omp parallel for schedule(dynamic) if (level.size() > 1)
+        for (int i = 0; i < (int)level.size(); ++i)
+            scanDir(index[level[i]], subDirs[i]);
+
+        std::vector<std::size_t> nextLevel;
+
+        for (std::size_t i = 0; i < level.size(); ++i) {
+            if (index[level[i]].depth == 0)
+                continue;
+
+            for (std::vector<std::string>::const_iterator it
+                 = subDirs[i].begin(), itEnd = subDirs[i].end();
+                 it != itEnd; ++it)
+            {
+                const DirIndex& parent = index[level[i]];
+
+                DirIndex dir;
+                dir.path = (*it);
+                dir.depth = parent.depth - 1;
+                dir.labelName = (parent.labelDepth > 0)
+                    ? parent.labelName + "/" + Utils::baseName(*it)
+                    : parent.labelName;
+                dir.labelDepth = (parent.labelDepth > 0)
+                    ? parent.labelDepth - 1
+                    : parent.labelDepth;
+                dir.time = 0;
+
+                index[level[i]].subDirs.push_back(index.size());
+                nextLevel.push_back(index.size());
+                index.push_back(dir);
+            }
+        }
+
+        level.swap(nextLevel);
+    }
+}
+
+void N2D2::DIR_Database::scanDir(DirIndex& dir,
+                                 std::vector<std::string>& subDirs) const
+{
     struct stat fileStat;
-    std::vector<std::string> subDirs;
-    std::vector<std::string> files;
 
-    std::cout << "Loading directory database \"" << dirPath << "\""
-              << std::endl;
+    if (stat(dir.path.c_str(), &fileStat) == 0)
+        dir.time = (long long int)fileStat.st_mtime;
+
+    DIR* pDir = opendir(dir.path.c_str());
+
+    if (pDir == NULL) {
+        dir.error = "Couldn't open database directory: " + dir.path;
+        return;
+    }
+
+    const std::string multiChannelMatch = mMultiChannelMatch;
+    const std::vector<std::string> multiChannelReplace = mMultiChannelReplace;
+    const std::regex regexp(multiChannelMatch);
+
+    std::ostringstream log;
+    struct dirent* pFile;
 
     while ((pFile = readdir(pDir))) {
         const std::string fileName(pFile->d_name);
-        const std::string filePath(dirPath + "/" + fileName);
+        const std::string filePath(dir.path + "/" + fileName);
 
         // Ignore file in case of stat failure
         if (stat(filePath.c_str(), &fileStat) < 0)
@@ -94,9 +221,9 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
              itEnd = mIgnoreMasks.end(); it != itEnd; ++it)
         {
             if (Utils::match((*it), filePath)) {
-                std::cout << Utils::cnotice << "Notice: path \"" << filePath
-                          << "\" ignored (matching mask: " << (*it) << ")."
-                          << Utils::cdef << std::endl;
+                log << Utils::cnotice << "Notice: path \"" << filePath
+                    << "\" ignored (matching mask: " << (*it) << ")."
+                    << Utils::cdef << std::endl;
                 masked = true;
             }
         }
@@ -119,32 +246,23 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
                                                       fileExtension)
                                             != mValidExtensions.end()) {
                 if (!Registrar<DataFile>::exists(fileExtension)) {
-                    std::cout << Utils::cnotice << "Notice: file " << fileName
-                              << " does not appear to be a valid stimulus,"
-                                 " ignoring." << Utils::cdef << std::endl;
+                    log << Utils::cnotice << "Notice: file " << fileName
+                        << " does not appear to be a valid stimulus,"
+                           " ignoring." << Utils::cdef << std::endl;
                     continue;
                 }
 
-                const std::string& multiChannelMatch
-                    = getParameter<std::string>("MultiChannelMatch");
-
                 if (!multiChannelMatch.empty()) {
-                    const std::regex regexp(multiChannelMatch);
-
                     if (!std::regex_match(filePath, regexp))
                         continue;
 
-                    const std::vector<std::string>& multiChannelReplace
-                        = getParameter<std::vector<std::string> >
-                            ("MultiChannelReplace");
-
                     for (size_t ch = 0; ch < multiChannelReplace.size(); ++ch) {
                         const std::string chFilePath
                             = std::regex_replace(filePath, regexp,
                                                 multiChannelReplace[ch]);
 
                         if (!std::ifstream(chFilePath).good()) {
-                            std::cout << Utils::cnotice
+                            log << Utils::cnotice
                                 << "Notice: missing channel #"
                                 << ch << " data for stimulus: " << filePath
                                 << Utils::cdef << std::endl;
@@ -152,21 +270,37 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
                     }
                 }
 
-                files.push_back(filePath);
+                dir.files.push_back(filePath);
             }
         }
     }
 
     closedir(pDir);
 
-    if (!files.empty()) {
-        // Load stimuli contained in this directory
-        std::sort(files.begin(), files.end());
+    std::sort(dir.files.begin(), dir.files.end());
+    std::sort(subDirs.begin(), subDirs.end());
+    dir.log = log.str();
+}
 
-        const int dirLabelID = (labelDepth >= 0) ? labelID(labelName) : -1;
+void N2D2::DIR_Database::loadDirIndex(const std::vector<DirIndex>& index,
+                                      std::size_t dir)
+{
+    const DirIndex& dirIndex = index[dir];
+
+    if (!dirIndex.error.empty())
+        throw std::runtime_error(dirIndex.error);
+
+    std::cout << "Loading directory database \"" << dirIndex.path << "\""
+              << std::endl;
+    std::cout << dirIndex.log;
 
-        for (std::vector<std::string>::const_iterator it = files.begin(),
-                                                      itEnd = files.end();
+    if (!dirIndex.files.empty()) {
+        // Load stimuli contained in this directory
+        const int dirLabelID = (dirIndex.labelDepth >= 0)
+            ? labelID(dirIndex.labelName) : -1;
+
+        for (std::vector<std::string>::const_iterator it
+             = dirIndex.files.begin(), itEnd = dirIndex.files.end();
              it != itEnd;
              ++it) {
             mStimuli.push_back(Stimulus(*it, dirLabelID));
@@ -174,25 +308,276 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
         }
     }
 
-    if (depth != 0) {
-        // Recursively load stimuli contained in the subdirectories
-        std::sort(subDirs.begin(), subDirs.end());
+    // Recursively load stimuli contained in the subdirectories
+    for (std::vector<std::size_t>::const_iterator it
+         = dirIndex.subDirs.begin(), itEnd = dirIndex.subDirs.end();
+         it != itEnd;
+         ++it) {
+        loadDirIndex(index, *it);
+    }
 
-        for (std::vector<std::string>::const_iterator it = subDirs.begin(),
-                                                      itEnd = subDirs.end();
-             it != itEnd;
-             ++it) {
-            if (labelDepth > 0)
-                loadDir(*it,
-                        depth - 1,
-                        labelName + "/" + Utils::baseName(*it),
-                        labelDepth - 1);
-            else
-                loadDir(*it, depth - 1, labelName, labelDepth);
+    std::cout << "Found " << mStimuli.size() << " stimuli" << std::endl;
+}
+
+std::string N2D2::DIR_Database::getManifestKey(
+    const std::vector<DirIndex>& index) const
+{
+    // Everything the directory index depends on, besides the directories
+    // content
+    std::ostringstream key;
+    key << "DIR_Database manifest v1\n";
+
+    for (std::vector<DirIndex>::const_iterator it = index.begin(),
+         itEnd = index.end(); it != itEnd; ++it)
+    {
+        key << (*it).path << "\n" << (*it).depth << "\n" << (*it).labelName
+            << "\n" << (*it).labelDepth << "\n";
+    }
+
+    key << "IgnoreMasks:";
+
+    for (std::vector<std::string>::const_iterator it = mIgnoreMasks.begin(),
+         itEnd = mIgnoreMasks.end(); it != itEnd; ++it)
+    {
+        key << " " << (*it);
+    }
+
+    key << "\nValidExtensions:";
+
+    for (std::vector<std::string>::const_iterator it
+         = mValidExtensions.begin(), itEnd = mValidExtensions.end();
+         it != itEnd; ++it)
+    {
+        key << " " << (*it);
+    }
+
+    key << "\nMultiChannelMatch: " << (std::string)mMultiChannelMatch
+        << "\nMultiChannelReplace:";
+
+    const std::vector<std::string> multiChannelReplace = mMultiChannelReplace;
+
+    for (std::vector<std::string>::const_iterator it
+         = multiChannelReplace.begin(), itEnd = multiChannelReplace.end();
+         it != itEnd; ++it)
+    {
+        key << " " << (*it);
+    }
+
+    key << "\n";
+    return key.str();
+}
+
+namespace {
+// Manifests are a cache local to the machine, native endianness is used
+template <class T>
+void writeManifestValue(std::ofstream& data, const T& value)
+{
+    data.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeManifestString(std::ofstream& data, const std::string& value)
+{
+    writeManifestValue(data, (unsigned long long int)value.size());
+    data.write(value.data(), value.size());
+}
+
+class ManifestReader {
+public:
+    ManifestReader(const unsigned char* data, std::size_t size)
+        : mData(data), mSize(size), mPos(0) {};
+
+    template <class T>
+    bool read(T& value)
+    {
+        if (mSize - mPos < sizeof(value))
+            return false;
+
+        std::memcpy(&value, mData + mPos, sizeof(value));
+        mPos += sizeof(value);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        unsigned long long int size;
+
+        if (!read(size) || mSize - mPos < size)
+            return false;
+
+        value.assign(reinterpret_cast<const char*>(mData + mPos), size);
+        mPos += size;
+        return true;
+    }
+
+    bool end() const
+    {
+        return (mPos == mSize);
+    }
+
+private:
+    const unsigned char* mData;
+    std::size_t mSize;
+    std::size_t mPos;
+};
+
+const unsigned int manifestMagic = 0x4D44324E; // "N2DM"
+}
+
+bool N2D2::DIR_Database::loadManifest(const std::string& fileName,
+                                      const std::string& key,
+                                      std::vector<DirIndex>& index) const
+{
+    struct stat fileStat;
+
+    if (stat(fileName.c_str(), &fileStat) != 0)
+        return false;
+
+    const MemoryMappedFile manifest(fileName);
+    ManifestReader reader(manifest.data(), manifest.size());
+
+    unsigned int magic;
+    std::string manifestKey;
+    unsigned long long int nbDirs;
+
+    if (!reader.read(magic) || magic != manifestMagic
+        || !reader.read(manifestKey) || manifestKey != key
+        || !reader.read(nbDirs) || nbDirs < index.size())
+    {
+        return false;
+    }
+
+    std::vector<DirIndex> manifestIndex(nbDirs);
+
+    for (std::size_t i = 0; i < nbDirs; ++i) {
+        DirIndex& dir = manifestIndex[i];
+        unsigned long long int nbFiles;
+        unsigned long long int nbSubDirs;
+
+        if (!reader.read(dir.path) || !reader.read(dir.depth)
+            || !reader.read(dir.labelName) || !reader.read(dir.labelDepth)
+            || !reader.read(dir.time) || !reader.read(dir.log)
+            || !reader.read(nbFiles))
+        {
+            return false;
+        }
+
+        dir.files.resize(nbFiles);
+
+        for (std::size_t f = 0; f < nbFiles; ++f) {
+            if (!reader.read(dir.files[f]))
+                return false;
+        }
+
+        if (!reader.read(nbSubDirs))
+            return false;
+
+        dir.subDirs.resize(nbSubDirs);
+
+        for (std::size_t d = 0; d < nbSubDirs; ++d) {
+            unsigned long long int subDir;
+
+            if (!reader.read(subDir) || subDir >= nbDirs)
+                return false;
+
+            dir.subDirs[d] = subDir;
         }
     }
 
-    std::cout << "Found " << mStimuli.size() << " stimuli" << std::endl;
+    if (!reader.end())
+        return false;
+
+    // Adding, removing or renaming an entry changes the modification time
+    // of its directory: checking the directories is enough
+    int valid = 1;
+
+#pragma omp parallel for schedule(dynamic) reduction(&&:valid) \
+    if (nbDirs > 16)
+    for (int i = 0; i < (int)nbDirs; ++i) {
+        struct stat dirStat;
+
+        if (stat(manifestIndex[i].path.c_str(), &dirStat) != 0
+            || (long long int)dirStat.st_mtime != manifestIndex[i].time)
+        {
+            valid = 0;
+        }
+    }
+
+    if (!valid)
+        return false;
+
+    std::cout << "Using directory database manifest \"" << fileName << "\""
+              << std::endl;
+
+    index.swap(manifestIndex);
+    return true;
+}
+
+void N2D2::DIR_Database::saveManifest(const std::string& fileName,
+                                      const std::string& key,
+                                      const std::vector<DirIndex>& index) const
+{
+    if (!Utils::createDirectories(Utils::dirName(fileName))) {
+        std::cout << Utils::cwarning << "Could not create directory for"
+            " manifest: " << fileName << Utils::cdef << std::endl;
+        return;
+    }
+
+    // Written to a temporary file first, so that an interrupted write never
+    // leaves an incomplete manifest
+    const std::string tmpFileName = fileName + ".tmp";
+
+    {
+        std::ofstream data(tmpFileName.c_str(), std::fstream::binary);
+
+        writeManifestValue(data, manifestMagic);
+        writeManifestString(data, key);
+        writeManifestValue(data, (unsigned long long int)index.size());
+
+        for (std::vector<DirIndex>::const_iterator it = index.begin(),
+             itEnd = index.end(); it != itEnd; ++it)
+        {
+            writeManifestString(data, (*it).path);
+            writeManifestValue(data, (*it).depth);
+            writeManifestString(data, (*it).labelName);
+            writeManifestValue(data, (*it).labelDepth);
+            writeManifestValue(data, (*it).time);
+            writeManifestString(data, (*it).log);
+            writeManifestValue(data, (unsigned long long int)(*it).files.size());
+
+            for (std::vector<std::string>::const_iterator itFile
+                 = (*it).files.begin(), itFileEnd = (*it).files.end();
+                 itFile != itFileEnd; ++itFile)
+            {
+                writeManifestString(data, *itFile);
+            }
+
+            writeManifestValue(data,
+                               (unsigned long long int)(*it).subDirs.size());
+
+            for (std::vector<std::size_t>::const_iterator itDir
+                 = (*it).subDirs.begin(), itDirEnd = (*it).subDirs.end();
+                 itDir != itDirEnd; ++itDir)
+            {
+                writeManifestValue(data, (unsigned long long int)(*itDir));
+            }
+        }
+
+        if (!data.good()) {
+            std::cout << Utils::cwarning << "Could not write manifest: "
+                << tmpFileName << Utils::cdef << std::endl;
+            data.close();
+            std::remove(tmpFileName.c_str());
+            return;
+        }
+    }
+
+    std::remove(fileName.c_str());
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        std::cout << Utils::cwarning << "Could not write manifest: "
+            << fileName << Utils::cdef << std::endl;
+        std::remove(tmpFileName.c_str());
+    }
 }
 
 N2D2::Database::StimulusID N2D2::DIR_Database::loadFile(
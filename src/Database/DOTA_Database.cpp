@@ -69,62 +69,118 @@ void N2D2::DOTA_Database::loadLabels(const std::string& labelPath) {
             + Utils::baseName(Utils::fileBaseName(mStimuli[(*it)].name))
             + ".txt";
 
-        std::ifstream labelData(labelName.c_str());
+        // Missing files are still reported when loading, but the
+        // annotations are only parsed on first access
+        deferStimulusROIs(*it, parseLabelNames(labelName),
+                          std::bind(&DOTA_Database::parseLabelFile,
+                                    labelName));
+    }
+}
 
-        if (!labelData.good()) {
-            throw std::runtime_error("Could not open TXT label file "
-                                     "(missing?): " + labelName);
-        }
+std::vector<std::string>
+N2D2::DOTA_Database::parseLabelNames(const std::string& fileName)
+{
+    std::ifstream labelData(fileName.c_str());
 
-        std::string line;
+    if (!labelData.good()) {
+        throw std::runtime_error("Could not open TXT label file "
+                                 "(missing?): " + fileName);
+    }
 
-        // read imagesource
-        if (!std::getline(labelData, line) || line.find("imagesource:") != 0) {
-            throw std::runtime_error("First line should start with "
-                                     "\"imagesource:\" in: " + labelName);
-        }
+    std::string line;
+
+    // skip imagesource and gsd, checked by parseLabelFile()
+    std::getline(labelData, line);
+    std::getline(labelData, line);
 
-        // read gsd
-        if (!std::getline(labelData, line) || line.find("gsd:") != 0) {
-            throw std::runtime_error("Second line should start with "
-                                     "\"gsd:\" in: " + labelName);
+    std::vector<std::string> labelNames;
+
+    while (std::getline(labelData, line)) {
+        std::stringstream values(line);
+        std::string category;
+
+        // the category follows the 8 coordinates
+        for (unsigned int i = 0; i < 9; ++i)
+            values >> category;
+
+        if (values && std::find(labelNames.begin(), labelNames.end(),
+                                category) == labelNames.end())
+        {
+            labelNames.push_back(category);
         }
+    }
+
+    return labelNames;
+}
 
-        // read annotations
-        while (std::getline(labelData, line)) {
-            if (line.empty())
-                continue;
-
-            unsigned int x1, y1, x2, y2, x3, y3, x4, y4;
-            std::string category;
-            bool difficult;
-
-            std::stringstream values(line);
-
-            if (!(Utils::signChecked<unsigned int>(values) >> x1)
-                || !(Utils::signChecked<unsigned int>(values) >> y1)
-                || !(Utils::signChecked<unsigned int>(values) >> x2)
-                || !(Utils::signChecked<unsigned int>(values) >> y2)
-                || !(Utils::signChecked<unsigned int>(values) >> x3)
-                || !(Utils::signChecked<unsigned int>(values) >> y3)
-                || !(Utils::signChecked<unsigned int>(values) >> x4)
-                || !(Utils::signChecked<unsigned int>(values) >> y4)
-                || !(values >> category)
-                || !(values >> difficult))
+N2D2::Database::NamedROIs_T
+N2D2::DOTA_Database::parseLabelFile(const std::string& fileName)
+{
+    std::ifstream labelData(fileName.c_str());
+
+    if (!labelData.good()) {
+        throw std::runtime_error("Could not open TXT label file "
+                                 "(missing?): " + fileName);
+    }
+
+    std::string line;
+
+    // read imagesource
+    if (!std::getline(labelData, line) || line.find("imagesource:") != 0) {
+        throw std::runtime_error("First line should start with "
+                                 "\"imagesource:\" in: " + fileName);
+    }
+
+    // read gsd
+    if (!std::getline(labelData, line) || line.find("gsd:") != 0) {
+        throw std::runtime_error("Second line should start with "
+                                 "\"gsd:\" in: " + fileName);
+    }
+
+    NamedROIs_T ROIs;
+
+    // read annotations
+    while (std::getline(labelData, line)) {
+        if (line.empty())
+            continue;
+
+        unsigned int x1, y1, x2, y2, x3, y3, x4, y4;
+        std::string category;
+        bool difficult;
+
+        std::stringstream values(line);
+
+        if (!(Utils::signChecked<unsigned int>(values) >> x1)
+            || !(Utils::signChecked<unsigned int>(values) >> y1)
+            || !(Utils::signChecked<unsigned int>(values) >> x2)
+            || !(Utils::signChecked<unsigned int>(values) >> y2)
+            || !(Utils::signChecked<unsigned int>(values) >> x3)
+            || !(Utils::signChecked<unsigned int>(values) >> y3)
+            || !(Utils::signChecked<unsigned int>(values) >> x4)
+            || !(Utils::signChecked<unsigned int>(values) >> y4)
+            || !(values >> category)
+            || !(values >> difficult))
+        {
+            for (NamedROIs_T::const_iterator it = ROIs.begin(),
+                 itEnd = ROIs.end(); it != itEnd; ++it)
             {
-                throw std::runtime_error("DOTA_Database: unreadable value in "
-                                         "line \"" + line + "\" for file: "
-                                         + labelPath);
+                delete (*it).second;
             }
 
-            std::vector<cv::Point> pts;
-            pts.push_back(cv::Point(x1, y1));
-            pts.push_back(cv::Point(x2, y2));
-            pts.push_back(cv::Point(x3, y3));
-            pts.push_back(cv::Point(x4, y4));
-
-            mStimuli[(*it)].ROIs.push_back(new PolygonalROI<int>(
-                labelID(category), pts));
+            throw std::runtime_error("DOTA_Database: unreadable value in "
+                                     "line \"" + line + "\" for file: "
+                                     + fileName);
         }
+
+        std::vector<cv::Point> pts;
+        pts.push_back(cv::Point(x1, y1));
+        pts.push_back(cv::Point(x2, y2));
+        pts.push_back(cv::Point(x3, y3));
+        pts.push_back(cv::Point(x4, y4));
+
+        ROIs.push_back(std::make_pair(category,
+                                      new PolygonalROI<int>(-1, pts)));
     }
+
+    return ROIs;
 }
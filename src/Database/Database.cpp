@@ -24,6 +24,7 @@
 #include "ROI/RectangularROI.hpp"
 #include "utils/Gnuplot.hpp"
 
+#include <exception>
 #include <regex>
 
 const std::locale
@@ -40,7 +41,10 @@ N2D2::Database::Database(bool loadDataInMemory)
       mMultiChannelMatch(this, "MultiChannelMatch", ""),
       mMultiChannelReplace(this, "MultiChannelReplace",
                            std::vector<std::string>()),
+      mROIsCacheSize(this, "ROIsCacheSize", 1024U),
       mLoadDataInMemory(loadDataInMemory),
+      mLabelIndexValid(false),
+      mNbDeferredROIs(0),
       mStimuliDepth(-1),
       mStimuliTargetDepth(-1)
 {
@@ -55,6 +59,8 @@ void N2D2::Database::loadROIs(const std::string& fileName,
                               const std::string& relPath,
                               bool noImageSize)
 {
+    invalidateLabelIndex();
+
     // Create default label for no ROI
     if (!((std::string)mDefaultLabel).empty())
         labelID(mDefaultLabel);
@@ -62,6 +68,7 @@ void N2D2::Database::loadROIs(const std::string& fileName,
     // Find all stimuli within the relPath path
     const std::map<std::string, StimulusID> stimuliName
         = getRelPathStimuli(fileName, relPath);
+    std::vector<StimulusID> stimuliROIs;
 
     // Read label
     std::string fileExtension = Utils::fileExtension(fileName);
@@ -132,6 +139,7 @@ void N2D2::Database::loadROIs(const std::string& fileName,
 
             stimulusROIs.insert(stimulusROIs.end(),
                 (*it).second.begin(), (*it).second.end());
+            stimuliROIs.push_back((*itStimulus).second);
         }
         else {
             std::cout << Utils::cwarning
@@ -139,12 +147,20 @@ void N2D2::Database::loadROIs(const std::string& fileName,
                         << (*it).first << "\"" << Utils::cdef << std::endl;
         }
     }
+
+    for (std::vector<StimulusID>::const_iterator it = stimuliROIs.begin(),
+        itEnd = stimuliROIs.end(); it != itEnd; ++it)
+    {
+        poolStimulusROIs(*it);
+    }
 }
 
 void N2D2::Database::loadROIsDir(const std::string& dirName,
                                  const std::vector<std::string>& fileExt,
                                  int depth)
 {
+    invalidateLabelIndex();
+
     DIR* pDir = opendir(dirName.c_str());
 
     if (pDir == NULL)
@@ -231,11 +247,14 @@ void N2D2::Database::saveROIs(const std::string& fileName,
                                                itEnd = mStimuli.end();
          it != itEnd;
          ++it) {
-        if ((*it).ROIs.empty())
+        const ROIPool::ROIs_T ROIs
+            = getStimulusROIsRef(it - mStimuli.begin());
+
+        if (ROIs->empty())
             data << (*it).name << " # No ROI for this stimulus\n";
         else {
-            for (std::vector<ROI*>::const_iterator itRoi = (*it).ROIs.begin(),
-                                                   itRoiEnd = (*it).ROIs.end();
+            for (std::vector<ROI*>::const_iterator itRoi = ROIs->begin(),
+                                                   itRoiEnd = ROIs->end();
                  itRoi != itRoiEnd;
                  ++itRoi) {
                 const cv::Rect rect = (*itRoi)->getBoundingRect();
@@ -264,7 +283,7 @@ void N2D2::Database::saveROIs(const std::string& fileName,
 
 void N2D2::Database::logStats(const std::string& sizeFileName,
                               const std::string& labelFileName,
-                              StimuliSetMask setMask) const
+                              StimuliSetMask setMask)
 {
     // Stats collection
     std::map<std::pair<unsigned int, unsigned int>, unsigned int> sizeStats;
@@ -289,16 +308,8 @@ void N2D2::Database::logStats(const std::string& sizeFileName,
         for (int i = 0; i < (int)size; ++i){
             const StimulusID id = mStimuliSets(*itSet)[i];
 
-            // Read stimuli
-            std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
-            std::transform(fileExtension.begin(),
-                           fileExtension.end(),
-                           fileExtension.begin(),
-                           ::tolower);
-
-            std::shared_ptr<DataFile> dataFile = Registrar
-                <DataFile>::create(fileExtension)();
-            cv::Mat stimulus = dataFile->read(mStimuli[id].name);
+            // Stimuli may be in memory only, without any file
+            const cv::Mat stimulus = getStimulusData(id);
 
             // Stats
             if (stimulus.cols > (int)maxWidth) {
@@ -392,9 +403,10 @@ void N2D2::Database::logROIsStats(const std::string& sizeFileName,
             unsigned int bbMaxWidth = 0;
             unsigned int bbMaxHeight = 0;
 
-            for (std::vector<ROI*>::const_iterator itROIs
-                 = mStimuli[id].ROIs.begin(),
-                 itROIsEnd = mStimuli[id].ROIs.end();
+            const ROIPool::ROIs_T ROIs = getStimulusROIsRef(id);
+
+            for (std::vector<ROI*>::const_iterator itROIs = ROIs->begin(),
+                 itROIsEnd = ROIs->end();
                  itROIs != itROIsEnd;
                  ++itROIs) {
                 const cv::Rect bb = (*itROIs)->getBoundingRect();
@@ -455,7 +467,7 @@ void N2D2::Database::logROIsStats(const std::string& sizeFileName,
                     minHeight = bbMinHeight;
             }
 
-            nbROIs += mStimuli[id].ROIs.size();
+            nbROIs += ROIs->size();
         }
     }
 
@@ -469,7 +481,7 @@ void N2D2::Database::logROIsStats(const std::string& sizeFileName,
 }
 
 void N2D2::Database::logMultiChannelStats(const std::string& fileName,
-                                          StimuliSetMask setMask) const
+                                          StimuliSetMask setMask)
 {
     if (((std::string)mMultiChannelMatch).empty()) {
         std::cout << Utils::cwarning << "Database::logMultiChannelStats(): "
@@ -509,7 +521,8 @@ void N2D2::Database::logMultiChannelStats(const std::string& fileName,
 
             std::shared_ptr<DataFile> dataFile = Registrar
                 <DataFile>::create(fileExtension)();
-            cv::Mat data = dataFile->read(mStimuli[id].name);
+            // Stimuli may be in memory only, without any file
+            const cv::Mat data = getStimulusData(id);
 
             if (std::regex_match(mStimuli[id].name, regexp)) {
                 ++nbMatchMulti;
@@ -749,6 +762,9 @@ void N2D2::Database::plotStats(
 
 void N2D2::Database::extractROIs()
 {
+    invalidateLabelIndex();
+    unpoolROIs();
+
     for (int id = mStimuli.size() - 1; id >= 0; --id) {
         if (!mStimuli[id].ROIs.empty()) {
             std::vector<ROI*>::const_iterator it = mStimuli[id].ROIs.begin();
@@ -775,6 +791,9 @@ void N2D2::Database::filterROIs(const std::vector<int>& labels,
                                 bool filterKeep,
                                 bool removeStimuli)
 {
+    invalidateLabelIndex();
+    unpoolROIs();
+
     unsigned int nbRoi = 0;
     unsigned int nbRoiRemoved = 0;
     const unsigned int nbStimuli = mStimuli.size();
@@ -808,6 +827,9 @@ void N2D2::Database::filterROIs(const std::vector<int>& labels,
 
 void N2D2::Database::extractLabels(bool removeROIs)
 {
+    invalidateLabelIndex();
+    unpoolROIs();
+
     const int defaultLabel = getDefaultLabelID();
 
     for (int id = mStimuli.size() - 1; id >= 0; --id) {
@@ -844,6 +866,9 @@ void N2D2::Database::extractSlices(unsigned int width,
                                    bool randomShuffle,
                                    bool overlapping)
 {
+    invalidateLabelIndex();
+    unpoolROIs();
+
     const std::vector<StimuliSet> stimuliSets = getStimuliSets(setMask);
 
     // For progression visualization
@@ -1118,6 +1143,8 @@ void N2D2::Database::save(const std::string& dataPath,
 }
 
 void N2D2::Database::append(const Database& database) {
+    invalidateLabelIndex();
+
     const unsigned int offsetID = mStimuli.size();
     const unsigned int offsetLabelID = mLabelsName.size();
 
@@ -1131,6 +1158,15 @@ void N2D2::Database::append(const Database& database) {
         if (mStimuli.back().label >= 0)
             mStimuli.back().label += offsetLabelID;
 
+        // Pooled ROIs belong to the other database pool
+        const int entry
+            = database.getROIsPoolEntry(it - database.mStimuli.begin());
+
+        if (entry >= 0) {
+            mStimuli.back().ROIs = database.mROIPool.create(entry);
+            mStimuli.back().ROIsPoolEntry = -1;
+        }
+
         for (std::vector<ROI*>::const_iterator itROIs
             = mStimuli.back().ROIs.begin(), 
             itROIsEnd = mStimuli.back().ROIs.end(); itROIs != itROIsEnd;
@@ -1139,6 +1175,9 @@ void N2D2::Database::append(const Database& database) {
             if ((*itROIs)->getLabel() >= 0)
                 (*itROIs)->setLabel((*itROIs)->getLabel() + offsetLabelID);
         }
+
+        if ((*it).ROIsPoolEntry >= 0)
+            poolStimulusROIs(mStimuli.size() - 1);
     }
 
     mLabelsName.insert(mLabelsName.end(),
@@ -1149,6 +1188,8 @@ void N2D2::Database::append(const Database& database) {
         database.mStimuliLabelsData.begin(), database.mStimuliLabelsData.end());
     mStimuliTargetData.insert(mStimuliTargetData.end(),
         database.mStimuliTargetData.begin(), database.mStimuliTargetData.end());
+    mMappedFiles.insert(mMappedFiles.end(),
+        database.mMappedFiles.begin(), database.mMappedFiles.end());
 
     const std::vector<StimuliSet> stimuliSets = getStimuliSets(All);
 
@@ -1169,6 +1210,8 @@ void N2D2::Database::append(const Database& database) {
 
 void N2D2::Database::partitionStimulus(StimulusID id, StimuliSet set)
 {
+    invalidateLabelIndex();
+
     if (set == Unpartitioned)
         return;
 
@@ -1191,6 +1234,8 @@ void N2D2::Database::partitionStimulus(StimulusID id, StimuliSet set)
 
 void N2D2::Database::partitionStimuli(unsigned int nbStimuli, StimuliSet set)
 {
+    invalidateLabelIndex();
+
     if (set == Unpartitioned)
         return;
 
@@ -1226,6 +1271,8 @@ void N2D2::Database::partitionStimuli(unsigned int nbStimuli, StimuliSet set)
 void
 N2D2::Database::partitionStimuli(double learn, double validation, double test)
 {
+    invalidateLabelIndex();
+
     if (learn + validation + test > 1.0)
         throw std::runtime_error("Database::partitionStimuli(): total "
                                  "partition ratio cannot be higher than 1.");
@@ -1259,6 +1306,8 @@ N2D2::Database::partitionStimuli(double learn, double validation, double test)
 void N2D2::Database::partitionStimuliPerLabel(unsigned int nbStimuliPerLabel,
                                               StimuliSet set)
 {
+    invalidateLabelIndex();
+
     if (set == Unpartitioned)
         return;
 
@@ -1294,6 +1343,8 @@ void N2D2::Database::partitionStimuliPerLabel(double learnPerLabel,
                                               double testPerLabel,
                                               bool equiLabel)
 {
+    invalidateLabelIndex();
+
     if (learnPerLabel + validationPerLabel + testPerLabel > 1.0)
         throw std::runtime_error("Database::partitionStimuliPerLabel(): total "
                                  "partition ratio cannot be higher than 1.");
@@ -1429,6 +1480,8 @@ int N2D2::Database::addLabel(const std::string& labelName) {
 
 void N2D2::Database::removeStimulus(StimulusID id)
 {
+    invalidateLabelIndex();
+
     std::vector<StimuliSet> stimuliSets;
     stimuliSets.push_back(Learn);
     stimuliSets.push_back(Validation);
@@ -1457,11 +1510,17 @@ void N2D2::Database::removeStimulus(StimulusID id)
         throw std::runtime_error("Database::removeStimulus(): could not find "
                                  "the stimulus in any of the partition!");
 
+    releaseROIsPoolEntry(id);
     mStimuli.erase(mStimuli.begin() + id);
+
+    if (!mStimuliData.empty())
+        mStimuliData.erase(mStimuliData.begin() + id);
 }
 
 void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
 {
+    invalidateLabelIndex();
+
     std::vector<StimulusID> sortedIds(ids);
     std::sort(sortedIds.begin(), sortedIds.end());
 
@@ -1470,20 +1529,26 @@ void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
 
     // mStimuli.erase() is very slow, better create a new vector and swap!
     std::vector<Stimulus> newStimuli;
+    std::vector<cv::Mat> newStimuliData;
 
     for (unsigned int i = 0, size = mStimuli.size(); i < size; ++i) {
         if (std::binary_search(sortedIds.begin(), sortedIds.end(), i)) {
             stimuliMapping.insert(std::make_pair(i, -1));
+            releaseROIsPoolEntry(i);
             //mStimuli.erase(mStimuli.begin() + (i - offset));
             ++offset;
         }
         else {
             stimuliMapping.insert(std::make_pair(i, i - offset));
             newStimuli.push_back(mStimuli[i]);
+
+            if (!mStimuliData.empty())
+                newStimuliData.push_back(mStimuliData[i]);
         }
     }
 
     mStimuli.swap(newStimuli);
+    mStimuliData.swap(newStimuliData);
 
     std::vector<StimuliSet> stimuliSets;
     stimuliSets.push_back(Learn);
@@ -1521,6 +1586,9 @@ void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
 
 void N2D2::Database::removeLabel(int label)
 {
+    invalidateLabelIndex();
+    loadDeferredROIs();
+
     for (int id = mStimuli.size() - 1; id >= 0; --id) {
         if (mStimuli[id].label == label)
             removeStimulus(id);
@@ -1533,6 +1601,9 @@ void N2D2::Database::removeLabel(int label)
 
 void N2D2::Database::removeLabels(const std::vector<int>& labels)
 {
+    invalidateLabelIndex();
+    loadDeferredROIs();
+
     std::vector<int> sortedLabels(labels);
     std::sort(sortedLabels.begin(), sortedLabels.end());
 
@@ -1701,10 +1772,25 @@ N2D2::Database::getStimulusROIs(StimulusID id) const
     assert(id < mStimuli.size());
 
     std::vector<std::shared_ptr<ROI> > stimulusROIs;
-    std::transform(mStimuli[id].ROIs.begin(),
-                   mStimuli[id].ROIs.end(),
-                   std::back_inserter(stimulusROIs),
-                   std::bind(&ROI::clone, std::placeholders::_1));
+
+    const int entry = getROIsPoolEntry(id);
+
+    if (entry >= 0) {
+        // New ROI objects are created from the pool, no need to clone them
+        const std::vector<ROI*> ROIs = mROIPool.create(entry);
+
+        for (std::vector<ROI*>::const_iterator it = ROIs.begin(),
+             itEnd = ROIs.end(); it != itEnd; ++it)
+        {
+            stimulusROIs.push_back(std::shared_ptr<ROI>(*it));
+        }
+    }
+    else {
+        std::transform(mStimuli[id].ROIs.begin(),
+                       mStimuli[id].ROIs.end(),
+                       std::back_inserter(stimulusROIs),
+                       std::bind(&ROI::clone, std::placeholders::_1));
+    }
 
     if (mCompositeLabel == Auto
         && mStimuli[id].label >= 0
@@ -1754,11 +1840,8 @@ unsigned int N2D2::Database::getNbROIs() const
 {
     unsigned int nbROIs = 0;
 
-    for (std::vector<Stimulus>::const_iterator it = mStimuli.begin(),
-                                               itEnd = mStimuli.end();
-         it != itEnd;
-         ++it)
-        nbROIs += (*it).ROIs.size();
+    for (StimulusID id = 0; id < mStimuli.size(); ++id)
+        nbROIs += getStimulusNbROIs(id);
 
     return nbROIs;
 }
@@ -1776,6 +1859,12 @@ unsigned int N2D2::Database::getNbStimuliWithLabel(
         itSet != itSetEnd;
         ++itSet)
     {
+        if (label >= 0 && label < (int)mLabelsName.size()) {
+            count += getLabelIndex(*itSet).nbStimuli[label];
+            continue;
+        }
+
+        // Stimuli without a valid label are not indexed
         count += std::count_if(
             mStimuliSets(*itSet).begin(),
             mStimuliSets(*itSet).end(),
@@ -1800,16 +1889,21 @@ unsigned int N2D2::Database::getNbROIsWithLabel(int label,
         itSet != itSetEnd;
         ++itSet)
     {
+        if (label >= 0 && label < (int)mLabelsName.size()) {
+            nbROIs += getLabelIndex(*itSet).nbROIs[label];
+            continue;
+        }
+
+        // ROIs without a valid label are not indexed
         for (std::vector<unsigned int>::const_iterator it = mStimuliSets(*itSet).begin(),
                                                 itEnd = mStimuliSets(*itSet).end();
             it != itEnd;
             ++it)
         {
-            for (std::vector<ROI*>::const_iterator itROIs = mStimuli[(*it)].ROIs.begin(),
-                                                itROIsEnd = mStimuli[(*it)].ROIs.end();
-                itROIs != itROIsEnd;
-                ++itROIs) {
-                if ((*itROIs)->getLabel() == label)
+            const unsigned int nbStimulusROIs = getStimulusNbROIs(*it);
+
+            for (unsigned int index = 0; index < nbStimulusROIs; ++index) {
+                if (getStimulusROILabel(*it, index) == label)
                     ++nbROIs;
             }
         }
@@ -1818,6 +1912,20 @@ unsigned int N2D2::Database::getNbROIsWithLabel(int label,
     return nbROIs;
 }
 
+const std::vector<N2D2::Database::StimulusID>&
+N2D2::Database::getStimuliWithLabel(int label, StimuliSet set) const
+{
+    if (label < 0 || label >= (int)mLabelsName.size()) {
+        std::stringstream msgStr;
+        msgStr << "Database::getStimuliWithLabel(): label ID (" << label
+               << ") out of range";
+
+        throw std::domain_error(msgStr.str());
+    }
+
+    return getLabelIndex(set).stimuli[label];
+}
+
 bool N2D2::Database::isLabel(const std::string& labelName) const
 {
     return (std::find(mLabelsName.begin(), mLabelsName.end(), labelName)
@@ -2087,13 +2195,17 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
 
         // Composite stimulus
         // Construct the labels matrix with the ROIs
-        cv::Mat stimulus = dataFile->read(mStimuli[id].name);
+        cv::Mat stimulus = (id < mStimuliData.size()
+                            && !mStimuliData[id].empty())
+            ? mStimuliData[id]
+            : dataFile->read(mStimuli[id].name);
 
         if (labels.empty()) {
             const int labelID = ((mCompositeLabel == Auto
                     && mStimuli[id].label == -1)
                 || mCompositeLabel == Default
-                || (mCompositeLabel == Disjoint && !mStimuli[id].ROIs.empty()))
+                || (mCompositeLabel == Disjoint
+                    && getStimulusNbROIs(id) > 0))
                     ? defaultLabel : mStimuli[id].label;
 
             labels = cv::Mat(stimulus.rows, stimulus.cols, CV_32SC1,
@@ -2108,8 +2220,10 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
         if (mStimuli[id].slice != NULL)
             labels = mStimuli[id].slice->extract(labels);
 
-        for (std::vector<ROI*>::const_iterator it = mStimuli[id].ROIs.begin(),
-                                               itEnd = mStimuli[id].ROIs.end();
+        const ROIPool::ROIs_T ROIs = getStimulusROIsRef(id);
+
+        for (std::vector<ROI*>::const_iterator it = ROIs->begin(),
+                                               itEnd = ROIs->end();
              it != itEnd;
              ++it)
         {
@@ -2120,7 +2234,7 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
             {
 #pragma omp critical(Database__loadStimulusLabelsData)
                 std::cout << Utils::cwarning << "Could not append ROI #"
-                    << (it - mStimuli[id].ROIs.begin()) << " to stimulus "
+                    << (it - ROIs->begin()) << " to stimulus "
                     << mStimuli[id].name << " (" << stimulus.cols
                     << "x" << stimulus.rows << "):\n" << Utils::cdef
                     << e.what() << std::endl;
@@ -2130,8 +2244,8 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
         return labels;
     } else {
         // Non-composite stimulus
-        if (mCompositeLabel == Auto && !mStimuli[id].ROIs.empty()) {
-            if (mStimuli[id].ROIs.size() != 1) {
+        if (mCompositeLabel == Auto && getStimulusNbROIs(id) > 0) {
+            if (getStimulusNbROIs(id) != 1) {
 #pragma omp critical(Database__loadStimulusLabelsData)
                 throw std::runtime_error("Database::loadStimulusLabelsData(): "
                                          "number of ROIs should be 1 for "
@@ -2140,7 +2254,7 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
             }
 
             return cv::Mat(
-                1, 1, CV_32SC1, cv::Scalar(mStimuli[id].ROIs[0]->getLabel()));
+                1, 1, CV_32SC1, cv::Scalar(getStimulusROILabel(id, 0)));
         } else
             return cv::Mat(1, 1, CV_32SC1, cv::Scalar(mStimuli[id].label));
     }
@@ -2269,13 +2383,14 @@ cv::Mat N2D2::Database::loadData(
 
     if (mCompositeLabel == Auto
         && mStimuli[id].label >= 0
-        && !mStimuli[id].ROIs.empty())
+        && getStimulusNbROIs(id) > 0)
     {
+        const ROIPool::ROIs_T ROIs = getStimulusROIsRef(id);
         bool extracted = false;
 
         for (std::vector<ROI*>::const_iterator
-            itROIs = mStimuli[id].ROIs.begin(),
-            itROIsEnd = mStimuli[id].ROIs.end();
+            itROIs = ROIs->begin(),
+            itROIsEnd = ROIs->end();
             itROIs != itROIsEnd; ++itROIs)
         {
             if ((*itROIs)->getLabel() >= 0) {
@@ -2339,6 +2454,95 @@ N2D2::Database::getLabelsStimuliSetIndexes(StimuliSet set) const
     return labelsStimuli;
 }
 
+const N2D2::Database::LabelIndex&
+N2D2::Database::getLabelIndex(StimuliSet set) const
+{
+    // Fast path, without lock: the index is valid and the sizes are the same.
+    // The database is not modified while its stimuli are being drawn.
+    if (mLabelIndexValid.load(std::memory_order_acquire)
+        && getLabelIndexSizes() == mLabelIndexSizes)
+    {
+        return mLabelIndex[set];
+    }
+
+#pragma omp critical(Database__getLabelIndex)
+    {
+        // Stimuli added or partitioned directly through mStimuli and
+        // mStimuliSets are detected with the sizes
+        const LabelIndexSizes_T sizes = getLabelIndexSizes();
+
+        if (!mLabelIndexValid.load(std::memory_order_relaxed)
+            || sizes != mLabelIndexSizes)
+        {
+            mLabelIndexValid.store(false, std::memory_order_relaxed);
+
+            const unsigned int nbLabels = mLabelsName.size();
+
+            mLabelIndex.assign(Unpartitioned + 1, LabelIndex());
+
+            for (int s = Learn; s <= Unpartitioned; ++s) {
+                LabelIndex& labelIndex = mLabelIndex[s];
+                labelIndex.stimuli.resize(nbLabels);
+                labelIndex.nbStimuli.resize(nbLabels, 0);
+                labelIndex.nbROIs.resize(nbLabels, 0);
+
+                const std::vector<StimulusID>& stimuliSet
+                    = mStimuliSets((StimuliSet)s);
+
+                for (std::vector<StimulusID>::const_iterator it
+                     = stimuliSet.begin(), itEnd = stimuliSet.end();
+                     it != itEnd;
+                     ++it)
+                {
+                    const Stimulus& stimulus = mStimuli[(*it)];
+
+                    if (stimulus.label >= 0
+                        && stimulus.label < (int)nbLabels)
+                    {
+                        labelIndex.stimuli[stimulus.label].push_back(*it);
+                        ++labelIndex.nbStimuli[stimulus.label];
+                    }
+
+                    const unsigned int nbROIs = getStimulusNbROIs(*it);
+
+                    for (unsigned int index = 0; index < nbROIs; ++index) {
+                        const int label = getStimulusROILabel(*it, index);
+
+                        if (label < 0 || label >= (int)nbLabels)
+                            continue;
+
+                        ++labelIndex.nbROIs[label];
+
+                        // Each stimulus is indexed only once per label
+                        if (labelIndex.stimuli[label].empty()
+                            || labelIndex.stimuli[label].back() != (*it))
+                        {
+                            labelIndex.stimuli[label].push_back(*it);
+                        }
+                    }
+                }
+            }
+
+            mLabelIndexSizes = sizes;
+            mLabelIndexValid.store(true, std::memory_order_release);
+        }
+    }
+
+    return mLabelIndex[set];
+}
+
+N2D2::Database::LabelIndexSizes_T N2D2::Database::getLabelIndexSizes() const
+{
+    LabelIndexSizes_T sizes;
+    sizes[0] = mStimuli.size();
+    sizes[1] = mLabelsName.size();
+
+    for (int s = Learn; s <= Unpartitioned; ++s)
+        sizes[2 + s] = mStimuliSets((StimuliSet)s).size();
+
+    return sizes;
+}
+
 void N2D2::Database::partitionIndexes(std::vector
                                       <unsigned int>& unpartitionedIndexes,
                                       std::vector
@@ -2387,6 +2591,206 @@ void N2D2::Database::removeIndexesFromSet(std::vector<unsigned int>& indexes,
     indexes.clear();
 }
 
+void N2D2::Database::poolStimulusROIs(StimulusID id)
+{
+    Stimulus& stimulus = mStimuli[id];
+
+    if (stimulus.ROIs.empty() || !ROIPool::isPoolable(stimulus.ROIs))
+        return;
+
+    mROIPool.setCacheSize(mROIsCacheSize);
+
+    const int entry = getROIsPoolEntry(id);
+
+    if (entry >= 0) {
+        // New ROIs were added to an already pooled stimulus: the stimulus
+        // gets a new entry with all its ROIs
+        std::vector<ROI*> ROIs = mROIPool.create(entry);
+        ROIs.insert(ROIs.end(), stimulus.ROIs.begin(), stimulus.ROIs.end());
+        stimulus.ROIs.swap(ROIs);
+        mROIPool.erase(entry);
+    }
+
+    stimulus.ROIsPoolEntry = mROIPool.push_back(stimulus.ROIs);
+    std::for_each(stimulus.ROIs.begin(), stimulus.ROIs.end(), Utils::Delete());
+    stimulus.ROIs.clear();
+}
+
+void N2D2::Database::poolROIs(StimulusID first)
+{
+    for (StimulusID id = first; id < mStimuli.size(); ++id)
+        poolStimulusROIs(id);
+}
+
+void N2D2::Database::unpoolROIs()
+{
+    if (mROIPool.getNbEntries() == 0)
+        return;
+
+    // The pending entries cannot be created
+    loadDeferredROIs();
+
+    for (std::vector<Stimulus>::iterator it = mStimuli.begin(),
+                                         itEnd = mStimuli.end();
+         it != itEnd;
+         ++it)
+    {
+        if ((*it).ROIsPoolEntry >= 0) {
+            std::vector<ROI*> ROIs = mROIPool.create((*it).ROIsPoolEntry);
+            ROIs.insert(ROIs.end(), (*it).ROIs.begin(), (*it).ROIs.end());
+            (*it).ROIs.swap(ROIs);
+            (*it).ROIsPoolEntry = -1;
+        }
+    }
+
+    mROIPool.clear();
+}
+
+void N2D2::Database::deferStimulusROIs(StimulusID id,
+                                       const std::vector<std::string>&
+                                           labelNames,
+                                       const ROIsLoader_T& loader)
+{
+    Stimulus& stimulus = mStimuli[id];
+
+    // The labels are only created here, never when parsing the ROIs, as the
+    // labels accessors read them without lock
+    for (std::vector<std::string>::const_iterator it = labelNames.begin(),
+         itEnd = labelNames.end(); it != itEnd; ++it)
+    {
+        if (!(*it).empty())
+            labelID(*it);
+    }
+
+    if (!stimulus.ROIs.empty() || stimulus.ROIsPoolEntry >= 0) {
+        // The stimulus already has ROIs: the new ones are parsed right away
+        const NamedROIs_T namedROIs = loader();
+
+        for (NamedROIs_T::const_iterator it = namedROIs.begin(),
+             itEnd = namedROIs.end(); it != itEnd; ++it)
+        {
+            (*it).second->setLabel(((*it).first.empty())
+                ? -1 : labelID((*it).first));
+            stimulus.ROIs.push_back((*it).second);
+        }
+
+        poolStimulusROIs(id);
+        return;
+    }
+
+    stimulus.ROIsPoolEntry = mROIPool.push_back_deferred();
+    mROIsLoaders.insert(std::make_pair(stimulus.ROIsPoolEntry, loader));
+    ++mNbDeferredROIs;
+}
+
+void N2D2::Database::loadDeferredROIs(StimulusID id) const
+{
+    // Loading the deferred ROIs does not change the database content, as
+    // seen from its accessors. The exceptions cannot leave the critical
+    // section.
+    std::exception_ptr error;
+
+#pragma omp critical(Database__loadDeferredROIs)
+    {
+        try {
+            const_cast<Database*>(this)->parseDeferredROIs(id);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void N2D2::Database::parseDeferredROIs(StimulusID id)
+{
+    if (id >= mStimuli.size()) {
+        // Parse all the deferred ROIs
+        for (StimulusID stimulusId = 0;
+            stimulusId < mStimuli.size() && mNbDeferredROIs > 0; ++stimulusId)
+        {
+            parseDeferredROIs(stimulusId);
+        }
+
+        return;
+    }
+
+    const int entry = mStimuli[id].ROIsPoolEntry;
+
+    // The ROIs may have been parsed in the meantime by another thread
+    if (entry < 0 || !mROIPool.isPending(entry))
+        return;
+
+    const std::map<unsigned int, ROIsLoader_T>::iterator itLoader
+        = mROIsLoaders.find(entry);
+    const NamedROIs_T namedROIs = (*itLoader).second();
+
+    std::vector<ROI*> ROIs;
+
+    for (NamedROIs_T::const_iterator it = namedROIs.begin(),
+         itEnd = namedROIs.end(); it != itEnd; ++it)
+    {
+        ROIs.push_back((*it).second);
+    }
+
+    try {
+        for (NamedROIs_T::const_iterator it = namedROIs.begin(),
+             itEnd = namedROIs.end(); it != itEnd; ++it)
+        {
+            // The labels were created by deferStimulusROIs()
+            (*it).second->setLabel(((*it).first.empty())
+                ? -1 : getLabelID((*it).first));
+        }
+
+        mROIPool.assign(entry, ROIs);
+    }
+    catch (...) {
+        std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+        throw;
+    }
+
+    std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+    mROIsLoaders.erase(itLoader);
+
+#pragma omp atomic
+    --mNbDeferredROIs;
+}
+
+void N2D2::Database::releaseROIsPoolEntry(StimulusID id)
+{
+    const int entry = mStimuli[id].ROIsPoolEntry;
+
+    if (entry < 0)
+        return;
+
+    const std::map<unsigned int, ROIsLoader_T>::iterator itLoader
+        = mROIsLoaders.find(entry);
+
+    if (itLoader != mROIsLoaders.end()) {
+        // Never parsed
+        mROIsLoaders.erase(itLoader);
+        --mNbDeferredROIs;
+    }
+
+    mROIPool.erase(entry);
+    mStimuli[id].ROIsPoolEntry = -1;
+}
+
+N2D2::ROIPool::ROIs_T N2D2::Database::getStimulusROIsRef(StimulusID id) const
+{
+    const int entry = getROIsPoolEntry(id);
+
+    if (entry >= 0) {
+        // The ROIsCacheSize parameter may have changed since the last access
+        return mROIPool.get(entry, mROIsCacheSize);
+    }
+
+    // Non-owning pointer to the stimulus ROIs
+    return ROIPool::ROIs_T(ROIPool::ROIs_T(), &mStimuli[id].ROIs);
+}
+
 N2D2::Database::~Database()
 {
     for (std::vector<Stimulus>::iterator it = mStimuli.begin(),
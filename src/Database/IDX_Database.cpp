@@ -20,6 +20,8 @@
 
 #include "Database/IDX_Database.hpp"
 
+#include <cstring>
+
 N2D2::IDX_Database::IDX_Database(bool loadDataInMemory)
     : Database(loadDataInMemory)
 {
@@ -31,21 +33,24 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
                               bool /*extractROIs*/)
 {
     // Images
-    std::ifstream images(dataPath.c_str(), std::fstream::binary);
-
-    if (!images.good())
-        throw std::runtime_error("Could not open images file: " + dataPath);
+    // The file is memory mapped and the stimuli data are views on the
+    // mapping: nothing is copied nor written to disk
+    const std::shared_ptr<MemoryMappedFile> images
+        = std::make_shared<MemoryMappedFile>(dataPath);
 
     MagicNumber magicNumber;
     unsigned int nbImages;
     unsigned int nbRows;
     unsigned int nbColumns;
 
-    images.read(reinterpret_cast<char*>(&magicNumber.value),
-                sizeof(magicNumber));
-    images.read(reinterpret_cast<char*>(&nbImages), sizeof(nbImages));
-    images.read(reinterpret_cast<char*>(&nbRows), sizeof(nbRows));
-    images.read(reinterpret_cast<char*>(&nbColumns), sizeof(nbColumns));
+    if (images->size() < 4 * sizeof(unsigned int))
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + dataPath);
+
+    std::memcpy(&magicNumber.value, images->data(), sizeof(magicNumber));
+    std::memcpy(&nbImages, images->data() + 4, sizeof(nbImages));
+    std::memcpy(&nbRows, images->data() + 8, sizeof(nbRows));
+    std::memcpy(&nbColumns, images->data() + 12, sizeof(nbColumns));
 
     if (!Utils::isBigEndian()) {
         Utils::swapEndian(magicNumber.value);
@@ -60,21 +65,34 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
                                  + dataPath);
     }
 
-    // Labels
-    std::ifstream labels(labelPath.c_str(), std::fstream::binary);
+    const std::size_t imageSize = (std::size_t)nbRows * nbColumns;
+    const std::size_t dataSize = 4 * sizeof(unsigned int)
+                                 + (std::size_t)nbImages * imageSize;
+
+    if (images->size() < dataSize)
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + dataPath);
+    else if (images->size() > dataSize)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataPath);
 
-    if (!labels.good())
-        throw std::runtime_error("Could not open labels file: " + labelPath);
+    // Labels
+    const std::shared_ptr<MemoryMappedFile> labels
+        = std::make_shared<MemoryMappedFile>(labelPath);
 
     MagicNumber magicNumberLabels;
     unsigned int nbItemsLabels;
 
-    labels.read(reinterpret_cast<char*>(&magicNumberLabels.value),
+    if (labels->size() < 2 * sizeof(unsigned int))
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + labelPath);
+
+    std::memcpy(&magicNumberLabels.value, labels->data(),
                 sizeof(magicNumberLabels));
-    labels.read(reinterpret_cast<char*>(&nbItemsLabels), sizeof(nbItemsLabels));
+    std::memcpy(&nbItemsLabels, labels->data() + 4, sizeof(nbItemsLabels));
 
     if (!Utils::isBigEndian()) {
-        Utils::swapEndian(magicNumberLabels);
+        Utils::swapEndian(magicNumberLabels.value);
         Utils::swapEndian(nbItemsLabels);
     }
 
@@ -89,58 +107,52 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
         throw std::runtime_error(
             "The number of images and the number of labels does not match.");
 
+    const std::size_t labelsSize = 2 * sizeof(unsigned int) + nbItemsLabels;
+
+    if (labels->size() < labelsSize)
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + labelPath);
+    else if (labels->size() > labelsSize)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + labelPath);
+
+    const unsigned char* imagesData = images->data() + 4 * sizeof(unsigned int);
+    const unsigned char* labelsData = labels->data() + 2 * sizeof(unsigned int);
+
+    // Stimuli data must be kept aligned with mStimuli
+    mStimuliData.resize(mStimuli.size());
+    mStimuli.reserve(mStimuli.size() + nbImages);
+    mStimuliData.reserve(mStimuli.size() + nbImages);
+
+    // Label ID of each label value, created in order of first occurrence
+    std::vector<int> labelIDs(256, -1);
+
     // For each image...
     for (unsigned int i = 0; i < nbImages; ++i) {
-        unsigned char buff;
+        // ... attach the corresponding label
+        const unsigned char label = labelsData[i];
 
-        std::ostringstream nameStr;
-        nameStr << dataPath << "[" << std::setfill('0') << std::setw(5) << i
-                << "].pgm";
+        if (labelIDs[label] < 0) {
+            std::ostringstream labelStr;
+            labelStr << (unsigned int)label;
 
-        // ... generate the stimuli
-        if (!std::ifstream(nameStr.str()).good()) {
-            cv::Mat frame(cv::Size(nbColumns, nbRows), CV_8UC1);
-
-            for (unsigned int y = 0; y < nbRows; ++y) {
-                for (unsigned int x = 0; x < nbColumns; ++x) {
-                    images.read(reinterpret_cast<char*>(&buff), sizeof(buff));
-                    frame.at<unsigned char>(y, x) = buff;
-                }
-            }
-
-            if (!cv::imwrite(nameStr.str(), frame))
-                throw std::runtime_error("Unable to write image: "
-                                         + nameStr.str());
-        } else {
-            // Skip image data (to grab labels only)
-            images.seekg(nbColumns * nbRows, images.cur);
+            labelIDs[label] = labelID(labelStr.str());
         }
 
-        // ... attach the corresponding label
-        labels.read(reinterpret_cast<char*>(&buff), sizeof(buff));
-
-        std::ostringstream labelStr;
-        labelStr << (unsigned int)buff;
+        // The name is only used to identify the stimulus, there is no file
+        std::ostringstream nameStr;
+        nameStr << dataPath << "[" << std::setfill('0') << std::setw(5) << i
+                << "].pgm";
 
-        mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelStr.str())));
+        mStimuli.push_back(Stimulus(nameStr.str(), labelIDs[label]));
         mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
-    }
 
-    if (images.eof())
-        throw std::runtime_error(
-            "End-of-file reached prematurely in data file: " + dataPath);
-    else if (!images.good())
-        throw std::runtime_error("Error while reading data file: " + dataPath);
-    else if (images.get() != std::fstream::traits_type::eof())
-        throw std::runtime_error("Data file size larger than expected: "
-                                 + dataPath);
+        // ... and the image data, without copy
+        mStimuliData.push_back(cv::Mat(nbRows, nbColumns, CV_8UC1,
+            const_cast<unsigned char*>(imagesData + i * imageSize)));
+    }
 
-    if (labels.eof())
-        throw std::runtime_error(
-            "End-of-file reached prematurely in data file: " + labelPath);
-    else if (!labels.good())
-        throw std::runtime_error("Error while reading data file: " + labelPath);
-    else if (labels.get() != std::fstream::traits_type::eof())
-        throw std::runtime_error("Data file size larger than expected: "
-                                 + labelPath);
+    // The data must stay in memory, as the file is not written anymore
+    mLoadDataInMemory = true;
+    mMappedFiles.push_back(images);
 }
@@ -64,10 +64,17 @@ void N2D2::ILSVRC2012_Database::loadImageNetStimuliPerDir(const std::string
         throw std::runtime_error("Could not open labels file: "
                                  + labelNamePath);
 
+    std::vector<std::string> classDirPaths;
+    std::vector<std::string> classDirs;
     std::string classDir;
 
-    while (labels >> classDir)
-        loadDir(dirPath + "/" + classDir, 0, classDir, 0);
+    while (labels >> classDir) {
+        classDirPaths.push_back(dirPath + "/" + classDir);
+        classDirs.push_back(classDir);
+    }
+
+    // All the class directories are indexed at once, in parallel
+    loadDirs(classDirPaths, 0, classDirs, 0);
 }
 
 void N2D2::ILSVRC2012_Database::loadImageNetValidationStimuli(const std::string
@@ -88,6 +88,7 @@ void N2D2::KITTI_Database::loadKITTIStimuli(const std::string& dirPath,
 
     const unsigned int stimuliWidth = 1242;
     const unsigned int stimuliHeight = 375;
+    const StimulusID firstStimulus = mStimuli.size();
 
     /**frame Parameters: Frame within the sequence where the object appearers**/
     int frame = 0;
@@ -209,4 +210,6 @@ void N2D2::KITTI_Database::loadKITTIStimuli(const std::string& dirPath,
         if ( c == EOF )
             break;
     }
+
+    poolROIs(firstStimulus);
 }
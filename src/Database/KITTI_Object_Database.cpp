@@ -71,6 +71,76 @@ void N2D2::KITTI_Object_Database::loadKITTIStimuli(const std::string& dirPath,
     if (!((std::string)mDefaultLabel).empty())
         labelID(mDefaultLabel);
 
+    std::vector<std::string> files;
+
+    struct dirent* pFile;
+
+    DIR* pDir = opendir(dirPath.c_str());
+    if (pDir == NULL)
+        throw std::runtime_error(
+            "Couldn't open the directory for the directory database: "
+            + dirPath);
+
+    while ((pFile = readdir(pDir)) != NULL) {
+        if (pFile->d_name[0] != '.')
+            files.push_back(std::string(dirPath + "/" + pFile->d_name));
+    }
+
+    closedir(pDir);
+    std::sort(files.begin(), files.end());
+
+    std::cout << "Loading directory database \"" << dirPath << "\""
+              << " size of the directory: " << files.size() << " picture"
+              << std::endl;
+    std::cout << "Loading the labels datafile \"" << labelPath << "\""
+              << std::endl;
+    for(unsigned int frameIdx = 0; frameIdx < labelfiles.size(); ++ frameIdx) {
+        // Missing files are still reported when loading, but the
+        // annotations are only parsed on first access
+        const std::vector<std::string> labelNames
+            = parseLabelNames(labelfiles[frameIdx]);
+
+        mStimuli.push_back(Stimulus(files[frameIdx], -1));
+        mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
+
+        deferStimulusROIs(mStimuli.size() - 1, labelNames,
+                          std::bind(&KITTI_Object_Database::parseLabelFile,
+                                    labelfiles[frameIdx], files[frameIdx]));
+    }
+}
+
+std::vector<std::string>
+N2D2::KITTI_Object_Database::parseLabelNames(const std::string& fileName)
+{
+    std::ifstream labelFile(fileName.c_str());
+
+    if (!labelFile.good())
+        throw std::runtime_error("Could not open validation labels file: "
+                                 + fileName);
+
+    std::vector<std::string> labelNames;
+    std::string line;
+
+    while (std::getline(labelFile, line)) {
+        // The object type is the first value of each line
+        std::stringstream values(line);
+        std::string objectType;
+
+        if ((values >> objectType)
+            && std::find(labelNames.begin(), labelNames.end(), objectType)
+                == labelNames.end())
+        {
+            labelNames.push_back(objectType);
+        }
+    }
+
+    return labelNames;
+}
+
+N2D2::Database::NamedROIs_T
+N2D2::KITTI_Object_Database::parseLabelFile(const std::string& fileName,
+                                            const std::string& stimulusName)
+{
     const unsigned int stimuliWidth = 1242;
     const unsigned int stimuliHeight = 375;
 
@@ -113,83 +183,66 @@ void N2D2::KITTI_Object_Database::loadKITTIStimuli(const std::string& dirPath,
      * [-pi..pi] **/
     float rotation_x = 0.0;
 
-    std::vector<std::string> files;
+    std::ifstream labelFile(fileName.c_str());
 
-    struct dirent* pFile;
+    if (!labelFile.good())
+        throw std::runtime_error("Could not open validation labels file: "
+                                 + fileName);
 
-    DIR* pDir = opendir(dirPath.c_str());
-    if (pDir == NULL)
-        throw std::runtime_error(
-            "Couldn't open the directory for the directory database: "
-            + dirPath);
+    NamedROIs_T ROIs;
 
-    while ((pFile = readdir(pDir)) != NULL) {
-        if (pFile->d_name[0] != '.')
-            files.push_back(std::string(dirPath + "/" + pFile->d_name));
-    }
-
-    closedir(pDir);
-    std::sort(files.begin(), files.end());
+    while (!labelFile.eof()) {
 
-    std::cout << "Loading directory database \"" << dirPath << "\""
-              << " size of the directory: " << files.size() << " picture"
-              << std::endl;
-    std::cout << "Loading the labels datafile \"" << labelPath << "\""
-              << std::endl;
-    for(unsigned int frameIdx = 0; frameIdx < labelfiles.size(); ++ frameIdx) {
-        std::ifstream labelFile(labelfiles[frameIdx].c_str());
-
-        if (!labelFile.good())
-            throw std::runtime_error("Could not open validation labels file: "
-                                     + labelfiles[frameIdx]);
-        mStimuli.push_back(Stimulus(files[frameIdx], -1));
-        mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
-
-        while (!labelFile.eof()) {
-
-            if (!(labelFile >> objectType) || !(labelFile >> truncated)
-                || !(labelFile >> occluded) || !(labelFile>> alpha)
-                || !(labelFile >> bb_left) || !(labelFile >> bb_top)
-                || !(labelFile >> bb_right) || !(labelFile >> bb_bottom)
-                || !(labelFile >> dim_height) || !(labelFile>> dim_width)
-                || !(labelFile >> dim_length) || !(labelFile >> loc_x)
-                || !(labelFile >> loc_y) || !(labelFile >> loc_z)
-                || !(labelFile >> rotation_x)) {
-                throw std::runtime_error("KITTI_Object_Database::loadKITTIStimuli(): "
-                                         "unreadable values in file: " + labelfiles[frameIdx]);
-            }
-            unsigned int width = bb_right - bb_left;
-            unsigned int height = bb_bottom - bb_top;
-
-            if ((width + bb_left) > stimuliWidth) {
-                std::cout << Utils::cwarning << "BBV right border >" << stimuliWidth
-                          << " in picture " << files[frameIdx] << Utils::cdef
-                          << std::endl;
-                width = stimuliWidth - bb_left;
+        if (!(labelFile >> objectType) || !(labelFile >> truncated)
+            || !(labelFile >> occluded) || !(labelFile>> alpha)
+            || !(labelFile >> bb_left) || !(labelFile >> bb_top)
+            || !(labelFile >> bb_right) || !(labelFile >> bb_bottom)
+            || !(labelFile >> dim_height) || !(labelFile>> dim_width)
+            || !(labelFile >> dim_length) || !(labelFile >> loc_x)
+            || !(labelFile >> loc_y) || !(labelFile >> loc_z)
+            || !(labelFile >> rotation_x)) {
+            for (NamedROIs_T::const_iterator it = ROIs.begin(),
+                 itEnd = ROIs.end(); it != itEnd; ++it)
+            {
+                delete (*it).second;
             }
 
-            if ((height + bb_top) > stimuliHeight) {
-                std::cout << Utils::cwarning << "BBV bottom border >"
-                          << stimuliHeight << " in picture " << files[frameIdx]
-                          << Utils::cdef << std::endl;
-                height = stimuliHeight - bb_top;
-            }
+            throw std::runtime_error("KITTI_Object_Database::parseLabelFile(): "
+                                     "unreadable values in file: " + fileName);
+        }
+        unsigned int width = bb_right - bb_left;
+        unsigned int height = bb_bottom - bb_top;
+
+        if ((width + bb_left) > stimuliWidth) {
+            std::cout << Utils::cwarning << "BBV right border >" << stimuliWidth
+                      << " in picture " << stimulusName << Utils::cdef
+                      << std::endl;
+            width = stimuliWidth - bb_left;
+        }
 
-            mStimuli.back().ROIs.push_back(new RectangularROI<int>(
-                labelID(objectType),
-                RectangularROI<int>::Point_T(bb_left, bb_top),
-                width,
-                height));
+        if ((height + bb_top) > stimuliHeight) {
+            std::cout << Utils::cwarning << "BBV bottom border >"
+                      << stimuliHeight << " in picture " << stimulusName
+                      << Utils::cdef << std::endl;
+            height = stimuliHeight - bb_top;
+        }
 
-            labelFile >> std::ws;  // eat up any leading white spaces
+        ROIs.push_back(std::make_pair(objectType, new RectangularROI<int>(
+            -1,
+            RectangularROI<int>::Point_T(bb_left, bb_top),
+            width,
+            height)));
 
-            int c = labelFile.peek();  // peek character
+        labelFile >> std::ws;  // eat up any leading white spaces
 
-            if ( c == EOF )
-                break;
+        int c = labelFile.peek();  // peek character
+
+        if ( c == EOF )
+            break;
 
-        }
     }
+
+    return ROIs;
 }
 
 void N2D2::KITTI_Object_Database::loadKITTITestStimuli(const std::string& dirPath)
@@ -96,58 +96,24 @@ void N2D2::N_MNIST_Database::loadAerStimulusData(
 {
 
 
-    std::string filename = mStimuli[mStimuliSets(set)[id]].name;
     std::cout << "ID: " << id << std::endl;
 
-    std::ifstream data(filename, std::ios::in|std::ios::binary|std::ios::ate);
+    AerStream stream;
+    loadAerStimulusStream(stream, set, id);
 
-    if (data.good()) {
-
-            std::streampos size;
-            char * memblock;
-            size = data.tellg(); // Get pointer to end of file
-            memblock = new char [size]; // Allocate memory for data
-            data.seekg(0, std::ios::beg); // Set pointer to beginning
-            data.read(memblock, size);
-            data.close();
-
-            unsigned int nbEvents = (unsigned int)((int)size/5);
-
-            for (unsigned int ev = 0; ev < nbEvents; ++ev) {
-
-                unsigned int offset = 5*ev;
-
-                unsigned int xCoor =
-                            (unsigned int)((unsigned char)memblock[offset]);
-                unsigned int yCoor =
-                            (unsigned int)((unsigned char)memblock[offset+1]);
-
-                 // Use unsigned int because only 24 bit
-                unsigned int bitstring = ((unsigned char)memblock[offset+2]);
-                bitstring =
-                    (bitstring << 8) | (unsigned char)memblock[offset+3];
-                bitstring =
-                    (bitstring << 8) | (unsigned char)memblock[offset+4];
-                bitstring = bitstring << 8;
-
-                // Bit 24 represents sign
-                unsigned int sign = static_cast<unsigned int>(bitstring >> 31);
-                // Bits 23-0 represent time
-                unsigned int time = static_cast<unsigned int>((bitstring << 1)
-                                                                >> (32-23));
-                
-                // We use here the polarity/sign for the channel, and not for
-                // the event value
-                aerData.push_back(AerReadEvent(xCoor, yCoor, sign, batch, 1, time));
+    // We use here the polarity/sign for the channel, and not for the event
+    // value
+    stream.getWindow().append(aerData, batch);
+}
 
-            }
+void N2D2::N_MNIST_Database::loadAerStimulusStream(AerStream& stream,
+                                                   StimuliSet set,
+                                                   StimulusID id)
+{
+    const std::string& filename = mStimuli[mStimuliSets(set)[id]].name;
 
-            delete[] memblock;
-    }
-    else {
-        throw std::runtime_error("N_MNIST_Database::loadAerStimulusData: "
-                                    "Could not open AER file: " + filename);
-    }
+    // Events are sorted by time, so that time windows can be taken
+    stream.load(filename, AerStream::Atis);
 }
 
 
@@ -0,0 +1,397 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Database/ROIPool.hpp"
+#include "ROI/EllipticROI.hpp"
+#include "ROI/PolygonalROI.hpp"
+#include "ROI/RectangularROI.hpp"
+
+#include <stdexcept>
+#include <typeinfo>
+
+N2D2::ROIPool::ROIPool(unsigned int cacheSize)
+    : mCacheSize(cacheSize),
+      mErasedRecords(0)
+{
+    // ctor
+}
+
+bool N2D2::ROIPool::isPoolable(const std::vector<ROI*>& ROIs)
+{
+    // The exact type is checked, as derived types may hold more data
+    for (std::vector<ROI*>::const_iterator it = ROIs.begin(),
+         itEnd = ROIs.end(); it != itEnd; ++it)
+    {
+        const std::type_info& type = typeid(*(*it));
+
+        if (type != typeid(PolygonalROI<int>)
+            && type != typeid(RectangularROI<int>)
+            && type != typeid(EllipticROI<int>))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+unsigned int N2D2::ROIPool::push_back(const std::vector<ROI*>& ROIs)
+{
+    if (!isPoolable(ROIs)) {
+        throw std::runtime_error("ROIPool::push_back(): unsupported ROI"
+                                 " type");
+    }
+
+    Entry entry;
+    entry.first = mStorage.records.size();
+    entry.size = ROIs.size();
+    entry.deferred = false;
+
+    mStorage.append(ROIs);
+    mEntries.push_back(entry);
+    return (mEntries.size() - 1);
+}
+
+unsigned int N2D2::ROIPool::push_back_deferred()
+{
+    Entry entry;
+    entry.first = mDeferred.size();
+    entry.size = 0;
+    entry.deferred = true;
+
+    mDeferred.push_back(std::shared_ptr<const Storage>());
+    mEntries.push_back(entry);
+    return (mEntries.size() - 1);
+}
+
+void N2D2::ROIPool::assign(unsigned int entry, const std::vector<ROI*>& ROIs)
+{
+    if (!mEntries[entry].deferred) {
+        throw std::runtime_error("ROIPool::assign(): entry is not"
+                                 " deferred");
+    }
+
+    if (!isPoolable(ROIs)) {
+        throw std::runtime_error("ROIPool::assign(): unsupported ROI"
+                                 " type");
+    }
+
+    std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+    storage->append(ROIs);
+
+    // Only the entry own storage is written, the shared arrays are left
+    // untouched for the concurrent readers
+    std::shared_ptr<const Storage> expected;
+
+    if (!std::atomic_compare_exchange_strong(
+        &mDeferred[mEntries[entry].first], &expected,
+        std::shared_ptr<const Storage>(storage)))
+    {
+        throw std::runtime_error("ROIPool::assign(): entry is already"
+                                 " assigned");
+    }
+}
+
+void N2D2::ROIPool::erase(unsigned int entry)
+{
+    Entry& erased = mEntries[entry];
+
+    const std::unordered_map<unsigned int,
+        std::pair<ROIs_T, LRU_T::iterator> >::iterator it
+            = mCache.find(entry);
+
+    if (it != mCache.end()) {
+        mLRU.erase((*it).second.second);
+        mCache.erase(it);
+    }
+
+    if (erased.deferred)
+        mDeferred[erased.first].reset();
+    else
+        mErasedRecords += erased.size;
+
+    // An erased entry is an empty entry
+    erased.first = 0;
+    erased.size = 0;
+    erased.deferred = false;
+
+    if (mErasedRecords > 0
+        && 2 * mErasedRecords >= mStorage.records.size())
+    {
+        compact();
+    }
+}
+
+std::vector<N2D2::ROI*> N2D2::ROIPool::create(unsigned int entry) const
+{
+    if (mEntries[entry].deferred) {
+        const std::shared_ptr<const Storage> storage = getDeferred(entry);
+        return storage->create(0, storage->records.size());
+    }
+
+    return mStorage.create(mEntries[entry].first, mEntries[entry].size);
+}
+
+N2D2::ROIPool::ROIs_T N2D2::ROIPool::get(unsigned int entry) const
+{
+    unsigned int cacheSize;
+
+#pragma omp critical(ROIPool__get)
+    cacheSize = mCacheSize;
+
+    return get(entry, cacheSize);
+}
+
+N2D2::ROIPool::ROIs_T N2D2::ROIPool::get(unsigned int entry,
+                                         unsigned int cacheSize) const
+{
+    ROIs_T ROIs;
+
+#pragma omp critical(ROIPool__get)
+    {
+        if (cacheSize != mCacheSize) {
+            mCacheSize = cacheSize;
+            evict();
+        }
+
+        const std::unordered_map<unsigned int,
+            std::pair<ROIs_T, LRU_T::iterator> >::iterator it
+                = mCache.find(entry);
+
+        if (it != mCache.end()) {
+            mLRU.splice(mLRU.begin(), mLRU, (*it).second.second);
+            ROIs = (*it).second.first;
+        }
+    }
+
+    if (ROIs)
+        return ROIs;
+
+    // The ROI objects are created outside of the critical section
+    ROIs = ROIs_T(new std::vector<ROI*>(create(entry)), DeleteROIs());
+
+    if (cacheSize > 0) {
+#pragma omp critical(ROIPool__get)
+        {
+            const std::pair<std::unordered_map<unsigned int,
+                std::pair<ROIs_T, LRU_T::iterator> >::iterator, bool> ret
+                    = mCache.insert(std::make_pair(entry,
+                        std::make_pair(ROIs, mLRU.end())));
+
+            if (ret.second) {
+                mLRU.push_front(entry);
+                (*ret.first).second.second = mLRU.begin();
+                evict();
+            }
+            else {
+                // Created concurrently by another thread
+                ROIs = (*ret.first).second.first;
+            }
+        }
+    }
+
+    return ROIs;
+}
+
+void N2D2::ROIPool::setCacheSize(unsigned int cacheSize)
+{
+    mCacheSize = cacheSize;
+    evict();
+}
+
+void N2D2::ROIPool::clear()
+{
+    mEntries.clear();
+    mStorage = Storage();
+    mErasedRecords = 0;
+    mDeferred.clear();
+
+    mLRU.clear();
+    mCache.clear();
+}
+
+void N2D2::ROIPool::Storage::append(const std::vector<ROI*>& ROIs)
+{
+    for (std::vector<ROI*>::const_iterator it = ROIs.begin(),
+         itEnd = ROIs.end(); it != itEnd; ++it)
+    {
+        Record record;
+        record.label = (*it)->getLabel();
+
+        if (typeid(*(*it)) == typeid(EllipticROI<int>)) {
+            const EllipticROI<int>* roi
+                = static_cast<const EllipticROI<int>*>(*it);
+
+            record.type = Elliptic;
+            record.size = 0;
+            record.offset = ellipses.size();
+
+            ellipses.push_back(roi->center.x);
+            ellipses.push_back(roi->center.y);
+            ellipses.push_back(roi->majorRadius);
+            ellipses.push_back(roi->minorRadius);
+            ellipses.push_back(roi->angle);
+        }
+        else {
+            // RectangularROI<int> is a PolygonalROI<int>, only its points are
+            // stored
+            const PolygonalROI<int>* roi
+                = dynamic_cast<const PolygonalROI<int>*>(*it);
+
+            record.type = (typeid(*(*it)) == typeid(RectangularROI<int>))
+                ? Rectangular : Polygonal;
+            record.size = roi->points.size();
+            record.offset = points.size();
+
+            for (std::vector<cv::Point>::const_iterator itPoint
+                 = roi->points.begin(), itPointEnd = roi->points.end();
+                 itPoint != itPointEnd; ++itPoint)
+            {
+                points.push_back((*itPoint).x);
+                points.push_back((*itPoint).y);
+            }
+        }
+
+        records.push_back(record);
+    }
+}
+
+void N2D2::ROIPool::Storage::append(const Storage& storage,
+                                    std::size_t first,
+                                    std::size_t size)
+{
+    for (std::size_t r = first; r < first + size; ++r) {
+        Record record = storage.records[r];
+
+        if (record.type == Elliptic) {
+            record.offset = ellipses.size();
+            ellipses.insert(ellipses.end(),
+                storage.ellipses.begin() + storage.records[r].offset,
+                storage.ellipses.begin() + storage.records[r].offset + 5);
+        }
+        else {
+            record.offset = points.size();
+            points.insert(points.end(),
+                storage.points.begin() + storage.records[r].offset,
+                storage.points.begin() + storage.records[r].offset
+                    + 2 * record.size);
+        }
+
+        records.push_back(record);
+    }
+}
+
+std::vector<N2D2::ROI*> N2D2::ROIPool::Storage::create(std::size_t first,
+                                                       std::size_t size) const
+{
+    std::vector<ROI*> ROIs;
+    ROIs.reserve(size);
+
+    for (std::size_t r = first; r < first + size; ++r) {
+        const Record& record = records[r];
+
+        if (record.type == Elliptic) {
+            const double* ellipse = &ellipses[record.offset];
+
+            ROIs.push_back(new EllipticROI<int>(record.label,
+                cv::Point((int)ellipse[0], (int)ellipse[1]),
+                ellipse[2], ellipse[3], ellipse[4]));
+            continue;
+        }
+
+        std::vector<cv::Point> pts(record.size);
+
+        for (unsigned int p = 0; p < record.size; ++p) {
+            pts[p] = cv::Point(points[record.offset + 2 * p],
+                               points[record.offset + 2 * p + 1]);
+        }
+
+        if (record.type == Rectangular) {
+            // The points are restored as is, whatever the original
+            // constructor arguments
+            RectangularROI<int>* roi = new RectangularROI<int>(record.label,
+                cv::Point(0, 0), cv::Point(0, 0));
+            roi->points.swap(pts);
+            ROIs.push_back(roi);
+        }
+        else
+            ROIs.push_back(new PolygonalROI<int>(record.label, pts));
+    }
+
+    return ROIs;
+}
+
+void N2D2::ROIPool::DeleteROIs::operator()(const std::vector<ROI*>* ROIs)
+    const
+{
+    for (std::vector<ROI*>::const_iterator it = ROIs->begin(),
+         itEnd = ROIs->end(); it != itEnd; ++it)
+    {
+        delete (*it);
+    }
+
+    delete ROIs;
+}
+
+std::shared_ptr<const N2D2::ROIPool::Storage>
+N2D2::ROIPool::getDeferred(unsigned int entry) const
+{
+    const std::shared_ptr<const Storage> storage
+        = std::atomic_load(&mDeferred[mEntries[entry].first]);
+
+    if (!storage) {
+        throw std::runtime_error("ROIPool: the ROIs of a deferred entry were"
+                                 " not assigned");
+    }
+
+    return storage;
+}
+
+void N2D2::ROIPool::evict() const
+{
+    // Entries still in use keep their ROI objects alive through their
+    // shared pointer
+    while (mLRU.size() > mCacheSize) {
+        mCache.erase(mLRU.back());
+        mLRU.pop_back();
+    }
+}
+
+void N2D2::ROIPool::compact()
+{
+    // Cached ROI objects do not refer to the storage and stay valid
+    Storage storage;
+    storage.records.reserve(mStorage.records.size() - mErasedRecords);
+
+    for (std::vector<Entry>::iterator it = mEntries.begin(),
+         itEnd = mEntries.end(); it != itEnd; ++it)
+    {
+        if (!(*it).deferred) {
+            const std::size_t first = storage.records.size();
+            storage.append(mStorage, (*it).first, (*it).size);
+            (*it).first = first;
+        }
+    }
+
+    mStorage.records.swap(storage.records);
+    mStorage.points.swap(storage.points);
+    mStorage.ellipses.swap(storage.ellipses);
+    mErasedRecords = 0;
+}
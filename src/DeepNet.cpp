@@ -40,6 +40,8 @@
 #include "utils/Utils.hpp"
 #include "Solver/Solver.hpp"
 
+#include <set>
+
 N2D2::DeepNet::DeepNet(Network& net)
     : mName(this, "Name", ""),
       mNet(net),
@@ -792,6 +794,57 @@ std::shared_ptr<N2D2::CMonitor> N2D2::DeepNet::getCMonitor(const std::string
     return (*it).second;
 }
 
+void N2D2::DeepNet::setLayers(
+    const std::vector<std::vector<std::string> >& layers)
+{
+    if (layers.empty() || layers[0] != std::vector<std::string>(1, "env")) {
+        throw std::runtime_error("DeepNet::setLayers(): the first layer must "
+                                 "be \"env\"");
+    }
+
+    std::set<std::string> placed;
+    placed.insert("env");
+
+    for (std::vector<std::vector<std::string> >::const_iterator itLayer
+         = layers.begin() + 1, itLayerEnd = layers.end();
+         itLayer != itLayerEnd; ++itLayer)
+    {
+        for (std::vector<std::string>::const_iterator it = (*itLayer).begin(),
+             itEnd = (*itLayer).end(); it != itEnd; ++it)
+        {
+            if (!hasCell(*it) || placed.find(*it) != placed.end()) {
+                throw std::runtime_error("DeepNet::setLayers(): cell \""
+                    + (*it) + "\" is unknown or appears more than once");
+            }
+
+            const std::pair<std::multimap<std::string, std::string>
+                ::const_iterator, std::multimap<std::string, std::string>
+                    ::const_iterator> parents = mParentLayers.equal_range(*it);
+
+            for (std::multimap<std::string, std::string>::const_iterator
+                 itParent = parents.first; itParent != parents.second;
+                 ++itParent)
+            {
+                if (placed.find((*itParent).second) == placed.end()) {
+                    throw std::runtime_error("DeepNet::setLayers(): cell \""
+                        + (*it) + "\" is placed before its parent \""
+                        + (*itParent).second + "\"");
+                }
+            }
+        }
+
+        // Cells of a same layer cannot depend on each other
+        placed.insert((*itLayer).begin(), (*itLayer).end());
+    }
+
+    if (placed.size() != mCells.size() + 1) {
+        throw std::runtime_error("DeepNet::setLayers(): some cells are "
+                                 "missing in the layers");
+    }
+
+    mLayers = layers;
+}
+
 bool N2D2::DeepNet::hasCell(const std::string& name) const {
     return mCells.find(name) != mCells.end();
 }
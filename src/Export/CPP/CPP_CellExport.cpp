@@ -193,6 +193,11 @@ void N2D2::CPP_CellExport::generateBenchmarkStart(const DeepNet& /*deepNet*/,
     functionCalls << "#ifdef BENCHMARK\n"
         "    const Tick_T start_" << identifier << " = tick();\n"
         "#endif\n\n";
+
+    // functionCalls: start profiling
+    functionCalls << "#ifdef PROFILING\n"
+        "    const Cycle_T start_cycles_" << identifier << " = cycles();\n"
+        "#endif\n\n";
 }
 
 void N2D2::CPP_CellExport::generateBenchmarkEnd(const DeepNet& /*deepNet*/,
@@ -208,6 +213,19 @@ void N2D2::CPP_CellExport::generateBenchmarkEnd(const DeepNet& /*deepNet*/,
         "    benchmark(\"" << identifier << "\", start_" << identifier
         << ", end_" << identifier << ", " << identifier << "_timing);\n"
         "#endif\n\n";
+
+    // functionCalls: stop profiling, with the number of MACs and an estimate
+    // of the memory touched (inputs, outputs and parameters, read once)
+    Cell::Stats stats;
+    cell.getStats(stats);
+
+    functionCalls << "#ifdef PROFILING\n"
+        "    profile(\"" << identifier << "\", start_cycles_" << identifier
+            << ", cycles(), " << stats.nbConnections << "ULL, "
+            << (cell.getInputsSize() + cell.getOutputsSize()) << "ULL"
+                << "*sizeof(DATA_T) + "
+            << stats.nbSynapses << "ULL*sizeof(WDATA_T));\n"
+        "#endif\n\n";
 }
 
 void N2D2::CPP_CellExport::generateSaveOutputs(const DeepNet& /*deepNet*/,
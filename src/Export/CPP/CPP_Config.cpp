@@ -25,3 +25,15 @@ const int N2D2::CPP_Config::MEMORY_ALIGNMENT_DEFAULT = 1;
 
 const std::string N2D2::CPP_Config::MEMORY_MANAGER_STRATEGY = "MemoryManagerStrategy";
 const N2D2::MemoryManager::OptimizeStrategy N2D2::CPP_Config::MEMORY_MANAGER_STRATEGY_DEFAULT = N2D2::MemoryManager::OptimizeMaxLifetimeMaxSizeFirst;
+
+const std::string N2D2::CPP_Config::OPTIMIZE_EXECUTION_ORDER = "OptimizeExecutionOrder";
+const bool N2D2::CPP_Config::OPTIMIZE_EXECUTION_ORDER_DEFAULT = false;
+
+const std::string N2D2::CPP_Config::EXECUTION_ORDER_BEAM_WIDTH = "ExecutionOrderBeamWidth";
+const unsigned int N2D2::CPP_Config::EXECUTION_ORDER_BEAM_WIDTH_DEFAULT = 64;
+
+const std::string N2D2::CPP_Config::SPARSE_WEIGHTS_THRESHOLD = "SparseWeightsThreshold";
+const double N2D2::CPP_Config::SPARSE_WEIGHTS_THRESHOLD_DEFAULT = 0.5;
+
+const std::string N2D2::CPP_Config::SPARSE_WEIGHTS_BLOCK_SIZE = "SparseWeightsBlockSize";
+const unsigned int N2D2::CPP_Config::SPARSE_WEIGHTS_BLOCK_SIZE_DEFAULT = 4;
@@ -44,6 +44,53 @@
 #include "utils/IniParser.hpp"
 #include "utils/Registrar.hpp"
 
+namespace {
+// Partial execution order of the cells, for the execution order search
+struct ExecState {
+    std::vector<char> done;
+    // Number of consumers not yet executed, for each cell outputs
+    std::vector<unsigned int> pending;
+    std::vector<unsigned int> order;
+    size_t live;
+    size_t peak;
+
+    bool operator<(const ExecState& other) const {
+        return (peak < other.peak
+                || (peak == other.peak && live < other.live));
+    }
+};
+
+// Cells graph, with the outputs size of each cell and the cells reading
+// them
+struct ExecGraph {
+    std::vector<std::string> names;
+    std::vector<size_t> sizes;
+    std::vector<std::vector<unsigned int> > parents;
+    std::vector<std::vector<unsigned int> > consumers;
+    // Buffers freed when executing a cell
+    std::vector<std::vector<unsigned int> > releases;
+    size_t envSize;
+    std::vector<unsigned int> envConsumers;
+};
+
+void execute(const ExecGraph& graph, unsigned int index, ExecState& state)
+{
+    state.done[index] = true;
+    state.order.push_back(index);
+    state.live += graph.sizes[index];
+    state.peak = std::max(state.peak, state.live);
+
+    for (std::vector<unsigned int>::const_iterator
+         it = graph.releases[index].begin(),
+         itEnd = graph.releases[index].end(); it != itEnd; ++it)
+    {
+        if (--state.pending[*it] == 0)
+            state.live -= (*it < graph.sizes.size()) ? graph.sizes[*it]
+                                                     : graph.envSize;
+    }
+}
+}
+
 N2D2::Registrar<N2D2::DeepNetExport>
 N2D2::CPP_DeepNetExport::mRegistrar(
     {"CPP", "CPP_ASMP", "CPP_STM32", "CPP_HLS"},
@@ -83,14 +130,30 @@ void N2D2::CPP_DeepNetExport::generate(DeepNet& deepNet,
         CPP_Config::MEMORY_ALIGNMENT,
         CPP_Config::MEMORY_ALIGNMENT_DEFAULT);
 
+    const MemoryManager::OptimizeStrategy memoryManagerStrategy
+        = exportParams.getProperty<MemoryManager::OptimizeStrategy>(
+            CPP_Config::MEMORY_MANAGER_STRATEGY,
+            CPP_Config::MEMORY_MANAGER_STRATEGY_DEFAULT);
+
+    const bool optimizeExecOrder = exportParams.getProperty(
+        CPP_Config::OPTIMIZE_EXECUTION_ORDER,
+        CPP_Config::OPTIMIZE_EXECUTION_ORDER_DEFAULT);
+
+    if (optimizeExecOrder) {
+        optimizeExecutionOrder(deepNet, wrapAroundBuffer, noBranchConcatOpt,
+            includeInputInBuffer, memoryAlignment, memoryManagerStrategy,
+            exportParams.getProperty(
+                CPP_Config::EXECUTION_ORDER_BEAM_WIDTH,
+                CPP_Config::EXECUTION_ORDER_BEAM_WIDTH_DEFAULT),
+            dirName + "/execution_order.log");
+    }
+
     MemoryManager memManager = generateMemory(deepNet, wrapAroundBuffer,
                     noBranchConcatOpt, includeInputInBuffer, memoryAlignment);
 
     DrawNet::drawGraph(deepNet, dirName + "/graph");
 
-    memManager.optimize(exportParams.getProperty<MemoryManager::OptimizeStrategy>
-        (CPP_Config::MEMORY_MANAGER_STRATEGY,
-        CPP_Config::MEMORY_MANAGER_STRATEGY_DEFAULT));
+    memManager.optimize(memoryManagerStrategy);
 
     memManager.log(dirName + "/memory_mapping.log");
 
@@ -108,7 +171,8 @@ N2D2::MemoryManager N2D2::CPP_DeepNetExport::generateMemory(
     bool wrapAroundBuffer,
     bool noBranchConcatOpt,
     bool includeInputInBuffer,
-    int memoryAlignment)
+    int memoryAlignment,
+    bool removeNoBranchConcats)
 {
     MemoryManager memManager;
 
@@ -424,17 +488,279 @@ N2D2::MemoryManager N2D2::CPP_DeepNetExport::generateMemory(
     }
 
     // Remove noBranchConcats cells
-    for (std::map<std::shared_ptr<Cell>, MemoryManager::MemoryPlane>
-        ::const_iterator itConcat = noBranchConcats.begin(),
-        itConcatEnd = noBranchConcats.end();
-        itConcat != itConcatEnd; ++itConcat)
-    {
-        deepNet.removeCell((*itConcat).first);
+    if (removeNoBranchConcats) {
+        for (std::map<std::shared_ptr<Cell>, MemoryManager::MemoryPlane>
+            ::const_iterator itConcat = noBranchConcats.begin(),
+            itConcatEnd = noBranchConcats.end();
+            itConcat != itConcatEnd; ++itConcat)
+        {
+            deepNet.removeCell((*itConcat).first);
+        }
     }
 
     return memManager;
 }
 
+/**
+ * Search a cells execution order that minimizes the peak memory usage.
+ * The search is a beam search over the partial execution orders, guided by
+ * the memory needed to keep alive the outputs of the cells that still have
+ * consumers to execute. Partial orders executing the same set of cells are
+ * merged (they have the same live memory), keeping the one with the lowest
+ * peak. Reshape cells outputs are views of their input and occupy no memory.
+ * The searched order and the current layers order are then both mapped with
+ * generateMemory() and the MemoryManager @p strategy. If the searched order
+ * has the lowest MemoryManager peak usage, the layers are replaced by one
+ * cell per layer in this order, which is then followed by the memory mapping
+ * and the generated propagate code. Otherwise, the layers are unchanged.
+ * Both peak usages and the selected order are written to @p logFileName.
+ * Returns true if the layers were replaced.
+*/
+bool N2D2::CPP_DeepNetExport::optimizeExecutionOrder(
+    DeepNet& deepNet,
+    bool wrapAroundBuffer,
+    bool noBranchConcatOpt,
+    bool includeInputInBuffer,
+    int memoryAlignment,
+    MemoryManager::OptimizeStrategy strategy,
+    unsigned int beamWidth,
+    const std::string& logFileName)
+{
+    const std::vector<std::vector<std::string> >& layers = deepNet.getLayers();
+
+    ExecGraph graph;
+    std::map<std::string, unsigned int> indexes;
+
+    for (std::vector<std::vector<std::string> >::const_iterator itLayer
+        = layers.begin() + 1,
+        itLayerEnd = layers.end(); itLayer != itLayerEnd; ++itLayer)
+    {
+        for (std::vector<std::string>::const_iterator it = (*itLayer).begin(),
+            itEnd = (*itLayer).end();
+            it != itEnd; ++it)
+        {
+            const std::shared_ptr<Cell> cell = deepNet.getCell(*it);
+            const size_t size = (cell->getNbOutputs() > 1)
+                ? memoryAlignment * (size_t)std::ceil(cell->getNbOutputs()
+                                                / (double)memoryAlignment) : 1;
+
+            indexes[*it] = graph.names.size();
+            graph.names.push_back(*it);
+            graph.sizes.push_back((cell->getType() == ReshapeCell::Type)
+                ? 0 : size * cell->getOutputsWidth()
+                        * cell->getOutputsHeight());
+        }
+    }
+
+    const unsigned int nbCells = graph.names.size();
+
+    if (nbCells < 2)
+        return false;
+
+    // Index nbCells stands for the env
+    graph.parents.resize(nbCells);
+    graph.consumers.resize(nbCells + 1);
+    graph.releases.resize(nbCells);
+    graph.envSize = 0;
+
+    if (includeInputInBuffer) {
+        const std::shared_ptr<StimuliProvider>& sp
+            = deepNet.getStimuliProvider();
+        const size_t nbChannelsAligned = (sp->getNbChannels() > 1)
+            ? memoryAlignment * (size_t)std::ceil(sp->getNbChannels()
+                                                / (double)memoryAlignment) : 1;
+
+        graph.envSize = nbChannelsAligned * sp->getSizeX() * sp->getSizeY();
+    }
+
+    for (unsigned int index = 0; index < nbCells; ++index) {
+        const std::vector<std::shared_ptr<Cell> > parents
+            = deepNet.getParentCells(graph.names[index]);
+
+        for (std::vector<std::shared_ptr<Cell> >::const_iterator
+            itParent = parents.begin(), itParentEnd = parents.end();
+            itParent != itParentEnd; ++itParent)
+        {
+            const unsigned int parent = (*itParent)
+                ? indexes.at((*itParent)->getName()) : nbCells;
+
+            if (parent < nbCells)
+                graph.parents[index].push_back(parent);
+
+            graph.consumers[parent].push_back(index);
+        }
+    }
+
+    // The outputs of a Reshape cell parent stay alive as long as the Reshape
+    // cell outputs are read
+    for (unsigned int buffer = 0; buffer <= nbCells; ++buffer) {
+        std::vector<unsigned int>& consumers = graph.consumers[buffer];
+
+        for (unsigned int c = 0; c < consumers.size(); ) {
+            const unsigned int consumer = consumers[c];
+
+            if (graph.sizes[consumer] == 0
+                && !graph.consumers[consumer].empty())
+            {
+                consumers.erase(consumers.begin() + c);
+                consumers.insert(consumers.end(),
+                                 graph.consumers[consumer].begin(),
+                                 graph.consumers[consumer].end());
+            }
+            else
+                ++c;
+        }
+
+        std::sort(consumers.begin(), consumers.end());
+        consumers.erase(std::unique(consumers.begin(), consumers.end()),
+                        consumers.end());
+
+        for (std::vector<unsigned int>::const_iterator
+             it = consumers.begin(), itEnd = consumers.end();
+             it != itEnd; ++it)
+        {
+            graph.releases[*it].push_back(buffer);
+        }
+    }
+
+    ExecState initState;
+    initState.done.assign(nbCells, false);
+    initState.pending.resize(nbCells + 1);
+
+    for (unsigned int buffer = 0; buffer <= nbCells; ++buffer)
+        initState.pending[buffer] = graph.consumers[buffer].size();
+
+    initState.live = (graph.consumers[nbCells].empty()) ? 0 : graph.envSize;
+    initState.peak = initState.live;
+
+    // Current layers order
+    ExecState layersState = initState;
+
+    for (unsigned int index = 0; index < nbCells; ++index)
+        execute(graph, index, layersState);
+
+    // Beam search
+    std::vector<ExecState> beam(1, initState);
+
+    for (unsigned int step = 0; step < nbCells; ++step) {
+        std::map<std::vector<char>, ExecState> candidates;
+
+        for (std::vector<ExecState>::const_iterator itState = beam.begin(),
+             itStateEnd = beam.end(); itState != itStateEnd; ++itState)
+        {
+            for (unsigned int index = 0; index < nbCells; ++index) {
+                if ((*itState).done[index])
+                    continue;
+
+                bool ready = true;
+
+                for (std::vector<unsigned int>::const_iterator
+                     itParent = graph.parents[index].begin(),
+                     itParentEnd = graph.parents[index].end();
+                     itParent != itParentEnd; ++itParent)
+                {
+                    if (!(*itState).done[*itParent]) {
+                        ready = false;
+                        break;
+                    }
+                }
+
+                if (!ready)
+                    continue;
+
+                ExecState state = (*itState);
+                execute(graph, index, state);
+
+                std::map<std::vector<char>, ExecState>::iterator itCandidate
+                    = candidates.find(state.done);
+
+                if (itCandidate == candidates.end())
+                    candidates.insert(std::make_pair(state.done, state));
+                else if (state < (*itCandidate).second)
+                    (*itCandidate).second = state;
+            }
+        }
+
+        beam.clear();
+
+        for (std::map<std::vector<char>, ExecState>::const_iterator
+             it = candidates.begin(), itEnd = candidates.end();
+             it != itEnd; ++it)
+        {
+            beam.push_back((*it).second);
+        }
+
+        std::stable_sort(beam.begin(), beam.end());
+
+        if (beam.size() > beamWidth)
+            beam.resize(std::max(1U, beamWidth));
+    }
+
+    const ExecState& bestState = beam.front();
+
+    std::vector<std::vector<std::string> > orderedLayers(1,
+        std::vector<std::string>(1, "env"));
+
+    for (std::vector<unsigned int>::const_iterator
+         it = bestState.order.begin(), itEnd = bestState.order.end();
+         it != itEnd; ++it)
+    {
+        orderedLayers.push_back(std::vector<std::string>(1, graph.names[*it]));
+    }
+
+    // Map both orders with the MemoryManager, without removing the no-branch
+    // concatenation cells, which is done by the final generateMemory()
+    const std::vector<std::vector<std::string> > layersCopy = layers;
+    unsigned int peakUsages[2];
+
+    for (unsigned int candidate = 0; candidate < 2; ++candidate) {
+        deepNet.setLayers((candidate == 0) ? layersCopy : orderedLayers);
+
+        MemoryManager memManager = generateMemory(deepNet, wrapAroundBuffer,
+            noBranchConcatOpt, includeInputInBuffer, memoryAlignment, false);
+        memManager.optimize(strategy);
+        peakUsages[candidate] = memManager.getPeakUsage();
+    }
+
+    const bool searchedOrder = (peakUsages[1] < peakUsages[0]);
+
+    if (!searchedOrder)
+        deepNet.setLayers(layersCopy);
+
+    const double kiB = std::abs(CellExport::mPrecision) / 8.0 / 1024.0;
+
+    std::cout << "Execution order search: peak buffer usage "
+        << peakUsages[0] * kiB << " KiB with layers order, "
+        << peakUsages[1] * kiB << " KiB with searched order, "
+        << ((searchedOrder) ? "searched" : "layers") << " order kept."
+        << std::endl;
+
+    if (!logFileName.empty()) {
+        std::ofstream log(logFileName.c_str());
+
+        if (!log.good()) {
+            throw std::runtime_error("Could not create execution order log "
+                                     "file: " + logFileName);
+        }
+
+        log << "# Peak buffer usage (MemoryManager, in words)\n"
+            "Layers order: " << peakUsages[0] << "\n"
+            "Searched order: " << peakUsages[1] << "\n"
+            "Kept order: " << ((searchedOrder) ? "searched" : "layers") << "\n"
+            "\n"
+            "# Searched order\n";
+
+        for (std::vector<unsigned int>::const_iterator
+             it = bestState.order.begin(), itEnd = bestState.order.end();
+             it != itEnd; ++it)
+        {
+            log << graph.names[*it] << "\n";
+        }
+    }
+
+    return searchedOrder;
+}
+
 void N2D2::CPP_DeepNetExport::addBranchesCells(DeepNet& deepNet) {
     // Need a copy of layers as we will modify the deepNet during the iteration.
     const std::vector<std::vector<std::string>> layers = deepNet.getLayers();
@@ -991,11 +1317,11 @@ void N2D2::CPP_DeepNetExport::printStats(const DeepNet& deepNet,
     }
 
     std::cout << "\nEstimated intermediate buffer usage: " << 
-        memManager.getPeakUsage()*(std::abs(CellExport::mPrecision)/8)/1024.0 
+        memManager.getPeakUsage()*(std::abs(CellExport::mPrecision)/8.0)/1024.0 
         << " KiB." << std::endl;
     
     std::cout << "Estimated weights and constants usage: " << 
-        globalStats.nbSynapses*(std::abs(CellExport::mPrecision)/8)/1024.0 
+        globalStats.nbSynapses*(std::abs(CellExport::mPrecision)/8.0)/1024.0 
         << " KiB.\n" << std::endl;
 }
 
@@ -25,11 +25,16 @@
 #include "Export/DeepNetExport.hpp"
 #include "Export/CPP/CPP_ConvCellExport.hpp"
 #include "Export/CPP/CPP_CellExport.hpp"
+#include "Export/CPP/CPP_Config.hpp"
 #include "Export/CPP/CPP_FcCellExport.hpp"
 #include "Export/CPP/CPP_DeepNetExport.hpp"
+#include "utils/IniParser.hpp"
 #include "utils/Registrar.hpp"
 #include "utils/Utils.hpp"
 
+std::map<std::string, std::size_t>
+N2D2::CPP_FcCellExport::mSparseBlockSizes;
+
 N2D2::Registrar<N2D2::FcCellExport> N2D2::CPP_FcCellExport::mRegistrar(
     {"CPP", "CPP_ASMP", "CPP_STM32", "CPP_HLS"},
     N2D2::CPP_FcCellExport::generate);
@@ -48,6 +53,9 @@ void N2D2::CPP_FcCellExport::generate(const FcCell& cell, const std::string& dir
         throw std::runtime_error("Could not create CPP header file: " + fileName);
     }
 
+    // The weights may have changed since a previous export
+    mSparseBlockSizes.erase(cell.getName());
+
     CPP_CellExport::generateHeaderBegin(cell, header);
     CPP_CellExport::generateHeaderIncludes(cell, header);
     generateHeaderConstants(cell, header);
@@ -81,9 +89,15 @@ void N2D2::CPP_FcCellExport::generateHeaderConstants(const FcCell& cell, std::of
 void N2D2::CPP_FcCellExport::generateHeaderFreeParameters(const FcCell & cell, std::ofstream& header) {
     generateHeaderBias(cell, header);
 
+    const std::size_t blockSize = (mThreshold > 0.0)
+        ? 0 : getSparseBlockSize(cell);
+
     if (mThreshold > 0.0) {
         generateHeaderWeightsSparse(cell, header);
     }
+    else if (blockSize > 0) {
+        generateHeaderWeightsBlockSparse(cell, header, blockSize);
+    }
     else {
         generateHeaderWeights(cell, header);
     }
@@ -171,6 +185,207 @@ void N2D2::CPP_FcCellExport::generateHeaderWeights(const FcCell & cell, std::ofs
     header << "};\n\n";
 }
 
+void N2D2::CPP_FcCellExport::generateHeaderWeightsBlockSparse(
+    const FcCell & cell,
+    std::ofstream& header,
+    std::size_t blockSize)
+{
+    const std::string identifier = Utils::CIdentifier(cell.getName());
+    const std::string prefix = Utils::upperCase(identifier);
+    const std::size_t channelsSize = cell.getNbChannels()
+                                      * cell.getChannelsWidth()
+                                      * cell.getChannelsHeight();
+    const std::size_t nbColBlocks = channelsSize / blockSize;
+
+    const std::vector<double> weights = getWeightsOHWC(cell);
+
+    std::vector<double> blocks;
+    std::vector<std::size_t> rowPtr(1, 0);
+    std::vector<std::size_t> blockIdx;
+
+    for (std::size_t output = 0; output < cell.getNbOutputs(); ++output) {
+        for (std::size_t col = 0; col < nbColBlocks; ++col) {
+            std::vector<double>::const_iterator itBegin = weights.begin()
+                + output * channelsSize + col * blockSize;
+            std::vector<double>::const_iterator itEnd = itBegin + blockSize;
+
+            if (std::any_of(itBegin, itEnd,
+                            [](double w) { return (w != 0.0); }))
+            {
+                blocks.insert(blocks.end(), itBegin, itEnd);
+                blockIdx.push_back(col);
+            }
+        }
+
+        rowPtr.push_back(blockIdx.size());
+    }
+
+    const std::size_t nbBlocks = blockIdx.size();
+
+    header << "#define " << prefix << "_WEIGHTS_BLOCK_SIZE " << blockSize
+                                                                << "\n"
+           << "#define " << prefix << "_WEIGHTS_NB_BLOCKS " << nbBlocks << "\n"
+           << "#define " << prefix << "_WEIGHTS_SIZE (" 
+               << prefix << "_WEIGHTS_NB_BLOCKS*"
+               << prefix << "_WEIGHTS_BLOCK_SIZE)\n\n";
+
+    header << "// Block-sparse (BCSR) weights. Each row [OUTPUTS_SIZE] is split "
+               << "in blocks of WEIGHTS_BLOCK_SIZE consecutive weights, in the "
+               << "[CHANNELS_HEIGHT][CHANNELS_WIDTH][NB_CHANNELS] order.\n"
+           << "// Only the non-zero blocks are stored: the blocks of output o "
+               << "are [weights_row_ptr[o], weights_row_ptr[o+1]) and "
+               << "weights_block_idx gives their position in the row.\n";
+
+    header << "static const WDATA_T " << identifier << "_weights_blocks["
+               << prefix << "_WEIGHTS_SIZE"
+           << "] N2D2_SECTION_ATTRIBUTE(N2D2_SECTION_NN_WEIGHTS) = {\n";
+
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        CellExport::generateFreeParameter(blocks[i], header);
+        header << ", ";
+
+        if ((i + 1) % 30 == 0)
+            header << "\n";
+    }
+
+    header << "};\n\n";
+
+    header << "static const unsigned int " << identifier << "_weights_row_ptr["
+               << prefix << "_NB_OUTPUTS + 1"
+           << "] N2D2_SECTION_ATTRIBUTE(N2D2_SECTION_NN_WEIGHTS) = {\n";
+
+    for (std::size_t i = 0; i < rowPtr.size(); ++i) {
+        header << rowPtr[i] << ", ";
+
+        if ((i + 1) % 30 == 0)
+            header << "\n";
+    }
+
+    header << "};\n\n";
+
+    header << "static const "
+               << ((nbColBlocks <= 65536) ? "unsigned short" : "unsigned int")
+               << " " << identifier << "_weights_block_idx["
+               << prefix << "_WEIGHTS_NB_BLOCKS"
+           << "] N2D2_SECTION_ATTRIBUTE(N2D2_SECTION_NN_WEIGHTS) = {\n";
+
+    for (std::size_t i = 0; i < nbBlocks; ++i) {
+        header << blockIdx[i] << ", ";
+
+        if ((i + 1) % 30 == 0)
+            header << "\n";
+    }
+
+    header << "};\n\n";
+
+    std::cout << Utils::cnotice << "Block-sparse weights ratio for "
+              << cell.getName() << ": " << nbBlocks << "/"
+              << (cell.getNbOutputs() * nbColBlocks) << " blocks of "
+              << blockSize << " ("
+              << 100.0 * (nbBlocks / (double)(cell.getNbOutputs() * nbColBlocks))
+              << "%)" << Utils::cdef << std::endl;
+}
+
+std::vector<double> N2D2::CPP_FcCellExport::getWeightsOHWC(const FcCell& cell)
+{
+    const Cell_Frame_Top* cellFrame
+        = dynamic_cast<const Cell_Frame_Top*>(&cell);
+
+    if (cellFrame != NULL)
+        cellFrame->synchronizeToH(false);
+
+    std::vector<double> weights;
+    weights.reserve(cell.getNbOutputs() * cell.getNbChannels()
+                    * cell.getChannelsHeight() * cell.getChannelsWidth());
+
+    Tensor<double> weight;
+
+    for (std::size_t output = 0; output < cell.getNbOutputs(); output++) {
+        for (std::size_t h = 0; h < cell.getChannelsHeight(); h++) {
+            for (std::size_t w = 0; w < cell.getChannelsWidth(); w++) {
+                for (std::size_t ch = 0; ch < cell.getNbChannels(); ch++) {
+                    const std::size_t wch = ch*cell.getChannelsHeight()*cell.getChannelsWidth() + 
+                                            h*cell.getChannelsWidth() + 
+                                            w;
+
+                    cell.getWeight(output, wch, weight);
+                    weights.push_back(weight(0));
+                }
+            }
+        }
+    }
+
+    if (cellFrame != NULL)
+        cellFrame->keepInSync(true);
+
+    return weights;
+}
+
+/**
+ * Return the block size of the cell, computed on first use: the header and
+ * the call code of a cell must agree on the weights format.
+ */
+std::size_t N2D2::CPP_FcCellExport::getSparseBlockSize(const FcCell& cell) {
+    std::map<std::string, std::size_t>::const_iterator it
+        = mSparseBlockSizes.find(cell.getName());
+
+    if (it == mSparseBlockSizes.end()) {
+        it = mSparseBlockSizes.insert(std::make_pair(cell.getName(),
+                                    computeSparseBlockSize(cell))).first;
+    }
+
+    return (*it).second;
+}
+
+/**
+ * Return the block size to use for the block-sparse weights format, or 0 if
+ * the weights of the cell are not sparse enough and must be exported dense.
+ * A block never crosses a pixel boundary, so that it is contiguous in the
+ * HWC input memory, including with wrapping or strided buffers.
+ */
+std::size_t N2D2::CPP_FcCellExport::computeSparseBlockSize(const FcCell& cell)
+{
+    IniParser exportParams;
+
+    if(!DeepNetExport::mExportParameters.empty())
+        exportParams.load(DeepNetExport::mExportParameters);
+
+    const double threshold = exportParams.getProperty(
+        CPP_Config::SPARSE_WEIGHTS_THRESHOLD,
+        CPP_Config::SPARSE_WEIGHTS_THRESHOLD_DEFAULT);
+    const unsigned int maxBlockSize = exportParams.getProperty(
+        CPP_Config::SPARSE_WEIGHTS_BLOCK_SIZE,
+        CPP_Config::SPARSE_WEIGHTS_BLOCK_SIZE_DEFAULT);
+
+    if (threshold > 1.0 || maxBlockSize == 0)
+        return 0;
+
+    std::size_t blockSize = 1;
+
+    while (2 * blockSize <= maxBlockSize
+        && cell.getNbChannels() % (2 * blockSize) == 0)
+    {
+        blockSize *= 2;
+    }
+
+    const std::vector<double> weights = getWeightsOHWC(cell);
+    const std::size_t nbBlocks = weights.size() / blockSize;
+    std::size_t nbZeroBlocks = 0;
+
+    for (std::size_t b = 0; b < nbBlocks; ++b) {
+        if (std::all_of(weights.begin() + b * blockSize,
+                        weights.begin() + (b + 1) * blockSize,
+                        [](double w) { return (w == 0.0); }))
+        {
+            ++nbZeroBlocks;
+        }
+    }
+
+    // An all-zero cell is kept dense, to avoid empty arrays
+    return (nbZeroBlocks < nbBlocks
+            && nbZeroBlocks >= threshold * nbBlocks) ? blockSize : 0;
+}
+
 // Legacy function, may be removed in the future
 void N2D2::CPP_FcCellExport::generateHeaderWeightsSparse(const FcCell & cell, std::ofstream& header) {
     const std::string identifier = Utils::CIdentifier(cell.getName());
@@ -258,14 +473,24 @@ void N2D2::CPP_FcCellExport::generateCallCode(
     const std::string outputBuffer
         = Utils::CIdentifier(cell.getName() + "_output");
 
-    functionCalls << "    fccellPropagate<"
+    const FcCell& fcCell = dynamic_cast<const FcCell&>(cell);
+    const bool blockSparse = (mThreshold <= 0.0
+                              && getSparseBlockSize(fcCell) > 0);
+
+    functionCalls << "    "
+                << ((blockSparse) ? "fccellSparsePropagate" : "fccellPropagate")
+                << "<"
                 << prefix << "_NB_CHANNELS, "
                 << prefix << "_CHANNELS_HEIGHT, "
                 << prefix << "_CHANNELS_WIDTH, "
                 << prefix << "_NB_OUTPUTS, "
                 << prefix << "_OUTPUTS_HEIGHT, " 
-                << prefix << "_OUTPUTS_WIDTH, "
-                << prefix << "_ACTIVATION, ";
+                << prefix << "_OUTPUTS_WIDTH, ";
+
+    if (blockSparse)
+        functionCalls << prefix << "_WEIGHTS_BLOCK_SIZE, ";
+
+    functionCalls << prefix << "_ACTIVATION, ";
 
     // Memory mapping: input
     const std::string parentIdentifier
@@ -288,9 +513,17 @@ void N2D2::CPP_FcCellExport::generateCallCode(
             << ">("
                 << inputBuffer << " , "
                 << outputBuffer << ", "
-                << identifier << "_biases, "
-                << identifier << "_weights, "
-                << prefix << "_SCALING"
+                << identifier << "_biases, ";
+
+    if (blockSparse) {
+        functionCalls << identifier << "_weights_blocks, "
+                    << identifier << "_weights_row_ptr, "
+                    << identifier << "_weights_block_idx, ";
+    }
+    else
+        functionCalls << identifier << "_weights, ";
+
+    functionCalls << prefix << "_SCALING"
             << ");\n\n";
 
     generateBenchmarkEnd(deepNet, cell, functionCalls);
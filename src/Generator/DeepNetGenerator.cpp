@@ -78,6 +78,8 @@
 #include <google/protobuf/io/coded_stream.h>
 #endif
 
+std::string N2D2::DeepNetGenerator::mIniCachePath = "";
+
 std::shared_ptr<N2D2::DeepNet>
 N2D2::DeepNetGenerator::generate(Network& network, const std::string& fileName)
 {
@@ -114,6 +116,9 @@ N2D2::DeepNetGenerator::generateFromINI(Network& network,
 {
     IniParser iniConfig;
 
+    if (!mIniCachePath.empty())
+        iniConfig.setCachePath(mIniCachePath);
+
     std::cout << "Loading network configuration file " << fileName << std::endl;
     iniConfig.load(fileName);
 
@@ -192,113 +197,160 @@ N2D2::DeepNetGenerator::generateFromINI(Network& network,
     // Construct network tree
     // std::cout << "Construct network tree..." << std::endl;
     std::map<std::string, std::vector<std::string> > parentLayers;
+    std::vector<std::vector<std::string> > layers;
 
     const std::vector<std::string> sections = iniConfig.getSections();
+    std::string topology;
 
-    for (std::vector<std::string>::const_iterator itSection = sections.begin(),
-                                                  itSectionEnd = sections.end();
-         itSection != itSectionEnd;
-         ++itSection) {
-        iniConfig.currentSection(*itSection, false);
-
-        if (iniConfig.isProperty("Input")) {
-            std::vector<std::string> inputs = Utils::split(
-                iniConfig.getProperty<std::string>("Input"), ",");
-
-            std::map<std::string, std::vector<std::string> >::iterator
-                itParent;
-            std::tie(itParent, std::ignore) = parentLayers.insert(
-                std::make_pair((*itSection), std::vector<std::string>()));
-
-            for (std::vector<std::string>::iterator it = inputs.begin(),
-                                                    itEnd = inputs.end();
-                 it != itEnd;
-                 ++it)
-            {
-                if ((*it) == "sp" || (*it) == "cenv")
-                    (*it) = "env";
+    if (iniConfig.getCacheValue("DeepNetGenerator::Topology", topology)) {
+        // One line per layer order ("L" followed by the layers) and per child
+        // layer ("P" followed by "child=parents")
+        const std::vector<std::string> lines = Utils::split(topology, "\n",
+                                                            true);
 
-                (*itParent).second.push_back((*it));
-                // std::cout << "  " << (*it) << " => " << (*itSection) <<
-                // std::endl;
+        for (std::vector<std::string>::const_iterator it = lines.begin(),
+             itEnd = lines.end(); it != itEnd; ++it)
+        {
+            if ((*it)[0] == 'L') {
+                layers.push_back(Utils::split((*it).substr(1), ",", true));
+                continue;
             }
+
+            const size_t sepPos = (*it).find('=');
+            const std::string child = (*it).substr(1, sepPos - 1);
+
+            parentLayers[child] = Utils::split((*it).substr(sepPos + 1), ",",
+                                               true);
+
+            // The "Input" property is not read from the cached tree
+            iniConfig.currentSection(child, false);
+            iniConfig.ignoreProperty("Input");
         }
     }
+    else {
+        for (std::vector<std::string>::const_iterator itSection = sections.begin(),
+                                                      itSectionEnd = sections.end();
+             itSection != itSectionEnd;
+             ++itSection) {
+            iniConfig.currentSection(*itSection, false);
+
+            if (iniConfig.isProperty("Input")) {
+                std::vector<std::string> inputs = Utils::split(
+                    iniConfig.getProperty<std::string>("Input"), ",");
+
+                std::map<std::string, std::vector<std::string> >::iterator
+                    itParent;
+                std::tie(itParent, std::ignore) = parentLayers.insert(
+                    std::make_pair((*itSection), std::vector<std::string>()));
+
+                for (std::vector<std::string>::iterator it = inputs.begin(),
+                                                        itEnd = inputs.end();
+                     it != itEnd;
+                     ++it)
+                {
+                    if ((*it) == "sp" || (*it) == "cenv")
+                        (*it) = "env";
 
-    std::vector<std::vector<std::string> > layers(
-        1, std::vector<std::string>(1, "env"));
+                    (*itParent).second.push_back((*it));
+                    // std::cout << "  " << (*it) << " => " << (*itSection) <<
+                    // std::endl;
+                }
+            }
+        }
 
-    std::map<std::string, unsigned int> layersOrder;
-    layersOrder.insert(std::make_pair("env", 0));
-    unsigned int nbOrderedLayers = 0;
-    unsigned int nbOrderedLayersNext = 1;
+        layers.assign(1, std::vector<std::string>(1, "env"));
 
-    while (nbOrderedLayers < nbOrderedLayersNext) {
-        nbOrderedLayers = nbOrderedLayersNext;
+        std::map<std::string, unsigned int> layersOrder;
+        layersOrder.insert(std::make_pair("env", 0));
+        unsigned int nbOrderedLayers = 0;
+        unsigned int nbOrderedLayersNext = 1;
 
-        // Iterate over sections instead of parentLayers to keep INI file order
-        for (std::vector<std::string>::const_iterator it = sections.begin(),
-             itEnd = sections.end(); it != itEnd; ++it)
-        {
-            const std::map<std::string, std::vector<std::string> >
-                ::const_iterator itParents = parentLayers.find(*it);
+        while (nbOrderedLayers < nbOrderedLayersNext) {
+            nbOrderedLayers = nbOrderedLayersNext;
 
-            // Skip standalone sections
-            if (itParents == parentLayers.end())
-                continue;
+            // Iterate over sections instead of parentLayers to keep INI file order
+            for (std::vector<std::string>::const_iterator it = sections.begin(),
+                 itEnd = sections.end(); it != itEnd; ++it)
+            {
+                const std::map<std::string, std::vector<std::string> >
+                    ::const_iterator itParents = parentLayers.find(*it);
 
-            unsigned int order = 0;
-            bool knownOrder = true;
+                // Skip standalone sections
+                if (itParents == parentLayers.end())
+                    continue;
 
-            for (std::vector<std::string>::const_iterator itParent
-                 = (*itParents).second.begin();
-                 itParent != (*itParents).second.end();
-                 ++itParent)
-            {
-                const std::vector<std::string>::const_iterator itSections
-                    = std::find(sections.begin(), sections.end(), (*itParent));
-
-                // If this parent is not a section, it is assumed that the order
-                // is determined by the other parents (this is the case for 
-                // ONNX)
-                if (itSections != sections.end()) {
-                    iniConfig.currentSection(*itSections, false);
-
-                    // If this parent has no "Input" property, we make the same
-                    // assumption (probably an ONNX layer for which we added
-                    // parameters)
-                    if (iniConfig.isProperty("Input")) {
-                        const std::map<std::string, unsigned int>
-                            ::const_iterator itLayer
-                                = layersOrder.find((*itParent));
-
-                        if (itLayer != layersOrder.end())
-                            order = std::max(order, (*itLayer).second);
-                        else {
-                            knownOrder = false;
-                            break;
+                unsigned int order = 0;
+                bool knownOrder = true;
+
+                for (std::vector<std::string>::const_iterator itParent
+                     = (*itParents).second.begin();
+                     itParent != (*itParents).second.end();
+                     ++itParent)
+                {
+                    const std::vector<std::string>::const_iterator itSections
+                        = std::find(sections.begin(), sections.end(), (*itParent));
+
+                    // If this parent is not a section, it is assumed that the order
+                    // is determined by the other parents (this is the case for 
+                    // ONNX)
+                    if (itSections != sections.end()) {
+                        iniConfig.currentSection(*itSections, false);
+
+                        // If this parent has no "Input" property, we make the same
+                        // assumption (probably an ONNX layer for which we added
+                        // parameters)
+                        if (iniConfig.isProperty("Input")) {
+                            const std::map<std::string, unsigned int>
+                                ::const_iterator itLayer
+                                    = layersOrder.find((*itParent));
+
+                            if (itLayer != layersOrder.end())
+                                order = std::max(order, (*itLayer).second);
+                            else {
+                                knownOrder = false;
+                                break;
+                            }
                         }
                     }
                 }
-            }
 
-            if (knownOrder) {
-                layersOrder.insert(std::make_pair((*it), order + 1));
+                if (knownOrder) {
+                    layersOrder.insert(std::make_pair((*it), order + 1));
 
-                if (order + 1 >= layers.size())
-                    layers.resize(order + 2);
+                    if (order + 1 >= layers.size())
+                        layers.resize(order + 2);
 
-                if (std::find(layers[order + 1].begin(),
-                              layers[order + 1].end(),
-                              (*it)) == layers[order + 1].end()) {
-                    layers[order + 1].push_back((*it));
-                    // std::cout << "  " << (*it) << " = " << order + 1 <<
-                    // std::endl;
+                    if (std::find(layers[order + 1].begin(),
+                                  layers[order + 1].end(),
+                                  (*it)) == layers[order + 1].end()) {
+                        layers[order + 1].push_back((*it));
+                        // std::cout << "  " << (*it) << " = " << order + 1 <<
+                        // std::endl;
 
-                    ++nbOrderedLayersNext;
+                        ++nbOrderedLayersNext;
+                    }
                 }
             }
         }
+
+        std::ostringstream topologyStr;
+
+        for (std::vector<std::vector<std::string> >::const_iterator it
+             = layers.begin(), itEnd = layers.end(); it != itEnd; ++it)
+        {
+            topologyStr << "L" << Utils::join((*it).begin(), (*it).end(), ',')
+                << "\n";
+        }
+
+        for (std::map<std::string, std::vector<std::string> >::const_iterator it
+             = parentLayers.begin(), itEnd = parentLayers.end(); it != itEnd; ++it)
+        {
+            topologyStr << "P" << (*it).first << "="
+                << Utils::join((*it).second.begin(), (*it).second.end(), ',')
+                << "\n";
+        }
+
+        iniConfig.setCacheValue("DeepNetGenerator::Topology", topologyStr.str());
     }
 
     std::set<std::string> ignoreParents;
@@ -508,6 +560,7 @@ N2D2::DeepNetGenerator::generateFromINI(Network& network,
     std::cout << "Total number of connections: " << stats.nbConnections
               << std::endl;
 
+    iniConfig.saveCache();
     return deepNet;
 }
 
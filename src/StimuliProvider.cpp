@@ -149,6 +149,7 @@ N2D2::StimuliProvider::StimuliProvider(StimuliProvider&& other)
       mBatchSize(other.mBatchSize),
       mCompositeStimuli(other.mCompositeStimuli),
       mCachePath(std::move(other.mCachePath)),
+      mCacheShards(std::move(other.mCacheShards)),
       mTransformations(other.mTransformations),
       mChannelsTransformations(std::move(other.mChannelsTransformations)),
       mProvidedData(std::move(other.mProvidedData)),
@@ -164,6 +165,7 @@ N2D2::StimuliProvider N2D2::StimuliProvider::cloneParameters() const {
     sp.mQuantizationMin = mQuantizationMin;
     sp.mQuantizationMax = mQuantizationMax;
     sp.mCachePath = mCachePath;
+    sp.mCacheShards = mCacheShards;
     sp.mTransformations = mTransformations;
     sp.mChannelsTransformations = mChannelsTransformations;
 
@@ -811,14 +813,15 @@ N2D2::StimuliProvider::getRandomID(Database::StimuliSet set)
 N2D2::Database::StimulusID
 N2D2::StimuliProvider::getRandomIDWithLabel(Database::StimuliSet set, int label)
 {
-    std::vector<Database::StimulusID> partitionWithLabel;
+    const std::vector<Database::StimulusID>& partitionWithLabel
+        = mDatabase.getStimuliWithLabel(label, set);
 
-    for (unsigned int index = 0; index < mDatabase.getNbStimuli(set); ++index) {
-        if (mDatabase.getStimulusLabel(set, index) == label
-            || mDatabase.getNbROIsWithLabel(label) > 0)
-        {
-            partitionWithLabel.push_back(mDatabase.getStimulusID(set, index));
-        }
+    if (partitionWithLabel.empty()) {
+        std::ostringstream msgStr;
+        msgStr << "StimuliProvider::getRandomIDWithLabel(): no stimulus with "
+            "label ID " << label << " in set " << set;
+
+        throw std::runtime_error(msgStr.str());
     }
 
     const unsigned int randomIdx
@@ -1008,42 +1011,25 @@ void N2D2::StimuliProvider::readStimulus(Database::StimulusID id,
     std::vector<cv::Mat> rawChannelsLabels;
 
     // 1. Cached data
-    if (!mCachePath.empty() && std::ifstream(validCacheFile.str()).good()) {
+    if (mCacheShards) {
+        // Cache packed in shards, stimuli missing from the shards are not
+        // cached
+        if (!mCacheShards->read(id, set, rawChannelsData, rawChannelsLabels))
+        {
+            loadCacheableData(id, set, rawChannelsData, rawChannelsLabels,
+                              labelsROI);
+        }
+    }
+    else if (!mCachePath.empty()
+        && std::ifstream(validCacheFile.str()).good())
+    {
         // Cache present, load the pre-processed data
         rawChannelsData = loadDataCache(dataCacheFile.str());
         rawChannelsLabels = loadDataCache(labelsCacheFile.str());
     } else {
         // Cache not present, load the raw stimuli from the database
-        cv::Mat rawData
-            = mDatabase.getStimulusData(id)
-                  .clone(); // make sure the database image will not be altered
-        cv::Mat rawLabels
-            = mDatabase.getStimulusLabelsData(id)
-                  .clone(); // make sure the database image will not be altered
-
-        // Apply global cacheable transformation
-        mTransformations(set)
-            .cacheable.apply(rawData, rawLabels, labelsROI, id);
-
-        if (mTransformations(set).onTheFly.empty()
-            && !mChannelsTransformations.empty()) {
-            // If no global on-the-fly transformation, apply the cacheable
-            // channels transformations
-            for (std::vector<TransformationsSets>::iterator it
-                 = mChannelsTransformations.begin(),
-                 itEnd = mChannelsTransformations.end();
-                 it != itEnd;
-                 ++it) {
-                cv::Mat channelData = rawData.clone();
-                cv::Mat channelLabels = rawLabels.clone();
-                (*it)(set).cacheable.apply(channelData, channelLabels, id);
-                rawChannelsData.push_back(channelData);
-                rawChannelsLabels.push_back(channelLabels);
-            }
-        } else {
-            rawChannelsData.push_back(rawData);
-            rawChannelsLabels.push_back(rawLabels);
-        }
+        loadCacheableData(id, set, rawChannelsData, rawChannelsLabels,
+                          labelsROI);
 
         // Save the pre-processed data
         if (!mCachePath.empty()) {
@@ -1624,6 +1610,71 @@ void N2D2::StimuliProvider::setCachePath(const std::string& path)
     }
 
     mCachePath = path;
+    mCacheShards = (!path.empty() && StimuliShards::exists(path))
+        ? std::make_shared<StimuliShards>(path)
+        : std::shared_ptr<StimuliShards>();
+}
+
+void N2D2::StimuliProvider::packCache(const std::string& path,
+                                      Database::StimuliSetMask setMask,
+                                      StimuliShards::Compression compression,
+                                      std::size_t shardSize)
+{
+    StimuliShards::Writer writer(path, compression, shardSize);
+
+    const std::vector<Database::StimuliSet> stimuliSets
+        = mDatabase.getStimuliSets(setMask);
+
+    // Number of stimuli processed in parallel before writing them in order
+    const int chunkSize = 1024;
+
+    for (std::vector<Database::StimuliSet>::const_iterator itSet
+         = stimuliSets.begin(), itSetEnd = stimuliSets.end();
+         itSet != itSetEnd; ++itSet)
+    {
+        const int size = mDatabase.getNbStimuli(*itSet);
+
+        std::cout << "StimuliProvider: packing " << size << " stimuli of the "
+            << (*itSet) << " set to: " << path << std::flush;
+
+        std::vector<std::vector<char> > records(chunkSize);
+
+        for (int offset = 0; offset < size; offset += chunkSize) {
+            const int end = std::min(offset + chunkSize, size);
+
+#pragma omp parallel for schedule(dynamic)
+            for (int index = offset; index < end; ++index) {
+                const Database::StimulusID id
+                    = mDatabase.getStimulusID(*itSet, index);
+
+                std::vector<std::shared_ptr<ROI> > labelsROI
+                    = mDatabase.getStimulusROIs(id);
+                std::vector<cv::Mat> rawChannelsData;
+                std::vector<cv::Mat> rawChannelsLabels;
+
+                loadCacheableData(id, *itSet, rawChannelsData,
+                                  rawChannelsLabels, labelsROI);
+
+                records[index - offset] = StimuliShards::Writer::encode(
+                    rawChannelsData, rawChannelsLabels, compression);
+            }
+
+            for (int index = offset; index < end; ++index) {
+                writer.append(mDatabase.getStimulusID(*itSet, index),
+                              *itSet, records[index - offset]);
+                std::vector<char>().swap(records[index - offset]);
+            }
+
+            std::cout << "." << std::flush;
+        }
+
+        std::cout << std::endl;
+    }
+
+    writer.close();
+
+    if (path == mCachePath)
+        setCachePath(path);
 }
 
 unsigned int
@@ -2330,6 +2381,45 @@ void N2D2::StimuliProvider::logRgbData(const std::string& fileName,
 }
 */
 
+void N2D2::StimuliProvider::loadCacheableData(
+    Database::StimulusID id,
+    Database::StimuliSet set,
+    std::vector<cv::Mat>& rawChannelsData,
+    std::vector<cv::Mat>& rawChannelsLabels,
+    std::vector<std::shared_ptr<ROI> >& labelsROI)
+{
+    cv::Mat rawData
+        = mDatabase.getStimulusData(id)
+              .clone(); // make sure the database image will not be altered
+    cv::Mat rawLabels
+        = mDatabase.getStimulusLabelsData(id)
+              .clone(); // make sure the database image will not be altered
+
+    // Apply global cacheable transformation
+    mTransformations(set)
+        .cacheable.apply(rawData, rawLabels, labelsROI, id);
+
+    if (mTransformations(set).onTheFly.empty()
+        && !mChannelsTransformations.empty()) {
+        // If no global on-the-fly transformation, apply the cacheable
+        // channels transformations
+        for (std::vector<TransformationsSets>::iterator it
+             = mChannelsTransformations.begin(),
+             itEnd = mChannelsTransformations.end();
+             it != itEnd;
+             ++it) {
+            cv::Mat channelData = rawData.clone();
+            cv::Mat channelLabels = rawLabels.clone();
+            (*it)(set).cacheable.apply(channelData, channelLabels, id);
+            rawChannelsData.push_back(channelData);
+            rawChannelsLabels.push_back(channelLabels);
+        }
+    } else {
+        rawChannelsData.push_back(rawData);
+        rawChannelsLabels.push_back(rawLabels);
+    }
+}
+
 std::vector<cv::Mat> N2D2::StimuliProvider::loadDataCache(const std::string
                                                           & fileName) const
 {
@@ -0,0 +1,394 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "StimuliShards.hpp"
+#include "utils/Utils.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <omp.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// "N2SH"
+const uint32_t ShardsMagic = 0x4853324E;
+const uint32_t ShardsVersion = 1;
+
+enum MatCodec {
+    RawCodec,
+    PngCodec
+};
+
+template <class T>
+void appendValue(std::vector<char>& buffer, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+T readValue(const unsigned char*& data, const unsigned char* end)
+{
+    if (data + sizeof(T) > end)
+        throw std::runtime_error("StimuliShards: truncated record");
+
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+void encodeMat(std::vector<char>& buffer,
+               const cv::Mat& mat,
+               N2D2::StimuliShards::Compression compression)
+{
+    const cv::Mat matCont = (mat.isContinuous()) ? mat : mat.clone();
+    const int channels = matCont.channels();
+
+    int32_t codec = RawCodec;
+    std::vector<unsigned char> encoded;
+
+    if (compression == N2D2::StimuliShards::Png
+        && !matCont.empty()
+        && (matCont.depth() == CV_8U || matCont.depth() == CV_16U)
+        && (channels == 1 || channels == 3 || channels == 4))
+    {
+        // Fastest compression level, decoding speed matters most
+        std::vector<int> params;
+        params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+        params.push_back(1);
+
+        if (cv::imencode(".png", matCont, encoded, params))
+            codec = PngCodec;
+    }
+
+    appendValue<int32_t>(buffer, matCont.rows);
+    appendValue<int32_t>(buffer, matCont.cols);
+    appendValue<int32_t>(buffer, matCont.type());
+    appendValue<int32_t>(buffer, codec);
+
+    if (codec == PngCodec) {
+        appendValue<uint64_t>(buffer, encoded.size());
+        buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    }
+    else {
+        const std::size_t size = matCont.elemSize() * matCont.rows
+                                 * matCont.cols;
+        appendValue<uint64_t>(buffer, size);
+        buffer.insert(buffer.end(),
+                      reinterpret_cast<const char*>(matCont.data),
+                      reinterpret_cast<const char*>(matCont.data) + size);
+    }
+}
+
+cv::Mat decodeMat(const unsigned char*& data, const unsigned char* end)
+{
+    const int rows = readValue<int32_t>(data, end);
+    const int cols = readValue<int32_t>(data, end);
+    const int type = readValue<int32_t>(data, end);
+    const int codec = readValue<int32_t>(data, end);
+    const std::size_t size = readValue<uint64_t>(data, end);
+
+    if (data + size > end)
+        throw std::runtime_error("StimuliShards: truncated record");
+
+    cv::Mat mat;
+
+    if (codec == PngCodec) {
+        const cv::Mat encoded(1, (int)size, CV_8UC1,
+                              const_cast<unsigned char*>(data));
+#if CV_MAJOR_VERSION >= 3
+        mat = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+#else
+        mat = cv::imdecode(encoded, CV_LOAD_IMAGE_UNCHANGED);
+#endif
+
+        if (mat.rows != rows || mat.cols != cols || mat.type() != type)
+            throw std::runtime_error("StimuliShards: corrupted PNG record");
+    }
+    else if (codec == RawCodec) {
+        mat.create(rows, cols, type);
+
+        if (mat.elemSize() * rows * cols != size)
+            throw std::runtime_error("StimuliShards: corrupted raw record");
+
+        // Copy, as the matrix is likely to be transformed in place
+        std::memcpy(mat.data, data, size);
+    }
+    else
+        throw std::runtime_error("StimuliShards: unknown record codec");
+
+    data += size;
+    return mat;
+}
+}
+
+std::size_t N2D2::StimuliShards::ReadAhead = 4 * 1024 * 1024;
+
+N2D2::StimuliShards::Writer::Writer(const std::string& path,
+                                    Compression compression,
+                                    std::size_t shardSize)
+    : mPath(path),
+      mCompression(compression),
+      mShardSize(shardSize),
+      mNbShards(0),
+      mShardOffset(0),
+      mNbEntries(0),
+      mClosed(false)
+{
+    if (!Utils::createDirectories(path)) {
+        throw std::runtime_error("StimuliShards::Writer: could not create"
+                                 " directory: " + path);
+    }
+
+    // A previous index would refer to the shards being overwritten
+    std::remove((path + "/shards.idx").c_str());
+}
+
+std::vector<char> N2D2::StimuliShards::Writer::encode(
+    const std::vector<cv::Mat>& data,
+    const std::vector<cv::Mat>& labels,
+    Compression compression)
+{
+    std::vector<char> record;
+    appendValue<uint32_t>(record, data.size());
+    appendValue<uint32_t>(record, labels.size());
+
+    for (std::vector<cv::Mat>::const_iterator it = data.begin(),
+         itEnd = data.end(); it != itEnd; ++it)
+    {
+        encodeMat(record, *it, compression);
+    }
+
+    for (std::vector<cv::Mat>::const_iterator it = labels.begin(),
+         itEnd = labels.end(); it != itEnd; ++it)
+    {
+        encodeMat(record, *it, compression);
+    }
+
+    return record;
+}
+
+void N2D2::StimuliShards::Writer::append(Database::StimulusID id,
+                                         Database::StimuliSet set,
+                                         const std::vector<char>& record)
+{
+    if (mClosed)
+        throw std::runtime_error("StimuliShards::Writer: writer is closed");
+
+    if (!mShard.is_open() || mShardOffset >= mShardSize) {
+        if (mShard.is_open())
+            mShard.close();
+
+        const std::string shardName = getShardName(mPath, mNbShards);
+        mShard.open(shardName.c_str(), std::ios::binary);
+
+        if (!mShard.good()) {
+            throw std::runtime_error("StimuliShards::Writer: could not"
+                                     " create shard: " + shardName);
+        }
+
+        ++mNbShards;
+        mShardOffset = 0;
+    }
+
+    mShard.write(&record[0], record.size());
+
+    if (!mShard.good()) {
+        throw std::runtime_error("StimuliShards::Writer: error writing"
+                                 " shard: " + getShardName(mPath,
+                                                           mNbShards - 1));
+    }
+
+    appendValue<int32_t>(mIndex, set);
+    appendValue<uint32_t>(mIndex, id);
+    appendValue<uint32_t>(mIndex, mNbShards - 1);
+    appendValue<uint64_t>(mIndex, mShardOffset);
+    appendValue<uint64_t>(mIndex, record.size());
+    ++mNbEntries;
+
+    mShardOffset += record.size();
+}
+
+void N2D2::StimuliShards::Writer::close()
+{
+    if (mClosed)
+        return;
+
+    mClosed = true;
+
+    if (mShard.is_open())
+        mShard.close();
+
+    // Write to a temporary file first, so that an interrupted write never
+    // leaves a truncated index
+    const std::string indexName = mPath + "/shards.idx";
+    const std::string tmpIndexName = indexName + ".tmp";
+
+    std::ofstream index(tmpIndexName.c_str(), std::ios::binary);
+
+    if (!index.good()) {
+        throw std::runtime_error("StimuliShards::Writer: could not create"
+                                 " index: " + tmpIndexName);
+    }
+
+    std::vector<char> header;
+    appendValue<uint32_t>(header, ShardsMagic);
+    appendValue<uint32_t>(header, ShardsVersion);
+    appendValue<uint32_t>(header, mNbShards);
+    appendValue<uint32_t>(header, mNbEntries);
+
+    index.write(&header[0], header.size());
+
+    if (!mIndex.empty())
+        index.write(&mIndex[0], mIndex.size());
+
+    index.close();
+
+    if (!index.good() || std::rename(tmpIndexName.c_str(),
+                                     indexName.c_str()) != 0)
+    {
+        throw std::runtime_error("StimuliShards::Writer: error writing"
+                                 " index: " + indexName);
+    }
+}
+
+N2D2::StimuliShards::Writer::~Writer()
+{
+    // The index is not written if close() was not called, the shards are
+    // then considered incomplete
+    if (mShard.is_open())
+        mShard.close();
+}
+
+bool N2D2::StimuliShards::exists(const std::string& path)
+{
+    return std::ifstream((path + "/shards.idx").c_str()).good();
+}
+
+N2D2::StimuliShards::StimuliShards(const std::string& path)
+    : mPath(path),
+      mEntries(Database::Unpartitioned + 1),
+      mLastIds(Database::Unpartitioned + 1, 0)
+{
+    const MemoryMappedFile index(path + "/shards.idx");
+    const unsigned char* data = index.data();
+    const unsigned char* end = data + index.size();
+
+    if (readValue<uint32_t>(data, end) != ShardsMagic
+        || readValue<uint32_t>(data, end) != ShardsVersion)
+    {
+        throw std::runtime_error("StimuliShards: invalid index in: " + path);
+    }
+
+    const unsigned int nbShards = readValue<uint32_t>(data, end);
+    const unsigned int nbEntries = readValue<uint32_t>(data, end);
+
+    for (unsigned int shard = 0; shard < nbShards; ++shard) {
+        mShards.push_back(std::make_shared<MemoryMappedFile>(
+            getShardName(path, shard)));
+    }
+
+    for (unsigned int i = 0; i < nbEntries; ++i) {
+        const int set = readValue<int32_t>(data, end);
+        const unsigned int id = readValue<uint32_t>(data, end);
+
+        Entry entry;
+        entry.shard = readValue<uint32_t>(data, end);
+        entry.offset = readValue<uint64_t>(data, end);
+        entry.size = readValue<uint64_t>(data, end);
+
+        if (set < 0 || set > Database::Unpartitioned
+            || entry.shard >= nbShards
+            || entry.offset + entry.size > mShards[entry.shard]->size())
+        {
+            throw std::runtime_error("StimuliShards: invalid index entry in: "
+                                     + path);
+        }
+
+        std::vector<Entry>& setEntries = mEntries[set];
+
+        if (id >= setEntries.size()) {
+            const Entry noEntry = {0, 0, 0};
+            setEntries.resize(id + 1, noEntry);
+        }
+
+        setEntries[id] = entry;
+    }
+}
+
+bool N2D2::StimuliShards::read(Database::StimulusID id,
+                               Database::StimuliSet set,
+                               std::vector<cv::Mat>& data,
+                               std::vector<cv::Mat>& labels) const
+{
+    const std::vector<Entry>& setEntries = mEntries[set];
+
+    if (id >= setEntries.size() || setEntries[id].size == 0)
+        return false;
+
+    const Entry& entry = setEntries[id];
+    const MemoryMappedFile& shard = *mShards[entry.shard];
+
+    Database::StimulusID lastId;
+
+#pragma omp atomic capture
+    {
+        lastId = mLastIds[set];
+        mLastIds[set] = id;
+    }
+
+    // Read the following records ahead on sequential reads only, as
+    // consecutive stimuli are stored contiguously. The stimuli of a batch
+    // are read by several threads, which may slightly reorder them.
+    const bool sequential = (id > lastId
+        && id - lastId <= (unsigned int)omp_get_max_threads());
+
+    shard.prefetch(entry.offset, entry.size + ((sequential) ? ReadAhead : 0));
+
+    const unsigned char* record = shard.data() + entry.offset;
+    const unsigned char* end = record + entry.size;
+
+    const unsigned int nbData = readValue<uint32_t>(record, end);
+    const unsigned int nbLabels = readValue<uint32_t>(record, end);
+
+    data.clear();
+    labels.clear();
+
+    for (unsigned int i = 0; i < nbData; ++i)
+        data.push_back(decodeMat(record, end));
+
+    for (unsigned int i = 0; i < nbLabels; ++i)
+        labels.push_back(decodeMat(record, end));
+
+    return true;
+}
+
+std::string N2D2::StimuliShards::getShardName(const std::string& path,
+                                              unsigned int shard)
+{
+    std::ostringstream shardName;
+    shardName << path << "/shard_" << std::setfill('0') << std::setw(5)
+              << shard << ".bin";
+    return shardName.str();
+}
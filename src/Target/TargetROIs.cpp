@@ -119,6 +119,13 @@ void N2D2::TargetROIs::processEstimatedLabels(Database::StimuliSet set,
 
     mDetectedBB.assign(targets.dimB(), std::vector<DetectedBB>());
 
+#ifdef _OPENMP
+    if (mLSL.size() < (unsigned int)omp_get_max_threads())
+        mLSL.resize(omp_get_max_threads());
+#else
+    mLSL.resize(1);
+#endif
+
 #pragma omp parallel for if (targets.dimB() > 4)
     for (int batchPos = 0; batchPos < (int)targets.dimB(); ++batchPos) {
 #ifdef CUDA
@@ -136,27 +143,8 @@ void N2D2::TargetROIs::processEstimatedLabels(Database::StimuliSet set,
         std::vector<DetectedBB> detectedBB;
 
         // Extract estimated BB
-        const Tensor<int> estLabels = estimatedLabels[batchPos][0];
-
-        ComputerVision::LSL_Box lsl(mMinSize);
-        lsl.process(Matrix<int>(estLabels.dimY(),
-                                estLabels.dimX(),
-                                estLabels.begin(),
-                                estLabels.end()));
-
-        std::vector<ComputerVision::ROI::Roi_T> estimatedROIs = lsl.getRoi();
-
-        if (mFilterMinHeight > 0 || mFilterMinWidth > 0
-            || mFilterMinAspectRatio > 0.0 || mFilterMaxAspectRatio > 0.0) {
-            ComputerVision::ROI::filterSize(estimatedROIs,
-                                            mFilterMinHeight,
-                                            mFilterMinWidth,
-                                            mFilterMinAspectRatio,
-                                            mFilterMaxAspectRatio);
-        }
-
-        ComputerVision::ROI::filterSeparability(
-            estimatedROIs, mMergeMaxHDist, mMergeMaxVDist);
+        const std::vector<ComputerVision::ROI::Roi_T> estimatedROIs
+            = extractROIs(estimatedLabels[batchPos][0]);
 
         for (std::vector<ComputerVision::ROI::Roi_T>::const_iterator it
              = estimatedROIs.begin(),
@@ -871,22 +859,23 @@ void N2D2::TargetROIs::clear(Database::StimuliSet set)
     clearConfusionMatrix(set);
 }
 
-std::vector<std::shared_ptr<N2D2::ROI> > N2D2::TargetROIs::generateLabelsROIs(
-    const Tensor<int>& labels) const
+std::vector<N2D2::ComputerVision::ROI::Roi_T>
+N2D2::TargetROIs::extractROIs(const Tensor<int>& labels) const
 {
-    // Compute label ROIs from pixel-wise annotations.
-    // In this case, it makes sense to apply the same filtering
-    // to the obtained label ROIs, than the estimated ROIs.
-    std::vector<std::shared_ptr<ROI> > labelROIs;
+    // Reuse the labeling buffers of the current thread when available
+#ifdef _OPENMP
+    const unsigned int thread = omp_get_thread_num();
+#else
+    const unsigned int thread = 0;
+#endif
+    ComputerVision::ParallelLSL_Box localLsl;
+    ComputerVision::ParallelLSL_Box& lsl = (thread < mLSL.size())
+        ? mLSL[thread] : localLsl;
 
-    ComputerVision::LSL_Box lsl(mMinSize);
-    lsl.process(Matrix<int>(labels.dimY(),
-                            labels.dimX(),
-                            labels.begin(),
-                            labels.end()));
+    lsl.setMinSize(mMinSize);
+    lsl.process(&(*labels.begin()), labels.dimX(), labels.dimY());
 
-    std::vector<ComputerVision::ROI::Roi_T> estimatedROIs
-        = lsl.getRoi();
+    std::vector<ComputerVision::ROI::Roi_T> estimatedROIs = lsl.getRoi();
 
     if (mFilterMinHeight > 0 || mFilterMinWidth > 0
         || mFilterMinAspectRatio > 0.0 || mFilterMaxAspectRatio > 0.0) {
@@ -900,6 +889,19 @@ std::vector<std::shared_ptr<N2D2::ROI> > N2D2::TargetROIs::generateLabelsROIs(
     ComputerVision::ROI::filterSeparability(
         estimatedROIs, mMergeMaxHDist, mMergeMaxVDist);
 
+    return estimatedROIs;
+}
+
+std::vector<std::shared_ptr<N2D2::ROI> > N2D2::TargetROIs::generateLabelsROIs(
+    const Tensor<int>& labels) const
+{
+    // Compute label ROIs from pixel-wise annotations.
+    // In this case, it makes sense to apply the same filtering
+    // to the obtained label ROIs, than the estimated ROIs.
+    std::vector<std::shared_ptr<ROI> > labelROIs;
+    std::vector<ComputerVision::ROI::Roi_T> estimatedROIs
+        = extractROIs(labels);
+
     for (std::vector<ComputerVision::ROI::Roi_T>::iterator
         it = estimatedROIs.begin(), itEnd = estimatedROIs.end();
         it != itEnd; ++it)
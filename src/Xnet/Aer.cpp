@@ -70,31 +70,35 @@ N2D2::Aer::AerData_T N2D2::Aer::read(const std::string& fileName,
                                      Time_T start,
                                      Time_T end)
 {
-    static std::map<std::string, std::pair<Time_T, std::streampos> > history;
+    static std::map<std::string, std::pair<Time_T, std::size_t> > history;
 
-    std::ifstream data(fileName.c_str(), std::fstream::binary);
+    // The whole file is decoded at once, in the file order
+    if (mStream.getFileName() != fileName || mStream.isOutdated())
+        mStream.load(fileName, AerStream::AerDat, format, false);
 
-    if (!data.good())
-        throw std::runtime_error("Could not open AER file: " + fileName);
-
-    AerEvent event(readVersion(data));
+    const std::vector<Time_T>& times = mStream.getTimes();
+    const std::vector<unsigned int>& addrs = mStream.getAddr();
+    std::size_t index = 0;
 
     if (history.find(fileName) != history.end() && start
                                                    == history[fileName].first)
         // Start from last position
-        data.seekg(history[fileName].second);
+        index = history[fileName].second;
 
+    AerEvent event;
     AerData_T events;
     unsigned int nbEvents = 0;
     Time_T lastTime = start;
 
-    while (event.read(data).good()) {
+    for (std::size_t size = times.size(); index < size; ++index) {
+        event.time = times[index];
+        event.addr = addrs[index];
+
         // Tolerate a lag of 100ms because real AER retina captures are not
         // always non-monotonic
         if (event.time + 100 * TimeMs >= lastTime) {
             if (end > 0 && event.time >= end) {
-                history[fileName] = std::make_pair(
-                    end, (std::streamoff)data.tellg() - event.size());
+                history[fileName] = std::make_pair(end, index);
                 break;
             }
 
@@ -0,0 +1,393 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Xnet/AerStream.hpp"
+#include "Database/AER_Database.hpp"
+#include "utils/MemoryMappedFile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+namespace {
+// AER-DAT files are big endian, whatever the host endianness
+inline unsigned int loadBigEndian16(const unsigned char* data)
+{
+    return ((unsigned int)data[0] << 8) | (unsigned int)data[1];
+}
+
+inline unsigned int loadBigEndian32(const unsigned char* data)
+{
+    return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16)
+           | ((unsigned int)data[2] << 8) | (unsigned int)data[3];
+}
+
+inline unsigned long long int loadBigEndian64(const unsigned char* data)
+{
+    return ((unsigned long long int)loadBigEndian32(data) << 32)
+           | (unsigned long long int)loadBigEndian32(data + 4);
+}
+
+bool getFileStat(const std::string& fileName,
+                 std::size_t& fileSize,
+                 long long int& fileTime)
+{
+    struct stat fileStat;
+
+    if (stat(fileName.c_str(), &fileStat) != 0)
+        return false;
+
+    fileSize = (std::size_t)fileStat.st_size;
+    fileTime = (long long int)fileStat.st_mtime;
+    return true;
+}
+}
+
+N2D2::AerStream::Window::Window()
+    : mTimes(NULL),
+      mX(NULL),
+      mY(NULL),
+      mPolarity(NULL),
+      mSize(0)
+{
+    // ctor
+}
+
+N2D2::AerStream::Window::Window(const AerStream& stream,
+                                std::size_t begin,
+                                std::size_t end)
+    : mTimes(stream.mTimes.data() + begin),
+      mX(stream.mX.data() + begin),
+      mY(stream.mY.data() + begin),
+      mPolarity(stream.mPolarity.data() + begin),
+      mSize(end - begin)
+{
+    // ctor
+}
+
+void N2D2::AerStream::Window::append(std::vector<AerReadEvent>& events,
+                                     unsigned int batch,
+                                     int value) const
+{
+    events.reserve(events.size() + mSize);
+
+    for (std::size_t i = 0; i < mSize; ++i) {
+        events.push_back(AerReadEvent(mX[i], mY[i], mPolarity[i], batch,
+                                      value, mTimes[i]));
+    }
+}
+
+N2D2::AerStream::AerStream()
+    : mFileSize(0),
+      mFileTime(0),
+      mSorted(true)
+{
+    // ctor
+}
+
+void N2D2::AerStream::load(const std::string& fileName,
+                           StreamFormat format,
+                           AerEvent::AerFormat aerFormat,
+                           bool sortByTime)
+{
+    clear();
+
+    if (!getFileStat(fileName, mFileSize, mFileTime))
+        throw std::runtime_error("Could not open AER file: " + fileName);
+
+    const MemoryMappedFile file(fileName);
+
+    if (format == AerDat)
+        loadAerDat(file.data(), file.size(), aerFormat);
+    else if (format == Atis)
+        loadAtis(file.data(), file.size());
+    else if (format == Text)
+        loadText(file.data(), file.size());
+    else
+        throw std::runtime_error("Unknown AER stream format");
+
+    mFileName = fileName;
+    mSorted = std::is_sorted(mTimes.begin(), mTimes.end());
+
+    if (sortByTime && !mSorted)
+        sort();
+}
+
+void N2D2::AerStream::clear()
+{
+    mFileName.clear();
+    mFileSize = 0;
+    mFileTime = 0;
+    mSorted = true;
+
+    mTimes.clear();
+    mX.clear();
+    mY.clear();
+    mPolarity.clear();
+    mAddr.clear();
+}
+
+N2D2::AerStream::Window N2D2::AerStream::getWindow(Time_T start,
+                                                   Time_T end) const
+{
+    if (!mSorted) {
+        throw std::runtime_error("AerStream::getWindow(): events are not"
+                                 " sorted by time in file: " + mFileName);
+    }
+
+    const std::size_t begin = lowerBound(start);
+    const std::size_t last = (end > 0) ? std::max(begin, lowerBound(end))
+                                       : mTimes.size();
+
+    return Window(*this, begin, last);
+}
+
+std::size_t N2D2::AerStream::lowerBound(Time_T time) const
+{
+    return std::lower_bound(mTimes.begin(), mTimes.end(), time)
+           - mTimes.begin();
+}
+
+bool N2D2::AerStream::isOutdated() const
+{
+    std::size_t fileSize;
+    long long int fileTime;
+
+    return (!getFileStat(mFileName, fileSize, fileTime)
+            || fileSize != mFileSize || fileTime != mFileTime);
+}
+
+void N2D2::AerStream::loadAerDat(const unsigned char* data,
+                                 std::size_t size,
+                                 AerEvent::AerFormat aerFormat)
+{
+    // Header, same parsing as Aer::readVersion()
+    std::size_t pos = 0;
+    double version = 1.0; // Default version
+
+    while (pos < size && data[pos] == '#') {
+        const unsigned char* eol = static_cast<const unsigned char*>(
+            std::memchr(data + pos, '\n', size - pos));
+        const std::size_t lineEnd = (eol != NULL) ? (std::size_t)(eol - data)
+                                                  : size;
+        const std::string line(data + pos, data + lineEnd);
+
+        if (line.compare(0, 9, "#!AER-DAT") == 0) {
+            std::stringstream versionStr(line.substr(9));
+            versionStr >> version;
+        }
+
+        pos = std::min(lineEnd + 1, size);
+    }
+
+    // Same record layouts as AerEvent::read()
+    const int fileVersion = (int)version;
+    const std::size_t addrSize = (fileVersion == 2 || fileVersion == 3)
+                                     ? sizeof(unsigned int)
+                                     : sizeof(unsigned short);
+    const std::size_t timeSize = (fileVersion == 3)
+                                     ? sizeof(unsigned long long int)
+                                     : sizeof(int);
+    const std::size_t recordSize = addrSize + timeSize;
+    // A truncated last record is ignored
+    const int nbEvents = (int)((size - pos) / recordSize);
+    const unsigned char* records = data + pos;
+
+    resize(nbEvents);
+    mAddr.resize(nbEvents);
+
+    unsigned int* addr = mAddr.data();
+    Time_T* times = mTimes.data();
+
+    if (fileVersion == 3) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = 0; i < nbEvents; ++i) {
+            const unsigned char* record = records + i * recordSize;
+            addr[i] = loadBigEndian32(record);
+            times[i] = loadBigEndian64(record + addrSize);
+        }
+    }
+    else {
+        std::vector<int> rawTimes(nbEvents);
+        int* rawTime = rawTimes.data();
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = 0; i < nbEvents; ++i) {
+            const unsigned char* record = records + i * recordSize;
+            addr[i] = (addrSize == sizeof(unsigned int))
+                ? loadBigEndian32(record) : loadBigEndian16(record);
+            rawTime[i] = (int)loadBigEndian32(record + addrSize);
+        }
+
+        // Check & correct for overflow, as in AerEvent::read(). This is a
+        // prefix scan and stays sequential.
+        unsigned long long int rawTimeOffset = 0;
+        bool rawTimeNeg = false;
+
+        for (int i = 0; i < nbEvents; ++i) {
+            if (rawTime[i] < 0 && !rawTimeNeg) {
+                rawTimeOffset += (1ULL << 8 * sizeof(int));
+                rawTimeNeg = true;
+            }
+            else if (rawTime[i] >= 0 && rawTimeNeg)
+                rawTimeNeg = false;
+
+            times[i] = (rawTimeOffset + rawTime[i]) * TimeUs;
+        }
+    }
+
+    // Address decoding, as in AerEvent::maps()
+    unsigned int* x = mX.data();
+    unsigned int* y = mY.data();
+    unsigned char* polarity = mPolarity.data();
+
+    if (aerFormat == AerEvent::N2D2Env) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = 0; i < nbEvents; ++i) {
+            x[i] = addr[i] & 0xFFFFFF;
+            y[i] = addr[i] >> 28;
+            polarity[i] = (unsigned char)((addr[i] >> 24) & 0xF);
+        }
+    }
+    else if (aerFormat == AerEvent::Dvs128) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = 0; i < nbEvents; ++i) {
+            const unsigned int node = 128 * 128 - (addr[i] >> 1) - 1;
+            x[i] = node % 128;
+            y[i] = node / 128;
+            polarity[i] = (unsigned char)(addr[i] & 1);
+        }
+    }
+    else
+        throw std::runtime_error("Unknown AER format");
+}
+
+void N2D2::AerStream::loadAtis(const unsigned char* data, std::size_t size)
+{
+    // 40 bits events: 8 bits x, 8 bits y, 1 bit polarity, 23 bits time
+    const int nbEvents = (int)(size / 5);
+
+    resize(nbEvents);
+
+    Time_T* times = mTimes.data();
+    unsigned int* x = mX.data();
+    unsigned int* y = mY.data();
+    unsigned char* polarity = mPolarity.data();
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+    for (int i = 0; i < nbEvents; ++i) {
+        const unsigned char* event = data + 5 * i;
+        x[i] = event[0];
+        y[i] = event[1];
+        polarity[i] = event[2] >> 7;
+        times[i] = ((unsigned int)(event[2] & 0x7F) << 16)
+                   | ((unsigned int)event[3] << 8) | (unsigned int)event[4];
+    }
+}
+
+void N2D2::AerStream::loadText(const unsigned char* data, std::size_t size)
+{
+    // Reading stops at the first invalid field, like operator>>
+    std::size_t pos = 0;
+
+    while (true) {
+        unsigned long long int fields[4];
+        bool valid = true;
+
+        for (unsigned int f = 0; f < 4 && valid; ++f) {
+            while (pos < size && std::isspace(data[pos]))
+                ++pos;
+
+            valid = (pos < size && std::isdigit(data[pos]));
+            fields[f] = 0;
+
+            while (pos < size && std::isdigit(data[pos])) {
+                fields[f] = 10 * fields[f] + (data[pos] - '0');
+                ++pos;
+            }
+        }
+
+        if (!valid)
+            break;
+
+        mX.push_back((unsigned int)fields[0]);
+        mY.push_back((unsigned int)fields[1]);
+        mTimes.push_back(fields[2]);
+        mPolarity.push_back((unsigned char)fields[3]);
+    }
+}
+
+void N2D2::AerStream::resize(std::size_t nbEvents)
+{
+    mTimes.resize(nbEvents);
+    mX.resize(nbEvents);
+    mY.resize(nbEvents);
+    mPolarity.resize(nbEvents);
+}
+
+namespace {
+template <class T>
+void permute(std::vector<T>& data, const std::vector<std::size_t>& order)
+{
+    if (data.empty())
+        return;
+
+    std::vector<T> sorted(data.size());
+
+    for (std::size_t i = 0, size = order.size(); i < size; ++i)
+        sorted[i] = data[order[i]];
+
+    data.swap(sorted);
+}
+}
+
+void N2D2::AerStream::sort()
+{
+    std::vector<std::size_t> order(mTimes.size());
+
+    for (std::size_t i = 0, size = order.size(); i < size; ++i)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(),
+        [this](std::size_t a, std::size_t b)
+            { return (mTimes[a] < mTimes[b]); });
+
+    permute(mTimes, order);
+    permute(mX, order);
+    permute(mY, order);
+    permute(mPolarity, order);
+    permute(mAddr, order);
+
+    mSorted = true;
+}
@@ -24,6 +24,9 @@
 
 N2D2::Monitor::Monitor(Network& net)
     : mNet(net),
+      mNodeIdOffset(0),
+      mNbCompiledNodes(0),
+      mValidFiringRate(false),
       mEarlierId(0),
       mMostActiveId(0),
       mMostActiveRate(0),
@@ -72,6 +75,45 @@ void N2D2::Monitor::update(bool recordActivity)
         mValidFirstEvent = true;
     }
 
+    compileNodes();
+    mValidFiringRate = true;
+
+    std::vector<unsigned int> activity(mNodeIds.size(), 0);
+    std::vector<Time_T> firstEvent(mNodeIds.size(), 0);
+
+    // Consecutive events are often of the same type
+    EventType_T lastType = 0;
+    int lastTypeIndex = -1;
+    bool validLastType = false;
+
+    // Single pass over the network spike log
+    mNet.getSpikeLog().forEach(
+        [&](NodeId_T nodeId, Time_T timestamp, EventType_T type) {
+            const int node = getNodeIndex(nodeId);
+
+            if (node < 0)
+                return;
+
+            if (!validLastType || type != lastType) {
+                lastType = type;
+                lastTypeIndex = getTypeIndex(type);
+                validLastType = true;
+            }
+
+            if (lastTypeIndex < 0)
+                return;
+
+            ++mFiringRate[lastTypeIndex][node];
+
+            if (activity[node] == 0)
+                firstEvent[node] = timestamp;
+
+            ++activity[node];
+
+            if (recordActivity)
+                mActivity.push_back(nodeId, timestamp, type);
+        });
+
     Time_T first = 0;
 
     for (std::vector<Node*>::const_iterator it = mNodes.begin(),
@@ -79,58 +121,20 @@ void N2D2::Monitor::update(bool recordActivity)
          it != itEnd;
          ++it) {
         const NodeId_T nodeId = (*it)->getId();
-        const NodeEvents_T& record = mNet.getSpikeRecording(nodeId);
+        const int node = getNodeIndex(nodeId);
 
-        NodeEvents_T filteredRecord;
+        mTotalActivity += activity[node];
 
-        // mFiringRate peut se déduire très facilement de mActivity, seulement
-        // ça permet d'éviter d'avoir à garder en mémoire de
-        // trop grosses quantités de données lorsque l'on a pas besoin de
-        // mActivity.
-        std::map<NodeId_T, std::map<EventType_T, unsigned int> >::iterator
-        itFiringRate;
-        std::tie(itFiringRate, std::ignore) = mFiringRate.insert(
-            std::make_pair(nodeId, std::map<EventType_T, unsigned int>()));
-
-        for (NodeEvents_T::const_iterator it = record.begin(),
-                                          itEnd = record.end();
-             it != itEnd;
-             ++it) {
-            if (mRecordEventTypes.empty()
-                || mRecordEventTypes.find((*it).second)
-                   != mRecordEventTypes.end()) {
-                filteredRecord.push_back(*it);
-                mEventTypes.insert((*it).second);
-                std::map<EventType_T, unsigned int>::iterator itNodeFiringRate
-                    = (*itFiringRate).second.find((*it).second);
-
-                if (itNodeFiringRate != (*itFiringRate).second.end())
-                    ++(*itNodeFiringRate).second;
-                else
-                    (*itFiringRate)
-                        .second.insert(std::make_pair((*it).second, 1));
-            }
-        }
-
-        const unsigned int activity = filteredRecord.size();
-
-        mTotalActivity += activity;
-
-        if (mMostActiveRate < activity) {
-            mMostActiveRate = activity;
+        if (mMostActiveRate < activity[node]) {
+            mMostActiveRate = activity[node];
             mMostActiveId = nodeId;
         }
 
-        if (activity > 0
-            && (mEarlierId == 0 || filteredRecord[0].first < first)) {
+        if (activity[node] > 0
+            && (mEarlierId == 0 || firstEvent[node] < first)) {
             mEarlierId = nodeId;
-            first = filteredRecord[0].first;
+            first = firstEvent[node];
         }
-
-        if (recordActivity && activity > 0)
-            mActivity[nodeId].insert(mActivity[nodeId].end(),
-                                     filteredRecord.begin(),
-                                     filteredRecord.end());
     }
 
     // If no neuron fired more than once, take the first to have fired (for
@@ -252,39 +256,50 @@ bool N2D2::Monitor::checkLearningResponse(unsigned int cls,
 
 unsigned int N2D2::Monitor::getFiringRate(NodeId_T nodeId) const
 {
-    std::map<NodeId_T, std::map<EventType_T, unsigned int> >::const_iterator
-    itFiringRate = mFiringRate.find(nodeId);
+    const int node = getNodeIndex(nodeId);
+
+    if (node < 0)
+        throw std::runtime_error("Monitor::getFiringRate(): node not monitored");
 
     unsigned int firingRate = 0;
 
-    for (std::map<EventType_T, unsigned int>::const_iterator it
-         = (*itFiringRate).second.begin(),
-         itEnd = (*itFiringRate).second.end();
+    for (std::vector<std::vector<unsigned int> >::const_iterator it
+         = mFiringRate.begin(),
+         itEnd = mFiringRate.end();
          it != itEnd;
          ++it) {
-        firingRate += (*it).second;
+        firingRate += (*it)[node];
     }
 
     return firingRate;
 }
 
+unsigned int N2D2::Monitor::getFiringRate(NodeId_T nodeId,
+                                          EventType_T type) const
+{
+    const int node = getNodeIndex(nodeId);
+
+    if (node < 0)
+        throw std::runtime_error("Monitor::getFiringRate(): node not monitored");
+
+    const std::vector<EventType_T>::const_iterator itType
+        = std::find(mFiringRateTypes.begin(), mFiringRateTypes.end(), type);
+
+    return (itType != mFiringRateTypes.end())
+        ? mFiringRate[itType - mFiringRateTypes.begin()][node]
+        : 0;
+}
+
 unsigned int N2D2::Monitor::getTotalFiringRate() const
 {
     unsigned int firingRate = 0;
 
-    for (std::map
-         <NodeId_T, std::map<EventType_T, unsigned int> >::const_iterator
-             itFiringRate = mFiringRate.begin(),
-             itFiringRateEnd = mFiringRate.end();
-         itFiringRate != itFiringRateEnd;
-         ++itFiringRate) {
-        for (std::map<EventType_T, unsigned int>::const_iterator it
-             = (*itFiringRate).second.begin(),
-             itEnd = (*itFiringRate).second.end();
-             it != itEnd;
-             ++it) {
-            firingRate += (*it).second;
-        }
+    for (std::vector<std::vector<unsigned int> >::const_iterator it
+         = mFiringRate.begin(),
+         itEnd = mFiringRate.end();
+         it != itEnd;
+         ++it) {
+        firingRate += std::accumulate((*it).begin(), (*it).end(), 0U);
     }
 
     return firingRate;
@@ -292,22 +307,15 @@ unsigned int N2D2::Monitor::getTotalFiringRate() const
 
 unsigned int N2D2::Monitor::getTotalFiringRate(EventType_T type) const
 {
-    unsigned int firingRate = 0;
+    const std::vector<EventType_T>::const_iterator itType
+        = std::find(mFiringRateTypes.begin(), mFiringRateTypes.end(), type);
 
-    for (std::map
-         <NodeId_T, std::map<EventType_T, unsigned int> >::const_iterator
-             itFiringRate = mFiringRate.begin(),
-             itFiringRateEnd = mFiringRate.end();
-         itFiringRate != itFiringRateEnd;
-         ++itFiringRate) {
-        std::map<EventType_T, unsigned int>::const_iterator it
-            = (*itFiringRate).second.find(type);
-
-        if (it != (*itFiringRate).second.end())
-            firingRate += (*it).second;
-    }
+    if (itType == mFiringRateTypes.end())
+        return 0;
 
-    return firingRate;
+    const std::vector<unsigned int>& firingRate
+        = mFiringRate[itType - mFiringRateTypes.begin()];
+    return std::accumulate(firingRate.begin(), firingRate.end(), 0U);
 }
 
 double N2D2::Monitor::getSuccessRate(unsigned int avgWindow) const
@@ -342,35 +350,42 @@ void N2D2::Monitor::logFiringRate(const std::string& fileName, bool plot) const
 
     unsigned int totalActivity = 0;
 
-    for (std::map
-         <NodeId_T, std::map<EventType_T, unsigned int> >::const_iterator it
-         = mFiringRate.begin(),
-         itEnd = mFiringRate.end();
-         it != itEnd;
-         ++it) {
-        data << (*it).first;
-
-        for (std::set<EventType_T>::const_iterator itType = mEventTypes.begin(),
-                                                   itTypeEnd
-                                                   = mEventTypes.end();
-             itType != itTypeEnd;
-             ++itType) {
-            std::map<EventType_T, unsigned int>::const_iterator itNodeType
-                = (*it).second.find(*itType);
-
-            if (itNodeType != (*it).second.end()) {
-                totalActivity += (*itNodeType).second;
-                data << " " << (*itNodeType).second;
-            } else
-                data << " 0";
-        }
+    // Index in mFiringRate of each type of mEventTypes (-1 if none)
+    std::vector<int> typeIndexes;
+
+    for (std::set<EventType_T>::const_iterator itType = mEventTypes.begin(),
+                                               itTypeEnd = mEventTypes.end();
+         itType != itTypeEnd;
+         ++itType) {
+        const std::vector<EventType_T>::const_iterator it = std::find(
+            mFiringRateTypes.begin(), mFiringRateTypes.end(), *itType);
+        typeIndexes.push_back((it != mFiringRateTypes.end())
+                                  ? (int)(it - mFiringRateTypes.begin())
+                                  : -1);
+    }
+
+    if (mValidFiringRate) {
+        for (unsigned int node = 0; node < mNodeIds.size(); ++node) {
+            data << mNodeIds[node];
 
-        data << "\n";
+            for (std::vector<int>::const_iterator it = typeIndexes.begin(),
+                                                  itEnd = typeIndexes.end();
+                 it != itEnd;
+                 ++it) {
+                const unsigned int firingRate
+                    = ((*it) >= 0) ? mFiringRate[(*it)][node] : 0;
+
+                totalActivity += firingRate;
+                data << " " << firingRate;
+            }
+
+            data << "\n";
+        }
     }
 
     data.close();
 
-    if (mFiringRate.empty())
+    if (!mValidFiringRate || mNodeIds.empty())
         std::cout << "Notice: no firing rate recorded." << std::endl;
     else if (plot) {
         NodeId_T xmin = mNodes[0]->getId();
@@ -406,7 +421,7 @@ void N2D2::Monitor::logFiringRate(const std::string& fileName, bool plot) const
         gnuplot.setYlabel("Number of activations");
         gnuplot.setXlabel("Node ID");
 
-        if (mFiringRate.size() < 100) {
+        if (mNodeIds.size() < 100) {
             gnuplot.set("grid");
             gnuplot.set("xtics", "1 rotate by 90");
         }
@@ -451,17 +466,31 @@ void N2D2::Monitor::logActivity(const std::string& fileName,
     // Use the full double precision to keep accuracy even on small scales
     data.precision(std::numeric_limits<double>::digits10 + 1);
 
-    for (std::map<NodeId_T, NodeEvents_T>::const_iterator it
-         = mActivity.begin(),
-         itEnd = mActivity.end();
-         it != itEnd;
-         ++it) {
-        for (NodeEvents_T::const_iterator itTime = (*it).second.begin(),
-                                          itTimeEnd = (*it).second.end();
-             itTime != itTimeEnd;
-             ++itTime) {
-            data << (*it).first << " " << (*itTime).first / ((double)TimeS)
-                 << " " << (*itTime).second << "\n";
+    // Group the events by node ID (counting sort of the log)
+    std::vector<std::size_t> offsets(mNodeIds.size() + 1, 0);
+
+    mActivity.forEach([&](NodeId_T nodeId, Time_T, EventType_T) {
+        ++offsets[getNodeIndex(nodeId) + 1];
+    });
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<std::pair<Time_T, EventType_T> > events(mActivity.size());
+    std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+
+    mActivity.forEach(
+        [&](NodeId_T nodeId, Time_T timestamp, EventType_T type) {
+            events[pos[getNodeIndex(nodeId)]++]
+                = std::make_pair(timestamp, type);
+        });
+
+    for (unsigned int node = 0; node < mNodeIds.size(); ++node) {
+        if (offsets[node] == offsets[node + 1])
+            continue;
+
+        for (std::size_t i = offsets[node]; i < offsets[node + 1]; ++i) {
+            data << mNodeIds[node] << " " << events[i].first / ((double)TimeS)
+                 << " " << events[i].second << "\n";
         }
 
         data << "\n\n";
@@ -538,7 +567,7 @@ void N2D2::Monitor::clearAll()
     mActivity.clear();
     mFirstEvent = 0;
     mValidFirstEvent = false;
-    mFiringRate.clear();
+    clearFiringRate();
     mSuccess.clear();
     mEventTypes.clear();
 }
@@ -552,10 +581,85 @@ void N2D2::Monitor::clearActivity()
 
 void N2D2::Monitor::clearFiringRate()
 {
+    mFiringRateTypes.clear();
     mFiringRate.clear();
+    mValidFiringRate = false;
 }
 
 void N2D2::Monitor::clearSuccess()
 {
     mSuccess.clear();
 }
+
+void N2D2::Monitor::compileNodes()
+{
+    if (mNbCompiledNodes == mNodes.size())
+        return;
+
+    const std::vector<NodeId_T> prevNodeIds(mNodeIds);
+
+    mNodeIds.clear();
+
+    for (std::vector<Node*>::const_iterator it = mNodes.begin(),
+                                            itEnd = mNodes.end();
+         it != itEnd;
+         ++it)
+        mNodeIds.push_back((*it)->getId());
+
+    std::sort(mNodeIds.begin(), mNodeIds.end());
+    mNodeIds.erase(std::unique(mNodeIds.begin(), mNodeIds.end()),
+                   mNodeIds.end());
+
+    mNodeLookup.clear();
+    mNodeIdOffset = 0;
+
+    if (!mNodeIds.empty()) {
+        // The recorded nodes usually have contiguous IDs (cells or layers),
+        // the direct look-up table is used as long as it remains reasonably
+        // small
+        const std::size_t span = mNodeIds.back() - mNodeIds.front() + 1;
+
+        if (span <= std::max<std::size_t>(64, 4 * mNodeIds.size())) {
+            mNodeIdOffset = mNodeIds.front();
+            mNodeLookup.assign(span, -1);
+
+            for (unsigned int i = 0; i < mNodeIds.size(); ++i)
+                mNodeLookup[mNodeIds[i] - mNodeIdOffset] = i;
+        }
+    }
+
+    // Move the firing rates to the new node indexes
+    for (std::vector<std::vector<unsigned int> >::iterator it
+         = mFiringRate.begin(),
+         itEnd = mFiringRate.end();
+         it != itEnd;
+         ++it) {
+        std::vector<unsigned int> firingRate(mNodeIds.size(), 0);
+
+        for (unsigned int i = 0; i < prevNodeIds.size(); ++i)
+            firingRate[getNodeIndex(prevNodeIds[i])] = (*it)[i];
+
+        (*it).swap(firingRate);
+    }
+
+    mNbCompiledNodes = mNodes.size();
+}
+
+int N2D2::Monitor::getTypeIndex(EventType_T type)
+{
+    if (!mRecordEventTypes.empty()
+        && mRecordEventTypes.find(type) == mRecordEventTypes.end())
+        return -1;
+
+    mEventTypes.insert(type);
+
+    const std::vector<EventType_T>::const_iterator it
+        = std::find(mFiringRateTypes.begin(), mFiringRateTypes.end(), type);
+
+    if (it != mFiringRateTypes.end())
+        return (it - mFiringRateTypes.begin());
+
+    mFiringRateTypes.push_back(type);
+    mFiringRate.push_back(std::vector<unsigned int>(mNodeIds.size(), 0));
+    return (mFiringRateTypes.size() - 1);
+}
@@ -87,13 +87,302 @@ N2D2::NetworkObserver::~NetworkObserver()
     mNet.removeObserver(this);
 }
 
+const unsigned int N2D2::SpikeLog::ChunkBits;
+const std::size_t N2D2::SpikeLog::MaxChunkSize;
+const std::size_t N2D2::SpikeLog::MaxNbChunks;
+
+N2D2::SpikeLog::NodesIndex::NodesIndex()
+    : chunk(0),
+      event(0),
+      size(0)
+{
+    // ctor
+}
+
+void N2D2::SpikeLog::NodesIndex::clear()
+{
+    positions.clear();
+    chunk = 0;
+    event = 0;
+    size.store(0, std::memory_order_release);
+}
+
+N2D2::SpikeLog::SpikeLog()
+    : mSize(0)
+{
+    // ctor
+}
+
+void N2D2::SpikeLog::append(SpikeLog& log)
+{
+    if (log.empty())
+        return;
+
+    // The chunks are moved, not the events
+    mChunks.reserve(mChunks.size() + log.mChunks.size());
+
+    for (std::vector<Chunk>::iterator it = log.mChunks.begin(),
+         itEnd = log.mChunks.end(); it != itEnd; ++it)
+    {
+        if (!(*it).timestamps.empty())
+            mChunks.push_back(std::move(*it));
+    }
+
+    mSize += log.mSize;
+
+    log.mChunks.clear();
+    log.clear();
+}
+
+void N2D2::SpikeLog::clear()
+{
+    // Keep the first chunk allocated, as the log is usually cleared before
+    // each run
+    if (!mChunks.empty()) {
+        mChunks.resize(1);
+        mChunks[0].timestamps.clear();
+        mChunks[0].nodeIds.clear();
+        mChunks[0].types.clear();
+    }
+
+    mSize = 0;
+    mIndex.clear();
+}
+
+unsigned int N2D2::SpikeLog::getNodeActivity(NodeId_T nodeId,
+                                             Time_T start,
+                                             Time_T stop,
+                                             EventType_T type) const
+{
+    const std::vector<Position_T>* positions = getNodePositions(nodeId);
+    unsigned int activity = 0;
+
+    if (positions == NULL)
+        return activity;
+
+    for (std::vector<Position_T>::const_iterator it = positions->begin(),
+         itEnd = positions->end(); it != itEnd; ++it)
+    {
+        const Chunk& chunk = mChunks[(*it) >> ChunkBits];
+        const std::size_t offset = (*it) & (MaxChunkSize - 1);
+        const Time_T timestamp = chunk.timestamps[offset];
+
+        if (chunk.types[offset] == type && (start == 0 || timestamp >= start)
+            && (stop == 0 || timestamp < stop))
+            ++activity;
+    }
+
+    return activity;
+}
+
+std::pair<N2D2::Time_T, bool> N2D2::SpikeLog::getNodeFirstEvent(
+    NodeId_T nodeId, Time_T start, Time_T stop, EventType_T type) const
+{
+    const std::vector<Position_T>* positions = getNodePositions(nodeId);
+
+    if (positions == NULL)
+        return std::make_pair(0, false);
+
+    for (std::vector<Position_T>::const_iterator it = positions->begin(),
+         itEnd = positions->end(); it != itEnd; ++it)
+    {
+        const Chunk& chunk = mChunks[(*it) >> ChunkBits];
+        const std::size_t offset = (*it) & (MaxChunkSize - 1);
+        const Time_T timestamp = chunk.timestamps[offset];
+
+        if (chunk.types[offset] == type && (start == 0 || timestamp >= start)
+            && (stop == 0 || timestamp < stop))
+            return std::make_pair(timestamp, true);
+    }
+
+    return std::make_pair(0, false);
+}
+
+N2D2::NodeEvents_T N2D2::SpikeLog::getNodeEvents(NodeId_T nodeId) const
+{
+    const std::vector<Position_T>* positions = getNodePositions(nodeId);
+    NodeEvents_T events;
+
+    if (positions == NULL)
+        return events;
+
+    events.reserve(positions->size());
+
+    for (std::vector<Position_T>::const_iterator it = positions->begin(),
+         itEnd = positions->end(); it != itEnd; ++it)
+    {
+        const Chunk& chunk = mChunks[(*it) >> ChunkBits];
+        const std::size_t offset = (*it) & (MaxChunkSize - 1);
+
+        events.push_back(std::make_pair(chunk.timestamps[offset],
+                                        chunk.types[offset]));
+    }
+
+    return events;
+}
+
+std::unordered_map<N2D2::NodeId_T, N2D2::NodeEvents_T>
+N2D2::SpikeLog::getNodesEvents() const
+{
+    std::unordered_map<NodeId_T, NodeEvents_T> nodesEvents;
+
+    forEach([&nodesEvents](NodeId_T nodeId, Time_T timestamp,
+                           EventType_T type)
+        { nodesEvents[nodeId].push_back(std::make_pair(timestamp, type)); });
+
+    return nodesEvents;
+}
+
+void N2D2::SpikeLog::save(const std::string& fileName) const
+{
+    std::ofstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        throw std::runtime_error("Could not create spike log file: "
+                                 + fileName);
+
+    const unsigned long long int size = mSize;
+
+    data.write("N2D2SPKL", 8);
+    data.write(reinterpret_cast<const char*>(&size), sizeof(size));
+
+    for (std::vector<Chunk>::const_iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.write(reinterpret_cast<const char*>((*it).timestamps.data()),
+                   (*it).timestamps.size() * sizeof(Time_T));
+    }
+
+    for (std::vector<Chunk>::const_iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.write(reinterpret_cast<const char*>((*it).nodeIds.data()),
+                   (*it).nodeIds.size() * sizeof(NodeId_T));
+    }
+
+    for (std::vector<Chunk>::const_iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.write(reinterpret_cast<const char*>((*it).types.data()),
+                   (*it).types.size() * sizeof(EventType_T));
+    }
+
+    if (!data.good())
+        throw std::runtime_error("Error writing spike log file: " + fileName);
+}
+
+void N2D2::SpikeLog::load(const std::string& fileName)
+{
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        throw std::runtime_error("Could not open spike log file: " + fileName);
+
+    char signature[8];
+    unsigned long long int size = 0;
+
+    data.read(signature, 8);
+    data.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+    if (!data.good() || std::string(signature, 8) != "N2D2SPKL")
+        throw std::runtime_error("Invalid spike log file: " + fileName);
+
+    clear();
+    mChunks.resize(std::max<std::size_t>(1,
+        (size + MaxChunkSize - 1) / MaxChunkSize));
+
+    for (std::size_t c = 0; c < mChunks.size(); ++c) {
+        const std::size_t chunkSize
+            = std::min<std::size_t>(MaxChunkSize, size - c * MaxChunkSize);
+
+        mChunks[c].timestamps.resize(chunkSize);
+        mChunks[c].nodeIds.resize(chunkSize);
+        mChunks[c].types.resize(chunkSize);
+    }
+
+    for (std::vector<Chunk>::iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.read(reinterpret_cast<char*>((*it).timestamps.data()),
+                  (*it).timestamps.size() * sizeof(Time_T));
+    }
+
+    for (std::vector<Chunk>::iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.read(reinterpret_cast<char*>((*it).nodeIds.data()),
+                  (*it).nodeIds.size() * sizeof(NodeId_T));
+    }
+
+    for (std::vector<Chunk>::iterator it = mChunks.begin(),
+         itEnd = mChunks.end(); it != itEnd; ++it)
+    {
+        data.read(reinterpret_cast<char*>((*it).types.data()),
+                  (*it).types.size() * sizeof(EventType_T));
+    }
+
+    if (!data.good()) {
+        clear();
+        throw std::runtime_error("Error reading spike log file: " + fileName);
+    }
+
+    mSize = size;
+}
+
+const std::vector<N2D2::SpikeLog::Position_T>*
+N2D2::SpikeLog::getNodePositions(NodeId_T nodeId) const
+{
+    indexNodes();
+
+    // The index is complete, it is not modified by the concurrent queries
+    const std::unordered_map<NodeId_T, std::vector<Position_T> >
+        ::const_iterator it = mIndex.positions.find(nodeId);
+
+    return (it != mIndex.positions.end()) ? &(*it).second : NULL;
+}
+
+void N2D2::SpikeLog::indexNodes() const
+{
+    if (mIndex.size.load(std::memory_order_acquire) == mSize)
+        return;
+
+    if (mChunks.size() > MaxNbChunks)
+        throw std::runtime_error("SpikeLog: too many chunks to index");
+
+#pragma omp critical(SpikeLog__indexNodes)
+    {
+        if (mIndex.size.load(std::memory_order_relaxed) != mSize) {
+            for (; mIndex.chunk < mChunks.size(); ++mIndex.chunk) {
+                const std::vector<NodeId_T>& nodeIds
+                    = mChunks[mIndex.chunk].nodeIds;
+                const Position_T chunkPos = mIndex.chunk << ChunkBits;
+
+                for (; mIndex.event < nodeIds.size(); ++mIndex.event) {
+                    mIndex.positions[nodeIds[mIndex.event]].push_back(
+                        chunkPos | mIndex.event);
+                }
+
+                // The last chunk may still grow
+                if (mIndex.chunk + 1 == mChunks.size())
+                    break;
+
+                mIndex.event = 0;
+            }
+
+            mIndex.size.store(mSize, std::memory_order_release);
+        }
+    }
+}
+
 N2D2::Network::Network(unsigned int seed)
     : mInitialized(false),
       mFirstEvent(0),
       mLastEvent(0),
       mStop(0),
       mDiscard(false),
-      mStartTime(std::chrono::high_resolution_clock::now())
+      mStartTime(std::chrono::high_resolution_clock::now()),
+      mNbPartitions(0),
+      mParallel(false)
 {
 // ctor
 #if !defined(WIN32) && !defined(__APPLE__) && !defined(__CYGWIN__) && !defined(_WIN32)
@@ -138,7 +427,7 @@ N2D2::Network::Network(unsigned int seed)
 bool N2D2::Network::run(Time_T stop, bool clearActivity)
 {
     if (clearActivity)
-        mSpikeRecording.clear();
+        mSpikeLog.clear();
 
     // Auto-initialization the first time run() is lauched
     if (!mInitialized) {
@@ -151,15 +440,37 @@ bool N2D2::Network::run(Time_T stop, bool clearActivity)
         mInitialized = true;
     }
 
-    SpikeEvent* event;
-    bool stopped = false;
-
     if (!mEvents.empty())
         mFirstEvent = mEvents.top()->getTimestamp();
 
     mStop = stop;
     mDiscard = false;
 
+    const bool stopped = (mNbPartitions > 1) ? runParallel()
+                                             : runSequential();
+
+    if (mDiscard) {
+        while (!mEvents.empty()) {
+            mEventsPool.push(mEvents.top());
+            mEvents.pop();
+        }
+    }
+
+    std::for_each(mObservers.begin(),
+                  mObservers.end(),
+                  std::bind(&NetworkObserver::notify,
+                            std::placeholders::_1,
+                            mLastEvent,
+                            NetworkObserver::Finalize));
+
+    return stopped;
+}
+
+bool N2D2::Network::runSequential()
+{
+    SpikeEvent* event;
+    bool stopped = false;
+
     while (!mEvents.empty()) {
         event = mEvents.top();
 
@@ -201,23 +512,317 @@ bool N2D2::Network::run(Time_T stop, bool clearActivity)
         mEventsPool.push(event);
     }
 
-    if (mDiscard) {
-        while (!mEvents.empty()) {
-            mEventsPool.push(mEvents.top());
-            mEvents.pop();
+    return stopped;
+}
+
+bool N2D2::Network::runParallel()
+{
+    if (std::find_if(mObservers.begin(), mObservers.end(),
+                     std::mem_fn(&NetworkObserver::canStop))
+        != mObservers.end())
+    {
+        std::cout << Utils::cwarning << "Network::run(): the simulation can "
+            "be stopped from within, falling back to the sequential engine"
+            << Utils::cdef << std::endl;
+        return runSequential();
+    }
+
+    const Time_T lookahead = partitionNodes();
+
+    if (lookahead == 0 || mPartitions.size() < 2) {
+        std::cout << Utils::cwarning << "Network::run(): no delay between the "
+            "partitions of the parallel engine, falling back to the sequential "
+            "engine" << Utils::cdef << std::endl;
+        return runSequential();
+    }
+
+    const int nbPartitions = mPartitions.size();
+
+    for (int p = 0; p < nbPartitions; ++p)
+        mPartitions[p].lastEvent = mLastEvent;
+
+    // Distribute the pending events among the partitions
+    while (!mEvents.empty()) {
+        SpikeEvent* event = mEvents.top();
+        mEvents.pop();
+
+        if (event->isDiscarded())
+            mEventsPool.push(event);
+        else
+            mPartitions[getPartition(event)].events.push(event);
+    }
+
+    mThreadPartition.assign(omp_get_max_threads(), 0);
+    mParallel = true;
+
+    bool stopped = false;
+    std::string errorMsg;
+
+    while (true) {
+        // The next time window starts with the earliest pending event. No
+        // event of a partition can affect another partition within less than
+        // the lookahead, so the partitions are independent in the window.
+        Time_T start = std::numeric_limits<Time_T>::max();
+
+        for (int p = 0; p < nbPartitions; ++p) {
+            if (!mPartitions[p].events.empty()) {
+                start = std::min(start,
+                                 mPartitions[p].events.top()->getTimestamp());
+            }
+        }
+
+        if (start == std::numeric_limits<Time_T>::max())
+            break;
+
+        if (mStop > 0 && start >= mStop) {
+            stopped = true;
+            break;
         }
+
+        Time_T horizon = (lookahead < std::numeric_limits<Time_T>::max() - start)
+            ? start + lookahead : std::numeric_limits<Time_T>::max();
+
+        if (mStop > 0 && mStop < horizon)
+            horizon = mStop;
+
+#pragma omp parallel for schedule(dynamic)
+        for (int p = 0; p < nbPartitions; ++p) {
+            mThreadPartition[omp_get_thread_num()] = p;
+
+            try {
+                runPartition(mPartitions[p], horizon);
+            }
+            catch (const std::exception& e) {
+#pragma omp critical(Network__runParallel)
+                {
+                    if (errorMsg.empty())
+                        errorMsg = e.what();
+                }
+            }
+        }
+
+        // Deliver the events sent to the other partitions
+        for (int src = 0; src < nbPartitions; ++src) {
+            for (int dst = 0; dst < nbPartitions; ++dst) {
+                std::vector<SpikeEvent*>& outbox = mPartitions[src].outbox[dst];
+
+                for (std::vector<SpikeEvent*>::const_iterator it
+                     = outbox.begin(), itEnd = outbox.end(); it != itEnd; ++it)
+                {
+                    mPartitions[dst].events.push(*it);
+                }
+
+                outbox.clear();
+            }
+        }
+
+        if (!errorMsg.empty())
+            break;
     }
 
-    std::for_each(mObservers.begin(),
-                  mObservers.end(),
-                  std::bind(&NetworkObserver::notify,
-                            std::placeholders::_1,
-                            mLastEvent,
-                            NetworkObserver::Finalize));
+    mParallel = false;
+
+    // Gather the partitions state back into the network
+    for (int p = 0; p < nbPartitions; ++p) {
+        Partition& partition = mPartitions[p];
+
+        mLastEvent = std::max(mLastEvent, partition.lastEvent);
+
+        while (!partition.events.empty()) {
+            mEvents.push(partition.events.top());
+            partition.events.pop();
+        }
+
+        while (!partition.eventsPool.empty()) {
+            mEventsPool.push(partition.eventsPool.top());
+            partition.eventsPool.pop();
+        }
+
+        // A node belongs to a single partition, so its recorded events
+        // remain in chronological order
+        mSpikeLog.append(partition.spikeLog);
+    }
+
+    if (!errorMsg.empty())
+        throw std::runtime_error(errorMsg);
 
     return stopped;
 }
 
+/**
+ * Distribute the nodes among the partitions of the parallel engine and
+ * return the lookahead, which is the minimum delay of the connections between
+ * partitions.
+ * Nodes connected through lateral inhibition or without incoming delay are
+ * merged in the same partition, and the resulting groups are distributed to
+ * balance the number of nodes per partition.
+*/
+N2D2::Time_T N2D2::Network::partitionNodes()
+{
+    std::vector<Node*> nodes;
+
+    for (std::set<NetworkObserver*>::const_iterator it = mObservers.begin(),
+         itEnd = mObservers.end(); it != itEnd; ++it)
+    {
+        Node* node = dynamic_cast<Node*>(*it);
+
+        if (node != NULL)
+            nodes.push_back(node);
+    }
+
+    // Node IDs give a deterministic partitioning, unlike the node addresses
+    std::sort(nodes.begin(), nodes.end(),
+              [](const Node* a, const Node* b)
+                { return (a->getId() < b->getId()); });
+
+    std::unordered_map<const Node*, unsigned int> nodeIndex;
+
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        nodeIndex[nodes[i]] = i;
+
+    // Union-find of the nodes that must be in the same partition
+    std::vector<unsigned int> parent(nodes.size());
+    std::iota(parent.begin(), parent.end(), 0U);
+
+    const std::function<unsigned int(unsigned int)> find
+        = [&parent](unsigned int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+
+            return i;
+        };
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        const NodeNeuron* neuron = dynamic_cast<const NodeNeuron*>(nodes[i]);
+
+        if (neuron != NULL) {
+            const std::vector<NodeNeuron*>& lateralBranches
+                = neuron->getLateralBranches();
+
+            for (std::vector<NodeNeuron*>::const_iterator it
+                 = lateralBranches.begin(), itEnd = lateralBranches.end();
+                 it != itEnd; ++it)
+            {
+                parent[find(nodeIndex.at(*it))] = find(i);
+            }
+        }
+
+        const std::vector<Node*>& branches = nodes[i]->getBranches();
+
+        for (std::vector<Node*>::const_iterator it = branches.begin(),
+             itEnd = branches.end(); it != itEnd; ++it)
+        {
+            if ((*it)->getMinIncomingDelay() == 0)
+                parent[find(nodeIndex.at(*it))] = find(i);
+        }
+    }
+
+    std::map<unsigned int, std::vector<unsigned int> > groups;
+
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        groups[find(i)].push_back(i);
+
+    std::vector<std::vector<unsigned int> > sortedGroups;
+
+    for (std::map<unsigned int, std::vector<unsigned int> >::iterator it
+         = groups.begin(), itEnd = groups.end(); it != itEnd; ++it)
+    {
+        sortedGroups.push_back(std::vector<unsigned int>());
+        sortedGroups.back().swap((*it).second);
+    }
+
+    std::stable_sort(sortedGroups.begin(), sortedGroups.end(),
+                     [](const std::vector<unsigned int>& a,
+                        const std::vector<unsigned int>& b)
+                        { return (a.size() > b.size()); });
+
+    // Largest groups first, to the least loaded partition
+    const unsigned int nbPartitions
+        = std::min<unsigned int>(mNbPartitions, sortedGroups.size());
+    std::vector<std::size_t> loads(nbPartitions, 0);
+
+    mNodePartition.clear();
+
+    for (std::vector<std::vector<unsigned int> >::const_iterator it
+         = sortedGroups.begin(), itEnd = sortedGroups.end(); it != itEnd; ++it)
+    {
+        const unsigned int partition = std::min_element(loads.begin(),
+                                                        loads.end())
+                                        - loads.begin();
+
+        for (std::vector<unsigned int>::const_iterator itNode = (*it).begin(),
+             itNodeEnd = (*it).end(); itNode != itNodeEnd; ++itNode)
+        {
+            mNodePartition[nodes[*itNode]] = partition;
+        }
+
+        loads[partition] += (*it).size();
+    }
+
+    mPartitions.resize(nbPartitions);
+
+    for (unsigned int p = 0; p < nbPartitions; ++p)
+        mPartitions[p].outbox.assign(nbPartitions, std::vector<SpikeEvent*>());
+
+    // Lookahead
+    Time_T lookahead = std::numeric_limits<Time_T>::max();
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        const std::vector<Node*>& branches = nodes[i]->getBranches();
+
+        for (std::vector<Node*>::const_iterator it = branches.begin(),
+             itEnd = branches.end(); it != itEnd; ++it)
+        {
+            if (mNodePartition[*it] != mNodePartition[nodes[i]]) {
+                lookahead = std::min(lookahead,
+                                     (*it)->getMinIncomingDelay());
+            }
+        }
+    }
+
+    return lookahead;
+}
+
+void N2D2::Network::runPartition(Partition& partition, Time_T horizon)
+{
+    while (!partition.events.empty()) {
+        SpikeEvent* event = partition.events.top();
+
+        if (event->isDiscarded()) {
+            partition.events.pop();
+            partition.eventsPool.push(event);
+            continue;
+        }
+
+        if (event->getTimestamp() >= horizon)
+            break;
+
+        // Safety check
+        if (event->getTimestamp() < partition.lastEvent) {
+            std::ostringstream errorMsg;
+            errorMsg
+                << "Cannot go back in time! I want to deal with event at time "
+                << event->getTimestamp() << " whereas last event was at "
+                << partition.lastEvent << ", type is " << event->getType();
+            throw std::runtime_error(errorMsg.str());
+        }
+
+        partition.events.pop();
+        partition.lastEvent = event->release();
+        partition.eventsPool.push(event);
+    }
+}
+
+unsigned int N2D2::Network::getPartition(const SpikeEvent* event) const
+{
+    const Node* node = (event->getDestination() != NULL)
+        ? event->getDestination() : event->getOrigin();
+
+    return mNodePartition.at(node);
+}
+
 void N2D2::Network::reset(Time_T timestamp)
 {
     mFirstEvent = timestamp;
@@ -271,17 +876,31 @@ N2D2::SpikeEvent* N2D2::Network::newEvent(Node* origin,
                                           Time_T timestamp,
                                           EventType_T type)
 {
+    std::stack<SpikeEvent*>& eventsPool = (mParallel)
+        ? mPartitions[mThreadPartition[omp_get_thread_num()]].eventsPool
+        : mEventsPool;
     SpikeEvent* event;
 
-    if (mEventsPool.empty())
+    if (eventsPool.empty())
         event = new SpikeEvent(origin, destination, timestamp, type);
     else {
-        event = mEventsPool.top();
-        mEventsPool.pop();
+        event = eventsPool.top();
+        eventsPool.pop();
         event->initialize(origin, destination, timestamp, type);
     }
 
-    mEvents.push(event);
+    if (mParallel) {
+        const unsigned int src = mThreadPartition[omp_get_thread_num()];
+        const unsigned int dst = getPartition(event);
+
+        if (dst == src)
+            mPartitions[src].events.push(event);
+        else
+            mPartitions[src].outbox[dst].push_back(event);
+    }
+    else
+        mEvents.push(event);
+
     return event;
 }
 
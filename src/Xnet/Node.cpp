@@ -69,18 +69,7 @@ N2D2::Node::getActivity(Time_T start, Time_T stop, EventType_T type) const
     if (!mActivityRecording)
         throw std::runtime_error("Activity not recorded for this node.");
 
-    const NodeEvents_T& record = mNet.getSpikeRecording(mId);
-    unsigned int activity = 0;
-
-    for (NodeEvents_T::const_iterator it = record.begin(), itEnd = record.end();
-         it != itEnd;
-         ++it) {
-        if ((*it).second == type && (start == 0 || (*it).first >= start)
-            && (stop == 0 || (*it).first < stop))
-            ++activity;
-    }
-
-    return activity;
+    return mNet.getSpikeLog().getNodeActivity(mId, start, stop, type);
 }
 
 std::pair<N2D2::Time_T, bool> N2D2::Node::getFirstActivationTime(
@@ -89,15 +78,5 @@ std::pair<N2D2::Time_T, bool> N2D2::Node::getFirstActivationTime(
     if (!mActivityRecording)
         throw std::runtime_error("Activity not recorded for this node.");
 
-    const NodeEvents_T& record = mNet.getSpikeRecording(mId);
-
-    for (NodeEvents_T::const_iterator it = record.begin(), itEnd = record.end();
-         it != itEnd;
-         ++it) {
-        if ((*it).second == type && (start == 0 || (*it).first >= start)
-            && (stop == 0 || (*it).first < stop))
-            return std::make_pair((*it).first, true);
-    }
-
-    return std::make_pair(0, false);
+    return mNet.getSpikeLog().getNodeFirstEvent(mId, start, stop, type);
 }
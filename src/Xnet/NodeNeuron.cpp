@@ -28,6 +28,8 @@ N2D2::NodeNeuron::NodeNeuron(Network& net)
     : Node(net),
       // Internal variables
       mInitializedState(false),
+      mLinkIdOffset(0),
+      mLinksCompiled(false),
       mStateLogPlot(false),
       mCacheValid(false)
 {
@@ -61,6 +63,7 @@ void N2D2::NodeNeuron::addLink(Node* origin)
     // Add the connexion
     mLinks.insert(std::make_pair(origin, newSynapse()));
     origin->addBranch(this);
+    mLinksCompiled = false;
 }
 
 void N2D2::NodeNeuron::addLateralBranch(NodeNeuron* lateralBranch)
@@ -77,8 +80,12 @@ void N2D2::NodeNeuron::notify(Time_T timestamp, NotifyType notify)
 {
     Node::notify(timestamp, notify);
 
-    if (notify == Initialize)
+    if (notify == Initialize) {
+        if (!mLinksCompiled)
+            compileLinks();
+
         initialize();
+    }
     else if (notify == Finalize) {
         finalize();
 
@@ -99,6 +106,51 @@ void N2D2::NodeNeuron::notify(Time_T timestamp, NotifyType notify)
         save(mNet.getLoadSavePath());
 }
 
+void N2D2::NodeNeuron::compileLinks()
+{
+    std::vector<std::pair<NodeId_T, Node*> > links;
+    links.reserve(mLinks.size());
+
+    for (std::unordered_map<Node*, Synapse*>::const_iterator it
+         = mLinks.begin(),
+         itEnd = mLinks.end();
+         it != itEnd;
+         ++it)
+        links.push_back(std::make_pair((*it).first->getId(), (*it).first));
+
+    std::sort(links.begin(), links.end());
+
+    mLinkNodes.resize(links.size());
+    mLinkSynapses.resize(links.size());
+    mLinkIds.resize(links.size());
+
+    for (unsigned int i = 0; i < links.size(); ++i) {
+        mLinkIds[i] = links[i].first;
+        mLinkNodes[i] = links[i].second;
+        mLinkSynapses[i] = mLinks[links[i].second];
+    }
+
+    mLinkLookup.clear();
+    mLinkIdOffset = 0;
+
+    if (!links.empty()) {
+        // The input nodes of a neuron usually have contiguous IDs (previous
+        // layer or receptive field rows), the direct look-up table is used
+        // as long as it remains reasonably small
+        const std::size_t span = links.back().first - links.front().first + 1;
+
+        if (span <= std::max<std::size_t>(64, 4 * links.size())) {
+            mLinkIdOffset = links.front().first;
+            mLinkLookup.assign(span, -1);
+
+            for (unsigned int i = 0; i < links.size(); ++i)
+                mLinkLookup[mLinkIds[i] - mLinkIdOffset] = i;
+        }
+    }
+
+    mLinksCompiled = true;
+}
+
 void N2D2::NodeNeuron::readActivity(const std::vector<Time_T>& activity)
 {
     // /!\ C'est bien Node::emitSpike() qui doit être appelé ici et pas
@@ -60,11 +60,26 @@ N2D2::NodeNeuron_Behavioral::NodeNeuron_Behavioral(Network& net)
       mLastSpikeTime(0),
       mEvent(NULL),
       mRefractoryEnd(0),
-      mLastStdp(0)
+      mLastStdp(0),
+      mLtpFifoHead(-1),
+      mLtpFifoTail(-1),
+      mLtpFifoSize(0)
 {
     // ctor
 }
 
+N2D2::NodeNeuron_Behavioral::~NodeNeuron_Behavioral()
+{
+    // The pooled synapses are released with mSynapses, not by ~NodeNeuron()
+    for (std::unordered_map<Node*, Synapse*>::iterator it = mLinks.begin(),
+                                                       itEnd = mLinks.end();
+         it != itEnd;
+         ++it) {
+        if (isPooledSynapse((*it).second))
+            (*it).second = NULL;
+    }
+}
+
 N2D2::Synapse* N2D2::NodeNeuron_Behavioral::newSynapse() const
 {
     return new Synapse_Behavioral(mIncomingDelay.spreadNormal(0),
@@ -77,12 +92,125 @@ N2D2::Synapse* N2D2::NodeNeuron_Behavioral::newSynapse() const
                                   mWeightsInit.spreadNormal(0));
 }
 
+void N2D2::NodeNeuron_Behavioral::compileLinks()
+{
+    // Keep the STDP FIFO content, as the link indexes may change
+    std::vector<Node*> ltpFifo;
+
+    for (int link = mLtpFifoHead; link >= 0; link = mLtpFifoNext[link])
+        ltpFifo.push_back(mLinkNodes[link]);
+
+    NodeNeuron::compileLinks();
+
+    // Relocate the synapses contiguously, in the compiled links order
+    std::vector<Synapse_Behavioral> synapses;
+    synapses.reserve(mLinkSynapses.size());
+
+    for (std::vector<Synapse*>::const_iterator it = mLinkSynapses.begin(),
+                                               itEnd = mLinkSynapses.end();
+         it != itEnd;
+         ++it)
+        synapses.push_back(*static_cast<Synapse_Behavioral*>(*it));
+
+    for (std::vector<Synapse*>::const_iterator it = mLinkSynapses.begin(),
+                                               itEnd = mLinkSynapses.end();
+         it != itEnd;
+         ++it)
+    {
+        if (!isPooledSynapse(*it))
+            delete (*it);
+    }
+
+    mSynapses.swap(synapses);
+
+    for (unsigned int link = 0; link < mSynapses.size(); ++link) {
+        mLinkSynapses[link] = &mSynapses[link];
+        mLinks[mLinkNodes[link]] = &mSynapses[link];
+    }
+
+    mLtpFifoPrev.assign(mSynapses.size(), -1);
+    mLtpFifoNext.assign(mSynapses.size(), -1);
+    mLtpFifoIn.assign(mSynapses.size(), false);
+    mLtpFifoHead = -1;
+    mLtpFifoTail = -1;
+    mLtpFifoSize = 0;
+
+    for (std::vector<Node*>::const_iterator it = ltpFifo.begin(),
+                                            itEnd = ltpFifo.end();
+         it != itEnd;
+         ++it)
+        ltpFifoPush(getLinkIndex(*it));
+}
+
+void N2D2::NodeNeuron_Behavioral::ltpFifoPush(int link)
+{
+    if (mLtpFifoIn[link]) {
+        if (link == mLtpFifoTail)
+            return;
+
+        // Unlink, before moving it to the end
+        if (mLtpFifoPrev[link] >= 0)
+            mLtpFifoNext[mLtpFifoPrev[link]] = mLtpFifoNext[link];
+        else
+            mLtpFifoHead = mLtpFifoNext[link];
+
+        mLtpFifoPrev[mLtpFifoNext[link]] = mLtpFifoPrev[link];
+    }
+    else {
+        mLtpFifoIn[link] = true;
+        ++mLtpFifoSize;
+    }
+
+    mLtpFifoPrev[link] = mLtpFifoTail;
+    mLtpFifoNext[link] = -1;
+
+    if (mLtpFifoTail >= 0)
+        mLtpFifoNext[mLtpFifoTail] = link;
+    else
+        mLtpFifoHead = link;
+
+    mLtpFifoTail = link;
+
+    if (mLtpFifoSize > mOrderStdp) {
+        // Pop front
+        const int head = mLtpFifoHead;
+        mLtpFifoHead = mLtpFifoNext[head];
+        mLtpFifoPrev[mLtpFifoHead] = -1;
+        mLtpFifoNext[head] = -1;
+        mLtpFifoIn[head] = false;
+        --mLtpFifoSize;
+    }
+}
+
+void N2D2::NodeNeuron_Behavioral::ltpFifoClear()
+{
+    int link = mLtpFifoHead;
+
+    while (link >= 0) {
+        const int next = mLtpFifoNext[link];
+        mLtpFifoPrev[link] = -1;
+        mLtpFifoNext[link] = -1;
+        mLtpFifoIn[link] = false;
+        link = next;
+    }
+
+    mLtpFifoHead = -1;
+    mLtpFifoTail = -1;
+    mLtpFifoSize = 0;
+}
+
 void N2D2::NodeNeuron_Behavioral::propagateSpike(Node* origin,
                                                  Time_T timestamp,
                                                  EventType_T type)
 {
-    const Time_T delay = static_cast
-                         <Synapse_Behavioral*>(mLinks[origin])->delay;
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_Behavioral::propagateSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    const Time_T delay = mSynapses[link].delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -90,29 +218,43 @@ void N2D2::NodeNeuron_Behavioral::propagateSpike(Node* origin,
         incomingSpike(origin, timestamp, type);
 }
 
+N2D2::Time_T N2D2::NodeNeuron_Behavioral::getMinIncomingDelay() const
+{
+    // The non-FIFO STDP reads the last activation time of the input nodes
+    if (!mLinksCompiled || mSynapses.empty()
+        || (mEnableStdp && mOrderStdp == 0))
+    {
+        return 0;
+    }
+
+    Time_T minDelay = std::numeric_limits<Time_T>::max();
+
+    for (std::vector<Synapse_Behavioral>::const_iterator it
+         = mSynapses.begin(), itEnd = mSynapses.end(); it != itEnd; ++it)
+    {
+        minDelay = std::min(minDelay, (*it).delay);
+    }
+
+    return minDelay;
+}
+
 void N2D2::NodeNeuron_Behavioral::incomingSpike(Node* origin,
                                                 Time_T timestamp,
                                                 EventType_T /*type*/)
 {
-    Synapse_Behavioral* synapse = static_cast
-        <Synapse_Behavioral*>(mLinks[origin]);
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_Behavioral::incomingSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    Synapse_Behavioral* synapse = &mSynapses[link];
     ++synapse->statsReadEvents;
 
     // LTP
-    if (mEnableStdp && mOrderStdp > 0) {
-        std::deque<Synapse_Behavioral*>::iterator it
-            = std::find(mLtpFifo.begin(), mLtpFifo.end(), synapse);
-
-        if (it == mLtpFifo.end()) {
-            mLtpFifo.push_back(synapse);
-
-            if (mLtpFifo.size() > mOrderStdp)
-                mLtpFifo.pop_front();
-        } else if (it != mLtpFifo.begin() + mLtpFifo.size() - 1) {
-            mLtpFifo.erase(it);
-            mLtpFifo.push_back(synapse);
-        }
-    }
+    if (mEnableStdp && mOrderStdp > 0)
+        ltpFifoPush(link);
 
     const Time_T dt = timestamp - mLastSpikeTime;
 
@@ -189,39 +331,26 @@ void N2D2::NodeNeuron_Behavioral::emitSpike(Time_T timestamp, EventType_T type)
     if (mEnableStdp && mAllowStdp) {
         unsigned int ltp = 0;
 
-        if (mOrderStdp > 0) {
-            for (std::deque<Synapse_Behavioral*>::const_iterator it
-                 = mLtpFifo.begin(),
-                 itEnd = mLtpFifo.end();
-                 it != itEnd;
-                 ++it) {
-                increaseWeight((*it), (*it)->weightIncrement);
-                ++ltp;
-            }
+        if (!mLinksCompiled)
+            compileLinks();
+
+        const unsigned int nbLinks = mSynapses.size();
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
+        if (mOrderStdp > 0) {
+            for (unsigned int link = 0; link < nbLinks; ++link) {
+                Synapse_Behavioral* synapse = &mSynapses[link];
 
-                if (std::find(mLtpFifo.begin(), mLtpFifo.end(), synapse)
-                    == mLtpFifo.end())
+                if (mLtpFifoIn[link]) {
+                    increaseWeight(synapse, synapse->weightIncrement);
+                    ++ltp;
+                }
+                else
                     decreaseWeight(synapse, synapse->weightDecrement);
             }
         } else {
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
-
-                if (stdp(synapse,
-                         (*it).first->getLastActivationTime(),
+            for (unsigned int link = 0; link < nbLinks; ++link) {
+                if (stdp(&mSynapses[link],
+                         mLinkNodes[link]->getLastActivationTime(),
                          timestamp))
                     ++ltp;
             }
@@ -294,7 +423,7 @@ void N2D2::NodeNeuron_Behavioral::reset(Time_T timestamp)
 
     if (mEnableStdp) {
         mLastStdp = 0;
-        mLtpFifo.clear();
+        ltpFifoClear();
     }
 
     if (mStateLog.is_open())
@@ -93,7 +93,14 @@ void N2D2::NodeNeuron_PCM::propagateSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_PCM*>(mLinks[origin])->delay;
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_PCM::propagateSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    const Time_T delay = static_cast<Synapse_PCM*>(mLinkSynapses[link])->delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -105,7 +112,14 @@ void N2D2::NodeNeuron_PCM::incomingSpike(Node* origin,
                                          Time_T timestamp,
                                          EventType_T /*type*/)
 {
-    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mLinks[origin]);
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_PCM::incomingSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mLinkSynapses[link]);
 
     // Stats
     ++synapse->statsReadEvents;
@@ -94,7 +94,14 @@ void N2D2::NodeNeuron_RRAM::propagateSpike(Node* origin,
                                            Time_T timestamp,
                                            EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_RRAM*>(mLinks[origin])->delay;
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_RRAM::propagateSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    const Time_T delay = static_cast<Synapse_RRAM*>(mLinkSynapses[link])->delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -106,7 +113,14 @@ void N2D2::NodeNeuron_RRAM::incomingSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T /*type*/)
 {
-    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mLinks[origin]);
+    const int link = getLinkIndex(origin);
+
+    if (link < 0) {
+        throw std::runtime_error("NodeNeuron_RRAM::incomingSpike(): no "
+                                 "synaptic link from the origin node");
+    }
+
+    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mLinkSynapses[link]);
 
     // Stats
     ++synapse->statsReadEvents;
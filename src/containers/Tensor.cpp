@@ -20,6 +20,7 @@
 
 #include "containers/Tensor.hpp"
 
+#include <atomic>
 #include <complex>
 #include <sstream>
 #include <stdexcept>
@@ -80,6 +81,16 @@ namespace {
 }
 
 
+/**
+ * BaseDataTensor
+ */
+unsigned long long N2D2::BaseDataTensor::newGeneration()
+{
+    // Starts at 1, 0 is never a valid generation
+    static std::atomic<unsigned long long> generation(0);
+    return ++generation;
+}
+
 /**
  * BaseTensor
  */
@@ -517,8 +528,8 @@ void N2D2::Tensor<T>::save(std::ostream& stream) const
 
     stream.write(reinterpret_cast<const char*>(&mSize), sizeof(mSize));
 
-    for (typename std::vector<T>::const_iterator it = (*mData)().begin();
-        it != (*mData)().end(); ++it)
+    for (typename std::vector<T>::const_iterator it = data().begin();
+        it != data().end(); ++it)
     {
         const T value = (*it);
         stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
@@ -580,6 +591,27 @@ void N2D2::Tensor<T>::swap(Tensor<T>& tensor)
     assert((*tensor.mData)().size() == tensor.size());
 }
 
+/**
+ * Make this tensor a view of the data of @p tensor, keeping its own
+ * dimensions. No data is copied: any later modification of the data through
+ * one of the tensors is visible in the other. Calling share() again on every
+ * pass is cheap and keeps the view valid if @p tensor storage was reallocated.
+*/
+template <class T>
+void N2D2::Tensor<T>::share(const Tensor<T>& tensor)
+{
+    if (tensor.size() != size()) {
+        throw std::runtime_error("Tensor<T>::share(): tensor size mismatch");
+    }
+
+    if (mData != tensor.mData) {
+        mData = tensor.mData;
+        mDataTensors.clear();
+    }
+
+    mDataOffset = tensor.mDataOffset;
+}
+
 template <class T>
 N2D2::Tensor<T> N2D2::Tensor<T>::clone() const {
     return Tensor<T>(mDims,
@@ -691,16 +723,16 @@ const N2D2::Tensor<T> N2D2::Tensor<T>::rows(size_t j0,
         std::vector<T> newData;
         newData.reserve(newSize);
 
-        while (offset < (*mData)().size()) {
-            assert(offset < (*mData)().size());
+        while (offset < data().size()) {
+            assert(offset < data().size());
             newData.insert(newData.end(),
-                          (*mData)().begin() + offset + stride * j0,
-                          (*mData)().begin() + offset + stride * (j0 + nb));
+                          data().begin() + offset + stride * j0,
+                          data().begin() + offset + stride * (j0 + nb));
 
             offset += stride * mDims[absTowardsDim];
         }
 
-        assert(offset == (*mData)().size());
+        assert(offset == data().size());
         assert(newData.size() == newSize);
 
         Tensor<T> subTensor(newDims);
@@ -830,7 +862,7 @@ typename N2D2::Tensor<T>::const_reference N2D2::Tensor<T>::operator()(const Inde
         offset = index[dim] + mDims[dim] * offset;
     }
 
-    return (*mData)()[mDataOffset + offset];
+    return data()[mDataOffset + offset];
 }
 
 //TODO: Generalize this to different data types and subtensors?
@@ -841,8 +873,8 @@ double N2D2::Tensor<T>::sum() const
 
     double sum = 0.0;
 
-    for (typename std::vector<T>::iterator it = (*mData)().begin();
-        it != (*mData)().end(); ++it)
+    for (typename std::vector<T>::const_iterator it = data().begin();
+        it != data().end(); ++it)
     {
         sum += convertValue<double>(*it);
     }
@@ -853,7 +885,7 @@ double N2D2::Tensor<T>::sum() const
 template <class T>
 double N2D2::Tensor<T>::mean() const
 {
-    return sum()/(*mData)().size();
+    return sum()/data().size();
 }
 
 template <class T>
@@ -866,7 +898,7 @@ bool N2D2::Tensor<T>::operator==(const Tensor& other) const {
         return true;
     }
 
-    assert((*mData)().size() == (*other.mData)().size());
+    assert(data().size() == other.data().size());
     return std::equal(begin(), end(), other.begin());
 }
 
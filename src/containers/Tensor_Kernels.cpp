@@ -0,0 +1,143 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "containers/Tensor_Kernels.hpp"
+
+// half_float::half only holds its binary representation, which is accessed
+// directly as uint16_t
+static_assert(sizeof(half_float::half) == sizeof(uint16_t),
+              "Unexpected half_float::half size");
+
+void N2D2::Tensor_Kernels::convert(const float* src,
+                                   half_float::half* dst,
+                                   std::size_t size)
+{
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+#ifdef __AVX2__
+    uint16_t* dstBits = reinterpret_cast<uint16_t*>(dst);
+#endif
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const int offset = block * BlockSize;
+        const int end = (int)std::min(offset + BlockSize, size);
+
+#ifdef __AVX2__
+        // Same rounding as float2half<round_indeterminate>(), which truncates
+        // the mantissa, but without the lookup tables, so that the loop is
+        // vectorizable. Without AVX2, narrowing the 32 bits lanes costs more
+        // than the table lookups.
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = offset; i < end; ++i) {
+            // Signed integers are used, as SSE/AVX have no unsigned
+            // comparison
+            int32_t bits;
+            std::memcpy(&bits, &src[i], sizeof(float));
+
+            const int32_t sign = (bits >> 16) & 0x8000;
+            const int32_t absBits = bits & 0x7FFFFFFF;
+            const int32_t exponent = absBits >> 23;
+
+            // Sub-normal half (exponent <= 112): truncated |x| * 2^24.
+            // |x| is clamped to the largest float with exponent 112 to keep
+            // the integer conversion in range for the other lanes.
+            const int32_t denormBits = (absBits < 0x387FFFFF) ? absBits
+                                                              : 0x387FFFFF;
+            float denorm;
+            std::memcpy(&denorm, &denormBits, sizeof(float));
+            const int32_t subnormal = (int32_t)(denorm * 16777216.0f);
+
+            // Normal half: re-biased exponent and truncated mantissa
+            const int32_t normal = (absBits >> 13) - (112 << 10);
+            // NaN keeps the upper mantissa bits
+            const int32_t nan = 0x7C00 | ((absBits >> 13) & 0x3FF);
+
+            const int32_t isSubnormal = -(int32_t)(exponent <= 112);
+            const int32_t isInf = -(int32_t)(exponent > 142);
+            const int32_t isNan = -(int32_t)(exponent == 255);
+
+            int32_t value = (subnormal & isSubnormal)
+                            | (normal & ~isSubnormal);
+            value = (value & ~isInf) | (0x7C00 & isInf);
+            value |= (nan & isNan);
+
+            dstBits[i] = (uint16_t)(sign | value);
+        }
+#else
+        for (int i = offset; i < end; ++i)
+            dst[i] = half_float::half(src[i]);
+#endif
+    }
+}
+
+void N2D2::Tensor_Kernels::convert(const half_float::half* src,
+                                   float* dst,
+                                   std::size_t size)
+{
+    // Exact conversion, identical to half2float(), but without the lookup
+    // tables, so that the loop is vectorizable
+    const int nbBlocks = (int)((size + BlockSize - 1) / BlockSize);
+    const uint16_t* srcBits = reinterpret_cast<const uint16_t*>(src);
+
+#pragma omp parallel for if (size > ParallelThreshold)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const int offset = block * BlockSize;
+        const int end = (int)std::min(offset + BlockSize, size);
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+        for (int i = offset; i < end; ++i) {
+            const int32_t bits = srcBits[i];
+            const int32_t sign = (bits & 0x8000) << 16;
+            const int32_t absBits = bits & 0x7FFF;
+            const int32_t exponent = absBits >> 10;
+
+            // Sub-normal half: mantissa * 2^-24, exact in single precision
+            const float subnormal = (float)absBits * 5.9604644775390625e-8f;
+            int32_t subnormalBits;
+            std::memcpy(&subnormalBits, &subnormal, sizeof(float));
+
+            const int32_t normal = (absBits << 13) + (112 << 23);
+            const int32_t infNan = 0x7F800000 | ((absBits & 0x3FF) << 13);
+
+            const int32_t isSubnormal = -(int32_t)(exponent == 0);
+            const int32_t isInfNan = -(int32_t)(exponent == 31);
+
+            int32_t value = (subnormalBits & isSubnormal)
+                            | (normal & ~isSubnormal);
+            value = sign | (value & ~isInfNan) | (infNan & isInfNan);
+
+            std::memcpy(&dst[i], &value, sizeof(float));
+        }
+    }
+}
+
+void N2D2::Tensor_Kernels::convert(const half_float::half* src,
+                                   half_float::half* dst,
+                                   std::size_t size)
+{
+    std::memcpy(dst, src, size * sizeof(half_float::half));
+}
@@ -29,6 +29,8 @@
 namespace py = pybind11;
 
 namespace N2D2 {
+py::array tensorView(BaseTensor& tensor);
+
 void init_Cell_Frame_Top(py::module &m) {
     py::class_<Cell_Frame_Top, std::shared_ptr<Cell_Frame_Top>> cell(m, "Cell_Frame_Top");
 
@@ -42,15 +44,18 @@ void init_Cell_Frame_Top(py::module &m) {
     .def("load", &Cell_Frame_Top::load, py::arg("dirName"))
     .def("addInput", &Cell_Frame_Top::addInput, py::arg("inputs"), py::arg("diffOutputs"))
     .def("replaceInput", &Cell_Frame_Top::replaceInput, py::arg("oldInputs"), py::arg("newInputs"), py::arg("newDiffOutputs"))
-    .def("propagate", &Cell_Frame_Top::propagate, py::arg("inference") = false)
-    .def("backPropagate", &Cell_Frame_Top::backPropagate)
-    .def("update", &Cell_Frame_Top::update)
+    .def("propagate", &Cell_Frame_Top::propagate, py::arg("inference") = false, py::call_guard<py::gil_scoped_release>())
+    .def("backPropagate", &Cell_Frame_Top::backPropagate, py::call_guard<py::gil_scoped_release>())
+    .def("update", &Cell_Frame_Top::update, py::call_guard<py::gil_scoped_release>())
     .def("checkGradient", &Cell_Frame_Top::checkGradient, py::arg("epsilon"), py::arg("maxError"))
     .def("setOutputTarget", &Cell_Frame_Top::setOutputTarget, py::arg("targets"))
     .def("setOutputTargets", &Cell_Frame_Top::setOutputTargets, py::arg("targets"))
     .def("setOutputErrors", &Cell_Frame_Top::setOutputErrors, py::arg("errors"))
     .def("getInputs", (BaseTensor& (Cell_Frame_Top::*)(unsigned int)) &Cell_Frame_Top::getInputs, py::arg("index") = 0, py::return_value_policy::reference)
     .def("getOutputs", (BaseTensor& (Cell_Frame_Top::*)()) &Cell_Frame_Top::getOutputs, py::return_value_policy::reference)
+    .def("getOutputsView", [](Cell_Frame_Top& cell) {
+        return tensorView(cell.getOutputs());
+    })
     .def("getDiffInputs", (BaseTensor& (Cell_Frame_Top::*)()) &Cell_Frame_Top::getDiffInputs, py::return_value_policy::reference)
     .def("getDiffOutputs", (BaseTensor& (Cell_Frame_Top::*)(unsigned int)) &Cell_Frame_Top::getDiffOutputs, py::arg("index") = 0, py::return_value_policy::reference)
     .def("getMaxOutput", &Cell_Frame_Top::getMaxOutput, py::arg("batchPos") = 0)
@@ -26,6 +26,8 @@
 #include "DeepNet.hpp"
 #include "Cell/Cell_Frame_Top.hpp"
 
+#include <future>
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -41,24 +43,29 @@ void init_DeepNet(py::module &m) {
     .def("addMonitor", &DeepNet::addMonitor, py::arg("name"), py::arg("monitor"))
     .def("addCMonitor", &DeepNet::addCMonitor, py::arg("name"), py::arg("monitor"))
     .def("update", (std::vector<std::pair<std::string, long long unsigned int>> (DeepNet::*)(bool, Time_T, Time_T, bool)) &DeepNet::update, py::arg("log"), py::arg("start"), py::arg("stop") = 0, py::arg("update") = true)
-    .def("save", &DeepNet::save, py::arg("dirName"))
-    .def("load", &DeepNet::load, py::arg("dirName"))
+    .def("save", &DeepNet::save, py::arg("dirName"), py::call_guard<py::gil_scoped_release>())
+    .def("load", &DeepNet::load, py::arg("dirName"), py::call_guard<py::gil_scoped_release>())
     .def("saveNetworkParameters", &DeepNet::saveNetworkParameters)
     .def("loadNetworkParameters", &DeepNet::loadNetworkParameters)
-    .def("exportNetworkFreeParameters", &DeepNet::exportNetworkFreeParameters, py::arg("dirName"))
+    .def("exportNetworkFreeParameters", &DeepNet::exportNetworkFreeParameters, py::arg("dirName"), py::call_guard<py::gil_scoped_release>())
     .def("exportNetworkSolverParameters", &DeepNet::exportNetworkSolverParameters, py::arg("dirName"))
-    .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, bool)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("ignoreNotExists") = false)
-    .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, const std::string&)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("weightName"))
+    .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, bool)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("ignoreNotExists") = false, py::call_guard<py::gil_scoped_release>())
+    .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, const std::string&)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("weightName"), py::call_guard<py::gil_scoped_release>())
     //.def("importNetworkSolverParameters", &DeepNet::importNetworkSolverParameters, py::arg("dirName"))
-    .def("checkGradient", &DeepNet::checkGradient, py::arg("epsilon") = 1.0e-4, py::arg("maxError") = 1.0e-6)
+    .def("checkGradient", &DeepNet::checkGradient, py::arg("epsilon") = 1.0e-4, py::arg("maxError") = 1.0e-6, py::call_guard<py::gil_scoped_release>())
     .def("initialize", &DeepNet::initialize)
-    .def("learn", &DeepNet::learn, py::arg("timings") = NULL)
-    .def("test", &DeepNet::test, py::arg("set"), py::arg("timings") = NULL)
-    .def("propagate", &DeepNet::propagate, py::arg("set"), py::arg("inference"), py::arg("timings") = NULL)
-    .def("backPropagate", &DeepNet::backPropagate, py::arg("timings") = NULL)
-    .def("update", (void (DeepNet::*)(std::vector<std::pair<std::string, double> >*)) &DeepNet::update, py::arg("timings") = NULL)
-    .def("cTicks", &DeepNet::cTicks, py::arg("start"), py::arg("stop"), py::arg("timestep"), py::arg("record") = false)
-    .def("cTargetsProcess", &DeepNet::cTargetsProcess, py::arg("set"))
+    .def("learn", &DeepNet::learn, py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("test", &DeepNet::test, py::arg("set"), py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("propagate", &DeepNet::propagate, py::arg("set"), py::arg("inference"), py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("propagateAsync", [](std::shared_ptr<DeepNet> deepNet, Database::StimuliSet set, bool inference) {
+        return std::async(std::launch::async, [deepNet, set, inference]() {
+            deepNet->propagate(set, inference, NULL);
+        }).share();
+    }, py::arg("set"), py::arg("inference"))
+    .def("backPropagate", &DeepNet::backPropagate, py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("update", (void (DeepNet::*)(std::vector<std::pair<std::string, double> >*)) &DeepNet::update, py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("cTicks", &DeepNet::cTicks, py::arg("start"), py::arg("stop"), py::arg("timestep"), py::arg("record") = false, py::call_guard<py::gil_scoped_release>())
+    .def("cTargetsProcess", &DeepNet::cTargetsProcess, py::arg("set"), py::call_guard<py::gil_scoped_release>())
     .def("cReset", &DeepNet::cReset, py::arg("timestamp") = 0)
     .def("initializeCMonitors", &DeepNet::initializeCMonitors, py::arg("nbTimesteps"))
     .def("spikeCodingCompare", &DeepNet::spikeCodingCompare, py::arg("dirName"), py::arg("idx"))
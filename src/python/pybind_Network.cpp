@@ -28,6 +28,18 @@ namespace py = pybind11;
 
 namespace N2D2 {
 void init_Network(py::module &m) {
+    py::class_<SpikeLog>(m, "SpikeLog")
+    .def(py::init<>())
+    .def("size", &SpikeLog::size)
+    .def("empty", &SpikeLog::empty)
+    .def("clear", &SpikeLog::clear)
+    .def("getNodeActivity", &SpikeLog::getNodeActivity, py::arg("nodeId"), py::arg("start") = 0, py::arg("stop") = 0, py::arg("type") = 0)
+    .def("getNodeFirstEvent", &SpikeLog::getNodeFirstEvent, py::arg("nodeId"), py::arg("start") = 0, py::arg("stop") = 0, py::arg("type") = 0)
+    .def("getNodeEvents", &SpikeLog::getNodeEvents, py::arg("nodeId"))
+    .def("getNodesEvents", &SpikeLog::getNodesEvents)
+    .def("save", &SpikeLog::save, py::arg("fileName"))
+    .def("load", &SpikeLog::load, py::arg("fileName"));
+
     py::class_<Network>(m, "Network")
     .def(py::init<unsigned int>(), py::arg("seed") = 0)
     .def("run", &Network::run, py::arg("stop") = 0, py::arg("clearActivity") = true)
@@ -35,11 +47,14 @@ void init_Network(py::module &m) {
     .def("reset", &Network::reset, py::arg("timestamp") = 0)
     .def("save", &Network::save, py::arg("dirName"))
     .def("load", &Network::load, py::arg("dirName"))
-    .def("getSpikeRecording", (const std::unordered_map<NodeId_T, NodeEvents_T>& (Network::*)()) &Network::getSpikeRecording)
-    .def("getSpikeRecording", (const NodeEvents_T& (Network::*)(NodeId_T)) &Network::getSpikeRecording, py::arg("nodeId"))
+    .def("getSpikeRecording", (std::unordered_map<NodeId_T, NodeEvents_T> (Network::*)() const) &Network::getSpikeRecording)
+    .def("getSpikeRecording", (NodeEvents_T (Network::*)(NodeId_T) const) &Network::getSpikeRecording, py::arg("nodeId"))
+    .def("getSpikeLog", &Network::getSpikeLog, py::return_value_policy::reference_internal)
     .def("getFirstEvent", &Network::getFirstEvent)
     .def("getLastEvent", &Network::getLastEvent)
-    .def("getLoadSavePath", &Network::getLoadSavePath);
+    .def("getLoadSavePath", &Network::getLoadSavePath)
+    .def("setNbPartitions", &Network::setNbPartitions, py::arg("nbPartitions"))
+    .def("getNbPartitions", &Network::getNbPartitions);
 }
 }
 #endif
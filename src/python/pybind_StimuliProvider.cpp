@@ -21,32 +21,65 @@
 #ifdef PYBIND
 #include "StimuliProvider.hpp"
 
+#include <future>
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 
 namespace py = pybind11;
 
 namespace N2D2 {
+py::array tensorView(BaseTensor& tensor);
+
 void init_StimuliProvider(py::module &m) {
+    // Result of the *Async() methods, which run without holding the GIL.
+    // wait() rethrows the exception of the asynchronous call, if any.
+    py::class_<std::shared_future<void> >(m, "Future")
+    .def("wait", [](const std::shared_future<void>& future) {
+        future.get();
+    }, py::call_guard<py::gil_scoped_release>())
+    .def("ready", [](const std::shared_future<void>& future) {
+        return (future.wait_for(std::chrono::seconds(0))
+            == std::future_status::ready);
+    })
+    .def("__await__", [](const std::shared_future<void>& future) {
+        // Wait in the default executor of the running asyncio event loop
+        return py::module::import("asyncio").attr("get_running_loop")()
+            .attr("run_in_executor")(py::none(), py::cpp_function(
+                [future]() { future.get(); }, py::call_guard<py::gil_scoped_release>()))
+            .attr("__await__")();
+    });
+
     py::class_<StimuliProvider, std::shared_ptr<StimuliProvider>>(m, "StimuliProvider", py::multiple_inheritance())
     .def(py::init<Database&, const std::vector<size_t>&, unsigned int, bool>(), py::arg("database"), py::arg("size"), py::arg("batchSize") = 1, py::arg("compositeStimuli") = false)
     .def("cloneParameters", &StimuliProvider::cloneParameters)
     .def("logTransformations", &StimuliProvider::logTransformations, py::arg("fileName"), py::arg("setMask"))
-    .def("future", &StimuliProvider::future)
-    .def("synchronize", &StimuliProvider::synchronize)
+    .def("future", &StimuliProvider::future, py::call_guard<py::gil_scoped_release>())
+    .def("synchronize", &StimuliProvider::synchronize, py::call_guard<py::gil_scoped_release>())
     .def("getRandomIndex", &StimuliProvider::getRandomIndex, py::arg("set"))
     .def("getRandomID", &StimuliProvider::getRandomID, py::arg("set"))
-    .def("readRandomBatch", &StimuliProvider::readRandomBatch, py::arg("set"))
-    .def("readRandomStimulus", &StimuliProvider::readRandomStimulus, py::arg("set"), py::arg("batchPos") = 0, py::arg("dev") = -1)
-    .def("readBatch", (void (StimuliProvider::*)(Database::StimuliSet, unsigned int)) &StimuliProvider::readBatch, py::arg("set"), py::arg("startIndex"))
-    .def("readBatch", (void (StimuliProvider::*)(Database::StimuliSet)) &StimuliProvider::readBatch, py::arg("set"))
-    .def("streamBatch", &StimuliProvider::streamBatch, py::arg("startIndex") = -1, py::arg("dev") = -1)
-    .def("readStimulusBatch", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, int)) &StimuliProvider::readStimulusBatch, py::arg("id"), py::arg("set"), py::arg("dev") = -1)
-    .def("readStimulusBatch", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, int)) &StimuliProvider::readStimulusBatch, py::arg("set"), py::arg("index"), py::arg("dev") = -1)
-    .def("readStimulus", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, unsigned int, int)) &StimuliProvider::readStimulus, py::arg("id"), py::arg("set"), py::arg("batchPos") = 0, py::arg("dev") = -1)
-    .def("readStimulus", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, unsigned int, int)) &StimuliProvider::readStimulus, py::arg("set"), py::arg("index"), py::arg("batchPos") = 0, py::arg("dev") = -1)
-    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimulusID) const) &StimuliProvider::readRawData, py::arg("id"))
-    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimuliSet, unsigned int) const) &StimuliProvider::readRawData, py::arg("set"), py::arg("index"))
+    .def("readRandomBatch", &StimuliProvider::readRandomBatch, py::arg("set"), py::call_guard<py::gil_scoped_release>())
+    .def("readRandomBatchAsync", [](std::shared_ptr<StimuliProvider> sp, Database::StimuliSet set) {
+        return std::async(std::launch::async, [sp, set]() {
+            sp->readRandomBatch(set);
+        }).share();
+    }, py::arg("set"))
+    .def("readBatchAsync", [](std::shared_ptr<StimuliProvider> sp, Database::StimuliSet set, unsigned int startIndex) {
+        return std::async(std::launch::async, [sp, set, startIndex]() {
+            sp->readBatch(set, startIndex);
+        }).share();
+    }, py::arg("set"), py::arg("startIndex"))
+    .def("readRandomStimulus", &StimuliProvider::readRandomStimulus, py::arg("set"), py::arg("batchPos") = 0, py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readBatch", (void (StimuliProvider::*)(Database::StimuliSet, unsigned int)) &StimuliProvider::readBatch, py::arg("set"), py::arg("startIndex"), py::call_guard<py::gil_scoped_release>())
+    .def("readBatch", (void (StimuliProvider::*)(Database::StimuliSet)) &StimuliProvider::readBatch, py::arg("set"), py::call_guard<py::gil_scoped_release>())
+    .def("streamBatch", &StimuliProvider::streamBatch, py::arg("startIndex") = -1, py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulusBatch", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, int)) &StimuliProvider::readStimulusBatch, py::arg("id"), py::arg("set"), py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulusBatch", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, int)) &StimuliProvider::readStimulusBatch, py::arg("set"), py::arg("index"), py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulus", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, unsigned int, int)) &StimuliProvider::readStimulus, py::arg("id"), py::arg("set"), py::arg("batchPos") = 0, py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulus", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, unsigned int, int)) &StimuliProvider::readStimulus, py::arg("set"), py::arg("index"), py::arg("batchPos") = 0, py::arg("dev") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimulusID) const) &StimuliProvider::readRawData, py::arg("id"), py::call_guard<py::gil_scoped_release>())
+    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimuliSet, unsigned int) const) &StimuliProvider::readRawData, py::arg("set"), py::arg("index"), py::call_guard<py::gil_scoped_release>())
     .def("setBatchSize", &StimuliProvider::setBatchSize, py::arg("batchSize"))
     .def("setCachePath", &StimuliProvider::setCachePath, py::arg("path") = "")
     .def("getDatabase", (Database& (StimuliProvider::*)()) &StimuliProvider::getDatabase)
@@ -64,6 +97,12 @@ void init_StimuliProvider(py::module &m) {
     .def("getChannelOnTheFlyTransformation", &StimuliProvider::getChannelOnTheFlyTransformation, py::arg("channel"), py::arg("set"))
     .def("getBatch", &StimuliProvider::getBatch)
     .def("getData", (StimuliProvider::TensorData_T& (StimuliProvider::*)(int)) &StimuliProvider::getData, py::arg("dev") = -1)
+    .def("getDataView", [](StimuliProvider& sp, int dev) {
+        return tensorView(sp.getData(dev));
+    }, py::arg("dev") = -1)
+    .def("getLabelsDataView", [](StimuliProvider& sp, int dev) {
+        return tensorView(sp.getLabelsData(dev));
+    }, py::arg("dev") = -1)
     .def("getLabelsData", (Tensor<int>& (StimuliProvider::*)(int)) &StimuliProvider::getLabelsData, py::arg("dev") = -1)
     .def("getLabelsROIs", (const std::vector<std::vector<std::shared_ptr<ROI> > >& (StimuliProvider::*)() const) &StimuliProvider::getLabelsROIs)
     .def("getDataChannel", (const StimuliProvider::TensorData_T (StimuliProvider::*)(unsigned int, unsigned int, int) const) &StimuliProvider::getDataChannel, py::arg("channel"), py::arg("batchPos") = 0, py::arg("dev") = -1)
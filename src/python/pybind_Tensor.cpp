@@ -84,6 +84,60 @@ void declare_Tensor_buffer_protocol(py::class_<Tensor<T>, BaseTensor>& /*tensor*
     // No buffer protocol for bool!
 }
 
+template<typename T>
+py::array tensorView(const Tensor<T>& tensor) {
+    if (tensor.empty())
+        throw std::runtime_error("tensorView(): empty tensor");
+
+    std::vector<ssize_t> dims;
+    std::vector<ssize_t> strides;
+    ssize_t stride = sizeof(T);
+
+    for (unsigned int dim = 0; dim < tensor.nbDims(); ++dim) {
+        dims.push_back(tensor.dims()[dim]);
+        strides.push_back(stride);
+        stride *= tensor.dims()[dim];
+    }
+
+    std::reverse(dims.begin(), dims.end());
+    std::reverse(strides.begin(), strides.end());
+
+    // The base of the array owns a copy of the tensor, which shares its data
+    Tensor<T>* owner = new Tensor<T>(tensor);
+    py::capsule base(owner, [](void* ptr) {
+        delete static_cast<Tensor<T>*>(ptr);
+    });
+
+    return py::array_t<T>(dims, strides, &(*owner->begin()), base);
+}
+
+/**
+ * Return a NumPy array viewing the host data of @p tensor, without any copy.
+ * A CUDA tensor is first synchronized to the host: later device computations
+ * are not visible in the view until it is taken again.
+ * The array owns a copy of the tensor sharing its data, so that the data
+ * outlives the owner of the tensor, or the rebinding of its data with
+ * Tensor::share(). In this case, the view keeps the previous data.
+ * The tensor must not be resized while a view exists.
+ */
+py::array tensorView(BaseTensor& tensor) {
+    tensor.synchronizeDToH();
+
+    if (Tensor<float>* tensorFloat = dynamic_cast<Tensor<float>*>(&tensor))
+        return tensorView(*tensorFloat);
+    else if (Tensor<double>* tensorDouble
+        = dynamic_cast<Tensor<double>*>(&tensor))
+    {
+        return tensorView(*tensorDouble);
+    }
+    else if (Tensor<int>* tensorInt = dynamic_cast<Tensor<int>*>(&tensor))
+        return tensorView(*tensorInt);
+    else {
+        throw std::runtime_error("tensorView(): unsupported tensor data "
+                                 "type: " + std::string(tensor.getType()->name()));
+    }
+}
+
 template<typename T>
 void declare_Tensor(py::module &m, const std::string& typeStr) {
     const std::string pyClassName("Tensor_" + typeStr);
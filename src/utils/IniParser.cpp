@@ -21,7 +21,99 @@
 #include "utils/IniParser.hpp"
 #include "utils/TemplateParser.hpp"
 
-N2D2::IniParser::IniParser() : mCheckForUnknown(false)
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+
+namespace {
+std::string getEnv(const std::string& name)
+{
+    const char* value = std::getenv(name.c_str());
+    return (value != NULL) ? std::string(value) : std::string();
+}
+
+// FNV-1a hash of a file content
+bool hashFile(const std::string& fileName, unsigned long long int& hash)
+{
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        return false;
+
+    const std::string content((std::istreambuf_iterator<char>(data)),
+                              std::istreambuf_iterator<char>());
+
+    hash = 14695981039346656037ULL;
+
+    for (std::string::const_iterator it = content.begin(),
+         itEnd = content.end(); it != itEnd; ++it)
+    {
+        hash ^= (unsigned char)(*it);
+        hash *= 1099511628211ULL;
+    }
+
+    return true;
+}
+
+// The cache is local to the machine, native endianness is used
+template <class T>
+void writeCacheValue(std::ofstream& data, const T& value)
+{
+    data.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeCacheString(std::ofstream& data, const std::string& value)
+{
+    writeCacheValue(data, (unsigned long long int)value.size());
+    data.write(value.data(), value.size());
+}
+
+class CacheReader {
+public:
+    CacheReader(const std::string& data) : mData(data), mPos(0) {};
+
+    template <class T>
+    bool read(T& value)
+    {
+        if (mData.size() - mPos < sizeof(value))
+            return false;
+
+        std::memcpy(&value, mData.data() + mPos, sizeof(value));
+        mPos += sizeof(value);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        unsigned long long int size;
+
+        if (!read(size) || mData.size() - mPos < size)
+            return false;
+
+        value.assign(mData, mPos, size);
+        mPos += size;
+        return true;
+    }
+
+    bool end() const
+    {
+        return (mPos == mData.size());
+    }
+
+private:
+    const std::string& mData;
+    std::size_t mPos;
+};
+
+const unsigned int cacheMagic = 0x4944324E; // "N2DI"
+const unsigned int cacheVersion = 1;
+}
+
+N2D2::IniParser::IniParser()
+    : mCheckForUnknown(false),
+      mCached(false),
+      mCacheModified(false)
 {
     currentSection("", false); // Create the global (default) section
 }
@@ -34,7 +126,32 @@ void N2D2::IniParser::load(const std::string& fileName)
         throw std::runtime_error("Could not open INI file: " + fileName);
 
     mFileName = fileName;
+    mCached = false;
+
+    // The cache restores the whole property tree, it can only be used for
+    // the first INI file loaded
+    const bool useCache = (!mCachePath.empty() && mIniSections.size() == 1
+                           && mIniData[0].empty());
+
+    if (useCache && loadCache()) {
+        mCached = true;
+        return;
+    }
+
+    mDependencies.clear();
+    mEnvDependencies.clear();
+    mCacheValues.clear();
+
+    addDependency(fileName);
+    mEnvDependencies["N2D2_PYTHON"] = getEnv("N2D2_PYTHON");
+
     load(data);
+
+    if (useCache) {
+        mLoadedSections = mIniSections;
+        mLoadedData = mIniData;
+        mCacheModified = true;
+    }
 }
 
 void N2D2::IniParser::load(std::istream& data, const std::string& parentSection)
@@ -121,6 +238,24 @@ void N2D2::IniParser::load(std::istream& data, const std::string& parentSection)
             if (sectionSplit.size() == 2) {
                 section = sectionSplit[0];
 
+                // Environment variables change the template file
+                size_t varPos = 0;
+
+                while ((varPos = sectionSplit[1].find("${", varPos))
+                       != std::string::npos)
+                {
+                    const size_t varEndPos = sectionSplit[1].find("}",
+                                                                  varPos + 2);
+
+                    if (varEndPos == std::string::npos)
+                        break;
+
+                    const std::string varName = sectionSplit[1].substr(
+                        varPos + 2, varEndPos - varPos - 2);
+                    mEnvDependencies[varName] = getEnv(varName);
+                    varPos = varEndPos + 1;
+                }
+
                 const std::string fileName
                     = Utils::expandEnvVars(sectionSplit[1]);
 
@@ -637,6 +772,16 @@ std::string N2D2::IniParser::getPropertyValue(std::string value) const
         const std::string cmdName
             = value.substr(startPos + 2, endPos - startPos - 2);
 
+        // The same expressions are often evaluated many times, and each
+        // evaluation starts a Python interpreter
+        const std::map<std::string, std::string>::const_iterator itExpr
+            = mExpressions.find(cmdName);
+
+        if (itExpr != mExpressions.end()) {
+            value.replace(startPos, endPos - startPos + 1, (*itExpr).second);
+            continue;
+        }
+
         std::stringstream cmdNameStr;
         const char* pythonCmd = std::getenv("N2D2_PYTHON");
 
@@ -669,6 +814,9 @@ std::string N2D2::IniParser::getPropertyValue(std::string value) const
                        std::not1(std::ptr_fun<int, int>(std::isspace))).base(),
                        cmdValue.end());
 
+        mExpressions[cmdName] = cmdValue;
+        mCacheModified = true;
+
         value.replace(startPos, endPos - startPos + 1, cmdValue);
     }
 
@@ -697,10 +845,298 @@ void N2D2::IniParser::loadTplIni(const std::string& tplIni) {
 
     const std::string parentFileName = mFileName;
     std::istringstream str(parser.renderFile(tplIni));
+
+    addDependency(tplIni);
+
+    for (std::vector<std::string>::const_iterator it
+         = parser.getIncludedFiles().begin(),
+         itEnd = parser.getIncludedFiles().end(); it != itEnd; ++it)
+    {
+        addDependency(*it);
+    }
+
     load(str, sectionName);
     mFileName = parentFileName;
 }
 
+void N2D2::IniParser::addDependency(const std::string& fileName)
+{
+    for (std::vector<std::pair<std::string, unsigned long long int> >
+         ::const_iterator it = mDependencies.begin(),
+         itEnd = mDependencies.end(); it != itEnd; ++it)
+    {
+        if ((*it).first == fileName)
+            return;
+    }
+
+    unsigned long long int hash = 0;
+
+    if (!hashFile(fileName, hash))
+        throw std::runtime_error("Could not read file: " + fileName);
+
+    mDependencies.push_back(std::make_pair(fileName, hash));
+}
+
+void N2D2::IniParser::setCacheValue(const std::string& name,
+                                    const std::string& value)
+{
+    std::map<std::string, std::string>::iterator it = mCacheValues.find(name);
+
+    if (it == mCacheValues.end() || (*it).second != value) {
+        mCacheValues[name] = value;
+        mCacheModified = true;
+    }
+}
+
+bool N2D2::IniParser::getCacheValue(const std::string& name,
+                                    std::string& value) const
+{
+    const std::map<std::string, std::string>::const_iterator it
+        = mCacheValues.find(name);
+
+    if (it == mCacheValues.end())
+        return false;
+
+    value = (*it).second;
+    return true;
+}
+
+std::string N2D2::IniParser::getCacheFileName() const
+{
+    std::ostringstream fileName;
+    fileName << mCachePath << "/" << std::hex
+        << std::hash<std::string>()(mFileName) << ".ini.cache";
+    return fileName.str();
+}
+
+bool N2D2::IniParser::loadCache()
+{
+    const std::string fileName = getCacheFileName();
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        return false;
+
+    const std::string content((std::istreambuf_iterator<char>(data)),
+                              std::istreambuf_iterator<char>());
+    CacheReader reader(content);
+
+    unsigned int magic;
+    unsigned int version;
+    std::string iniFileName;
+
+    if (!reader.read(magic) || magic != cacheMagic
+        || !reader.read(version) || version != cacheVersion
+        || !reader.read(iniFileName) || iniFileName != mFileName)
+    {
+        return false;
+    }
+
+    unsigned long long int size;
+    std::map<std::string, std::string> envDependencies;
+
+    if (!reader.read(size))
+        return false;
+
+    for (unsigned long long int i = 0; i < size; ++i) {
+        std::string name;
+        std::string value;
+
+        if (!reader.read(name) || !reader.read(value)
+            || getEnv(name) != value)
+        {
+            return false;
+        }
+
+        envDependencies[name] = value;
+    }
+
+    std::vector<std::pair<std::string, unsigned long long int> > dependencies;
+
+    if (!reader.read(size))
+        return false;
+
+    for (unsigned long long int i = 0; i < size; ++i) {
+        std::string depFileName;
+        unsigned long long int hash;
+        unsigned long long int currentHash;
+
+        if (!reader.read(depFileName) || !reader.read(hash)
+            || !hashFile(depFileName, currentHash) || currentHash != hash)
+        {
+            return false;
+        }
+
+        dependencies.push_back(std::make_pair(depFileName, hash));
+    }
+
+    std::vector<std::string> sections;
+    IniData_T iniData;
+
+    if (!reader.read(size))
+        return false;
+
+    for (unsigned long long int i = 0; i < size; ++i) {
+        std::string section;
+        unsigned long long int nbProperties;
+
+        if (!reader.read(section) || !reader.read(nbProperties))
+            return false;
+
+        sections.push_back(section);
+        iniData.push_back(std::map
+                          <std::string, std::pair<std::string, bool> >());
+
+        for (unsigned long long int p = 0; p < nbProperties; ++p) {
+            std::string property;
+            std::string value;
+            unsigned char read;
+
+            if (!reader.read(property) || !reader.read(value)
+                || !reader.read(read))
+            {
+                return false;
+            }
+
+            iniData.back()[property] = std::make_pair(value, (read != 0));
+        }
+    }
+
+    std::map<std::string, std::string> expressions;
+    std::map<std::string, std::string> cacheValues;
+
+    for (unsigned int m = 0; m < 2; ++m) {
+        std::map<std::string, std::string>& values
+            = (m == 0) ? expressions : cacheValues;
+
+        if (!reader.read(size))
+            return false;
+
+        for (unsigned long long int i = 0; i < size; ++i) {
+            std::string name;
+            std::string value;
+
+            if (!reader.read(name) || !reader.read(value))
+                return false;
+
+            values[name] = value;
+        }
+    }
+
+    if (!reader.end() || sections.empty())
+        return false;
+
+    std::cout << "Using INI cache \"" << fileName << "\"" << std::endl;
+
+    mEnvDependencies.swap(envDependencies);
+    mDependencies.swap(dependencies);
+    mIniSections = sections;
+    mIniData = iniData;
+    mLoadedSections.swap(sections);
+    mLoadedData.swap(iniData);
+    mExpressions.insert(expressions.begin(), expressions.end());
+    mCacheValues.swap(cacheValues);
+    mCurrentSection = 0;
+    mCacheModified = false;
+    return true;
+}
+
+void N2D2::IniParser::saveCache() const
+{
+    if (mCachePath.empty() || mLoadedSections.empty() || !mCacheModified)
+        return;
+
+    const std::string fileName = getCacheFileName();
+
+    if (!Utils::createDirectories(mCachePath)) {
+        std::cout << Utils::cwarning << "Could not create directory for"
+            " INI cache: " << fileName << Utils::cdef << std::endl;
+        return;
+    }
+
+    // Written to a temporary file first, so that an interrupted write never
+    // leaves an incomplete cache
+    const std::string tmpFileName = fileName + ".tmp";
+
+    {
+        std::ofstream data(tmpFileName.c_str(), std::fstream::binary);
+
+        writeCacheValue(data, cacheMagic);
+        writeCacheValue(data, cacheVersion);
+        writeCacheString(data, mFileName);
+
+        writeCacheValue(data, (unsigned long long int)mEnvDependencies.size());
+
+        for (std::map<std::string, std::string>::const_iterator it
+             = mEnvDependencies.begin(), itEnd = mEnvDependencies.end();
+             it != itEnd; ++it)
+        {
+            writeCacheString(data, (*it).first);
+            writeCacheString(data, (*it).second);
+        }
+
+        writeCacheValue(data, (unsigned long long int)mDependencies.size());
+
+        for (std::vector<std::pair<std::string, unsigned long long int> >
+             ::const_iterator it = mDependencies.begin(),
+             itEnd = mDependencies.end(); it != itEnd; ++it)
+        {
+            writeCacheString(data, (*it).first);
+            writeCacheValue(data, (*it).second);
+        }
+
+        writeCacheValue(data, (unsigned long long int)mLoadedSections.size());
+
+        for (unsigned int section = 0; section < mLoadedSections.size();
+             ++section)
+        {
+            writeCacheString(data, mLoadedSections[section]);
+            writeCacheValue(data,
+                (unsigned long long int)mLoadedData[section].size());
+
+            for (std::map<std::string, std::pair<std::string, bool> >
+                 ::const_iterator it = mLoadedData[section].begin(),
+                 itEnd = mLoadedData[section].end(); it != itEnd; ++it)
+            {
+                writeCacheString(data, (*it).first);
+                writeCacheString(data, (*it).second.first);
+                writeCacheValue(data, (unsigned char)(*it).second.second);
+            }
+        }
+
+        for (unsigned int m = 0; m < 2; ++m) {
+            const std::map<std::string, std::string>& values
+                = (m == 0) ? mExpressions : mCacheValues;
+
+            writeCacheValue(data, (unsigned long long int)values.size());
+
+            for (std::map<std::string, std::string>::const_iterator it
+                 = values.begin(), itEnd = values.end(); it != itEnd; ++it)
+            {
+                writeCacheString(data, (*it).first);
+                writeCacheString(data, (*it).second);
+            }
+        }
+
+        if (!data.good()) {
+            std::cout << Utils::cwarning << "Could not write INI cache: "
+                << tmpFileName << Utils::cdef << std::endl;
+            data.close();
+            std::remove(tmpFileName.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        std::cout << Utils::cwarning << "Could not write INI cache: "
+            << fileName << Utils::cdef << std::endl;
+        std::remove(tmpFileName.c_str());
+        return;
+    }
+
+    mCacheModified = false;
+}
+
 N2D2::IniParser::~IniParser()
 {
     for (unsigned int section = 0, nbSections = mIniSections.size();
@@ -0,0 +1,152 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "utils/MemoryMappedFile.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef WIN32
+#include <windows.h>
+#undef min
+#undef max
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+N2D2::MemoryMappedFile::MemoryMappedFile(const std::string& fileName)
+    : mFileName(fileName),
+      mData(NULL),
+      mSize(0)
+{
+#ifdef WIN32
+    mFile = NULL;
+    mMapping = NULL;
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Could not open file: " + fileName);
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not get file size: " + fileName);
+    }
+
+    mFile = file;
+    mSize = (std::size_t)fileSize.QuadPart;
+
+    // An empty file cannot be mapped
+    if (mSize == 0)
+        return;
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping == NULL) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not map file: " + fileName);
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Could not map file: " + fileName);
+    }
+
+    mMapping = mapping;
+    mData = static_cast<const unsigned char*>(view);
+#else
+    const int fd = open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        throw std::runtime_error("Could not open file: " + fileName);
+
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not get file size: " + fileName);
+    }
+
+    mSize = (std::size_t)fileStat.st_size;
+
+    // An empty file cannot be mapped
+    if (mSize > 0) {
+        void* view = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (view == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map file: " + fileName);
+        }
+
+        mData = static_cast<const unsigned char*>(view);
+    }
+
+    // The mapping stays valid after the file descriptor is closed
+    close(fd);
+#endif
+}
+
+void N2D2::MemoryMappedFile::prefetch(std::size_t offset,
+                                      std::size_t size) const
+{
+    if (mData == NULL || offset >= mSize)
+        return;
+
+    size = std::min(size, mSize - offset);
+
+#ifdef WIN32
+    // No portable equivalent before Windows 8, the pages are read on access
+    (void)size;
+#else
+    // The address must be aligned on a page boundary
+    const std::size_t pageSize = (std::size_t)sysconf(_SC_PAGESIZE);
+    const std::size_t begin = offset - (offset % pageSize);
+
+    posix_madvise(const_cast<unsigned char*>(mData) + begin,
+                  offset + size - begin, POSIX_MADV_WILLNEED);
+#endif
+}
+
+N2D2::MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef WIN32
+    if (mData != NULL)
+        UnmapViewOfFile(mData);
+
+    if (mMapping != NULL)
+        CloseHandle(mMapping);
+
+    if (mFile != NULL)
+        CloseHandle(mFile);
+#else
+    if (mData != NULL)
+        munmap(const_cast<unsigned char*>(mData), mSize);
+#endif
+}
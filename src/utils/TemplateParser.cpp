@@ -448,6 +448,8 @@ size_t N2D2::TemplateParser::processSection(const std::string& source,
                     std::istreambuf_iterator<char>());
                 incTempl.close();
 
+                mIncludedFiles.push_back(fileName);
+
                 size_t endPos = processSection(templ, 0, section);
 
                 if (endPos != templ.length())
@@ -25,6 +25,7 @@
 #include "DeepNet.hpp"
 #include "Xnet/Environment.hpp"
 #include "Xnet/Network.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
@@ -44,12 +45,15 @@ public:
     friend class UnitTest_BatchNormCell_Frame_float_setScales;
     friend class UnitTest_BatchNormCell_Frame_float_addInput__env;
     friend class UnitTest_BatchNormCell_Frame_float_addInput;
+    friend class UnitTest_BatchNormCell_Frame_float_propagate;
     friend class UnitTest_BatchNormCell_Frame_double_setScales;
     friend class UnitTest_BatchNormCell_Frame_double_addInput__env;
     friend class UnitTest_BatchNormCell_Frame_double_addInput;
+    friend class UnitTest_BatchNormCell_Frame_double_backPropagate;
     friend class UnitTest_BatchNormCell_Frame_half_setScales;
     friend class UnitTest_BatchNormCell_Frame_half_addInput__env;
     friend class UnitTest_BatchNormCell_Frame_half_addInput;
+    friend class UnitTest_BatchNormCell_Frame_half_propagate__inference;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -177,4 +181,304 @@ TEST_DATASET(BatchNormCell_Frame_float,
                   * conv1.getOutputsHeight());
 }
 
+TEST_DATASET(BatchNormCell_Frame_float,
+             propagate,
+             (unsigned int channelsWidth,
+              unsigned int channelsHeight,
+              unsigned int batchSize),
+             std::make_tuple(8U, 8U, 2U),
+             // Planes larger than a chunk
+             std::make_tuple(70U, 70U, 1U),
+             std::make_tuple(80U, 60U, 3U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 4;
+
+    Network net;
+    DeepNet dn(net);
+
+    BatchNormCell_Frame_Test<float> bn1(
+        dn, "bn1", nbOutputs, std::shared_ptr<Activation>());
+
+    Tensor<float> inputs({channelsWidth, channelsHeight, nbOutputs,
+                          batchSize});
+    Tensor<float> diffOutputs({channelsWidth, channelsHeight, nbOutputs,
+                               batchSize});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = 10.0 + Random::randUniform(-1.0, 1.0);
+
+    bn1.addInput(inputs, diffOutputs);
+    bn1.initialize();
+    bn1.propagate(false);
+
+    const Tensor<float>& outputs = tensor_cast<float>(bn1.getOutputs());
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        double sum = 0.0;
+
+        for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+            for (unsigned int y = 0; y < channelsHeight; ++y) {
+                for (unsigned int x = 0; x < channelsWidth; ++x)
+                    sum += inputs(x, y, output, batchPos);
+            }
+        }
+
+        const double size = channelsWidth * channelsHeight * batchSize;
+        const double mean = sum / size;
+        double variance = 0.0;
+
+        for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+            for (unsigned int y = 0; y < channelsHeight; ++y) {
+                for (unsigned int x = 0; x < channelsWidth; ++x) {
+                    const double zeroed = inputs(x, y, output, batchPos)
+                                          - mean;
+                    variance += zeroed * zeroed;
+                }
+            }
+        }
+
+        variance /= size;
+
+        ASSERT_EQUALS_DELTA(bn1.mSavedMean(output), mean, 1.0e-5);
+        ASSERT_EQUALS_DELTA(bn1.mSavedVariance(output), variance, 1.0e-5);
+
+        const double scale = (*bn1.mScale)(output);
+        const double bias = (*bn1.mBias)(output);
+
+        for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+            for (unsigned int y = 0; y < channelsHeight; ++y) {
+                for (unsigned int x = 0; x < channelsWidth; ++x) {
+                    const double normalized
+                        = (inputs(x, y, output, batchPos) - mean)
+                            / std::sqrt(variance + bn1.mEpsilon);
+
+                    ASSERT_EQUALS_DELTA(outputs(x, y, output, batchPos),
+                                        scale * normalized + bias, 1.0e-4);
+                }
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// double
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(BatchNormCell_Frame_double,
+             backPropagate,
+             (unsigned int channelsWidth,
+              unsigned int channelsHeight,
+              unsigned int batchSize),
+             std::make_tuple(4U, 3U, 2U),
+             std::make_tuple(5U, 5U, 1U),
+             std::make_tuple(3U, 4U, 3U))
+{
+    Random::mtSeed(0);
+
+    // Two inputs, to check the gradients at a non-zero output offset
+    const unsigned int nbChannels[2] = {2, 1};
+    const unsigned int nbOutputs = nbChannels[0] + nbChannels[1];
+    const double h = 1.0e-6;
+
+    Network net;
+    DeepNet dn(net);
+
+    BatchNormCell_Frame_Test<double> bn1(
+        dn, "bn1", nbOutputs, std::shared_ptr<Activation>());
+
+    std::vector<Tensor<double> > inputs;
+    std::vector<Tensor<double> > diffOutputs;
+
+    for (unsigned int k = 0; k < 2; ++k) {
+        inputs.push_back(Tensor<double>({channelsWidth, channelsHeight,
+                                         nbChannels[k], batchSize}));
+        diffOutputs.push_back(Tensor<double>({channelsWidth, channelsHeight,
+                                              nbChannels[k], batchSize}));
+
+        for (unsigned int index = 0; index < inputs[k].size(); ++index)
+            inputs[k](index) = Random::randUniform(-2.0, 2.0);
+    }
+
+    bn1.addInput(inputs[0], diffOutputs[0]);
+    bn1.addInput(inputs[1], diffOutputs[1]);
+    bn1.initialize();
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        (*bn1.mScale)(output) = Random::randUniform(0.5, 1.5);
+        (*bn1.mBias)(output) = Random::randUniform(-1.0, 1.0);
+    }
+
+    // Loss = sum(weights * outputs), whose gradient w.r.t. the outputs is
+    // weights
+    Tensor<double> weights(bn1.getOutputs().dims());
+
+    for (unsigned int index = 0; index < weights.size(); ++index)
+        weights(index) = Random::randUniform(-1.0, 1.0);
+
+    const auto loss = [&bn1, &weights]() {
+        bn1.propagate(false);
+
+        const Tensor<double>& outputs = tensor_cast<double>(bn1.getOutputs());
+        double sum = 0.0;
+
+        for (unsigned int index = 0; index < outputs.size(); ++index)
+            sum += weights(index) * outputs(index);
+
+        return sum;
+    };
+
+    loss();
+
+    for (unsigned int index = 0; index < weights.size(); ++index)
+        bn1.mDiffInputs(index) = weights(index);
+
+    bn1.mDiffInputs.setValid();
+    bn1.backPropagate();
+
+    // Copy the analytical gradients before the finite differences passes
+    const std::vector<Tensor<double> > diffInputs
+        = {tensor_cast<double>(bn1.mDiffOutputs[0]),
+           tensor_cast<double>(bn1.mDiffOutputs[1])};
+    const Tensor<double> diffScale = bn1.mDiffScale.clone();
+    const Tensor<double> diffBias = bn1.mDiffBias.clone();
+
+    for (unsigned int k = 0; k < 2; ++k) {
+        for (unsigned int index = 0; index < inputs[k].size(); ++index) {
+            const double value = inputs[k](index);
+
+            inputs[k](index) = value + h;
+            const double lossPlus = loss();
+            inputs[k](index) = value - h;
+            const double lossMinus = loss();
+            inputs[k](index) = value;
+
+            const double diff = (lossPlus - lossMinus) / (2.0 * h);
+
+            ASSERT_EQUALS_DELTA(diffInputs[k](index), diff,
+                                1.0e-5 * (1.0 + std::fabs(diff)));
+        }
+    }
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        const double scale = (*bn1.mScale)(output);
+
+        (*bn1.mScale)(output) = scale + h;
+        const double scalePlus = loss();
+        (*bn1.mScale)(output) = scale - h;
+        const double scaleMinus = loss();
+        (*bn1.mScale)(output) = scale;
+
+        const double diffScaleFD = (scalePlus - scaleMinus) / (2.0 * h);
+
+        ASSERT_EQUALS_DELTA(diffScale(output), diffScaleFD,
+                            1.0e-5 * (1.0 + std::fabs(diffScaleFD)));
+
+        const double bias = (*bn1.mBias)(output);
+
+        (*bn1.mBias)(output) = bias + h;
+        const double biasPlus = loss();
+        (*bn1.mBias)(output) = bias - h;
+        const double biasMinus = loss();
+        (*bn1.mBias)(output) = bias;
+
+        const double diffBiasFD = (biasPlus - biasMinus) / (2.0 * h);
+
+        ASSERT_EQUALS_DELTA(diffBias(output), diffBiasFD,
+                            1.0e-5 * (1.0 + std::fabs(diffBiasFD)));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// half
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(BatchNormCell_Frame_half,
+             propagate__inference,
+             (unsigned int channelsWidth,
+              unsigned int channelsHeight,
+              unsigned int batchSize),
+             std::make_tuple(8U, 8U, 2U),
+             // Planes larger than a chunk
+             std::make_tuple(70U, 70U, 1U),
+             std::make_tuple(80U, 60U, 3U))
+{
+    Random::mtSeed(0);
+
+    // Two inputs, so that the second one is normalized with the parameters
+    // starting at its output offset
+    const unsigned int nbChannels[2] = {3, 2};
+    const unsigned int nbOutputs = nbChannels[0] + nbChannels[1];
+
+    Network net;
+    DeepNet dn(net);
+
+    BatchNormCell_Frame_Test<half_float::half> bn1(
+        dn, "bn1", nbOutputs, std::shared_ptr<Activation>());
+
+    std::vector<Tensor<half_float::half> > inputs;
+    std::vector<Tensor<half_float::half> > diffOutputs;
+
+    for (unsigned int k = 0; k < 2; ++k) {
+        inputs.push_back(Tensor<half_float::half>({channelsWidth,
+                                                   channelsHeight,
+                                                   nbChannels[k],
+                                                   batchSize}));
+        diffOutputs.push_back(Tensor<half_float::half>({channelsWidth,
+                                                        channelsHeight,
+                                                        nbChannels[k],
+                                                        batchSize}));
+
+        for (unsigned int index = 0; index < inputs[k].size(); ++index) {
+            inputs[k](index)
+                = half_float::half_cast<half_float::half>(
+                    Random::randUniform(-2.0, 2.0));
+        }
+    }
+
+    bn1.addInput(inputs[0], diffOutputs[0]);
+    bn1.addInput(inputs[1], diffOutputs[1]);
+    bn1.initialize();
+
+    ASSERT_EQUALS(bn1.getNbChannels(), nbOutputs);
+    ASSERT_EQUALS(bn1.getOutputs().dimZ(), nbOutputs);
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        (*bn1.mScale)(output) = 0.5 + 0.25 * output;
+        (*bn1.mBias)(output) = -1.0 + 0.5 * output;
+        (*bn1.mMean)(output) = 0.1 * output;
+        (*bn1.mVariance)(output) = 1.0 + output;
+    }
+
+    bn1.propagate(true);
+
+    const Tensor<float>& outputs = tensor_cast<float>(bn1.getOutputs());
+    unsigned int outputOffset = 0;
+
+    for (unsigned int k = 0; k < 2; ++k) {
+        for (unsigned int channel = 0; channel < nbChannels[k]; ++channel) {
+            const unsigned int output = outputOffset + channel;
+            const double scale = (*bn1.mScale)(output);
+            const double bias = (*bn1.mBias)(output);
+            const double mean = (*bn1.mMean)(output);
+            const double variance = (*bn1.mVariance)(output);
+
+            for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+                for (unsigned int y = 0; y < channelsHeight; ++y) {
+                    for (unsigned int x = 0; x < channelsWidth; ++x) {
+                        const double value = scale
+                            * ((float)inputs[k](x, y, channel, batchPos) - mean)
+                                / std::sqrt(variance + bn1.mEpsilon) + bias;
+
+                        ASSERT_EQUALS_DELTA(outputs(x, y, output, batchPos),
+                                            value,
+                                            1.0e-2 * (1.0 + std::fabs(value)));
+                    }
+                }
+            }
+        }
+
+        outputOffset += nbChannels[k];
+    }
+}
+
 RUN_TESTS()
@@ -1858,7 +1858,8 @@ TEST_DATASET(ConvCell_Frame_half,
                         0,
                         kernelHeight);
 
-                    half_float::half sum(0.0f);
+                    // The weighted sums are computed in single precision
+                    float sum(0.0f);
 
                     for (unsigned int channel = 0;
                          channel < conv1.getNbChannels();
@@ -2001,7 +2002,8 @@ TEST_DATASET(ConvCell_Frame_half,
                         0,
                         kernelHeight);
 
-                    half_float::half sum(0.0f);
+                    // The weighted sums are computed in single precision
+                    float sum(0.0f);
 
                     for (unsigned int channel = 0;
                          channel < conv1.getNbChannels();
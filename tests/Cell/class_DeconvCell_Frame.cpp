@@ -0,0 +1,274 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/DeconvCell_Frame.hpp"
+#include "DeepNet.hpp"
+#include "Xnet/Network.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+class DeconvCell_Frame_Test : public DeconvCell_Frame<double> {
+public:
+    DeconvCell_Frame_Test(const DeepNet& deepNet,
+                          const std::string& name,
+                          const std::vector<unsigned int>& kernelDims,
+                          unsigned int nbOutputs,
+                          const std::vector<unsigned int>& strideDims,
+                          const std::vector<int>& paddingDims,
+                          const std::vector<unsigned int>& dilationDims
+                            = std::vector<unsigned int>(2, 1U))
+        : Cell(deepNet, name, nbOutputs),
+          DeconvCell(deepNet, name,
+                     kernelDims,
+                     nbOutputs,
+                     strideDims,
+                     paddingDims,
+                     dilationDims),
+          DeconvCell_Frame<double>(deepNet, name,
+                                   kernelDims,
+                                   nbOutputs,
+                                   strideDims,
+                                   paddingDims,
+                                   dilationDims)
+    {}
+
+    /// Direct scatter of each input through the mapped kernels
+    Tensor<double> scatter(const Tensor<double>& inputs) const
+    {
+        Tensor<double> expected(mOutputs.dims());
+
+        for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos)
+        {
+            for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+                for (unsigned int oy = 0; oy < expected.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < expected.dimX(); ++ox)
+                        expected(ox, oy, output, batchPos) = (*mBias)(output);
+                }
+
+                for (unsigned int channel = 0; channel < inputs.dimZ();
+                     ++channel)
+                {
+                    if (!mMapping(output, channel))
+                        continue;
+
+                    for (unsigned int iy = 0; iy < inputs.dimY(); ++iy) {
+                        for (unsigned int ix = 0; ix < inputs.dimX(); ++ix) {
+                            for (unsigned int sy = 0; sy < mKernelDims[1];
+                                 ++sy)
+                            {
+                                for (unsigned int sx = 0; sx < mKernelDims[0];
+                                     ++sx)
+                                {
+                                    const int ox = (int)(ix * mStrideDims[0]
+                                        + sx * mDilationDims[0])
+                                        - mPaddingDims[0];
+                                    const int oy = (int)(iy * mStrideDims[1]
+                                        + sy * mDilationDims[1])
+                                        - mPaddingDims[1];
+
+                                    if (ox < 0 || ox >= (int)expected.dimX()
+                                        || oy < 0
+                                        || oy >= (int)expected.dimY())
+                                    {
+                                        continue;
+                                    }
+
+                                    expected(ox, oy, output, batchPos)
+                                        += mSharedSynapses[0](sx, sy,
+                                                              output,
+                                                              channel)
+                                            * inputs(ix, iy, channel,
+                                                     batchPos);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return expected;
+    }
+
+    friend class UnitTest_DeconvCell_Frame_double_propagate;
+    friend class UnitTest_DeconvCell_Frame_double_propagate__dilation;
+    friend class UnitTest_DeconvCell_Frame_double_propagate__mapping;
+};
+
+TEST_DATASET(DeconvCell_Frame_double,
+             propagate,
+             (unsigned int kernel, unsigned int stride, int padding),
+             std::make_tuple(3U, 1U, 1),
+             std::make_tuple(2U, 2U, 0),
+             std::make_tuple(4U, 2U, 1),
+             std::make_tuple(3U, 2U, 1))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 3;
+    const unsigned int nbChannels = 2;
+
+    DeconvCell_Frame_Test deconv(dn, "deconv",
+                                 std::vector<unsigned int>(2, kernel),
+                                 nbOutputs,
+                                 std::vector<unsigned int>(2, stride),
+                                 std::vector<int>(2, padding));
+
+    Tensor<double> inputs({5, 4, nbChannels, 2});
+    Tensor<double> diffOutputs({5, 4, nbChannels, 2});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    deconv.addInput(inputs, diffOutputs);
+    deconv.initialize();
+
+    deconv.propagate();
+    const Tensor<double>& outputs
+        = tensor_cast<double>(deconv.getOutputs());
+
+    ASSERT_EQUALS(outputs.dimX(), 5 * stride + kernel - 2 * padding - stride);
+    ASSERT_EQUALS(outputs.dimY(), 4 * stride + kernel - 2 * padding - stride);
+    ASSERT_EQUALS(outputs.dimZ(), nbOutputs);
+    ASSERT_EQUALS(outputs.dimB(), inputs.dimB());
+
+    const Tensor<double> expected = deconv.scatter(inputs);
+
+    for (unsigned int o = 0; o < outputs.size(); ++o)
+        ASSERT_EQUALS_DELTA(outputs(o), expected(o), 1.0e-12);
+
+    ASSERT_NOTHROW_ANY(deconv.checkGradient(1.0e-3, 1.0e-3));
+}
+
+TEST_DATASET(DeconvCell_Frame_double,
+             propagate__dilation,
+             (unsigned int kernel,
+              unsigned int stride,
+              int padding,
+              unsigned int dilationX,
+              unsigned int dilationY),
+             std::make_tuple(3U, 1U, 1, 2U, 2U),
+             std::make_tuple(2U, 2U, 0, 2U, 3U),
+             std::make_tuple(3U, 2U, 2, 3U, 2U),
+             std::make_tuple(4U, 2U, 1, 2U, 1U))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 3;
+    const unsigned int nbChannels = 2;
+
+    DeconvCell_Frame_Test deconv(dn, "deconv",
+                                 std::vector<unsigned int>(2, kernel),
+                                 nbOutputs,
+                                 std::vector<unsigned int>(2, stride),
+                                 std::vector<int>(2, padding),
+                                 std::vector<unsigned int>({dilationX,
+                                                            dilationY}));
+
+    Tensor<double> inputs({5, 4, nbChannels, 2});
+    Tensor<double> diffOutputs({5, 4, nbChannels, 2});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    deconv.addInput(inputs, diffOutputs);
+    deconv.initialize();
+
+    deconv.propagate();
+    const Tensor<double>& outputs
+        = tensor_cast<double>(deconv.getOutputs());
+
+    ASSERT_EQUALS(outputs.dimX(), 5 * stride + dilationX * (kernel - 1) + 1
+                                  - 2 * padding - stride);
+    ASSERT_EQUALS(outputs.dimY(), 4 * stride + dilationY * (kernel - 1) + 1
+                                  - 2 * padding - stride);
+
+    const Tensor<double> expected = deconv.scatter(inputs);
+
+    for (unsigned int o = 0; o < outputs.size(); ++o)
+        ASSERT_EQUALS_DELTA(outputs(o), expected(o), 1.0e-12);
+
+    ASSERT_NOTHROW_ANY(deconv.checkGradient(1.0e-3, 1.0e-3));
+}
+
+TEST_DATASET(DeconvCell_Frame_double,
+             propagate__mapping,
+             (unsigned int kernel, unsigned int stride, int padding),
+             std::make_tuple(3U, 1U, 1),
+             std::make_tuple(4U, 2U, 1))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 3;
+    const unsigned int nbChannels = 2;
+
+    DeconvCell_Frame_Test deconv(dn, "deconv",
+                                 std::vector<unsigned int>(2, kernel),
+                                 nbOutputs,
+                                 std::vector<unsigned int>(2, stride),
+                                 std::vector<int>(2, padding));
+
+    Tensor<double> inputs({5, 4, nbChannels, 2});
+    Tensor<double> diffOutputs({5, 4, nbChannels, 2});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    deconv.addInput(inputs, diffOutputs);
+
+    // Partial mapping: output 0 only from channel 0, output 2 only from
+    // channel 1
+    deconv.mMapping(0, 1) = false;
+    deconv.mMapping(2, 0) = false;
+
+    deconv.initialize();
+
+    // Non-zero weights on the unmapped connections, which must be ignored
+    for (unsigned int index = 0; index < deconv.mSharedSynapses[0].size();
+         ++index)
+    {
+        deconv.mSharedSynapses[0](index) = Random::randUniform(-1.0, 1.0);
+    }
+
+    deconv.propagate();
+    const Tensor<double>& outputs
+        = tensor_cast<double>(deconv.getOutputs());
+    const Tensor<double> expected = deconv.scatter(inputs);
+
+    for (unsigned int o = 0; o < outputs.size(); ++o)
+        ASSERT_EQUALS_DELTA(outputs(o), expected(o), 1.0e-12);
+
+    ASSERT_NOTHROW_ANY(deconv.checkGradient(1.0e-3, 1.0e-3));
+}
+
+RUN_TESTS()
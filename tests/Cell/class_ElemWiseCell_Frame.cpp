@@ -350,6 +350,66 @@ TEST_DATASET(ElemWiseCell_Frame,
 }
 
 
+TEST(ElemWiseCell_Frame,
+     propagate_sum2_in_place)
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 4;
+
+    std::shared_ptr<ElemWiseCell_Frame> cellA = std::make_shared
+        <ElemWiseCell_Frame>(dn, "A", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame> cellB = std::make_shared
+        <ElemWiseCell_Frame>(dn, "B", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame> elemWise = std::make_shared
+        <ElemWiseCell_Frame>(dn, "elemwise", nbOutputs, ElemWiseCell::Sum);
+    elemWise->setParameter("InPlace", true);
+
+    Tensor<Float_T> inputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> inputsB({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsB({8, 8, nbOutputs, 2});
+
+    for (unsigned int index = 0; index < inputsA.size(); ++index) {
+        inputsA(index) = Random::randUniform(-1.0, 1.0);
+        inputsB(index) = Random::randUniform(-1.0, 1.0);
+    }
+
+    cellA->addInput(inputsA, diffOutputsA);
+    cellB->addInput(inputsB, diffOutputsB);
+    elemWise->addInput(cellA.get());
+    elemWise->addInput(cellB.get());
+
+    dn.addCell(cellA, std::vector<std::shared_ptr<Cell> >());
+    dn.addCell(cellB, std::vector<std::shared_ptr<Cell> >());
+    dn.addCell(elemWise, {cellA, cellB});
+
+    cellA->initialize();
+    cellB->initialize();
+    elemWise->initialize();
+
+    for (int inference = 1; inference >= 0; --inference) {
+        cellA->propagate(inference);
+        cellB->propagate(inference);
+        elemWise->propagate(inference);
+
+        const Tensor<Float_T>& outputsA
+            = tensor_cast<Float_T>(cellA->getOutputs());
+        const Tensor<Float_T>& outputs
+            = tensor_cast<Float_T>(elemWise->getOutputs());
+
+        // Accumulated in cell A outputs only in inference
+        ASSERT_EQUALS(&outputs(0) == &outputsA(0), (bool)inference);
+
+        for (unsigned int o = 0; o < outputs.size(); ++o) {
+            ASSERT_EQUALS_DELTA(outputs(o), inputsA(o) + inputsB(o), 1.0e-6);
+        }
+    }
+}
+
 TEST(ElemWiseCell_Frame,
      propagate_abs_sum2)
 {
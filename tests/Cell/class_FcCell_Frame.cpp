@@ -1746,10 +1746,10 @@ TEST_DATASET(FcCell_Frame_half,
     ASSERT_EQUALS(out.dimX(), 1U);
     ASSERT_EQUALS(out.dimY(), 1U);
 
-    const half_float::half sum
-        = std::accumulate(in.begin(),
-                          in.begin() + inputSize,
-                          half_float::half(0.0f));
+    // The weighted sums are computed in single precision
+    const half_float::half sum(std::accumulate(in.begin(),
+                                               in.begin() + inputSize,
+                                               0.0f));
 
     for (unsigned int output = 0; output < out.dimZ(); ++output) {
         ASSERT_EQUALS_DELTA(out(output, 0), sum, 1e-4);
@@ -1966,7 +1966,8 @@ TEST_DATASET(FcCell_Frame_half,
     ASSERT_EQUALS(out.dimY(), 1U);
 
     for (unsigned int output = 0; output < out.dimZ(); ++output) {
-        half_float::half sum(0.0f);
+        // The weighted sums are computed in single precision
+        float sum(0.0f);
 
         for (unsigned int channel = 0; channel < inputSize; ++channel) {
             Tensor<half_float::half> weight;
@@ -1975,7 +1976,7 @@ TEST_DATASET(FcCell_Frame_half,
             sum += weight(0);
         }
 
-        ASSERT_EQUALS_DELTA(out(output, 0), sum, 1e-5);
+        ASSERT_EQUALS_DELTA(out(output, 0), half_float::half(sum), 1e-5);
     }
 }
 
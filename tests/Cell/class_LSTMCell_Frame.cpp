@@ -0,0 +1,452 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/LSTMCell_Frame.hpp"
+#ifdef CUDA
+#include "Cell/LSTMCell_Frame_CUDA.hpp"
+#endif
+#include "DeepNet.hpp"
+#include "Filler/UniformFiller.hpp"
+#include "Xnet/Network.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+template <class T>
+class LSTMCell_Frame_Test : public LSTMCell_Frame<T> {
+public:
+    LSTMCell_Frame_Test(const DeepNet& deepNet,
+                        const std::string& name,
+                        unsigned int seqLength,
+                        unsigned int batchSize,
+                        unsigned int inputDim,
+                        unsigned int numberLayers,
+                        unsigned int hiddenSize,
+                        unsigned int bidirectional,
+                        unsigned int inputMode)
+        : Cell(deepNet, name, batchSize),
+          LSTMCell(deepNet, name, seqLength, batchSize, inputDim,
+                   numberLayers, hiddenSize, 0, batchSize, bidirectional,
+                   inputMode, 0.0, false),
+          LSTMCell_Frame<T>(deepNet, name, seqLength, batchSize, inputDim,
+                            numberLayers, hiddenSize, 0, batchSize,
+                            bidirectional, inputMode, 0.0, false) {};
+
+    // Reference implementation, straight from the cuDNN equations and
+    // weights layout
+    Tensor<T> propagateReference(const Tensor<T>& inputs) const
+    {
+        const unsigned int H = this->mHiddenSize;
+        const unsigned int B = this->mBatchSize;
+        const unsigned int S = this->mSeqLength;
+        const unsigned int bds = this->biDirScale;
+        const Tensor<T>& w = *this->mWeights;
+
+        Tensor<T> layerInputs = inputs.clone();
+        Tensor<T> layerOutputs;
+
+        for (unsigned int layer = 0; layer < this->mNumberLayers; ++layer) {
+            const unsigned int inputSize = layerInputs.dimY();
+            layerOutputs.resize({1, H * bds, B, S}, T(0.0));
+
+            for (unsigned int dir = 0; dir < bds; ++dir) {
+                const unsigned int pl = layer * bds + dir;
+
+                for (unsigned int b = 0; b < B; ++b) {
+                    std::vector<double> h(H), c(H);
+
+                    for (unsigned int k = 0; k < H; ++k) {
+                        h[k] = (*this->mhx)(0, k, b, pl);
+                        c[k] = (*this->mcx)(0, k, b, pl);
+                    }
+
+                    for (unsigned int step = 0; step < S; ++step) {
+                        const unsigned int s = (dir == 0) ? step
+                                                          : S - 1 - step;
+                        std::vector<double> gates(4 * H);
+
+                        for (unsigned int g = 0; g < 4; ++g) {
+                            const unsigned int wPos
+                                = this->getStartPosition(pl, g, true);
+                            const unsigned int rPos
+                                = this->getStartPosition(pl, g + 4, true);
+
+                            for (unsigned int o = 0; o < H; ++o) {
+                                double sum
+                                    = w(this->getStartPosition(pl, g, false)
+                                        + o)
+                                    + w(this->getStartPosition(pl, g + 4,
+                                                               false) + o);
+
+                                if (layer == 0 && this->mInputMode == 0)
+                                    sum += layerInputs(0, o, b, s);
+                                else {
+                                    for (unsigned int i = 0; i < inputSize;
+                                         ++i)
+                                    {
+                                        sum += w(wPos + o * inputSize + i)
+                                            * layerInputs(0, i, b, s);
+                                    }
+                                }
+
+                                for (unsigned int i = 0; i < H; ++i)
+                                    sum += w(rPos + o * H + i) * h[i];
+
+                                gates[g * H + o] = sum;
+                            }
+                        }
+
+                        for (unsigned int o = 0; o < H; ++o) {
+                            const double i = 1.0 / (1.0 + std::exp(-gates[o]));
+                            const double f
+                                = 1.0 / (1.0 + std::exp(-gates[H + o]));
+                            const double g = std::tanh(gates[2 * H + o]);
+                            const double out
+                                = 1.0 / (1.0 + std::exp(-gates[3 * H + o]));
+
+                            c[o] = f * c[o] + i * g;
+                            h[o] = out * std::tanh(c[o]);
+                            layerOutputs(0, dir * H + o, b, s) = h[o];
+                        }
+                    }
+                }
+            }
+
+            layerInputs.resize(layerOutputs.dims());
+            layerInputs = layerOutputs;
+        }
+
+        return layerOutputs;
+    }
+
+    friend class UnitTest_LSTMCell_Frame_float_propagate;
+    friend class UnitTest_LSTMCell_Frame_double_propagate;
+    friend class UnitTest_LSTMCell_Frame_float_setWeights;
+    friend class UnitTest_LSTMCell_Frame_float_setWeights_gate;
+};
+
+template <class T>
+void initializeLSTM(LSTMCell_Frame_Test<T>& lstm, Tensor<T>& inputs)
+{
+    const std::shared_ptr<Filler> filler
+        = std::make_shared<UniformFiller<T> >(-0.5, 0.5);
+
+    lstm.setWeightsPreviousLayerAllGateFiller_1stLayer(filler);
+    lstm.setWeightsPreviousLayerAllGateFiller(filler);
+    lstm.setWeightsRecurrentAllGateFiller(filler);
+    lstm.setBiasAllGateFiller(filler);
+    lstm.setHxFiller(filler);
+    lstm.setCxFiller(filler);
+
+    Tensor<T> diffOutputs;
+    lstm.addInput(inputs, diffOutputs);
+    lstm.initialize();
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// float
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(LSTMCell_Frame_float,
+             propagate,
+             (unsigned int seqLength,
+              unsigned int batchSize,
+              unsigned int inputDim,
+              unsigned int numberLayers,
+              unsigned int hiddenSize,
+              unsigned int bidirectional,
+              unsigned int inputMode),
+             std::make_tuple(1U, 1U, 1U, 1U, 1U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 1U, 4U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 2U, 4U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 1U, 4U, 1U, 1U),
+             std::make_tuple(5U, 3U, 7U, 3U, 4U, 1U, 1U),
+             std::make_tuple(4U, 2U, 6U, 2U, 6U, 0U, 0U),
+             std::make_tuple(4U, 2U, 6U, 2U, 6U, 1U, 0U),
+             std::make_tuple(10U, 16U, 32U, 2U, 80U, 1U, 1U))
+{
+    Random::mtSeed(0);
+
+    Network net;
+    DeepNet dn(net);
+
+    LSTMCell_Frame_Test<float> lstm(dn, "lstm", seqLength, batchSize,
+                                    inputDim, numberLayers, hiddenSize,
+                                    bidirectional, inputMode);
+
+    Tensor<float> inputs({1, inputDim, batchSize, seqLength});
+    initializeLSTM(lstm, inputs);
+
+    lstm.propagate(true);
+
+    const Tensor<float>& outputs = tensor_cast<float>(lstm.getOutputs());
+    const Tensor<float> outputsRef = lstm.propagateReference(inputs);
+
+    ASSERT_EQUALS(outputs.size(), outputsRef.size());
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-5);
+
+    // Last time step states: forward direction
+    for (unsigned int b = 0; b < batchSize; ++b) {
+        for (unsigned int h = 0; h < hiddenSize; ++h) {
+            ASSERT_EQUALS_DELTA(lstm.getmhy()(0, h, b,
+                                    (numberLayers - 1) * (bidirectional + 1)),
+                                outputsRef(0, h, b, seqLength - 1),
+                                1.0e-5);
+        }
+    }
+}
+
+TEST(LSTMCell_Frame_float,
+     setWeights)
+{
+    Random::mtSeed(0);
+
+    Network net;
+    DeepNet dn(net);
+
+    LSTMCell_Frame_Test<float> lstm(dn, "lstm", 3, 2, 5, 2, 4, 1, 1);
+
+    Tensor<float> inputs({1, 5, 2, 3});
+    initializeLSTM(lstm, inputs);
+
+    lstm.propagate(true);
+    const Tensor<float> outputs1
+        = tensor_cast<float>(lstm.getOutputs()).clone();
+
+    // Modifying the weights through the accessors invalidates the packed
+    // weights
+    Tensor<float> value({1}, 2.0f);
+    lstm.setWeightPLIG_1stLayer(1, 2, 1, value);
+    lstm.setWeightROG(0, 3, 2, value);
+    lstm.setBiasRFG(1, 3, value);
+
+    Tensor<float> check;
+    lstm.getWeightPLIG_1stLayer(1, 2, 1, check);
+    ASSERT_EQUALS(tensor_cast<float>(check)(0), 2.0f);
+
+    lstm.propagate(true);
+
+    const Tensor<float>& outputs2 = tensor_cast<float>(lstm.getOutputs());
+    const Tensor<float> outputsRef = lstm.propagateReference(inputs);
+    bool changed = false;
+
+    for (unsigned int index = 0; index < outputs2.size(); ++index) {
+        ASSERT_EQUALS_DELTA(outputs2(index), outputsRef(index), 1.0e-5);
+        changed = changed || (outputs2(index) != outputs1(index));
+    }
+
+    ASSERT_TRUE(changed);
+}
+
+TEST_DATASET(LSTMCell_Frame_float,
+             setWeights_gate,
+             (unsigned int inputIdx, unsigned int hiddenIdx),
+             std::make_tuple(0U, 0U),
+             std::make_tuple(4U, 1U),
+             std::make_tuple(2U, 3U),
+             std::make_tuple(1U, 2U))
+{
+    Random::mtSeed(0);
+
+    Network net;
+    DeepNet dn(net);
+
+    const unsigned int inputDim = 5;
+    const unsigned int hiddenSize = 4;
+
+    LSTMCell_Frame_Test<float> lstm(dn, "lstm", 1, 1, inputDim, 2,
+                                    hiddenSize, 1, 1);
+
+    Tensor<float> inputs({1, inputDim, 1, 1});
+    initializeLSTM(lstm, inputs);
+
+    // With all the parameters and states to 0, the gates are i = f = o = 0.5
+    // and g = 0. A single non-zero cell gate weight w(o, i) with x(i) = 1 (or
+    // h(i) = 1) gives c(o) = 0.5 * tanh(w) and h(o) = 0.5 * tanh(c(o)), only
+    // on output o.
+    const float weight = 1.5f;
+    const float expected = 0.5f * std::tanh(0.5f * std::tanh(weight));
+
+    for (unsigned int check = 0; check < 2; ++check) {
+        lstm.mWeights->fill(0.0f);
+        lstm.mhx->fill(0.0f);
+        lstm.mcx->fill(0.0f);
+        inputs.fill(0.0f);
+
+        Tensor<float> value({1}, weight);
+
+        if (check == 0) {
+            lstm.setWeightPLCG_1stLayer(inputIdx, hiddenIdx, 0, value);
+            inputs(0, inputIdx, 0, 0) = 1.0f;
+        }
+        else {
+            const unsigned int channelIdx = inputIdx % hiddenSize;
+            lstm.setWeightRCG(channelIdx, hiddenIdx, 0, value);
+            (*lstm.mhx)(0, channelIdx, 0, 0) = 1.0f;
+        }
+
+        Tensor<float> readBack;
+        lstm.getWeightPLCG_1stLayer(inputIdx, hiddenIdx, 0, readBack);
+        ASSERT_EQUALS(tensor_cast<float>(readBack)(0),
+                      (check == 0) ? weight : 0.0f);
+
+        lstm.propagate(true);
+
+        // First layer, forward direction
+        for (unsigned int h = 0; h < hiddenSize; ++h) {
+            ASSERT_EQUALS_DELTA(lstm.mLayerOutputs[0][h],
+                                (h == hiddenIdx) ? expected : 0.0f,
+                                1.0e-6);
+        }
+    }
+
+    // Accessors of the second layer input weights match the kernel layout
+    for (unsigned int gate = 0; gate < 4; ++gate) {
+        ASSERT_EQUALS(lstm.getInputWeightPosition(inputIdx, hiddenIdx, 1,
+                                                  gate),
+                      lstm.getStartPosition(3, gate, true)
+                        + hiddenIdx * 2 * hiddenSize + inputIdx);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// double
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(LSTMCell_Frame_double,
+             propagate,
+             (unsigned int seqLength,
+              unsigned int batchSize,
+              unsigned int inputDim,
+              unsigned int numberLayers,
+              unsigned int hiddenSize,
+              unsigned int bidirectional,
+              unsigned int inputMode),
+             std::make_tuple(1U, 1U, 1U, 1U, 1U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 2U, 4U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 3U, 4U, 1U, 1U),
+             std::make_tuple(4U, 2U, 6U, 2U, 6U, 1U, 0U))
+{
+    Random::mtSeed(0);
+
+    Network net;
+    DeepNet dn(net);
+
+    LSTMCell_Frame_Test<double> lstm(dn, "lstm", seqLength, batchSize,
+                                     inputDim, numberLayers, hiddenSize,
+                                     bidirectional, inputMode);
+
+    Tensor<double> inputs({1, inputDim, batchSize, seqLength});
+    initializeLSTM(lstm, inputs);
+
+    lstm.propagate(true);
+
+    const Tensor<double>& outputs = tensor_cast<double>(lstm.getOutputs());
+    const Tensor<double> outputsRef = lstm.propagateReference(inputs);
+
+    ASSERT_EQUALS(outputs.size(), outputsRef.size());
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-12);
+}
+
+#ifdef CUDA
+////////////////////////////////////////////////////////////////////////////////
+// Frame vs. Frame_CUDA (cuDNN)
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(LSTMCell_Frame_float,
+             propagate_CUDA,
+             (unsigned int seqLength,
+              unsigned int batchSize,
+              unsigned int inputDim,
+              unsigned int numberLayers,
+              unsigned int hiddenSize,
+              unsigned int bidirectional,
+              unsigned int inputMode),
+             std::make_tuple(5U, 3U, 7U, 2U, 4U, 0U, 1U),
+             std::make_tuple(5U, 3U, 7U, 3U, 4U, 1U, 1U),
+             std::make_tuple(4U, 2U, 6U, 2U, 6U, 1U, 0U))
+{
+    REQUIRED(UnitTest::CudaDeviceExists(3));
+
+    Random::mtSeed(0);
+
+    Network net;
+    DeepNet dn(net);
+
+    LSTMCell_Frame_Test<float> lstm(dn, "lstm", seqLength, batchSize,
+                                    inputDim, numberLayers, hiddenSize,
+                                    bidirectional, inputMode);
+    LSTMCell_Frame_CUDA<float> lstmCUDA(dn, "lstm_cuda", seqLength,
+                                        batchSize, inputDim, numberLayers,
+                                        hiddenSize, 0, batchSize,
+                                        bidirectional, inputMode, 0.0,
+                                        false);
+
+    Tensor<float> inputs({1, inputDim, batchSize, seqLength});
+    initializeLSTM(lstm, inputs);
+
+    CudaTensor<float> inputsCUDA(inputs.dims());
+    CudaTensor<float> diffOutputsCUDA(inputs.dims());
+    lstmCUDA.addInput(inputsCUDA, diffOutputsCUDA);
+    lstmCUDA.initialize();
+
+    // Same free parameters and initial states, in the cuDNN layout
+    const std::shared_ptr<Tensor<float> > weights = lstm.getWeights();
+    const std::shared_ptr<CudaTensor<float> > weightsCUDA
+        = std::dynamic_pointer_cast<CudaTensor<float> >(
+            lstmCUDA.getWeights());
+    ASSERT_TRUE(weightsCUDA);
+    ASSERT_EQUALS(weightsCUDA->size(), weights->size());
+
+    std::copy(weights->begin(), weights->end(), weightsCUDA->begin());
+    weightsCUDA->synchronizeHToD();
+
+    std::copy(lstm.getmhx()->begin(), lstm.getmhx()->end(),
+              lstmCUDA.getmhx()->begin());
+    lstmCUDA.getmhx()->synchronizeHToD();
+    std::copy(lstm.getmcx()->begin(), lstm.getmcx()->end(),
+              lstmCUDA.getmcx()->begin());
+    lstmCUDA.getmcx()->synchronizeHToD();
+
+    std::copy(inputs.begin(), inputs.end(), inputsCUDA.begin());
+    inputsCUDA.synchronizeHToD();
+
+    lstm.propagate(true);
+    lstmCUDA.propagate(true);
+    lstmCUDA.getOutputs().synchronizeDToH();
+
+    const Tensor<float>& outputs = tensor_cast<float>(lstm.getOutputs());
+    const Tensor<float>& outputsCUDA
+        = tensor_cast<float>(lstmCUDA.getOutputs());
+
+    ASSERT_EQUALS(outputsCUDA.size(), outputs.size());
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsCUDA(index), 1.0e-5);
+}
+#endif
+
+RUN_TESTS()
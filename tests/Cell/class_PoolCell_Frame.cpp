@@ -60,11 +60,13 @@ public:
     friend class UnitTest_PoolCell_Frame_addInput_float;
     friend class UnitTest_PoolCell_Frame_propagate_input_check_float;
     friend class UnitTest_PoolCell_Frame_propagate_2_input_check_float;
+    friend class UnitTest_PoolCell_Frame_propagate_average_float;
 
     friend class UnitTest_PoolCell_Frame_addInput__env_half;
     friend class UnitTest_PoolCell_Frame_addInput_half;
     friend class UnitTest_PoolCell_Frame_propagate_input_check_half;
     friend class UnitTest_PoolCell_Frame_propagate_2_input_check_half;
+    friend class UnitTest_PoolCell_Frame_propagate_average_half;
 
     friend class UnitTest_PoolCell_Frame_addInput__env_double;
     friend class UnitTest_PoolCell_Frame_addInput_double;
@@ -582,6 +584,101 @@ TEST_DATASET(PoolCell_Frame,
     }
 }
 
+TEST_DATASET(PoolCell_Frame,
+             propagate_average_float,
+             (unsigned int poolWidth,
+              unsigned int poolHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              unsigned int paddingX,
+              unsigned int paddingY,
+              unsigned int channelsWidth,
+              unsigned int channelsHeight),
+             std::make_tuple(3U, 3U, 1U, 1U, 0U, 0U, 24U, 24U),
+             std::make_tuple(2U, 5U, 1U, 1U, 0U, 0U, 24U, 32U),
+             std::make_tuple(3U, 3U, 2U, 2U, 0U, 0U, 32U, 24U),
+             std::make_tuple(3U, 3U, 1U, 3U, 2U, 2U, 24U, 24U),
+             std::make_tuple(2U, 5U, 1U, 1U, 1U, 3U, 32U, 24U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 2;
+    const unsigned int batchSize = 2;
+
+    Network net;
+    DeepNet dn(net);
+    PoolCell_Frame_Test<float> pool1(dn, "pool1",
+                              std::vector<unsigned int>({poolWidth, poolHeight}),
+                              nbOutputs,
+                              std::vector<unsigned int>({strideX, strideY}),
+                              std::vector<unsigned int>({paddingX, paddingY}),
+                              PoolCell::Average);
+
+    Tensor<float> in({channelsWidth, channelsHeight, nbChannels, batchSize});
+    Tensor<float> diffOutputs;
+
+    for (unsigned int index = 0; index < in.size(); ++index)
+        in(index) = float(Random::randUniform(-1.0, 1.0));
+
+    pool1.addInput(in, diffOutputs);
+    pool1.initialize();
+
+    ASSERT_EQUALS(pool1.getNbOutputs(), nbOutputs);
+    ASSERT_EQUALS(pool1.getNbChannels(), nbChannels);
+
+    pool1.propagate();
+
+    const Tensor<float>& out = tensor_cast<float>(pool1.getOutputs());
+
+    for (unsigned int batch = 0; batch < batchSize; ++batch) {
+        for (unsigned int output = 0; output < nbOutputs; ++output) {
+            for (unsigned int oy = 0; oy < pool1.getOutputsHeight(); ++oy) {
+                for (unsigned int ox = 0; ox < pool1.getOutputsWidth(); ++ox) {
+                    const unsigned int sxMin = (unsigned int)std::max(
+                        (int)paddingX - (int)(ox * strideX), 0);
+                    const unsigned int syMin = (unsigned int)std::max(
+                        (int)paddingY - (int)(oy * strideY), 0);
+                    const unsigned int sxMax = Utils::clamp
+                        <int>(pool1.getChannelsWidth() + paddingX
+                                - ox * strideX,
+                              0,
+                              poolWidth);
+                    const unsigned int syMax = Utils::clamp
+                        <int>(pool1.getChannelsHeight() + paddingY
+                                - oy * strideY,
+                              0,
+                              poolHeight);
+
+                    const int ix = (int)(ox * strideX) - (int)paddingX;
+                    const int iy = (int)(oy * strideY) - (int)paddingY;
+
+                    // For each output, compute the pool value, padding
+                    // included in the count
+                    double poolValue = 0.0;
+
+                    for (unsigned int channel = 0; channel < nbChannels;
+                         ++channel) {
+                        for (unsigned int sy = syMin; sy < syMax; ++sy) {
+                            for (unsigned int sx = sxMin; sx < sxMax; ++sx) {
+                                poolValue += (double)in(ix + sx,
+                                                        iy + sy,
+                                                        channel,
+                                                        batch);
+                            }
+                        }
+                    }
+
+                    poolValue /= nbChannels * poolWidth * poolHeight;
+
+                    ASSERT_EQUALS_DELTA(
+                        out(ox, oy, output, batch), poolValue, 1e-6);
+                }
+            }
+        }
+    }
+}
+
 TEST_DATASET(PoolCell_Frame,
              addInput__env_half,
              (unsigned int poolWidth,
@@ -1028,6 +1125,101 @@ TEST_DATASET(PoolCell_Frame,
 
 
 
+TEST_DATASET(PoolCell_Frame,
+             propagate_average_half,
+             (unsigned int poolWidth,
+              unsigned int poolHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              unsigned int paddingX,
+              unsigned int paddingY,
+              unsigned int channelsWidth,
+              unsigned int channelsHeight),
+             std::make_tuple(3U, 3U, 1U, 1U, 0U, 0U, 24U, 24U),
+             std::make_tuple(2U, 5U, 1U, 1U, 0U, 0U, 24U, 32U),
+             std::make_tuple(3U, 3U, 2U, 2U, 0U, 0U, 32U, 24U),
+             std::make_tuple(3U, 3U, 1U, 3U, 2U, 2U, 24U, 24U),
+             std::make_tuple(2U, 5U, 1U, 1U, 1U, 3U, 32U, 24U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 2;
+    const unsigned int batchSize = 2;
+
+    Network net;
+    DeepNet dn(net);
+    PoolCell_Frame_Test<half_float::half> pool1(dn, "pool1",
+                              std::vector<unsigned int>({poolWidth, poolHeight}),
+                              nbOutputs,
+                              std::vector<unsigned int>({strideX, strideY}),
+                              std::vector<unsigned int>({paddingX, paddingY}),
+                              PoolCell::Average);
+
+    Tensor<half_float::half> in({channelsWidth, channelsHeight, nbChannels, batchSize});
+    Tensor<half_float::half> diffOutputs;
+
+    for (unsigned int index = 0; index < in.size(); ++index)
+        in(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+
+    pool1.addInput(in, diffOutputs);
+    pool1.initialize();
+
+    ASSERT_EQUALS(pool1.getNbOutputs(), nbOutputs);
+    ASSERT_EQUALS(pool1.getNbChannels(), nbChannels);
+
+    pool1.propagate();
+
+    const Tensor<float>& out = tensor_cast<float>(pool1.getOutputs());
+
+    for (unsigned int batch = 0; batch < batchSize; ++batch) {
+        for (unsigned int output = 0; output < nbOutputs; ++output) {
+            for (unsigned int oy = 0; oy < pool1.getOutputsHeight(); ++oy) {
+                for (unsigned int ox = 0; ox < pool1.getOutputsWidth(); ++ox) {
+                    const unsigned int sxMin = (unsigned int)std::max(
+                        (int)paddingX - (int)(ox * strideX), 0);
+                    const unsigned int syMin = (unsigned int)std::max(
+                        (int)paddingY - (int)(oy * strideY), 0);
+                    const unsigned int sxMax = Utils::clamp
+                        <int>(pool1.getChannelsWidth() + paddingX
+                                - ox * strideX,
+                              0,
+                              poolWidth);
+                    const unsigned int syMax = Utils::clamp
+                        <int>(pool1.getChannelsHeight() + paddingY
+                                - oy * strideY,
+                              0,
+                              poolHeight);
+
+                    const int ix = (int)(ox * strideX) - (int)paddingX;
+                    const int iy = (int)(oy * strideY) - (int)paddingY;
+
+                    // For each output, compute the pool value, padding
+                    // included in the count
+                    double poolValue = 0.0;
+
+                    for (unsigned int channel = 0; channel < nbChannels;
+                         ++channel) {
+                        for (unsigned int sy = syMin; sy < syMax; ++sy) {
+                            for (unsigned int sx = sxMin; sx < sxMax; ++sx) {
+                                poolValue += (double)in(ix + sx,
+                                                        iy + sy,
+                                                        channel,
+                                                        batch);
+                            }
+                        }
+                    }
+
+                    poolValue /= nbChannels * poolWidth * poolHeight;
+
+                    ASSERT_EQUALS_DELTA(
+                        out(ox, oy, output, batch), poolValue, 1e-3);
+                }
+            }
+        }
+    }
+}
+
 TEST_DATASET(PoolCell_Frame,
              addInput__env_double,
              (unsigned int poolWidth,
@@ -48,6 +48,7 @@ public:
     }
 
     friend class UnitTest_ReshapeCell_Frame_float_propagate;
+    friend class UnitTest_ReshapeCell_Frame_propagate__share;
 };
 
 TEST(ReshapeCell_Frame, propagate)
@@ -92,4 +93,49 @@ TEST(ReshapeCell_Frame, propagate)
     }
 }
 
+TEST(ReshapeCell_Frame, propagate__share)
+{
+    const unsigned int nbOutputs = 4;
+    const std::vector<int> shape = {3, 2, (int)nbOutputs};
+
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    ReshapeCell_Frame_Test<Float_T> reshape(dn, "reshape",
+        nbOutputs,
+        shape);
+
+    Tensor<Float_T> inputs({nbOutputs, 6, 1, 2});
+    Tensor<Float_T> diffOutputs({nbOutputs, 6, 1, 2});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    reshape.addInput(inputs, diffOutputs);
+    reshape.initialize();
+
+    reshape.propagate();
+
+    // Without activation, the outputs are the inputs data, with the reshaped
+    // dimensions
+    ASSERT_TRUE(&reshape.mOutputs(0) == &inputs(0));
+    ASSERT_EQUALS(reshape.mOutputs.dimX(), (unsigned int)shape[0]);
+    ASSERT_EQUALS(reshape.mOutputs.dimY(), (unsigned int)shape[1]);
+    ASSERT_EQUALS(reshape.mOutputs.dimZ(), (unsigned int)shape[2]);
+    ASSERT_EQUALS(reshape.mOutputs.dimB(), 2U);
+
+    // The outputs follow the inputs from one pass to the next
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = index;
+
+    reshape.propagate();
+
+    ASSERT_TRUE(&reshape.mOutputs(0) == &inputs(0));
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        ASSERT_EQUALS(reshape.mOutputs(index), index);
+}
+
 RUN_TESTS()
@@ -21,12 +21,14 @@
 #include "N2D2.hpp"
 
 #include "Cell/TransposeCell_Frame.hpp"
+#include "Cell/TransposeCell_Frame_Kernels.hpp"
 #include "containers/Tensor.hpp"
 #include "DeepNet.hpp"
 #include "Xnet/Network.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Random.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <tuple>
@@ -48,6 +50,7 @@ public:
     }
 
     friend class UnitTest_TransposeCell_Frame_float_propagate;
+    friend class UnitTest_TransposeCell_Frame_backPropagate;
 };
 
 TEST(TransposeCell_Frame, propagate)
@@ -117,4 +120,128 @@ TEST(TransposeCell_Frame, propagate)
     }
 }
 
+TEST_DATASET(TransposeCell_Frame_Kernels,
+             transpose,
+             (unsigned int dimX,
+              unsigned int dimY,
+              unsigned int dimZ,
+              unsigned int dimB),
+             std::make_tuple(5U, 3U, 4U, 2U),
+             // Several tiles, with partial tiles
+             std::make_tuple(37U, 70U, 3U, 2U),
+             std::make_tuple(3U, 33U, 65U, 2U),
+             std::make_tuple(40U, 2U, 3U, 35U))
+{
+    Random::mtSeed(0);
+
+    const std::vector<size_t> dims = {dimX, dimY, dimZ, dimB};
+
+    Tensor<Float_T> inputs(dims);
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    std::vector<int> perm = {0, 1, 2, 3};
+    unsigned int nbPerms = 0;
+
+    do {
+        Tensor<Float_T> outputs({dims[perm[0]], dims[perm[1]],
+                                 dims[perm[2]], dims[perm[3]]});
+
+        TransposeCell_Frame_Kernels::transpose(&inputs(0), dims, perm,
+                                               &outputs(0));
+
+        std::size_t coords[4];
+        for (coords[3] = 0; coords[3] < dims[3]; ++coords[3]) {
+            for (coords[2] = 0; coords[2] < dims[2]; ++coords[2]) {
+                for (coords[1] = 0; coords[1] < dims[1]; ++coords[1]) {
+                    for (coords[0] = 0; coords[0] < dims[0]; ++coords[0]) {
+                        ASSERT_EQUALS(
+                            outputs(coords[perm[0]], coords[perm[1]],
+                                    coords[perm[2]], coords[perm[3]]),
+                            inputs(coords[0], coords[1],
+                                   coords[2], coords[3]));
+                    }
+                }
+            }
+        }
+
+        ++nbPerms;
+    }
+    while (std::next_permutation(perm.begin(), perm.end()));
+
+    ASSERT_EQUALS(nbPerms, 24U);
+}
+
+TEST_DATASET(TransposeCell_Frame,
+             backPropagate,
+             (int perm0, int perm1, int perm2),
+             // The batch dimension cannot be permuted by the cell
+             std::make_tuple(0, 1, 2),
+             std::make_tuple(0, 2, 1),
+             std::make_tuple(1, 0, 2),
+             std::make_tuple(1, 2, 0),
+             std::make_tuple(2, 0, 1),
+             std::make_tuple(2, 1, 0))
+{
+    const std::vector<int> perm = {perm0, perm1, perm2, 3};
+    const std::vector<size_t> dims = {35, 6, 40, 2};
+
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    TransposeCell_Frame_Test<Float_T> transpose(dn, "transpose",
+        dims[perm[2]],
+        perm);
+
+    Tensor<Float_T> inputs(dims);
+    Tensor<Float_T> diffOutputs(dims);
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    transpose.addInput(inputs, diffOutputs);
+    transpose.initialize();
+
+    transpose.propagate();
+
+    for (unsigned int index = 0; index < transpose.mDiffInputs.size();
+         ++index)
+    {
+        transpose.mDiffInputs(index) = Random::randUniform(-1.0, 1.0);
+    }
+
+    transpose.mDiffInputs.setValid();
+    transpose.backPropagate();
+
+    const Tensor<Float_T>& outputs = transpose.mOutputs;
+    const Tensor<Float_T>& diffInputs = transpose.mDiffInputs;
+
+    ASSERT_EQUALS(outputs.dimX(), dims[perm[0]]);
+    ASSERT_EQUALS(outputs.dimY(), dims[perm[1]]);
+    ASSERT_EQUALS(outputs.dimZ(), dims[perm[2]]);
+    ASSERT_EQUALS(outputs.dimB(), dims[3]);
+
+    std::size_t coords[4];
+    for (coords[3] = 0; coords[3] < dims[3]; ++coords[3]) {
+        for (coords[2] = 0; coords[2] < dims[2]; ++coords[2]) {
+            for (coords[1] = 0; coords[1] < dims[1]; ++coords[1]) {
+                for (coords[0] = 0; coords[0] < dims[0]; ++coords[0]) {
+                    ASSERT_EQUALS(
+                        outputs(coords[perm[0]], coords[perm[1]],
+                                coords[perm[2]], coords[perm[3]]),
+                        inputs(coords[0], coords[1], coords[2], coords[3]));
+                    ASSERT_EQUALS(
+                        diffOutputs(coords[0], coords[1],
+                                    coords[2], coords[3]),
+                        diffInputs(coords[perm[0]], coords[perm[1]],
+                                   coords[perm[2]], coords[perm[3]]));
+                }
+            }
+        }
+    }
+}
+
 RUN_TESTS()
@@ -0,0 +1,159 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "ComputerVision/NMS.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+using namespace N2D2;
+
+TEST(NMS, IoU)
+{
+    ASSERT_EQUALS_DELTA(ComputerVision::NMS::IoU(0, 0, 10, 10, 5, 0, 10, 10),
+                        50.0 / 150.0, 1.0e-6);
+    ASSERT_EQUALS(ComputerVision::NMS::IoU(0, 0, 10, 10, 10, 0, 10, 10), 0.0);
+    ASSERT_EQUALS(ComputerVision::NMS::IoU(0, 0, 10, 10, 0, 0, 10, 10), 1.0);
+}
+
+TEST(NMS, process_insertionOrder)
+{
+    ComputerVision::NMS nms(0.5);
+    nms.push_back(0, 0, 10, 10, 0.1);
+    nms.push_back(1, 1, 10, 10, 0.9);   // suppressed by #0
+    nms.push_back(20, 20, 10, 10, 0.5);
+    nms.push_back(1, 1, 10, 10, 0.9, 1); // other class
+
+    const std::vector<unsigned int>& kept = nms.process(0, false);
+
+    ASSERT_EQUALS(kept.size(), 3U);
+    ASSERT_EQUALS(kept[0], 0U);
+    ASSERT_EQUALS(kept[1], 2U);
+    ASSERT_EQUALS(kept[2], 3U);
+}
+
+TEST(NMS, process_score)
+{
+    ComputerVision::NMS nms(0.5);
+    nms.push_back(0, 0, 10, 10, 0.1);   // suppressed by #1
+    nms.push_back(1, 1, 10, 10, 0.9);
+    nms.push_back(20, 20, 10, 10, 0.5);
+
+    const std::vector<unsigned int>& kept = nms.process();
+
+    ASSERT_EQUALS(kept.size(), 2U);
+    ASSERT_EQUALS(kept[0], 1U);
+    ASSERT_EQUALS(kept[1], 2U);
+}
+
+TEST_DATASET(NMS,
+             process_maxKeep,
+             (unsigned int nbBoxes, unsigned int maxKeep),
+             std::make_tuple(10U, 0U),
+             std::make_tuple(100U, 5U),
+             std::make_tuple(1000U, 10U),
+             std::make_tuple(1000U, 200U))
+{
+    Random::mtSeed(0);
+
+    ComputerVision::NMS nms(0.3);
+    std::vector<float> x, y, w, h, score;
+    std::vector<int> cls;
+
+    for (unsigned int i = 0; i < nbBoxes; ++i) {
+        x.push_back(Random::randUniform(0.0, 100.0));
+        y.push_back(Random::randUniform(0.0, 100.0));
+        w.push_back(Random::randUniform(1.0, 20.0));
+        h.push_back(Random::randUniform(1.0, 20.0));
+        score.push_back(Random::randUniform());
+        cls.push_back(Random::randUniform(0, 2));
+
+        nms.push_back(x.back(), y.back(), w.back(), h.back(), score.back(),
+                      cls.back());
+    }
+
+    const std::vector<unsigned int>& kept = nms.process(maxKeep);
+
+    // Reference greedy NMS, with a full sort
+    std::vector<unsigned int> keptRef;
+
+    for (int c = 0; c <= 2; ++c) {
+        std::vector<std::pair<unsigned int, float> > candidates;
+
+        for (unsigned int i = 0; i < nbBoxes; ++i) {
+            if (cls[i] == c)
+                candidates.push_back(std::make_pair(i, score[i]));
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         Utils::PairSecondPred<unsigned int, float,
+                                               std::greater<float> >());
+
+        std::vector<unsigned int> selected;
+
+        for (unsigned int k = 0; k < candidates.size()
+            && (maxKeep == 0 || selected.size() < maxKeep); ++k)
+        {
+            const unsigned int i = candidates[k].first;
+            bool select = true;
+
+            for (unsigned int f = 0; f < selected.size(); ++f) {
+                const unsigned int j = selected[f];
+
+                if (ComputerVision::NMS::IoU(x[i], y[i], w[i], h[i],
+                                             x[j], y[j], w[j], h[j]) > 0.3)
+                {
+                    select = false;
+                    break;
+                }
+            }
+
+            if (select)
+                selected.push_back(i);
+        }
+
+        keptRef.insert(keptRef.end(), selected.begin(), selected.end());
+    }
+
+    ASSERT_EQUALS(kept.size(), keptRef.size());
+
+    for (unsigned int k = 0; k < kept.size(); ++k)
+        ASSERT_EQUALS(kept[k], keptRef[k]);
+}
+
+TEST(NMS, process_soft)
+{
+    ComputerVision::NMS nms(0.3, ComputerVision::NMS::SoftLinear);
+    nms.push_back(0, 0, 10, 10, 0.9);
+    nms.push_back(0, 5, 10, 10, 0.8);   // IoU = 1/3
+    nms.push_back(50, 50, 10, 10, 0.7);
+
+    const std::vector<unsigned int>& kept = nms.process();
+
+    ASSERT_EQUALS(kept.size(), 3U);
+    ASSERT_EQUALS(kept[0], 0U);
+    ASSERT_EQUALS(kept[1], 2U);
+    ASSERT_EQUALS(kept[2], 1U);
+    ASSERT_EQUALS_DELTA(nms.getScore(0), 0.9, 1.0e-6);
+    ASSERT_EQUALS_DELTA(nms.getScore(1), 0.8 * (1.0 - 1.0 / 3.0), 1.0e-6);
+    ASSERT_EQUALS_DELTA(nms.getScore(2), 0.7, 1.0e-6);
+}
+
+RUN_TESTS()
@@ -0,0 +1,201 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <chrono>
+
+#include "ComputerVision/LSL_Box.hpp"
+#include "ComputerVision/ParallelLSL_Box.hpp"
+#include "utils/Gnuplot.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+using namespace N2D2;
+
+// Reference 8-connected components labeling (flood fill)
+std::vector<ComputerVision::ROI::Roi_T> floodFill(const Matrix<int>& frame)
+{
+    std::vector<ComputerVision::ROI::Roi_T> roi;
+    Matrix<unsigned char> visited(frame.rows(), frame.cols(), 0);
+
+    for (unsigned int i = 0; i < frame.rows(); ++i) {
+        for (unsigned int j = 0; j < frame.cols(); ++j) {
+            if (frame(i, j) == 0 || visited(i, j))
+                continue;
+
+            const int cls = frame(i, j);
+            ComputerVision::ROI::Roi_T box(i, j, i, j, cls);
+            std::vector<std::pair<int, int> > stack(1, std::make_pair(i, j));
+            visited(i, j) = 1;
+
+            while (!stack.empty()) {
+                const std::pair<int, int> pixel = stack.back();
+                stack.pop_back();
+
+                box = ComputerVision::ROI::merge(box,
+                    ComputerVision::ROI::Roi_T(pixel.first, pixel.second,
+                                               pixel.first, pixel.second));
+
+                for (int di = -1; di <= 1; ++di) {
+                    for (int dj = -1; dj <= 1; ++dj) {
+                        const int y = pixel.first + di;
+                        const int x = pixel.second + dj;
+
+                        if (y >= 0 && x >= 0 && y < (int)frame.rows()
+                            && x < (int)frame.cols()
+                            && frame(y, x) == cls && !visited(y, x))
+                        {
+                            visited(y, x) = 1;
+                            stack.push_back(std::make_pair(y, x));
+                        }
+                    }
+                }
+            }
+
+            roi.push_back(box);
+        }
+    }
+
+    std::stable_sort(roi.begin(), roi.end(),
+        [](const ComputerVision::ROI::Roi_T& a,
+           const ComputerVision::ROI::Roi_T& b) { return (a.cls < b.cls); });
+
+    return roi;
+}
+
+Matrix<int> randomLabels(unsigned int width,
+                         unsigned int height,
+                         unsigned int nbBlobs,
+                         int nbLabels)
+{
+    Matrix<int> frame(height, width, 0);
+
+    for (unsigned int b = 0; b < nbBlobs; ++b) {
+        const unsigned int i0 = Random::randUniform(0, (int)height - 1);
+        const unsigned int j0 = Random::randUniform(0, (int)width - 1);
+        const unsigned int i1 = std::min(height,
+            i0 + Random::randUniform(1, (int)height / 4 + 1));
+        const unsigned int j1 = std::min(width,
+            j0 + Random::randUniform(1, (int)width / 4 + 1));
+        const int label = Random::randUniform(1, nbLabels);
+
+        for (unsigned int i = i0; i < i1; ++i) {
+            for (unsigned int j = j0; j < j1; ++j) {
+                if (Random::randUniform() > 0.1)
+                    frame(i, j) = label;
+            }
+        }
+    }
+
+    return frame;
+}
+
+TEST_DATASET(ParallelLSL_Box,
+             process,
+             (unsigned int width, unsigned int height,
+              unsigned int minTileHeight),
+             std::make_tuple(1U, 1U, 1U),
+             std::make_tuple(17U, 3U, 1U),
+             std::make_tuple(64U, 64U, 64U),
+             std::make_tuple(64U, 64U, 4U),
+             std::make_tuple(200U, 300U, 7U),
+             std::make_tuple(300U, 200U, 16U))
+{
+    Random::mtSeed(0);
+
+    ComputerVision::ParallelLSL_Box lsl(0, minTileHeight);
+
+    for (unsigned int n = 0; n < 10; ++n) {
+        const Matrix<int> frame = randomLabels(width, height, 40, 3);
+        const std::vector<ComputerVision::ROI::Roi_T> roiRef
+            = floodFill(frame);
+
+        lsl.process(frame);
+        const std::vector<ComputerVision::ROI::Roi_T>& roi = lsl.getRoi();
+
+        ASSERT_EQUALS(roi.size(), roiRef.size());
+
+        for (unsigned int k = 0; k < roi.size(); ++k) {
+            ASSERT_EQUALS(roi[k].i0, roiRef[k].i0);
+            ASSERT_EQUALS(roi[k].j0, roiRef[k].j0);
+            ASSERT_EQUALS(roi[k].i1, roiRef[k].i1);
+            ASSERT_EQUALS(roi[k].j1, roiRef[k].j1);
+            ASSERT_EQUALS(roi[k].cls, roiRef[k].cls);
+        }
+    }
+}
+
+TEST(ParallelLSL_Box, benchmark)
+{
+    Random::mtSeed(0);
+
+    // 4K label map
+    const Matrix<int> frame = randomLabels(3840, 2160, 2000, 8);
+    const unsigned int nbRuns = 5;
+
+    Utils::createDirectories("ComputerVision");
+    const std::string fileName
+        = "ComputerVision/ParallelLSL_Box_benchmark.dat";
+    std::ofstream data(fileName);
+
+    if (!data.good())
+        throw std::runtime_error("Unable to write file: " + fileName);
+
+    ComputerVision::LSL_Box lsl;
+    ComputerVision::ParallelLSL_Box parallelLsl;
+
+    for (unsigned int n = 0; n < nbRuns; ++n) {
+        std::chrono::high_resolution_clock::time_point startTime
+            = std::chrono::high_resolution_clock::now();
+        lsl.process(frame);
+        std::chrono::high_resolution_clock::time_point curTime
+            = std::chrono::high_resolution_clock::now();
+        const double timeElapsed
+            = std::chrono::duration_cast
+              <std::chrono::duration<double> >(curTime - startTime).count();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        parallelLsl.process(frame);
+        curTime = std::chrono::high_resolution_clock::now();
+        const double parallelTimeElapsed
+            = std::chrono::duration_cast
+              <std::chrono::duration<double> >(curTime - startTime).count();
+
+        data << n << " " << timeElapsed << " " << parallelTimeElapsed << "\n";
+
+        std::cout << "LSL_Box: " << (1000.0 * timeElapsed) << " ms / "
+            "ParallelLSL_Box: " << (1000.0 * parallelTimeElapsed) << " ms"
+            << std::endl;
+    }
+
+    data.close();
+
+    Gnuplot gnuplot;
+    gnuplot.set("grid");
+    gnuplot.setXlabel("Run");
+    gnuplot.setYlabel("Latency (s)");
+    gnuplot.saveToFile(fileName);
+    gnuplot.plot(
+        fileName,
+        "using 1:2 with linespoints lt 1 title \"LSL_Box\", "
+        "'' using 1:3 with linespoints lt 2 title \"ParallelLSL_Box\"");
+}
+
+RUN_TESTS()
@@ -0,0 +1,164 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <chrono>
+
+#include "ComputerVision/RealTimeGaussianMixture.hpp"
+#include "utils/Gnuplot.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+using namespace N2D2;
+
+// Static background with a small gaussian noise
+Matrix<float> noisyFrame(unsigned int width,
+                         unsigned int height,
+                         double value,
+                         double stdDev)
+{
+    Matrix<float> frame(height, width);
+
+    for (unsigned int index = 0; index < frame.size(); ++index)
+        frame(index) = Utils::clamp(Random::randNormal(value, stdDev),
+                                    0.0, 1.0);
+
+    return frame;
+}
+
+TEST_DATASET(RealTimeGaussianMixture,
+             process,
+             (unsigned int k),
+             std::make_tuple(2U),
+             std::make_tuple(3U),
+             std::make_tuple(4U),
+             std::make_tuple(7U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int width = 64;
+    const unsigned int height = 48;
+
+    ComputerVision::RealTimeGaussianMixture gmm(k);
+    gmm.setParameter("Alpha", 0.05);
+
+    for (unsigned int n = 0; n < 200; ++n)
+        gmm.process(noisyFrame(width, height, 0.5, 0.01));
+
+    // The background is learned
+    Matrix<unsigned char> foreground
+        = gmm.process(noisyFrame(width, height, 0.5, 0.01));
+
+    ASSERT_EQUALS(std::count(foreground.begin(), foreground.end(), 1), 0);
+
+    const Matrix<float> background = gmm.getBaseBackground();
+
+    for (unsigned int index = 0; index < background.size(); ++index)
+        ASSERT_EQUALS_DELTA(background(index), 0.5, 0.02);
+
+    // A bright object appears
+    Matrix<float> frame = noisyFrame(width, height, 0.5, 0.01);
+
+    for (unsigned int i = 10; i < 20; ++i) {
+        for (unsigned int j = 30; j < 45; ++j)
+            frame(i, j) = 0.95;
+    }
+
+    foreground = gmm.process(frame);
+
+    for (unsigned int i = 0; i < height; ++i) {
+        for (unsigned int j = 0; j < width; ++j) {
+            const bool object = (i >= 10 && i < 20 && j >= 30 && j < 45);
+            ASSERT_EQUALS(foreground(i, j), (unsigned char)object);
+        }
+    }
+
+    // Save and reload
+    Utils::createDirectories("ComputerVision");
+    gmm.save("ComputerVision/RealTimeGaussianMixture_process.dat");
+
+    ComputerVision::RealTimeGaussianMixture gmmLoaded(k);
+    gmmLoaded.load("ComputerVision/RealTimeGaussianMixture_process.dat");
+
+    const Matrix<float> backgroundLoaded = gmmLoaded.getBaseBackground();
+
+    for (unsigned int index = 0; index < background.size(); ++index)
+        ASSERT_EQUALS(backgroundLoaded(index), gmm.getBaseBackground()(index));
+}
+
+TEST(RealTimeGaussianMixture, benchmark)
+{
+    Random::mtSeed(0);
+
+    // 1080p frames
+    const unsigned int width = 1920;
+    const unsigned int height = 1080;
+    const unsigned int nbFrames = 50;
+
+    std::vector<Matrix<float> > frames;
+
+    for (unsigned int n = 0; n < 4; ++n)
+        frames.push_back(noisyFrame(width, height, 0.5, 0.05));
+
+    Utils::createDirectories("ComputerVision");
+    const std::string fileName
+        = "ComputerVision/RealTimeGaussianMixture_benchmark.dat";
+    std::ofstream data(fileName);
+
+    if (!data.good())
+        throw std::runtime_error("Unable to write file: " + fileName);
+
+    for (unsigned int k = 2; k <= 5; ++k) {
+        ComputerVision::RealTimeGaussianMixture gmm(k);
+        std::vector<unsigned char> foreground(width * height);
+
+        const std::chrono::high_resolution_clock::time_point startTime
+            = std::chrono::high_resolution_clock::now();
+
+        for (unsigned int n = 0; n < nbFrames; ++n) {
+            gmm.process(&(frames[n % frames.size()].data()[0]),
+                        width, height, &foreground[0]);
+        }
+
+        const std::chrono::high_resolution_clock::time_point curTime
+            = std::chrono::high_resolution_clock::now();
+        const double timeElapsed
+            = std::chrono::duration_cast
+              <std::chrono::duration<double> >(curTime - startTime).count();
+        const double fps = nbFrames / timeElapsed;
+
+        data << k << " " << fps << "\n";
+
+        std::cout << "K = " << k << ": " << fps << " fps ("
+            << (1000.0 * timeElapsed / nbFrames) << " ms / frame)"
+            << std::endl;
+    }
+
+    data.close();
+
+    Gnuplot gnuplot;
+    gnuplot.set("grid");
+    gnuplot.setXlabel("Number of gaussians per pixel");
+    gnuplot.setYlabel("Throughput @ 1080p (fps)");
+    gnuplot.saveToFile(fileName);
+    gnuplot.plot(fileName, "using 1:2 with linespoints notitle");
+}
+
+RUN_TESTS()
@@ -73,4 +73,104 @@ TEST_DATASET(CIFAR100_Database,
     ASSERT_EQUALS(db.getNbLabels(), 100U);
 }
 
+TEST_DATASET(CIFAR_Database,
+             loadCIFAR,
+             (bool coarseAndFine, bool useCoarse),
+             std::make_tuple(false, false),
+             std::make_tuple(true, false),
+             std::make_tuple(true, true))
+{
+    const unsigned int nbImages = 5;
+    const unsigned int nbPixels = 32 * 32;
+
+    {
+        std::ofstream labels("CIFAR_Database_loadCIFAR_labels.txt");
+        labels << "airplane\nautomobile\nbird\ncat\n";
+
+        // Records are: [coarse label], label, red, green and blue planes
+        std::ofstream images("CIFAR_Database_loadCIFAR_images.bin",
+                             std::fstream::binary);
+
+        for (unsigned int i = 0; i < nbImages; ++i) {
+            if (coarseAndFine)
+                images.put((char)(i % 2));
+
+            images.put((char)(3 - (i % 4)));
+
+            for (unsigned int ch = 0; ch < 3; ++ch) {
+                for (unsigned int p = 0; p < nbPixels; ++p)
+                    images.put((char)(unsigned char)(i + 10 * ch + p));
+            }
+        }
+    }
+
+    CIFAR10_Database db;
+    db.loadCIFAR("CIFAR_Database_loadCIFAR_images.bin",
+                 "CIFAR_Database_loadCIFAR_labels.txt",
+                 coarseAndFine,
+                 useCoarse);
+
+    ASSERT_EQUALS(db.getNbStimuli(), nbImages);
+    ASSERT_EQUALS(db.getNbStimuli(Database::Unpartitioned), nbImages);
+
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        const unsigned int label = (coarseAndFine && useCoarse)
+            ? (i % 2) : (3 - (i % 4));
+        const std::string labelName[4]
+            = {"airplane", "automobile", "bird", "cat"};
+
+        ASSERT_EQUALS(db.getLabelName(db.getStimulusLabel(i)),
+                      labelName[label]);
+
+        // No image file is generated
+        ASSERT_TRUE(!std::ifstream(db.getStimulusName(i).c_str()).good());
+
+        const cv::Mat data = db.getStimulusData(i);
+
+        ASSERT_EQUALS(data.type(), CV_8UC3);
+        ASSERT_EQUALS(data.rows, 32);
+        ASSERT_EQUALS(data.cols, 32);
+
+        for (unsigned int p = 0; p < nbPixels; ++p) {
+            const cv::Vec3b bgr = data.at<cv::Vec3b>(p / 32, p % 32);
+
+            ASSERT_EQUALS((int)bgr[2], (int)(unsigned char)(i + p));
+            ASSERT_EQUALS((int)bgr[1], (int)(unsigned char)(i + 10 + p));
+            ASSERT_EQUALS((int)bgr[0], (int)(unsigned char)(i + 20 + p));
+        }
+    }
+
+    // Stats are computed from the in-memory data, without stimulus files
+    db.partitionStimuli(1.0, 0.0, 0.0);
+    db.logStats("CIFAR_Database_loadCIFAR_size.dat",
+                "CIFAR_Database_loadCIFAR_label.dat");
+
+    std::ifstream sizeData("CIFAR_Database_loadCIFAR_size.dat");
+    ASSERT_TRUE(sizeData.good());
+
+    std::string line;
+    std::getline(sizeData, line);   // Date & time
+    std::getline(sizeData, line);
+    ASSERT_EQUALS(line, "32 32 5");
+
+    // Invalid label
+    {
+        std::ofstream images("CIFAR_Database_loadCIFAR_images.bin",
+                             std::fstream::binary | std::fstream::app);
+
+        if (coarseAndFine)
+            images.put(4);
+
+        images.put(4);
+        images << std::string(3 * nbPixels, '\0');
+    }
+
+    CIFAR10_Database dbWrong;
+    ASSERT_THROW(dbWrong.loadCIFAR("CIFAR_Database_loadCIFAR_images.bin",
+                                   "CIFAR_Database_loadCIFAR_labels.txt",
+                                   coarseAndFine,
+                                   useCoarse),
+                 std::runtime_error);
+}
+
 RUN_TESTS()
@@ -23,8 +23,60 @@
 #include "Database/DIR_Database.hpp"
 #include "utils/UnitTest.hpp"
 
+#include <chrono>
+#include <thread>
+
+#include <sys/stat.h>
+#include <utime.h>
+
 using namespace N2D2;
 
+void createFile(const std::string& fileName)
+{
+    std::ofstream file(fileName.c_str());
+    file << "\n";
+}
+
+/**
+ * Remove a file without changing the modification time of its directory,
+ * so that a manifest listing the file is still considered valid.
+ */
+bool removeFileKeepDirTime(const std::string& fileName)
+{
+    const std::string dirName = Utils::dirName(fileName);
+    struct stat dirStat;
+
+    if (stat(dirName.c_str(), &dirStat) != 0
+        || std::remove(fileName.c_str()) != 0)
+    {
+        return false;
+    }
+
+    struct utimbuf times;
+    times.actime = dirStat.st_atime;
+    times.modtime = dirStat.st_mtime;
+    return (utime(dirName.c_str(), &times) == 0);
+}
+
+unsigned int countManifests(const std::string& dirPath)
+{
+    DIR* pDir = opendir(dirPath.c_str());
+    unsigned int nbManifests = 0;
+
+    if (pDir != NULL) {
+        struct dirent* pFile;
+
+        while ((pFile = readdir(pDir))) {
+            if (Utils::fileExtension(pFile->d_name) == "manifest")
+                ++nbManifests;
+        }
+
+        closedir(pDir);
+    }
+
+    return nbManifests;
+}
+
 TEST(DIR_Database, load)
 {
     REQUIRED(UnitTest::DirExists(N2D2_DATA("lfw")));
@@ -58,4 +110,77 @@ TEST(DIR_Database, load)
     ASSERT_EQUALS(db.getStimulusLabel(nbStimuli - 1), db.getLabelID("/Zydrunas_Ilgauskas"));
 }
 
+TEST(DIR_Database, loadDir__manifest)
+{
+    const std::string dirPath = "DIR_Database/manifest_tree";
+    const std::string manifestPath = "DIR_Database/manifest";
+
+    Utils::createDirectories(dirPath + "/b/c");
+    Utils::createDirectories(dirPath + "/a");
+    Utils::createDirectories(manifestPath);
+    std::remove((dirPath + "/b/c/new.png").c_str());
+
+    createFile(dirPath + "/root.png");
+    createFile(dirPath + "/a/a1.png");
+    createFile(dirPath + "/a/a0.png");
+    createFile(dirPath + "/a/ignored.xyz");
+    createFile(dirPath + "/b/b0.png");
+    createFile(dirPath + "/b/c/c0.png");
+
+    // Directories modified less than 1 s before indexing are not stored
+    // in the manifest
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+    DIR_Database dbRef;
+    dbRef.loadDir(dirPath, -1, "", 1);
+
+    ASSERT_EQUALS(dbRef.getNbStimuli(), 5U);
+    ASSERT_EQUALS(dbRef.getStimulusName(0), dirPath + "/root.png");
+    ASSERT_EQUALS(dbRef.getStimulusName(1), dirPath + "/a/a0.png");
+    ASSERT_EQUALS(dbRef.getStimulusName(2), dirPath + "/a/a1.png");
+    ASSERT_EQUALS(dbRef.getStimulusName(3), dirPath + "/b/b0.png");
+    ASSERT_EQUALS(dbRef.getStimulusName(4), dirPath + "/b/c/c0.png");
+    ASSERT_EQUALS(dbRef.getLabelName(dbRef.getStimulusLabel(1)), "/a");
+    ASSERT_EQUALS(dbRef.getLabelName(dbRef.getStimulusLabel(4)), "/b");
+
+    for (unsigned int pass = 0; pass < 2; ++pass) {
+        DIR_Database db;
+        db.setParameter("ManifestPath", manifestPath);
+        db.loadDir(dirPath, -1, "", 1);
+
+        // The first pass writes the manifest, the second one uses it
+        ASSERT_EQUALS(countManifests(manifestPath), 1U);
+        ASSERT_EQUALS(db.getNbStimuli(), dbRef.getNbStimuli());
+        ASSERT_EQUALS(db.getNbLabels(), dbRef.getNbLabels());
+
+        for (unsigned int id = 0; id < db.getNbStimuli(); ++id) {
+            ASSERT_EQUALS(db.getStimulusName(id), dbRef.getStimulusName(id));
+            ASSERT_EQUALS(db.getStimulusLabel(id),
+                          dbRef.getStimulusLabel(id));
+        }
+
+        if (pass == 0) {
+            // Once removed behind the manifest's back, the file is only
+            // listed in the second pass if the manifest is used instead of
+            // scanning the directories
+            ASSERT_TRUE(removeFileKeepDirTime(dirPath + "/a/a1.png"));
+            ASSERT_TRUE(!std::ifstream((dirPath + "/a/a1.png").c_str()).good());
+        }
+    }
+
+    createFile(dirPath + "/a/a1.png");
+
+    // Adding a file invalidates the manifest
+    createFile(dirPath + "/b/c/new.png");
+
+    DIR_Database db;
+    db.setParameter("ManifestPath", manifestPath);
+    db.loadDir(dirPath, -1, "", 1);
+
+    ASSERT_EQUALS(db.getNbStimuli(), dbRef.getNbStimuli() + 1);
+    ASSERT_EQUALS(db.getStimulusName(5), dirPath + "/b/c/new.png");
+
+    std::remove((dirPath + "/b/c/new.png").c_str());
+}
+
 RUN_TESTS()
@@ -21,6 +21,8 @@
 #include "N2D2.hpp"
 
 #include "Database/Database.hpp"
+#include "ROI/EllipticROI.hpp"
+#include "ROI/RectangularROI.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
 
@@ -66,6 +68,15 @@ public:
         }
     }
 
+    using Database::poolROIs;
+    using Database::deferStimulusROIs;
+    using Database::getStimulusROIsRef;
+
+    const ROIPool& getROIPool() const
+    {
+        return mROIPool;
+    }
+
     void dumpLabels(const std::string& fileName) const
     {
         std::ofstream data(fileName.c_str());
@@ -90,6 +101,28 @@ private:
     unsigned int mNbLabels;
 };
 
+namespace {
+Database::NamedROIs_T loadNamedROIs(unsigned int* nbCalls,
+                                    const std::vector<std::string>& names)
+{
+    ++(*nbCalls);
+
+    Database::NamedROIs_T ROIs;
+
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        ROIs.push_back(std::make_pair(names[i],
+            new RectangularROI<int>(-1, cv::Point(i, i), 2, 2)));
+    }
+
+    return ROIs;
+}
+
+Database::NamedROIs_T loadInvalidROIs()
+{
+    throw std::runtime_error("unreadable annotations");
+}
+}
+
 TEST(Database, load)
 {
     Database_Test db(10, 2);
@@ -427,5 +460,376 @@ TEST_DATASET(Database,
     ASSERT_EQUALS(db.getNbLabels(), nbLabels - 1);
 }
 
+TEST_DATASET(Database,
+             getStimuliWithLabel,
+             (unsigned int nbStimuli, unsigned int nbLabels),
+             std::make_tuple(10, 1),
+             std::make_tuple(10, 3),
+             std::make_tuple(100, 5))
+{
+    Random::mtSeed(0);
+
+    Database_Test db(nbStimuli, nbLabels);
+    db.load("");
+    db.partitionStimuli(0.6, 0.2, 0.2);
+
+    const std::vector<Database::StimuliSet> stimuliSets
+        = db.getStimuliSets(Database::All);
+
+    for (std::vector<Database::StimuliSet>::const_iterator itSet
+         = stimuliSets.begin(), itSetEnd = stimuliSets.end();
+         itSet != itSetEnd;
+         ++itSet)
+    {
+        unsigned int nbIndexed = 0;
+
+        for (int label = 0; label < (int)nbLabels; ++label) {
+            const std::vector<Database::StimulusID>& stimuli
+                = db.getStimuliWithLabel(label, *itSet);
+
+            for (unsigned int i = 0; i < stimuli.size(); ++i) {
+                ASSERT_EQUALS(db.getStimulusLabel(stimuli[i]), label);
+                ASSERT_EQUALS(db.getStimulusSet(stimuli[i]), *itSet);
+            }
+
+            ASSERT_EQUALS(stimuli.size(),
+                db.getNbStimuliWithLabel(label,
+                                         db.getStimuliSetMask(*itSet)));
+            nbIndexed += stimuli.size();
+        }
+
+        ASSERT_EQUALS(nbIndexed, db.getNbStimuli(*itSet));
+    }
+
+    // The index follows the database modifications
+    db.removeStimuli(std::vector<Database::StimulusID>(1, 0));
+    ASSERT_EQUALS(db.getNbStimuliWithLabel(0),
+                  nbStimuli / nbLabels + (0 < nbStimuli % nbLabels) - 1);
+
+    db.addStimulus("new_stimulus", 0, Database::Test);
+    const std::vector<Database::StimulusID>& stimuli
+        = db.getStimuliWithLabel(0, Database::Test);
+
+    ASSERT_EQUALS(stimuli.back(), db.getNbStimuli() - 1);
+}
+
+TEST(Database, getStimuliWithLabel__ROIs)
+{
+    Database_Test db(10, 3);
+    db.load("");
+    db.partitionStimuli(1.0, 0.0, 0.0);
+
+    ASSERT_EQUALS(db.getNbROIsWithLabel(2), 0U);
+
+    // Stimulus #0 has label 0, add two ROIs with label 2 and one with label 1
+    std::vector<ROI*> ROIs;
+    ROIs.push_back(new RectangularROI<int>(2, cv::Point(0, 0), 1, 1));
+    ROIs.push_back(new RectangularROI<int>(1, cv::Point(0, 0), 1, 1));
+    ROIs.push_back(new RectangularROI<int>(2, cv::Point(1, 1), 1, 1));
+    db.setStimulusROIs(0, ROIs);
+
+    ASSERT_EQUALS(db.getNbROIsWithLabel(2), 2U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(1), 1U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(0), 0U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(2, Database::TestOnly), 0U);
+    ASSERT_EQUALS(db.getNbStimuliWithLabel(2), 3U);
+
+    // Stimuli with label 2: #2, #5, #8 and #0 through its ROIs, once
+    const std::vector<Database::StimulusID>& stimuli
+        = db.getStimuliWithLabel(2, Database::Learn);
+
+    ASSERT_EQUALS(stimuli.size(), 4U);
+    ASSERT_EQUALS(std::count(stimuli.begin(), stimuli.end(), 0U), 1);
+    ASSERT_EQUALS(db.getStimuliWithLabel(0, Database::Learn).size(), 4U);
+
+    db.filterROIs(std::vector<int>(1, 1), true, false);
+
+    ASSERT_EQUALS(db.getNbROIsWithLabel(2), 0U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(1), 1U);
+    ASSERT_EQUALS(db.getStimuliWithLabel(2, Database::Learn).size(), 3U);
+    ASSERT_THROW(db.getStimuliWithLabel(3, Database::Learn),
+                 std::domain_error);
+}
+
+TEST(Database, poolROIs)
+{
+    Database_Test db(10, 3);
+    db.load("");
+    db.partitionStimuli(1.0, 0.0, 0.0);
+    db.setParameter("CompositeLabel", Database::Default);
+    db.setParameter("ROIsCacheSize", 1U);
+
+    std::vector<cv::Point> points;
+    points.push_back(cv::Point(1, 2));
+    points.push_back(cv::Point(5, 2));
+    points.push_back(cv::Point(3, 7));
+
+    std::vector<ROI*> ROIs;
+    ROIs.push_back(new RectangularROI<int>(2, cv::Point(1, 1), 4, 3));
+    ROIs.push_back(new PolygonalROI<int>(1, points));
+    ROIs.push_back(new EllipticROI<int>(-1, cv::Point(8, 9), 4.5, 2.5, 0.3));
+    db.setStimulusROIs(0, ROIs);
+
+    std::vector<ROI*> otherROIs;
+    otherROIs.push_back(new RectangularROI<int>(0, cv::Point(2, 3), 5, 5));
+    db.setStimulusROIs(1, otherROIs);
+
+    // The pooled ROI objects are deleted
+    const std::vector<cv::Point> rectPoints
+        = static_cast<RectangularROI<int>*>(ROIs[0])->points;
+
+    db.poolROIs();
+
+    ASSERT_EQUALS(db.getNbROIs(), 4U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(2), 1U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(-1), 1U);
+    ASSERT_EQUALS(db.getStimuliWithLabel(1, Database::Learn).size(), 4U);
+
+    // Alternate accesses to go through the cache eviction
+    for (unsigned int n = 0; n < 2; ++n) {
+        const std::vector<std::shared_ptr<ROI> > stimulusROIs
+            = db.getStimulusROIs(0);
+
+        ASSERT_EQUALS(stimulusROIs.size(), 3U);
+        ASSERT_EQUALS(stimulusROIs[0]->getLabel(), 2);
+        ASSERT_EQUALS(stimulusROIs[1]->getLabel(), 1);
+        ASSERT_EQUALS(stimulusROIs[2]->getLabel(), -1);
+
+        const std::shared_ptr<RectangularROI<int> > rect
+            = std::dynamic_pointer_cast<RectangularROI<int> >(
+                stimulusROIs[0]);
+        const std::shared_ptr<PolygonalROI<int> > polygon
+            = std::dynamic_pointer_cast<PolygonalROI<int> >(
+                stimulusROIs[1]);
+        const std::shared_ptr<EllipticROI<int> > ellipse
+            = std::dynamic_pointer_cast<EllipticROI<int> >(
+                stimulusROIs[2]);
+
+        ASSERT_TRUE(rect != NULL);
+        ASSERT_TRUE(rect->points == rectPoints);
+        ASSERT_TRUE(polygon != NULL);
+        ASSERT_TRUE(polygon->points == points);
+        ASSERT_TRUE(ellipse != NULL);
+        ASSERT_EQUALS(ellipse->center.x, 8);
+        ASSERT_EQUALS(ellipse->center.y, 9);
+        ASSERT_EQUALS(ellipse->majorRadius, 4.5);
+        ASSERT_EQUALS(ellipse->minorRadius, 2.5);
+        ASSERT_EQUALS(ellipse->angle, 0.3);
+
+        ASSERT_EQUALS(db.getStimulusROIs(1).size(), 1U);
+    }
+
+    // Modifying the ROIs moves them back to the stimuli
+    db.filterROIs(std::vector<int>(1, 1), false, false);
+
+    ASSERT_EQUALS(db.getNbROIs(), 3U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(1), 0U);
+    ASSERT_EQUALS(db.getStimulusROIs(0)[1]->getLabel(), -1);
+}
+
+TEST(Database, deferStimulusROIs)
+{
+    Database_Test db(10, 3);
+    db.load("");
+    db.partitionStimuli(1.0, 0.0, 0.0);
+    db.setParameter("CompositeLabel", Database::Default);
+
+    std::vector<unsigned int> nbCalls(10, 0);
+    std::vector<std::vector<std::string> > names(10);
+    names[2].push_back("new_b");
+    names[2].push_back("label_1");
+    names[6].push_back("new_a");
+    names[8].push_back("label_0");
+    names[8].push_back("");
+
+    for (unsigned int id = 2; id < 10; id += 2) {
+        db.deferStimulusROIs(id, names[id],
+                             std::bind(loadNamedROIs, &nbCalls[id],
+                                       names[id]));
+    }
+
+    ASSERT_EQUALS(std::count(nbCalls.begin(), nbCalls.end(), 0U), 10);
+
+    // The labels are created when deferring, in stimuli order, and the
+    // labels accessors do not parse the ROIs
+    ASSERT_EQUALS(db.getNbLabels(), 5U);
+    ASSERT_EQUALS(db.getLabelID("new_b"), 3);
+    ASSERT_EQUALS(db.getLabelID("new_a"), 4);
+    ASSERT_EQUALS(db.getLabelName(4), "new_a");
+    ASSERT_EQUALS(db.getLabels().size(), 5U);
+    ASSERT_EQUALS(db.getDefaultLabelID(), -1);
+    ASSERT_EQUALS(std::count(nbCalls.begin(), nbCalls.end(), 0U), 10);
+
+    // Only the accessed stimulus is parsed, whatever its labels
+    std::vector<std::shared_ptr<ROI> > ROIs = db.getStimulusROIs(8);
+
+    ASSERT_EQUALS(ROIs.size(), 2U);
+    ASSERT_EQUALS(ROIs[0]->getLabel(), 0);
+    ASSERT_EQUALS(ROIs[1]->getLabel(), -1);
+    ASSERT_EQUALS(nbCalls[8], 1U);
+    ASSERT_EQUALS(std::count(nbCalls.begin(), nbCalls.end(), 0U), 9);
+
+    ROIs = db.getStimulusROIs(6);
+
+    ASSERT_EQUALS(ROIs.size(), 1U);
+    ASSERT_EQUALS(ROIs[0]->getLabel(), 4);
+    ASSERT_EQUALS(nbCalls[2], 0U);
+    ASSERT_EQUALS(nbCalls[6], 1U);
+    ASSERT_EQUALS(std::count(nbCalls.begin(), nbCalls.end(), 0U), 8);
+
+    ROIs = db.getStimulusROIs(2);
+
+    ASSERT_EQUALS(ROIs.size(), 2U);
+    ASSERT_EQUALS(ROIs[0]->getLabel(), 3);
+    ASSERT_EQUALS(ROIs[1]->getLabel(), 1);
+    ASSERT_EQUALS(nbCalls[2], 1U);
+    ASSERT_EQUALS(nbCalls[4], 0U);
+    ASSERT_EQUALS(db.getNbROIs(), 5U);
+    ASSERT_EQUALS(nbCalls[4], 1U);
+
+    names[1].push_back("new_c");
+    db.deferStimulusROIs(1, names[1],
+                         std::bind(loadNamedROIs, &nbCalls[1], names[1]));
+
+    ASSERT_EQUALS(db.getNbLabels(), 6U);
+    ASSERT_EQUALS(db.getLabelName(5), "new_c");
+    ASSERT_EQUALS(nbCalls[1], 0U);
+    ASSERT_EQUALS(db.getNbROIsWithLabel(5), 1U);
+    ASSERT_EQUALS(nbCalls[1], 1U);
+    ASSERT_EQUALS(db.getStimuliWithLabel(3, Database::Learn).size(), 1U);
+
+    // Stimuli with ROIs are parsed right away
+    db.deferStimulusROIs(8, names[6],
+                         std::bind(loadNamedROIs, &nbCalls[8], names[6]));
+
+    ASSERT_EQUALS(nbCalls[8], 2U);
+    ASSERT_EQUALS(db.getStimulusROIs(8).size(), 3U);
+    ASSERT_EQUALS(db.getStimulusROIs(8)[2]->getLabel(), 4);
+
+    // Deferred ROIs never parsed are not parsed when their stimulus is
+    // removed
+    db.deferStimulusROIs(3, names[2],
+                         std::bind(loadNamedROIs, &nbCalls[3], names[2]));
+    db.removeStimulus(3);
+
+    ASSERT_EQUALS(db.getNbLabels(), 6U);
+    ASSERT_EQUALS(nbCalls[3], 0U);
+
+    // Parsing errors, including labels not given when deferring, are
+    // reported on access, until the stimulus is removed
+    db.deferStimulusROIs(4, std::vector<std::string>(), loadInvalidROIs);
+
+    ASSERT_THROW(db.getStimulusROIs(4), std::runtime_error);
+    ASSERT_EQUALS(db.getNbLabels(), 6U);
+
+    names[7].push_back("undeclared");
+    db.deferStimulusROIs(6, std::vector<std::string>(),
+                         std::bind(loadNamedROIs, &nbCalls[7], names[7]));
+
+    ASSERT_THROW(db.getStimulusROIs(6), std::runtime_error);
+    ASSERT_EQUALS(nbCalls[7], 1U);
+
+    db.removeStimuli(std::vector<Database::StimulusID>(1, 4));
+    db.removeStimulus(5);
+
+    ASSERT_EQUALS(db.getNbLabels(), 6U);
+    ASSERT_EQUALS(db.getNbROIs(), 7U);
+}
+
+TEST(Database, poolROIs__cacheSize)
+{
+    Database_Test db(10, 3);
+    db.load("");
+
+    for (unsigned int id = 0; id < 10; ++id) {
+        db.setStimulusROIs(id, std::vector<ROI*>(1,
+            new RectangularROI<int>(id % 3, cv::Point(id, id), 2, 2)));
+    }
+
+    db.poolROIs();
+
+    ASSERT_EQUALS(db.getROIPool().getCacheSize(), 1024U);
+
+    const ROIPool::ROIs_T ROIs0 = db.getStimulusROIsRef(0);
+
+    ASSERT_TRUE(db.getStimulusROIsRef(0) == ROIs0);
+
+    // The parameter is applied on the next access, after pooling
+    db.setParameter("ROIsCacheSize", 0U);
+
+    ASSERT_TRUE(db.getStimulusROIsRef(0) != ROIs0);
+    ASSERT_EQUALS(db.getROIPool().getCacheSize(), 0U);
+
+    db.setParameter("ROIsCacheSize", 2U);
+
+    const ROIPool::ROIs_T ROIs1 = db.getStimulusROIsRef(1);
+
+    ASSERT_EQUALS(db.getROIPool().getCacheSize(), 2U);
+    ASSERT_TRUE(db.getStimulusROIsRef(1) == ROIs1);
+
+    db.getStimulusROIsRef(2);
+    db.getStimulusROIsRef(3);
+
+    ASSERT_TRUE(db.getStimulusROIsRef(1) != ROIs1);
+    ASSERT_EQUALS(ROIs1->size(), 1U);
+    ASSERT_EQUALS((*ROIs1)[0]->getLabel(), 1);
+}
+
+TEST(Database, removeStimuli__ROIs)
+{
+    Database_Test db(10, 3);
+    db.load("");
+    db.setParameter("CompositeLabel", Database::Default);
+
+    for (unsigned int id = 0; id < 10; ++id) {
+        db.setStimulusROIs(id, std::vector<ROI*>(1,
+            new RectangularROI<int>(id % 3, cv::Point(id, id), 2, 2)));
+    }
+
+    db.poolROIs();
+
+    ASSERT_EQUALS(db.getROIPool().getNbRecords(), 10U);
+
+    db.removeStimulus(0);
+
+    std::vector<Database::StimulusID> ids;
+    ids.push_back(2);
+    ids.push_back(4);
+    ids.push_back(6);
+
+    db.removeStimuli(ids);
+
+    // The pool entries of stimuli #0, #3, #5 and #7 are erased, which is not
+    // enough to reclaim the storage
+    ASSERT_EQUALS(db.getNbStimuli(), 6U);
+    ASSERT_EQUALS(db.getNbROIs(), 6U);
+    ASSERT_EQUALS(db.getROIPool().getNbRecords(), 10U);
+
+    db.removeStimulus(0);
+
+    ASSERT_EQUALS(db.getROIPool().getNbRecords(), 5U);
+
+    // Replaced ROIs are erased as well
+    db.setStimulusROIs(0, std::vector<ROI*>());
+
+    ASSERT_EQUALS(db.getROIPool().getNbRecords(), 5U);
+    ASSERT_EQUALS(db.getNbROIs(), 4U);
+
+    const unsigned int remaining[] = {4, 6, 8, 9};
+
+    for (unsigned int id = 1; id < 5; ++id) {
+        const std::vector<std::shared_ptr<ROI> > ROIs
+            = db.getStimulusROIs(id);
+
+        ASSERT_EQUALS(ROIs.size(), 1U);
+        ASSERT_EQUALS(ROIs[0]->getLabel(), (int)remaining[id - 1] % 3);
+
+        const std::shared_ptr<RectangularROI<int> > rect
+            = std::dynamic_pointer_cast<RectangularROI<int> >(ROIs[0]);
+
+        ASSERT_TRUE(rect != NULL);
+        ASSERT_EQUALS(rect->points[0].x, (int)remaining[id - 1]);
+    }
+}
 
 RUN_TESTS()
@@ -89,4 +89,82 @@ TEST(MNIST_IDX_Database, getStimulusLabelsData)
     ASSERT_EQUALS(labels.at<int>(0, 0), 1);    // first stimulus is a 1
 }
 
+void writeIDX_BigEndian(std::ofstream& data, unsigned int value)
+{
+    const unsigned char bytes[4] = {(unsigned char)(value >> 24),
+                                    (unsigned char)(value >> 16),
+                                    (unsigned char)(value >> 8),
+                                    (unsigned char)value};
+    data.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+TEST(IDX_Database, load)
+{
+    const unsigned int nbImages = 5;
+    const unsigned int nbRows = 3;
+    const unsigned int nbColumns = 4;
+
+    {
+        std::ofstream images("IDX_Database_load_images.idx",
+                             std::fstream::binary);
+        writeIDX_BigEndian(images, 0x00000803);
+        writeIDX_BigEndian(images, nbImages);
+        writeIDX_BigEndian(images, nbRows);
+        writeIDX_BigEndian(images, nbColumns);
+
+        for (unsigned int i = 0; i < nbImages * nbRows * nbColumns; ++i)
+            images.put((char)(unsigned char)(i * 7));
+
+        std::ofstream labels("IDX_Database_load_labels.idx",
+                             std::fstream::binary);
+        writeIDX_BigEndian(labels, 0x00000801);
+        writeIDX_BigEndian(labels, nbImages);
+
+        for (unsigned int i = 0; i < nbImages; ++i)
+            labels.put((char)(unsigned char)(3 - (i % 2)));
+    }
+
+    IDX_Database db;
+    db.load("IDX_Database_load_images.idx", "IDX_Database_load_labels.idx");
+
+    ASSERT_EQUALS(db.getNbStimuli(), nbImages);
+    ASSERT_EQUALS(db.getNbStimuli(Database::Unpartitioned), nbImages);
+    ASSERT_EQUALS(db.getNbLabels(), 2U);
+    ASSERT_EQUALS(db.getLabelName(0), "3");
+    ASSERT_EQUALS(db.getLabelName(1), "2");
+
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        ASSERT_EQUALS(db.getStimulusLabel(i), (int)(i % 2));
+
+        // No image file is generated anymore
+        ASSERT_TRUE(!std::ifstream(db.getStimulusName(i).c_str()).good());
+
+        const cv::Mat data = db.getStimulusData(i);
+
+        ASSERT_EQUALS(data.type(), CV_8UC1);
+        ASSERT_EQUALS(data.rows, (int)nbRows);
+        ASSERT_EQUALS(data.cols, (int)nbColumns);
+
+        for (unsigned int y = 0; y < nbRows; ++y) {
+            for (unsigned int x = 0; x < nbColumns; ++x) {
+                ASSERT_EQUALS((int)data.at<unsigned char>(y, x),
+                    (int)(unsigned char)(((i * nbRows + y) * nbColumns + x)
+                                         * 7));
+            }
+        }
+    }
+
+    // Wrong size
+    {
+        std::ofstream labels("IDX_Database_load_labels.idx",
+                             std::fstream::binary | std::fstream::app);
+        labels.put(0);
+    }
+
+    IDX_Database dbWrong;
+    ASSERT_THROW(dbWrong.load("IDX_Database_load_images.idx",
+                              "IDX_Database_load_labels.idx"),
+                 std::runtime_error);
+}
+
 RUN_TESTS()
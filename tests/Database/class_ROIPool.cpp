@@ -0,0 +1,207 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Database/ROIPool.hpp"
+#include "ROI/EllipticROI.hpp"
+#include "ROI/RectangularROI.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+using namespace N2D2;
+
+namespace {
+std::vector<ROI*> makeROIs(int label, unsigned int nbROIs)
+{
+    std::vector<ROI*> ROIs;
+
+    for (unsigned int i = 0; i < nbROIs; ++i) {
+        if (i % 2 == 0) {
+            ROIs.push_back(new RectangularROI<int>(label,
+                cv::Point(label, i), 2, 3));
+        }
+        else {
+            ROIs.push_back(new EllipticROI<int>(label,
+                cv::Point(i, label), 4.5, 2.5, 0.3));
+        }
+    }
+
+    return ROIs;
+}
+
+bool isMadeROIs(const std::vector<ROI*>& ROIs, int label,
+                unsigned int nbROIs)
+{
+    if (ROIs.size() != nbROIs)
+        return false;
+
+    for (unsigned int i = 0; i < nbROIs; ++i) {
+        if (ROIs[i]->getLabel() != label)
+            return false;
+
+        if (i % 2 == 0) {
+            const RectangularROI<int>* rect
+                = dynamic_cast<const RectangularROI<int>*>(ROIs[i]);
+
+            if (rect == NULL
+                || rect->points[0].x != label
+                || rect->points[0].y != (int)i
+                || rect->points[2].x != label + 1
+                || rect->points[2].y != (int)i + 2)
+            {
+                return false;
+            }
+        }
+        else {
+            const EllipticROI<int>* ellipse
+                = dynamic_cast<const EllipticROI<int>*>(ROIs[i]);
+
+            if (ellipse == NULL
+                || ellipse->center.x != (int)i
+                || ellipse->center.y != label
+                || ellipse->majorRadius != 4.5)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+}
+
+TEST(ROIPool, erase)
+{
+    ROIPool pool(4);
+
+    for (int entry = 0; entry < 4; ++entry) {
+        std::vector<ROI*> ROIs = makeROIs(entry, 2);
+        ASSERT_EQUALS(pool.push_back(ROIs), (unsigned int)entry);
+        std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+    }
+
+    ASSERT_EQUALS(pool.getNbRecords(), 8U);
+
+    // Cached objects stay valid after the entry removal
+    const ROIPool::ROIs_T ROIs1 = pool.get(1);
+
+    pool.erase(1);
+
+    ASSERT_EQUALS(pool.getNbEntries(), 4U);
+    ASSERT_EQUALS(pool.getSize(1), 0U);
+    ASSERT_EQUALS(pool.getNbRecords(), 8U);
+    ASSERT_TRUE(isMadeROIs(*ROIs1, 1, 2));
+
+    // Half of the records are erased: the storage is reclaimed
+    pool.erase(2);
+
+    ASSERT_EQUALS(pool.getNbRecords(), 4U);
+    ASSERT_EQUALS(pool.getSize(2), 0U);
+    ASSERT_TRUE(pool.get(2)->empty());
+
+    for (int entry = 0; entry < 4; entry += 3) {
+        ASSERT_EQUALS(pool.getSize(entry), 2U);
+        ASSERT_EQUALS(pool.getLabel(entry, 1), entry);
+        ASSERT_TRUE(isMadeROIs(*pool.get(entry), entry, 2));
+
+        std::vector<ROI*> ROIs = pool.create(entry);
+        ASSERT_TRUE(isMadeROIs(ROIs, entry, 2));
+        std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+    }
+
+    // New entries get new IDs
+    std::vector<ROI*> ROIs = makeROIs(4, 3);
+    ASSERT_EQUALS(pool.push_back(ROIs), 4U);
+    std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+
+    ASSERT_EQUALS(pool.getNbRecords(), 7U);
+    ASSERT_TRUE(isMadeROIs(*pool.get(4), 4, 3));
+    ASSERT_TRUE(isMadeROIs(*pool.get(3), 3, 2));
+}
+
+TEST(ROIPool, assign)
+{
+    ROIPool pool(4);
+
+    std::vector<ROI*> ROIs = makeROIs(0, 3);
+    const unsigned int storedEntry = pool.push_back(ROIs);
+    const unsigned int entry = pool.push_back_deferred();
+
+    ASSERT_TRUE(!pool.isPending(storedEntry));
+    ASSERT_TRUE(pool.isPending(entry));
+    ASSERT_THROW(pool.getSize(entry), std::runtime_error);
+    ASSERT_THROW(pool.assign(storedEntry, ROIs), std::runtime_error);
+    std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+
+    ROIs = makeROIs(5, 4);
+    pool.assign(entry, ROIs);
+
+    ASSERT_TRUE(!pool.isPending(entry));
+    ASSERT_THROW(pool.assign(entry, ROIs), std::runtime_error);
+    std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+
+    // The shared arrays only hold the stored entry
+    ASSERT_EQUALS(pool.getNbRecords(), 3U);
+    ASSERT_EQUALS(pool.getSize(entry), 4U);
+    ASSERT_EQUALS(pool.getLabel(entry, 3), 5);
+    ASSERT_TRUE(isMadeROIs(*pool.get(entry), 5, 4));
+    ASSERT_TRUE(isMadeROIs(*pool.get(storedEntry), 0, 3));
+
+    pool.erase(entry);
+
+    ASSERT_EQUALS(pool.getSize(entry), 0U);
+    ASSERT_TRUE(isMadeROIs(*pool.get(storedEntry), 0, 3));
+}
+
+TEST(ROIPool, get__cacheSize)
+{
+    ROIPool pool(2);
+
+    for (int entry = 0; entry < 3; ++entry) {
+        std::vector<ROI*> ROIs = makeROIs(entry, 1);
+        pool.push_back(ROIs);
+        std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+    }
+
+    const ROIPool::ROIs_T ROIs0 = pool.get(0);
+
+    ASSERT_TRUE(pool.get(0) == ROIs0);
+
+    // Entry #0 is the least recently used and is evicted
+    pool.get(1);
+    pool.get(2);
+
+    ASSERT_TRUE(pool.get(0) != ROIs0);
+    ASSERT_TRUE(isMadeROIs(*ROIs0, 0, 1));
+
+    // The cache size given on access is applied
+    const ROIPool::ROIs_T ROIs1 = pool.get(1, 0);
+
+    ASSERT_EQUALS(pool.getCacheSize(), 0U);
+    ASSERT_TRUE(pool.get(1) != ROIs1);
+
+    const ROIPool::ROIs_T ROIs2 = pool.get(2, 3);
+
+    ASSERT_EQUALS(pool.getCacheSize(), 3U);
+    ASSERT_TRUE(pool.get(2) == ROIs2);
+}
+
+RUN_TESTS()
@@ -16,6 +16,7 @@
 #include "Xnet/Network.hpp"
 #include "RangeStats.hpp"
 #include "ScalingMode.hpp"
+#include "Cell/FcCell.hpp"
 #include "Database/MNIST_IDX_Database.hpp"
 #include "Export/DeepNetExport.hpp"
 #include "Export/CPP/CPP_DeepNetExport.hpp"
@@ -38,6 +39,41 @@ float readSuccessRateFile(const std::string& succesRateFile) {
     return success_rate;
 }
 
+/**
+ * Zero the weights of the second half of the input channels of every Fc cell,
+ * so that half of the weights blocks are empty in the block-sparse format.
+ */
+void pruneFcWeights(DeepNet& deepNet) {
+    std::map<std::string, std::shared_ptr<Cell> >& cells = deepNet.getCells();
+
+    for (std::map<std::string, std::shared_ptr<Cell> >::const_iterator
+         it = cells.begin(), itEnd = cells.end(); it != itEnd; ++it)
+    {
+        const std::shared_ptr<FcCell> fcCell
+            = std::dynamic_pointer_cast<FcCell>((*it).second);
+
+        if (!fcCell)
+            continue;
+
+        const std::size_t channelSize = fcCell->getChannelsWidth()
+                                        * fcCell->getChannelsHeight();
+        const Tensor<Float_T> zero({1}, 0.0);
+
+        for (std::size_t output = 0; output < fcCell->getNbOutputs();
+            ++output)
+        {
+            for (std::size_t channel = fcCell->getNbChannels() / 2;
+                channel < fcCell->getNbChannels(); ++channel)
+            {
+                for (std::size_t i = 0; i < channelSize; ++i) {
+                    fcCell->setWeight(output, channel * channelSize + i,
+                                      zero);
+                }
+            }
+        }
+    }
+}
+
 TEST(CPP_Export, generateMemory) {
     const std::string data = "DefaultModel=Frame\n"
                              "\n"
@@ -147,6 +183,105 @@ TEST(CPP_Export, generateMemory) {
     memManager.log("memory_mapping.log");
 }
 
+TEST(CPP_Export, generateMemory_optimizeExecutionOrder) {
+    // Two branches with large intermediate outputs: the layers order keeps
+    // both large outputs alive at the same time, whereas executing one
+    // branch after the other does not
+    const std::string data = "DefaultModel=Frame\n"
+                             "\n"
+                             "[env]\n"
+                             "SizeX=32\n"
+                             "SizeY=32\n"
+                             "\n"
+                             "[conv1.1]\n"
+                             "Input=env\n"
+                             "Type=Conv\n"
+                             "KernelDims=1 1\n"
+                             "NbOutputs=64\n"
+                             "\n"
+                             "[conv1.2]\n"
+                             "Input=env\n"
+                             "Type=Conv\n"
+                             "KernelDims=1 1\n"
+                             "NbOutputs=64\n"
+                             "\n"
+                             "[conv2.1]\n"
+                             "Input=conv1.1\n"
+                             "Type=Conv\n"
+                             "KernelDims=1 1\n"
+                             "NbOutputs=1\n"
+                             "\n"
+                             "[conv2.2]\n"
+                             "Input=conv1.2\n"
+                             "Type=Conv\n"
+                             "KernelDims=1 1\n"
+                             "NbOutputs=1\n"
+                             "\n"
+                             "[sum]\n"
+                             "Input=conv2.1,conv2.2\n"
+                             "Type=ElemWise\n"
+                             "NbOutputs=1\n"
+                             "Operation=Sum\n"
+                             "\n"
+                             "[sum.Target]\n";
+
+    UnitTest::FileWriteContent("net_test_order.ini", data);
+
+    Network net(SEED);
+    std::shared_ptr<DeepNet> deepNet
+        = DeepNetGenerator::generate(net, "net_test_order.ini");
+
+    deepNet->initialize();
+
+    CPP_DeepNetExport::addBranchesCells(*deepNet);
+
+    bool wrapAroundBuffer = false;
+    bool noBranchConcatOpt = false;
+    bool includeInputInBuffer = false;
+    int memoryAlignment = 1;
+    const MemoryManager::OptimizeStrategy strategy
+        = MemoryManager::OptimizeMaxLifetimeMaxSizeFirst;
+
+    MemoryManager memManager = CPP_DeepNetExport::generateMemory(*deepNet,
+        wrapAroundBuffer, noBranchConcatOpt, includeInputInBuffer,
+        memoryAlignment);
+    memManager.optimize(strategy);
+
+    ASSERT_EQUALS(memManager.getPeakUsage(), 32*32*(64 + 64 + 1 + 1));
+
+    ASSERT_TRUE(CPP_DeepNetExport::optimizeExecutionOrder(*deepNet,
+        wrapAroundBuffer, noBranchConcatOpt, includeInputInBuffer,
+        memoryAlignment, strategy, 64, "execution_order.log"));
+
+    // One cell per layer, each branch executed in one go
+    const std::vector<std::vector<std::string> >& layers
+        = deepNet->getLayers();
+
+    ASSERT_EQUALS(layers.size(), 6U);
+
+    for (unsigned int layer = 1; layer < layers.size(); ++layer)
+        ASSERT_EQUALS(layers[layer].size(), 1U);
+
+    ASSERT_EQUALS(layers[5][0], "sum");
+    ASSERT_TRUE((layers[1][0] == "conv1.1" && layers[2][0] == "conv2.1")
+        || (layers[1][0] == "conv1.2" && layers[2][0] == "conv2.2"));
+
+    MemoryManager memManagerOrdered = CPP_DeepNetExport::generateMemory(
+        *deepNet, wrapAroundBuffer, noBranchConcatOpt, includeInputInBuffer,
+        memoryAlignment);
+    memManagerOrdered.optimize(strategy);
+
+    ASSERT_EQUALS(memManagerOrdered.getPeakUsage(), 32*32*(64 + 1 + 1));
+
+    // The searched order cannot be improved anymore: the layers are kept
+    const std::vector<std::vector<std::string> > orderedLayers = layers;
+
+    ASSERT_TRUE(!CPP_DeepNetExport::optimizeExecutionOrder(*deepNet,
+        wrapAroundBuffer, noBranchConcatOpt, includeInputInBuffer,
+        memoryAlignment, strategy, 64));
+    ASSERT_TRUE(deepNet->getLayers() == orderedLayers);
+}
+
 TEST_DATASET(CPP_Export,
              generateMemory_noBranchConcatOpt,
              (unsigned int nbOutputs, int memoryAlignment),
@@ -438,6 +573,169 @@ TEST(CPP_Export_32f, generate) {
 #endif
 }
 
+TEST(CPP_Export_32f, generate_sparseFc) {
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    const std::string testDataDir = "tests_data/mnist_model/";
+    const std::string exportDirs[2] = {"export_CPP_float32_dense/",
+                                       "export_CPP_float32_sparse/"};
+    const std::string exportParams[2] = {"export_params_dense.ini",
+                                         "export_params_sparse.ini"};
+    const std::string exportType = "CPP";
+    const std::size_t nbTestStimuli = 200;
+
+    UnitTest::FileWriteContent(exportParams[0], "SparseWeightsBlockSize=0\n");
+    UnitTest::FileWriteContent(exportParams[1], "SparseWeightsThreshold=0.5\n"
+                                                "SparseWeightsBlockSize=4\n");
+
+
+    // Initialize
+    DeepNetExport::mEnvDataUnsigned = true;
+    CellExport::mPrecision = static_cast<CellExport::Precision>(-32);
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        Network net(SEED);
+        std::shared_ptr<DeepNet> deepNet = DeepNetGenerator::generate(net, testDataDir + "model_wo_softmax.ini");
+
+        deepNet->initialize();
+        deepNet->importNetworkFreeParameters(testDataDir + "weights");
+
+        pruneFcWeights(*deepNet);
+
+
+        // Export, dense then block-sparse Fc weights
+        DeepNetExport::setExportParameters(exportParams[i]);
+        DeepNetExport::generate(*deepNet, exportDirs[i], exportType);
+
+#ifndef WIN32
+        ASSERT_EQUALS(system(("rm -f " + exportDirs[i] + "stimuli/*pgm").c_str()), 0);
+        StimuliProviderExport::generate(*deepNet, *deepNet->getStimuliProvider(), 
+                                        exportDirs[i] + "stimuli", exportType, Database::Test, 
+                                        DeepNetExport::mEnvDataUnsigned, CellExport::mPrecision, 
+                                        nbTestStimuli);
+
+        ASSERT_EQUALS(system(("cd " + exportDirs[i] + " && CXXFLAGS=\"-DOUTPUTFILE\" make && "
+                              "./run_export > run_export.log").c_str()), 0);
+#endif
+    }
+
+    DeepNetExport::setExportParameters("");
+
+#ifndef WIN32
+    // Both Fc cells use the sparse kernel in the sparse export only
+    ASSERT_EQUALS(system(("test `grep -c fccellSparsePropagate " + exportDirs[0]
+                          + "src/NetworkPropagate.cpp` -eq 0").c_str()), 0);
+    ASSERT_EQUALS(system(("test `grep -c fccellSparsePropagate " + exportDirs[1]
+                          + "src/NetworkPropagate.cpp` -eq 2").c_str()), 0);
+
+    // Same predictions for every stimulus
+    ASSERT_EQUALS(system(("cmp " + exportDirs[0] + "run_export.log "
+                          + exportDirs[1] + "run_export.log").c_str()), 0);
+    ASSERT_EQUALS(readSuccessRateFile(exportDirs[1] + "/success_rate.txt"),
+                  readSuccessRateFile(exportDirs[0] + "/success_rate.txt"));
+#endif
+}
+
+TEST(CPP_Export_32f, generate_profiling) {
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    const std::string testDataDir = "tests_data/mnist_model/";
+    const std::string exportDir = "export_CPP_float32_profiling/";
+    const std::string exportType = "CPP";
+    const std::size_t nbTestStimuli = 10;
+
+
+    // Initialize
+    DeepNetExport::mEnvDataUnsigned = true;
+    CellExport::mPrecision = static_cast<CellExport::Precision>(-32);
+
+    Network net(SEED);
+    std::shared_ptr<DeepNet> deepNet = DeepNetGenerator::generate(net, testDataDir + "model_wo_softmax.ini");
+
+    deepNet->initialize();
+    deepNet->importNetworkFreeParameters(testDataDir + "weights");
+
+
+    // Export
+    DeepNetExport::generate(*deepNet, exportDir, exportType);
+
+#ifndef WIN32
+    ASSERT_EQUALS(system(("rm -f " + exportDir + "stimuli/*pgm "
+                          + exportDir + "profiling.bin").c_str()), 0);
+    StimuliProviderExport::generate(*deepNet, *deepNet->getStimuliProvider(), 
+                                    exportDir + "stimuli", exportType, Database::Test, 
+                                    DeepNetExport::mEnvDataUnsigned, CellExport::mPrecision, 
+                                    nbTestStimuli);
+
+    ASSERT_EQUALS(system(("cd " + exportDir + " && CXXFLAGS=\"-DOUTPUTFILE -DPROFILING\" make && "
+                          "./run_export").c_str()), 0);
+
+
+    // Check the trace: one sample per cell and per stimulus
+    std::ifstream trace((exportDir + "profiling.bin").c_str(),
+                        std::ios::binary);
+    ASSERT_TRUE(trace.good());
+
+    char header[8];
+    trace.read(header, 8);
+    ASSERT_EQUALS(std::string(header, 8), "N2D2PROF");
+
+    std::map<uint16_t, std::string> names;
+    std::map<std::string, std::size_t> nbSamples;
+    char record;
+
+    while (trace.get(record)) {
+        uint16_t id;
+        trace.read(reinterpret_cast<char*>(&id), sizeof(id));
+
+        if (record == 'C') {
+            uint16_t length;
+            trace.read(reinterpret_cast<char*>(&length), sizeof(length));
+
+            std::string name(length, '\0');
+            trace.read(&name[0], length);
+
+            ASSERT_TRUE(names.find(id) == names.end());
+            names[id] = name;
+        }
+        else {
+            ASSERT_EQUALS(record, 'S');
+            ASSERT_TRUE(names.find(id) != names.end());
+
+            uint64_t sample[3];
+            trace.read(reinterpret_cast<char*>(sample), sizeof(sample));
+            ASSERT_TRUE(trace.good());
+
+            const std::shared_ptr<Cell> cell = deepNet->getCell(names[id]);
+            Cell::Stats stats;
+            cell->getStats(stats);
+
+            ASSERT_EQUALS(sample[1], stats.nbConnections);
+            ASSERT_TRUE(sample[2] > 0);
+
+            ++nbSamples[names[id]];
+        }
+    }
+
+    const std::vector<std::vector<std::string> >& layers = deepNet->getLayers();
+    std::size_t nbCells = 0;
+
+    for (std::vector<std::vector<std::string> >::const_iterator itLayer
+         = layers.begin() + 1, itLayerEnd = layers.end();
+         itLayer != itLayerEnd; ++itLayer)
+    {
+        for (std::vector<std::string>::const_iterator it = (*itLayer).begin(),
+             itEnd = (*itLayer).end(); it != itEnd; ++it)
+        {
+            ASSERT_EQUALS(nbSamples[Utils::CIdentifier(*it)], nbTestStimuli);
+            ++nbCells;
+        }
+    }
+
+    ASSERT_EQUALS(names.size(), nbCells);
+#endif
+}
+
 TEST(CPP_Export_8i, generate) {
     REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
 
@@ -488,4 +786,78 @@ TEST(CPP_Export_8i, generate) {
 #endif
 }
 
+TEST(CPP_Export_8i, generate_sparseFc) {
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    const std::string testDataDir = "tests_data/mnist_model/";
+    const std::string exportDirs[2] = {"export_CPP_int8_dense/",
+                                       "export_CPP_int8_sparse/"};
+    const std::string exportParams[2] = {"export_params_dense.ini",
+                                         "export_params_sparse.ini"};
+    const std::string exportType = "CPP";
+    const std::size_t nbTestStimuli = 200;
+
+    UnitTest::FileWriteContent(exportParams[0], "SparseWeightsBlockSize=0\n");
+    UnitTest::FileWriteContent(exportParams[1], "SparseWeightsThreshold=0.5\n"
+                                                "SparseWeightsBlockSize=4\n");
+
+
+    // Initialize
+    DeepNetExport::mEnvDataUnsigned = true;
+    CellExport::mPrecision = static_cast<CellExport::Precision>(8);
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        Network net(SEED);
+        std::shared_ptr<DeepNet> deepNet = DeepNetGenerator::generate(net, testDataDir + "model_wo_softmax.ini");
+
+        deepNet->initialize();
+        deepNet->importNetworkFreeParameters(testDataDir + "weights");
+
+        pruneFcWeights(*deepNet);
+
+
+        // Quantize
+        std::unordered_map<std::string, Histogram> emptyOutputsHistogram;
+        std::unordered_map<std::string, RangeStats> outputsRange;
+        RangeStats::loadOutputsRange(testDataDir + "outputs_range.bin", outputsRange);
+
+
+        DeepNetQuantization dnQuantization(*deepNet);
+        dnQuantization.quantizeNetwork(emptyOutputsHistogram, outputsRange,
+                                       CellExport::mPrecision, ClippingMode::NONE, 
+                                       ScalingMode::SINGLE_SHIFT, false);
+
+        // Export, dense then block-sparse Fc weights
+        DeepNetExport::setExportParameters(exportParams[i]);
+        DeepNetExport::generate(*deepNet, exportDirs[i], exportType);
+
+#ifndef WIN32
+        ASSERT_EQUALS(system(("rm -f " + exportDirs[i] + "stimuli/*pgm").c_str()), 0);
+        StimuliProviderExport::generate(*deepNet, *deepNet->getStimuliProvider(), 
+                                        exportDirs[i] + "stimuli", exportType, Database::Test, 
+                                        DeepNetExport::mEnvDataUnsigned, CellExport::mPrecision, 
+                                        nbTestStimuli);
+
+        ASSERT_EQUALS(system(("cd " + exportDirs[i] + " && CXXFLAGS=\"-DOUTPUTFILE\" make && "
+                              "./run_export > run_export.log").c_str()), 0);
+#endif
+    }
+
+    DeepNetExport::setExportParameters("");
+
+#ifndef WIN32
+    // Both Fc cells use the sparse kernel in the sparse export only
+    ASSERT_EQUALS(system(("test `grep -c fccellSparsePropagate " + exportDirs[0]
+                          + "src/NetworkPropagate.cpp` -eq 0").c_str()), 0);
+    ASSERT_EQUALS(system(("test `grep -c fccellSparsePropagate " + exportDirs[1]
+                          + "src/NetworkPropagate.cpp` -eq 2").c_str()), 0);
+
+    // Same predictions for every stimulus
+    ASSERT_EQUALS(system(("cmp " + exportDirs[0] + "run_export.log "
+                          + exportDirs[1] + "run_export.log").c_str()), 0);
+    ASSERT_EQUALS(readSuccessRateFile(exportDirs[1] + "/success_rate.txt"),
+                  readSuccessRateFile(exportDirs[0] + "/success_rate.txt"));
+#endif
+}
+
 RUN_TESTS()
@@ -0,0 +1,231 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <fstream>
+
+#include "N2D2.hpp"
+
+#include "Database/AER_Database.hpp"
+#include "Xnet/AerStream.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+void writeAer_BigEndian(std::ofstream& data,
+                        unsigned long long int value,
+                        unsigned int nbBytes)
+{
+    for (int b = nbBytes - 1; b >= 0; --b)
+        data.put((char)(unsigned char)(value >> (8 * b)));
+}
+
+TEST(AerStream, load_AerDat2)
+{
+    // Raw 32 bits timestamps, wrapping around twice the int range
+    const unsigned int rawTimes[] = {100U, 0x7FFFFFF0U, 0x80000010U,
+                                     0xFFFFFFF0U, 5U, 256U};
+    const unsigned long long int wrap = (1ULL << 32);
+    const Time_T times[] = {100U, 0x7FFFFFF0U, 0x80000010U, 0xFFFFFFF0U,
+                            wrap + 5U, wrap + 256U};
+    const unsigned int nbEvents = sizeof(rawTimes) / sizeof(rawTimes[0]);
+
+    {
+        std::ofstream data("AerStream_load_AerDat2.dat", std::fstream::binary);
+        data << "#!AER-DAT2.0\n"
+             << "# This is a comment\n";
+
+        for (unsigned int i = 0; i < nbEvents; ++i) {
+            // N2D2Env address: y (map) << 28 | channel << 24 | node
+            const unsigned int addr = ((i % 3) << 28) | ((i % 2) << 24)
+                                      | (1000 * i + 7);
+            writeAer_BigEndian(data, addr, 4);
+            writeAer_BigEndian(data, rawTimes[i], 4);
+        }
+
+        // Truncated last record
+        writeAer_BigEndian(data, 0, 4);
+        writeAer_BigEndian(data, 0, 2);
+    }
+
+    AerStream stream;
+    stream.load("AerStream_load_AerDat2.dat", AerStream::AerDat);
+
+    ASSERT_EQUALS(stream.size(), nbEvents);
+    ASSERT_TRUE(stream.isSorted());
+    ASSERT_EQUALS(stream.getFileName(), "AerStream_load_AerDat2.dat");
+    ASSERT_TRUE(!stream.isOutdated());
+
+    for (unsigned int i = 0; i < nbEvents; ++i) {
+        ASSERT_EQUALS(stream.getTimes()[i], times[i] * TimeUs);
+        ASSERT_EQUALS(stream.getX()[i], 1000 * i + 7);
+        ASSERT_EQUALS(stream.getY()[i], i % 3);
+        ASSERT_EQUALS((unsigned int)stream.getPolarity()[i], i % 2);
+    }
+
+    // Windows: start <= time < end
+    AerStream::Window window = stream.getWindow(100 * TimeUs,
+                                                0x80000010ULL * TimeUs);
+    ASSERT_EQUALS(window.size(), 2U);
+    ASSERT_EQUALS(window.time(0), 100 * TimeUs);
+    ASSERT_EQUALS(window.x(1), 1007U);
+
+    window = stream.getWindow(101 * TimeUs, (wrap + 256U) * TimeUs + 1);
+    ASSERT_EQUALS(window.size(), 5U);
+    ASSERT_EQUALS(window.time(0), 0x7FFFFFF0ULL * TimeUs);
+    ASSERT_EQUALS(window.time(4), (wrap + 256U) * TimeUs);
+    ASSERT_EQUALS(window.y(3), 1U);
+    ASSERT_EQUALS(window.polarity(3), 0U);
+
+    // No upper bound
+    window = stream.getWindow(wrap * TimeUs);
+    ASSERT_EQUALS(window.size(), 2U);
+    ASSERT_EQUALS(window.x(0), 4007U);
+
+    window = stream.getWindow(0, 100 * TimeUs);
+    ASSERT_TRUE(window.empty());
+
+    std::vector<AerReadEvent> events;
+    stream.getWindow(wrap * TimeUs).append(events, 3, -1);
+    ASSERT_EQUALS(events.size(), 2U);
+    ASSERT_EQUALS(events[1].x, 5007U);
+    ASSERT_EQUALS(events[1].y, 2U);
+    ASSERT_EQUALS(events[1].channel, 1U);
+    ASSERT_EQUALS(events[1].batch, 3U);
+    ASSERT_EQUALS(events[1].value, -1);
+    ASSERT_EQUALS(events[1].time, (wrap + 256U) * TimeUs);
+}
+
+TEST(AerStream, load_AerDat1_Dvs128)
+{
+    // Version 1 (no version line): 16 bits addresses, 32 bits timestamps
+    {
+        std::ofstream data("AerStream_load_AerDat1.dat", std::fstream::binary);
+
+        // Dvs128 address: node = 128 * 128 - (addr >> 1) - 1, polarity in
+        // the LSB
+        writeAer_BigEndian(data, (128 * 128 - 1 - (5 * 128 + 3)) << 1 | 1, 2);
+        writeAer_BigEndian(data, 50, 4);
+        writeAer_BigEndian(data, (128 * 128 - 1 - (127 * 128 + 127)) << 1, 2);
+        writeAer_BigEndian(data, 40, 4);
+    }
+
+    AerStream stream;
+    stream.load("AerStream_load_AerDat1.dat", AerStream::AerDat,
+                AerEvent::Dvs128, false);
+
+    ASSERT_EQUALS(stream.size(), 2U);
+    ASSERT_TRUE(!stream.isSorted());
+    ASSERT_THROW(stream.getWindow(), std::runtime_error);
+
+    ASSERT_EQUALS(stream.getTimes()[0], 50 * TimeUs);
+    ASSERT_EQUALS(stream.getX()[0], 3U);
+    ASSERT_EQUALS(stream.getY()[0], 5U);
+    ASSERT_EQUALS((unsigned int)stream.getPolarity()[0], 1U);
+    ASSERT_EQUALS(stream.getX()[1], 127U);
+    ASSERT_EQUALS(stream.getY()[1], 127U);
+    ASSERT_EQUALS((unsigned int)stream.getPolarity()[1], 0U);
+
+    // Sorted by time
+    stream.load("AerStream_load_AerDat1.dat", AerStream::AerDat,
+                AerEvent::Dvs128);
+
+    ASSERT_TRUE(stream.isSorted());
+    ASSERT_EQUALS(stream.getTimes()[0], 40 * TimeUs);
+    ASSERT_EQUALS(stream.getX()[0], 127U);
+    ASSERT_EQUALS(stream.getTimes()[1], 50 * TimeUs);
+    ASSERT_EQUALS(stream.getX()[1], 3U);
+    ASSERT_EQUALS(stream.getAddr()[1],
+                  (128U * 128U - 1U - (5U * 128U + 3U)) << 1 | 1U);
+}
+
+TEST(AerStream, load_AerDat3)
+{
+    // 32 bits addresses, 64 bits timestamps, without overflow correction
+    {
+        std::ofstream data("AerStream_load_AerDat3.dat", std::fstream::binary);
+        data << "#!AER-DAT3.0\n";
+
+        writeAer_BigEndian(data, 42, 4);
+        writeAer_BigEndian(data, 0x123456789ULL, 8);
+    }
+
+    AerStream stream;
+    stream.load("AerStream_load_AerDat3.dat", AerStream::AerDat);
+
+    ASSERT_EQUALS(stream.size(), 1U);
+    ASSERT_EQUALS(stream.getTimes()[0], 0x123456789ULL);
+    ASSERT_EQUALS(stream.getX()[0], 42U);
+}
+
+TEST(AerStream, load_Atis)
+{
+    // 40 bits events: 8 bits x, 8 bits y, 1 bit polarity, 23 bits time
+    {
+        std::ofstream data("AerStream_load_Atis.bin", std::fstream::binary);
+        const unsigned char events[] = {
+            12, 34, 0x80 | 0x01, 0x02, 0x03,
+            33, 0, 0x7F, 0xFF, 0xFF,
+            // Truncated
+            1, 2};
+        data.write(reinterpret_cast<const char*>(events), sizeof(events));
+    }
+
+    AerStream stream;
+    stream.load("AerStream_load_Atis.bin", AerStream::Atis);
+
+    ASSERT_EQUALS(stream.size(), 2U);
+    ASSERT_EQUALS(stream.getX()[0], 12U);
+    ASSERT_EQUALS(stream.getY()[0], 34U);
+    ASSERT_EQUALS((unsigned int)stream.getPolarity()[0], 1U);
+    ASSERT_EQUALS(stream.getTimes()[0], 0x010203U);
+    ASSERT_EQUALS(stream.getX()[1], 33U);
+    ASSERT_EQUALS(stream.getY()[1], 0U);
+    ASSERT_EQUALS((unsigned int)stream.getPolarity()[1], 0U);
+    ASSERT_EQUALS(stream.getTimes()[1], 0x7FFFFFU);
+}
+
+TEST(AerStream, load_Text)
+{
+    {
+        std::ofstream data("AerStream_load_Text.txt");
+        data << "1 2 300 1\n"
+                "4 5 100 0\n"
+                "  7 8\t200 1\n"
+                "invalid 0 0 0\n"
+                "9 9 9 9\n";
+    }
+
+    AerStream stream;
+    stream.load("AerStream_load_Text.txt", AerStream::Text);
+
+    ASSERT_EQUALS(stream.size(), 3U);
+    ASSERT_TRUE(stream.isSorted());
+    ASSERT_EQUALS(stream.getTimes()[0], 100U);
+    ASSERT_EQUALS(stream.getX()[0], 4U);
+    ASSERT_EQUALS(stream.getTimes()[1], 200U);
+    ASSERT_EQUALS(stream.getY()[1], 8U);
+    ASSERT_EQUALS((unsigned int)stream.getPolarity()[1], 1U);
+    ASSERT_EQUALS(stream.getTimes()[2], 300U);
+
+    ASSERT_THROW(stream.load("AerStream_load_missing.txt", AerStream::Text),
+                 std::runtime_error);
+}
+
+RUN_TESTS()
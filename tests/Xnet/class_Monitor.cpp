@@ -0,0 +1,152 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Xnet/Monitor.hpp"
+#include "Xnet/Network.hpp"
+#include "Xnet/NodeEnv.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST(Monitor, update)
+{
+    Network net;
+    std::vector<std::shared_ptr<NodeEnv> > nodes;
+
+    for (unsigned int i = 0; i < 4; ++i)
+        nodes.push_back(std::make_shared<NodeEnv>(net, 1.0, 0.0, i));
+
+    Monitor monitor(net);
+
+    for (unsigned int i = 0; i < 3; ++i)
+        monitor.add(*nodes[i]);
+
+    // Node i emits (i + 1) events of type 0 starting at 10 - i, and one
+    // event of type 1
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        for (unsigned int k = 0; k <= i; ++k)
+            net.newEvent(nodes[i].get(), NULL, (10 - i + k) * TimeUs, 0);
+
+        net.newEvent(nodes[i].get(), NULL, 20 * TimeUs, 1);
+    }
+
+    nodes[3]->setActivityRecording(true);
+    net.run();
+    monitor.update(true);
+
+    ASSERT_EQUALS(monitor.getTotalActivity(), 9U);
+    ASSERT_EQUALS(monitor.getMostActiveNeuronId(), nodes[2]->getId());
+    ASSERT_EQUALS(monitor.getMostActiveNeuronRate(), 4U);
+    ASSERT_EQUALS(monitor.getEarlierNeuronId(), nodes[2]->getId());
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        ASSERT_EQUALS(monitor.getFiringRate(nodes[i]->getId()), i + 2);
+        ASSERT_EQUALS(monitor.getFiringRate(nodes[i]->getId(), 0), i + 1);
+        ASSERT_EQUALS(monitor.getFiringRate(nodes[i]->getId(), 1), 1U);
+        ASSERT_EQUALS(monitor.getFiringRate(nodes[i]->getId(), 2), 0U);
+    }
+
+    ASSERT_THROW_ANY(monitor.getFiringRate(nodes[3]->getId()));
+    ASSERT_EQUALS(monitor.getActivity().size(), 9U);
+
+    // Only the events of type 1 are recorded, and the firing rates
+    // accumulate
+    monitor.recordEvent(1);
+    monitor.add(*nodes[3]);
+    monitor.update();
+
+    ASSERT_EQUALS(monitor.getTotalActivity(), 4U);
+    ASSERT_EQUALS(monitor.getEarlierNeuronId(), nodes[0]->getId());
+    ASSERT_EQUALS(monitor.getTotalFiringRate(), 9U + 4U);
+    ASSERT_EQUALS(monitor.getTotalFiringRate(0), 6U);
+    ASSERT_EQUALS(monitor.getTotalFiringRate(1), 3U + 4U);
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        ASSERT_EQUALS(monitor.getFiringRate(nodes[i]->getId(), 1), 2U);
+    }
+
+    ASSERT_EQUALS(monitor.getFiringRate(nodes[3]->getId()), 1U);
+    ASSERT_EQUALS(monitor.getActivity().size(), 9U);
+
+    monitor.clearFiringRate();
+
+    ASSERT_EQUALS(monitor.getTotalFiringRate(), 0U);
+}
+
+TEST(Monitor, logActivity)
+{
+    Network net;
+    std::vector<std::shared_ptr<NodeEnv> > nodes;
+    Monitor monitor(net);
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        nodes.push_back(std::make_shared<NodeEnv>(net, 1.0, 0.0, i));
+        monitor.add(*nodes.back());
+    }
+
+    // Interleaved events
+    for (unsigned int k = 0; k < 4; ++k) {
+        for (unsigned int i = 0; i < nodes.size(); ++i)
+            net.newEvent(nodes[i].get(), NULL, (1 + k) * TimeS, i);
+    }
+
+    net.run();
+    monitor.update(true);
+    monitor.logActivity("Monitor_logActivity.dat");
+    monitor.logFiringRate("Monitor_logFiringRate.dat");
+
+    std::ifstream activity("Monitor_logActivity.dat");
+    ASSERT_TRUE(activity.good());
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        for (unsigned int k = 0; k < 4; ++k) {
+            NodeId_T nodeId;
+            double timestamp;
+            EventType_T type;
+
+            activity >> nodeId >> timestamp >> type;
+
+            ASSERT_EQUALS(nodeId, nodes[i]->getId());
+            ASSERT_EQUALS(timestamp, 1.0 + k);
+            ASSERT_EQUALS(type, i);
+        }
+    }
+
+    std::ifstream firingRate("Monitor_logFiringRate.dat");
+    ASSERT_TRUE(firingRate.good());
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        NodeId_T nodeId;
+        firingRate >> nodeId;
+
+        ASSERT_EQUALS(nodeId, nodes[i]->getId());
+
+        for (unsigned int type = 0; type < nodes.size(); ++type) {
+            unsigned int rate;
+            firingRate >> rate;
+
+            ASSERT_EQUALS(rate, (type == i) ? 4U : 0U);
+        }
+    }
+}
+
+RUN_TESTS()
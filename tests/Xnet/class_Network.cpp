@@ -0,0 +1,393 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Xnet/Network.hpp"
+#include "Xnet/NodeEnv.hpp"
+#include "Xnet/NodeNeuron_Behavioral.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+class NetworkSimulation {
+public:
+    NetworkSimulation(unsigned int nbPartitions,
+                      unsigned int orderStdp,
+                      bool enableStdp,
+                      Time_T incomingDelay = 1 * TimeNs)
+    {
+        Random::mtSeed(0);
+
+        mNet.setNbPartitions(nbPartitions);
+
+        for (unsigned int i = 0; i < 16; ++i) {
+            mInputs.push_back(std::make_shared<NodeEnv>(mNet, 1.0, 0.0, i));
+            mInputs.back()->setActivityRecording(true);
+        }
+
+        // Two layers of 4 groups of neurons with lateral inhibition
+        std::vector<std::shared_ptr<Node> > parents(mInputs.begin(),
+                                                    mInputs.end());
+
+        for (unsigned int layer = 0; layer < 2; ++layer) {
+            std::vector<std::shared_ptr<Node> > neurons;
+
+            for (unsigned int group = 0; group < 4; ++group) {
+                std::vector<std::shared_ptr<NodeNeuron_Behavioral> > groupNeurons;
+
+                for (unsigned int n = 0; n < 3; ++n) {
+                    std::shared_ptr<NodeNeuron_Behavioral> neuron
+                        = std::make_shared<NodeNeuron_Behavioral>(mNet);
+                    neuron->setParameter("Threshold", 400.0);
+                    neuron->setParameter("Leak", 10 * TimeUs);
+                    neuron->setParameter("IncomingDelay", incomingDelay,
+                                         10.0 * TimePs);
+                    // No spread for the parameters drawn upon initialization,
+                    // as the nodes are initialized in address order
+                    neuron->setParameter("EmitDelay",
+                                         (Time_T)(100 * TimePs), 0.0);
+                    neuron->setParameter("EnableStdp", enableStdp);
+                    neuron->setParameter("OrderStdp", orderStdp);
+                    neuron->setActivityRecording(true);
+
+                    for (std::vector<std::shared_ptr<Node> >::const_iterator
+                         it = parents.begin(), itEnd = parents.end();
+                         it != itEnd; ++it)
+                    {
+                        if (Random::randUniform() < 0.5)
+                            neuron->addLink((*it).get());
+                    }
+
+                    groupNeurons.push_back(neuron);
+                }
+
+                for (unsigned int n = 0; n < groupNeurons.size(); ++n) {
+                    for (unsigned int m = 0; m < groupNeurons.size(); ++m) {
+                        if (m != n) {
+                            groupNeurons[n]->addLateralBranch(
+                                groupNeurons[m].get());
+                        }
+                    }
+
+                    mNeurons.push_back(groupNeurons[n]);
+                    neurons.push_back(groupNeurons[n]);
+                }
+            }
+
+            parents.swap(neurons);
+        }
+
+        // Input spike trains
+        for (unsigned int i = 0; i < mInputs.size(); ++i) {
+            Time_T timestamp = 0;
+
+            while (true) {
+                timestamp += (Time_T)Random::randExponential(20.0 * TimeUs);
+
+                if (timestamp >= 1 * TimeMs)
+                    break;
+
+                mNet.newEvent(mInputs[i].get(), NULL, timestamp);
+            }
+        }
+    }
+
+    void run(Time_T stop = 0)
+    {
+        mNet.run(stop, false);
+    }
+
+    std::vector<NodeEvents_T> getActivity()
+    {
+        std::vector<NodeEvents_T> activity;
+
+        for (std::vector<std::shared_ptr<NodeEnv> >::const_iterator it
+             = mInputs.begin(), itEnd = mInputs.end(); it != itEnd; ++it)
+        {
+            activity.push_back(mNet.getSpikeRecording((*it)->getId()));
+        }
+
+        for (std::vector<std::shared_ptr<NodeNeuron_Behavioral> >
+             ::const_iterator it = mNeurons.begin(), itEnd = mNeurons.end();
+             it != itEnd; ++it)
+        {
+            activity.push_back(mNet.getSpikeRecording((*it)->getId()));
+        }
+
+        return activity;
+    }
+
+    Network mNet;
+    std::vector<std::shared_ptr<NodeEnv> > mInputs;
+    std::vector<std::shared_ptr<NodeNeuron_Behavioral> > mNeurons;
+};
+
+TEST_DATASET(Network,
+             run_partitions,
+             (unsigned int nbPartitions, unsigned int orderStdp,
+              bool enableStdp),
+             std::make_tuple(2U, 0U, false),
+             std::make_tuple(4U, 0U, false),
+             std::make_tuple(4U, 2U, true),
+             std::make_tuple(64U, 2U, true))
+{
+    NetworkSimulation sequential(0, orderStdp, enableStdp);
+    NetworkSimulation parallel(nbPartitions, orderStdp, enableStdp);
+
+    sequential.run();
+    parallel.run();
+
+    const std::vector<NodeEvents_T> sequentialActivity
+        = sequential.getActivity();
+    const std::vector<NodeEvents_T> parallelActivity = parallel.getActivity();
+
+    ASSERT_EQUALS(parallelActivity.size(), sequentialActivity.size());
+
+    unsigned int nbNeuronSpikes = 0;
+
+    for (unsigned int i = 0; i < sequentialActivity.size(); ++i) {
+        ASSERT_EQUALS(parallelActivity[i].size(),
+                      sequentialActivity[i].size());
+
+        for (unsigned int k = 0; k < sequentialActivity[i].size(); ++k) {
+            ASSERT_EQUALS(parallelActivity[i][k].first,
+                          sequentialActivity[i][k].first);
+            ASSERT_EQUALS(parallelActivity[i][k].second,
+                          sequentialActivity[i][k].second);
+        }
+
+        if (i >= sequential.mInputs.size())
+            nbNeuronSpikes += sequentialActivity[i].size();
+    }
+
+    ASSERT_TRUE(nbNeuronSpikes > 0);
+    ASSERT_EQUALS(parallel.mNet.getLastEvent(),
+                  sequential.mNet.getLastEvent());
+}
+
+TEST(Network, run_partitions_stop)
+{
+    NetworkSimulation sequential(0, 2U, true);
+    NetworkSimulation parallel(4, 2U, true);
+
+    // Resume the simulation after intermediate stops
+    for (unsigned int step = 1; step <= 4; ++step) {
+        sequential.run(step * 250 * TimeUs);
+        parallel.run(step * 250 * TimeUs);
+    }
+
+    sequential.run();
+    parallel.run();
+
+    const std::vector<NodeEvents_T> sequentialActivity
+        = sequential.getActivity();
+    const std::vector<NodeEvents_T> parallelActivity = parallel.getActivity();
+
+    for (unsigned int i = 0; i < sequentialActivity.size(); ++i) {
+        ASSERT_EQUALS(parallelActivity[i].size(),
+                      sequentialActivity[i].size());
+
+        for (unsigned int k = 0; k < sequentialActivity[i].size(); ++k) {
+            ASSERT_EQUALS(parallelActivity[i][k].first,
+                          sequentialActivity[i][k].first);
+        }
+    }
+}
+
+class StopNode : public Node {
+public:
+    StopNode(Network& net, unsigned int nbSpikes)
+        : Node(net), mNbSpikes(nbSpikes)
+    {
+    }
+
+    void incomingSpike(Node* /*link*/, Time_T timestamp, EventType_T /*type*/)
+    {
+        // Same as FcCell_Spike with TerminateMax
+        if (mNbSpikes > 0 && --mNbSpikes == 0)
+            mNet.stop(timestamp + 2 * TimeFs, true);
+    }
+
+    bool canStop() const
+    {
+        return true;
+    }
+
+private:
+    unsigned int mNbSpikes;
+};
+
+TEST(Network, run_partitions_stopFromNode)
+{
+    // Time windows much larger than the inputs inter-spike interval
+    NetworkSimulation sequential(0, 2U, true, 100 * TimeUs);
+    NetworkSimulation parallel(4, 2U, true, 100 * TimeUs);
+    StopNode sequentialStop(sequential.mNet, 20);
+    StopNode parallelStop(parallel.mNet, 20);
+
+    // The first layer neurons notify the stop node
+    for (unsigned int n = 0; n < 12; ++n) {
+        sequential.mNeurons[n]->addBranch(&sequentialStop);
+        parallel.mNeurons[n]->addBranch(&parallelStop);
+    }
+
+    ASSERT_TRUE(sequential.mNet.run(0, false));
+    ASSERT_TRUE(parallel.mNet.run(0, false));
+    ASSERT_TRUE(sequential.mNet.getLastEvent() < 1 * TimeMs);
+    ASSERT_EQUALS(parallel.mNet.getLastEvent(),
+                  sequential.mNet.getLastEvent());
+
+    const std::vector<NodeEvents_T> sequentialActivity
+        = sequential.getActivity();
+    const std::vector<NodeEvents_T> parallelActivity = parallel.getActivity();
+
+    for (unsigned int i = 0; i < sequentialActivity.size(); ++i) {
+        ASSERT_TRUE(parallelActivity[i] == sequentialActivity[i]);
+    }
+}
+
+TEST(SpikeLog, append)
+{
+    SpikeLog log;
+    SpikeLog partitionLog;
+
+    // More than one chunk
+    for (unsigned int i = 0; i < 100000; ++i)
+        log.push_back(i % 3, i, i % 2);
+
+    for (unsigned int i = 100000; i < 100010; ++i)
+        partitionLog.push_back(i % 3, i, 2);
+
+    ASSERT_EQUALS(log.getNodeEvents(0).size(), 33334U);
+
+    log.append(partitionLog);
+    log.push_back(3, 100010, 0);
+
+    ASSERT_TRUE(partitionLog.empty());
+    ASSERT_EQUALS(log.size(), 100011U);
+    ASSERT_EQUALS(log.getNodesEvents().size(), 4U);
+
+    unsigned int nbEvents = 0;
+
+    for (NodeId_T nodeId = 0; nodeId < 3; ++nodeId) {
+        const NodeEvents_T& events = log.getNodeEvents(nodeId);
+
+        for (unsigned int k = 0; k < events.size(); ++k) {
+            ASSERT_EQUALS(events[k].first % 3, nodeId);
+            ASSERT_EQUALS(events[k].second,
+                          (events[k].first < 100000)
+                            ? events[k].first % 2 : 2U);
+
+            if (k > 0) {
+                ASSERT_EQUALS(events[k].first, events[k - 1].first + 3);
+            }
+        }
+
+        nbEvents += events.size();
+    }
+
+    ASSERT_EQUALS(nbEvents, 100010U);
+    ASSERT_EQUALS(log.getNodeEvents(3).size(), 1U);
+    ASSERT_TRUE(log.getNodeEvents(4).empty());
+
+    log.clear();
+
+    ASSERT_TRUE(log.empty());
+    ASSERT_TRUE(log.getNodeEvents(0).empty());
+}
+
+TEST(SpikeLog, getNodeActivity)
+{
+    SpikeLog log;
+    SpikeLog partitionLog;
+
+    for (unsigned int i = 0; i < 150000; ++i)
+        log.push_back(i % 10, i, i % 2);
+
+    ASSERT_EQUALS(log.getNodeActivity(3), 0U);
+    ASSERT_EQUALS(log.getNodeActivity(3, 0, 0, 1), 15000U);
+
+    // Partial chunks appended, then new events after the indexing
+    for (unsigned int i = 150000; i < 150100; ++i)
+        partitionLog.push_back(i % 10, i, i % 2);
+
+    log.append(partitionLog);
+
+    for (unsigned int i = 150100; i < 150200; ++i)
+        log.push_back(i % 10, i, i % 2);
+
+    ASSERT_EQUALS(log.getNodeActivity(3, 0, 0, 1), 15020U);
+    ASSERT_EQUALS(log.getNodeActivity(3, 100000, 150100, 1), 5010U);
+    ASSERT_EQUALS(log.getNodeActivity(10, 0, 0, 0), 0U);
+    ASSERT_TRUE(log.getNodeFirstEvent(4) == std::make_pair((Time_T)4, true));
+    ASSERT_TRUE(log.getNodeFirstEvent(4, 150101)
+                == std::make_pair((Time_T)150104, true));
+    ASSERT_TRUE(!log.getNodeFirstEvent(4, 0, 0, 1).second);
+    ASSERT_TRUE(!log.getNodeFirstEvent(4, 150200).second);
+
+    // Concurrent first queries, while the index is being built
+    log.push_back(11, 150200, 0);
+
+    std::vector<unsigned int> activities(64);
+
+#pragma omp parallel for
+    for (int k = 0; k < (int)activities.size(); ++k)
+        activities[k] = log.getNodeActivity(k % 12, 0, 0, (k % 12) % 2);
+
+    for (unsigned int k = 0; k < activities.size(); ++k) {
+        ASSERT_EQUALS(activities[k], (k % 12 < 10) ? 15020U : 0U);
+    }
+
+    ASSERT_EQUALS(log.getNodeActivity(11), 1U);
+}
+
+TEST(SpikeLog, save)
+{
+    SpikeLog log;
+
+    for (unsigned int i = 0; i < 70000; ++i)
+        log.push_back(i % 7, 1000 * i, (i % 5 == 0) ? 1 : 0);
+
+    log.save("SpikeLog_save.bin");
+
+    SpikeLog loadedLog;
+    loadedLog.push_back(8, 0, 0);
+    loadedLog.load("SpikeLog_save.bin");
+
+    ASSERT_EQUALS(loadedLog.size(), log.size());
+    ASSERT_EQUALS(loadedLog.getNodesEvents().size(), 7U);
+
+    for (NodeId_T nodeId = 0; nodeId < 7; ++nodeId) {
+        ASSERT_TRUE(loadedLog.getNodeEvents(nodeId)
+                    == log.getNodeEvents(nodeId));
+    }
+
+    // Loaded in several chunks, which can still grow
+    loadedLog.push_back(0, 1000 * 70000, 1);
+
+    ASSERT_EQUALS(loadedLog.getNodeActivity(0, 0, 0, 1),
+                  log.getNodeActivity(0, 0, 0, 1) + 1);
+
+    ASSERT_THROW_ANY(loadedLog.load("SpikeLog_missing.bin"));
+}
+
+RUN_TESTS()
@@ -0,0 +1,212 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Xnet/Network.hpp"
+#include "Xnet/NodeEnv.hpp"
+#include "Xnet/NodeNeuron_Behavioral.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+class BehavioralSimulation {
+public:
+    BehavioralSimulation(unsigned int orderStdp,
+                         bool enableStdp,
+                         unsigned int nbPartitions = 0)
+    {
+        Random::mtSeed(0);
+
+        mNet.setNbPartitions(nbPartitions);
+
+        // Created first, so that its link comes first in the compiled links
+        // order and shifts all the other link indexes once added
+        mSilentInput = std::make_shared<NodeEnv>(mNet, 1.0, 0.0, 0);
+
+        for (unsigned int i = 0; i < 32; ++i)
+            mInputs.push_back(std::make_shared<NodeEnv>(mNet, 1.0, 0.0, i));
+
+        for (unsigned int n = 0; n < 4; ++n) {
+            std::shared_ptr<NodeNeuron_Behavioral> neuron
+                = std::make_shared<NodeNeuron_Behavioral>(mNet);
+            neuron->setParameter("Threshold", 800.0);
+            neuron->setParameter("Leak", 10 * TimeUs);
+            neuron->setParameter("IncomingDelay",
+                                 (Time_T)(1 * TimeNs), 0.0);
+            neuron->setParameter("EmitDelay", (Time_T)(100 * TimePs), 0.0);
+            neuron->setParameter("WeightsInit", 80.0, 0.0);
+            neuron->setParameter("WeightIncrement", 50.0, 0.0);
+            neuron->setParameter("WeightDecrement", 50.0, 0.0);
+            neuron->setParameter("WeightsMin", 1.0, 0.0);
+            neuron->setParameter("WeightsMax", 100.0, 0.0);
+            neuron->setParameter("StdpLtp", (Time_T)(20 * TimeUs));
+            neuron->setParameter("EnableStdp", enableStdp);
+            neuron->setParameter("OrderStdp", orderStdp);
+            neuron->setActivityRecording(true);
+
+            for (unsigned int i = 0; i < mInputs.size(); ++i) {
+                if (Random::randUniform() < 0.75)
+                    neuron->addLink(mInputs[i].get());
+            }
+
+            mNeurons.push_back(neuron);
+        }
+
+        for (unsigned int i = 0; i < mInputs.size(); ++i) {
+            Time_T timestamp = 0;
+
+            while (true) {
+                timestamp += (Time_T)Random::randExponential(10.0 * TimeUs);
+
+                if (timestamp >= 1 * TimeMs)
+                    break;
+
+                mNet.newEvent(mInputs[i].get(), NULL, timestamp);
+            }
+        }
+    }
+
+    void addSilentLinks()
+    {
+        for (std::vector<std::shared_ptr<NodeNeuron_Behavioral> >
+             ::const_iterator it = mNeurons.begin(), itEnd = mNeurons.end();
+             it != itEnd; ++it)
+        {
+            (*it)->addLink(mSilentInput.get());
+        }
+    }
+
+    std::vector<NodeEvents_T> getActivity()
+    {
+        std::vector<NodeEvents_T> activity;
+
+        for (std::vector<std::shared_ptr<NodeNeuron_Behavioral> >
+             ::const_iterator it = mNeurons.begin(), itEnd = mNeurons.end();
+             it != itEnd; ++it)
+        {
+            activity.push_back(mNet.getSpikeRecording((*it)->getId()));
+        }
+
+        return activity;
+    }
+
+    Network mNet;
+    std::shared_ptr<NodeEnv> mSilentInput;
+    std::vector<std::shared_ptr<NodeEnv> > mInputs;
+    std::vector<std::shared_ptr<NodeNeuron_Behavioral> > mNeurons;
+};
+
+TEST_DATASET(NodeNeuron_Behavioral,
+             compileLinks,
+             (unsigned int orderStdp, bool enableStdp),
+             std::make_tuple(0U, false),
+             std::make_tuple(0U, true),
+             std::make_tuple(2U, true),
+             std::make_tuple(8U, true),
+             std::make_tuple(64U, true))
+{
+    // All the links are compiled once, upon initialization
+    BehavioralSimulation reference(orderStdp, enableStdp);
+    reference.addSilentLinks();
+    reference.mNet.run(0, false);
+
+    // A link added during the simulation triggers the recompilation of the
+    // links: the pooled synapses are relocated, all the link indexes are
+    // shifted and the STDP FIFO must be carried over
+    BehavioralSimulation recompiled(orderStdp, enableStdp);
+    recompiled.mNet.run(500 * TimeUs, false);
+    recompiled.addSilentLinks();
+    recompiled.mNet.run(0, false);
+
+    const std::vector<NodeEvents_T> referenceActivity
+        = reference.getActivity();
+    const std::vector<NodeEvents_T> recompiledActivity
+        = recompiled.getActivity();
+
+    ASSERT_EQUALS(recompiledActivity.size(), referenceActivity.size());
+
+    unsigned int nbLateSpikes = 0;
+
+    for (unsigned int i = 0; i < referenceActivity.size(); ++i) {
+        ASSERT_EQUALS(recompiledActivity[i].size(),
+                      referenceActivity[i].size());
+
+        for (unsigned int k = 0; k < referenceActivity[i].size(); ++k) {
+            ASSERT_EQUALS(recompiledActivity[i][k].first,
+                          referenceActivity[i][k].first);
+
+            if (referenceActivity[i][k].first > 500 * TimeUs)
+                ++nbLateSpikes;
+        }
+    }
+
+    // Spikes after the recompilation
+    ASSERT_TRUE(nbLateSpikes > 0);
+}
+
+TEST_DATASET(NodeNeuron_Behavioral,
+             run_partitions,
+             (unsigned int nbPartitions, unsigned int orderStdp,
+              bool enableStdp),
+             std::make_tuple(2U, 0U, false),
+             std::make_tuple(4U, 2U, true),
+             std::make_tuple(8U, 64U, true))
+{
+    BehavioralSimulation sequential(orderStdp, enableStdp);
+    sequential.mNet.run(0, false);
+
+    // Same spike trains with the parallel engine, including after a stop
+    BehavioralSimulation parallel(orderStdp, enableStdp, nbPartitions);
+    parallel.mNet.run(500 * TimeUs, false);
+    parallel.mNet.run(0, false);
+
+    const std::vector<NodeEvents_T> sequentialActivity
+        = sequential.getActivity();
+    const std::vector<NodeEvents_T> parallelActivity = parallel.getActivity();
+
+    ASSERT_EQUALS(parallelActivity.size(), sequentialActivity.size());
+
+    unsigned int nbSpikes = 0;
+
+    for (unsigned int i = 0; i < sequentialActivity.size(); ++i) {
+        ASSERT_TRUE(parallelActivity[i] == sequentialActivity[i]);
+        nbSpikes += sequentialActivity[i].size();
+    }
+
+    ASSERT_TRUE(nbSpikes > 0);
+    ASSERT_EQUALS(parallel.mNet.getLastEvent(),
+                  sequential.mNet.getLastEvent());
+}
+
+TEST(NodeNeuron_Behavioral, incomingSpike_noLink)
+{
+    Network net;
+    NodeEnv input(net, 1.0, 0.0, 0);
+    NodeEnv unlinked(net, 1.0, 0.0, 1);
+    NodeNeuron_Behavioral neuron(net);
+    neuron.addLink(&input);
+
+    ASSERT_THROW(neuron.propagateSpike(&unlinked, 0), std::runtime_error);
+    ASSERT_THROW(neuron.incomingSpike(&unlinked, 0), std::runtime_error);
+}
+
+RUN_TESTS()
@@ -0,0 +1,122 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "StimuliShards.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+#include <cstring>
+
+using namespace N2D2;
+
+cv::Mat randomMat(int rows, int cols, int type)
+{
+    cv::Mat mat(rows, cols, type);
+    unsigned char* data = mat.data;
+
+    for (std::size_t i = 0; i < mat.elemSize() * rows * cols; ++i)
+        data[i] = (unsigned char)Random::randUniform(0, 255);
+
+    return mat;
+}
+
+bool sameMat(const cv::Mat& mat1, const cv::Mat& mat2)
+{
+    return (mat1.rows == mat2.rows && mat1.cols == mat2.cols
+        && mat1.type() == mat2.type()
+        && std::memcmp(mat1.data, mat2.data,
+                       mat1.elemSize() * mat1.rows * mat1.cols) == 0);
+}
+
+TEST_DATASET(StimuliShards,
+             read,
+             (StimuliShards::Compression compression),
+             std::make_tuple(StimuliShards::None),
+             std::make_tuple(StimuliShards::Png))
+{
+    Random::mtSeed(0);
+
+    const std::string path = "StimuliShards_read";
+    const unsigned int nbStimuli = 20;
+
+    std::vector<std::vector<cv::Mat> > data(nbStimuli);
+    std::vector<std::vector<cv::Mat> > labels(nbStimuli);
+
+    for (unsigned int id = 0; id < nbStimuli; ++id) {
+        data[id].push_back(randomMat(16 + id, 24, CV_8UC3));
+        data[id].push_back(randomMat(8, 8, CV_32FC1));
+        labels[id].push_back(randomMat(1, 1, CV_32SC1));
+    }
+
+    {
+        // Small shards, to have several records per shard and several shards
+        StimuliShards::Writer writer(path, compression, 4096);
+
+        for (unsigned int id = 0; id < nbStimuli; ++id) {
+            // Odd stimuli are not packed
+            if (id % 2 == 0) {
+                writer.append(id, Database::Learn,
+                    StimuliShards::Writer::encode(data[id], labels[id],
+                                                  compression));
+            }
+        }
+
+        ASSERT_TRUE(!StimuliShards::exists(path));
+
+        writer.append(1, Database::Test,
+            StimuliShards::Writer::encode(data[1], labels[1], compression));
+        writer.close();
+    }
+
+    ASSERT_TRUE(StimuliShards::exists(path));
+
+    const StimuliShards shards(path);
+
+    for (unsigned int id = 0; id < nbStimuli; ++id) {
+        std::vector<cv::Mat> stimulusData;
+        std::vector<cv::Mat> stimulusLabels;
+
+        ASSERT_EQUALS(shards.read(id, Database::Learn,
+                                  stimulusData, stimulusLabels),
+                      (id % 2 == 0));
+
+        if (id % 2 == 0) {
+            ASSERT_EQUALS(stimulusData.size(), 2U);
+            ASSERT_EQUALS(stimulusLabels.size(), 1U);
+            ASSERT_TRUE(sameMat(stimulusData[0], data[id][0]));
+            ASSERT_TRUE(sameMat(stimulusData[1], data[id][1]));
+            ASSERT_TRUE(sameMat(stimulusLabels[0], labels[id][0]));
+        }
+    }
+
+    std::vector<cv::Mat> stimulusData;
+    std::vector<cv::Mat> stimulusLabels;
+
+    ASSERT_TRUE(shards.read(1, Database::Test, stimulusData, stimulusLabels));
+    ASSERT_TRUE(sameMat(stimulusData[0], data[1][0]));
+    ASSERT_TRUE(!shards.read(0, Database::Test, stimulusData,
+                             stimulusLabels));
+    ASSERT_TRUE(!shards.read(0, Database::Validation, stimulusData,
+                             stimulusLabels));
+}
+
+RUN_TESTS()
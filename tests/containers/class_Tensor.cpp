@@ -18,6 +18,8 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include <cstring>
+
 #include "containers/Tensor.hpp"
 #include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
@@ -948,4 +950,240 @@ TEST(Tensor4d, tensor_cast_float_to_int)
     ASSERT_EQUALS(B(1, 1, 1, 1), 4);
 }
 
+TEST(Tensor4d, tensor_cast_cache)
+{
+    Tensor<float> A({2, 3, 4, 5}, 1.0);
+
+    Tensor<half_float::half> B = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B(1, 1, 1, 1), half_float::half(1.0f));
+
+    // tensor_cast_nocopy() returns the same cached data
+    const Tensor<half_float::half> B1
+        = tensor_cast_nocopy<half_float::half>(A);
+    ASSERT_TRUE(&B1.data()[0] == &B.data()[0]);
+
+    // 1. Neither A nor the cache changed: no conversion.
+    // Conversions are detected by writing directly in the cached vector,
+    // which bypasses on purpose the modification tracking (B.data() is a
+    // modification, hence the first cast).
+    std::vector<half_float::half>& cache = B.data();
+    tensor_cast<half_float::half>(A);
+    cache[0] = half_float::half(3.0f);
+    const Tensor<half_float::half> B3
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B3(0, 0, 0, 0), half_float::half(3.0f));
+
+    // 2. A is modified: the cache is converted again
+    A(1, 1, 1, 1) = 2.0;
+    const Tensor<half_float::half> B4
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B4(0, 0, 0, 0), half_float::half(1.0f));
+    ASSERT_EQUALS(B4(1, 1, 1, 1), half_float::half(2.0f));
+
+    // 3. The cache is modified: it is converted again as well
+    B(1, 1, 1, 1) = half_float::half(4.0f);
+    const Tensor<half_float::half> B5
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B5(1, 1, 1, 1), half_float::half(2.0f));
+
+    // 4. Reading A or the cache through const tensors does not invalidate
+    // the cache. Note that with a non-const tensor, any access, even for
+    // reading, is considered as a modification.
+    const Tensor<float>& constA = A;
+    ASSERT_EQUALS(constA(1, 1, 1, 1), 2.0f);
+    ASSERT_EQUALS(constA.sum(), 121.0);
+    cache[0] = half_float::half(5.0f);
+    const Tensor<half_float::half> B6
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B6(0, 0, 0, 0), half_float::half(5.0f));
+
+    // 5. Any non-const access is considered as a modification
+    A.data();
+    const Tensor<half_float::half> B7
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B7(0, 0, 0, 0), half_float::half(1.0f));
+
+    // 6. Modification through a view of A (shared data)
+    Tensor<float> A1 = A[1];
+    A1(0, 0, 0) = 6.0;
+    const Tensor<half_float::half> B8
+        = tensor_cast<half_float::half>(A);
+    ASSERT_EQUALS(B8(0, 0, 0, 1), half_float::half(6.0f));
+}
+
+TEST(Tensor4d, tensor_cast_round)
+{
+    Tensor<float> A({2, 3, 4, 5}, 1.7);
+    A(1, 1, 1, 1) = -2.5;
+
+    const Tensor<int> B = tensor_cast<int>(A);
+    ASSERT_EQUALS(B(0, 0, 0, 0), 1);
+    ASSERT_EQUALS(B(1, 1, 1, 1), -2);
+
+    // Same source version, but a different rounding: converted again
+    const Tensor<int> C = tensor_cast<int, true>(A);
+    ASSERT_EQUALS(C(0, 0, 0, 0), 2);
+    ASSERT_EQUALS(C(1, 1, 1, 1), -3);
+
+    const Tensor<int> D = tensor_cast<int>(A);
+    ASSERT_EQUALS(D(0, 0, 0, 0), 1);
+    ASSERT_EQUALS(D(1, 1, 1, 1), -2);
+
+    Tensor<half_float::half> H({2, 3, 4, 5}, half_float::half(-1.5f));
+    const Tensor<int8_t> E = tensor_cast<int8_t, true>(H);
+    ASSERT_EQUALS((int)E(0, 0, 0, 0), -2);
+    const Tensor<int8_t> F = tensor_cast<int8_t>(H);
+    ASSERT_EQUALS((int)F(0, 0, 0, 0), -1);
+}
+
+TEST(Tensor4d, tensor_cast_resize)
+{
+    Tensor<float> A({2, 3, 4, 5}, 1.0);
+
+    const Tensor<double> B = tensor_cast<double>(A);
+    ASSERT_EQUALS(B.size(), A.size());
+
+    A.resize({4, 3, 4, 5}, 2.0);
+
+    const Tensor<double> C = tensor_cast<double>(A);
+    ASSERT_EQUALS(C.size(), A.size());
+    ASSERT_EQUALS(C(3, 2, 3, 4), 2.0);
+}
+
+TEST_DATASET(Tensor4d,
+             tensor_cast_half,
+             (size_t size),
+             std::make_tuple(1U),
+             std::make_tuple(1000U),
+             std::make_tuple(65536U),
+             std::make_tuple(100000U))
+{
+    Random::mtSeed(0);
+
+    // Every half value, including sub-normals, infinites and NaNs
+    Tensor<half_float::half> A({size});
+
+    for (size_t i = 0; i < size; ++i) {
+        const uint16_t bits = (uint16_t)i;
+        std::memcpy(&A(i), &bits, sizeof(bits));
+    }
+
+    const Tensor<float> B = tensor_cast<float>(A);
+
+    for (size_t i = 0; i < size; ++i) {
+        const float ref = (float)A(i);
+        ASSERT_TRUE(std::memcmp(&B(i), &ref, sizeof(float)) == 0);
+    }
+
+    // Finite values only, as signaling NaNs would raise a floating point
+    // exception when converted to double
+    for (size_t i = 0; i < size; ++i) {
+        if (!half_float::isfinite(A(i)))
+            A(i) = half_float::half(0.0f);
+    }
+
+    const Tensor<double> C = tensor_cast<double>(A);
+
+    for (size_t i = 0; i < size; ++i)
+        ASSERT_EQUALS(C(i), (double)(float)A(i));
+
+    // Random floats over the whole range
+    Tensor<float> D({size});
+
+    for (size_t i = 0; i < size; ++i) {
+        const uint32_t bits = (uint32_t)Random::mtRand();
+        std::memcpy(&D(i), &bits, sizeof(bits));
+    }
+
+    D(0) = 0.0f;
+
+    const Tensor<half_float::half> E = tensor_cast<half_float::half>(D);
+
+    for (size_t i = 0; i < size; ++i) {
+        const half_float::half ref(D(i));
+        ASSERT_TRUE(std::memcmp(&E(i), &ref, sizeof(ref)) == 0);
+    }
+
+    // Integer conversions
+    Tensor<half_float::half> H({size});
+
+    for (size_t i = 0; i < size; ++i)
+        H(i) = half_float::half((float)Random::randUniform(-30000.0, 30000.0));
+
+    const Tensor<int16_t> F = tensor_cast<int16_t>(H);
+    const Tensor<half_float::half> G = tensor_cast<half_float::half>(F);
+
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQUALS(F(i), (int16_t)(float)H(i));
+        ASSERT_TRUE(G(i) == half_float::half((float)F(i)));
+    }
+}
+
+TEST(Tensor4d, tensor_cast_cache_generation)
+{
+    DataTensor<half_float::half> cache(4);
+
+    {
+        const Tensor<float> A({4}, 1.0);
+        tensor_cast_data<false>(A, cache);
+        ASSERT_EQUALS(((const DataTensor<half_float::half>&)cache)()[0],
+                      half_float::half(1.0f));
+    }
+
+    // B data is likely allocated at the address of the freed A data, with
+    // the same version number: the cache must still be converted again.
+    const Tensor<float> B({4}, 2.0);
+    tensor_cast_data<false>(B, cache);
+    ASSERT_EQUALS(((const DataTensor<half_float::half>&)cache)()[0],
+                  half_float::half(2.0f));
+}
+
+TEST(Tensor4d, share)
+{
+    Tensor<float> A({2, 3, 4}, 1.0);
+    Tensor<float> B({6, 4}, 0.0);
+
+    B.share(A);
+
+    // B keeps its own dimensions, but aliases the data of A
+    ASSERT_EQUALS(B.nbDims(), 2U);
+    ASSERT_EQUALS(B.dimX(), 6U);
+    ASSERT_EQUALS(B.dimY(), 4U);
+    ASSERT_TRUE(&B(0) == &A(0));
+    ASSERT_EQUALS(B(5), 1.0);
+
+    A(5) = 3.0;
+    ASSERT_EQUALS(B(5), 3.0);
+
+    B(1, 2) = 4.0;
+    ASSERT_EQUALS(A(1, 0, 2), 4.0);
+
+    // Sub-tensor: the data offset is shared as well
+    Tensor<float> C({2, 3, 4, 2}, 0.0);
+    Tensor<float> C1 = C[1];
+    Tensor<float> D({24});
+
+    D.share(C1);
+    ASSERT_TRUE(&D(0) == &C(0, 0, 0, 1));
+
+    D(23) = 5.0;
+    ASSERT_EQUALS(C(1, 2, 3, 1), 5.0);
+    ASSERT_EQUALS(C(1, 2, 3, 0), 0.0);
+
+    Tensor<float> E({5});
+    ASSERT_THROW(E.share(A), std::runtime_error);
+}
+
+TEST(Tensor4d, share_tensor_cast)
+{
+    Tensor<float> A({4}, 1.0);
+    const Tensor<float> B({4}, 2.0);
+
+    ASSERT_EQUALS(tensor_cast<double>(A)(0), 1.0);
+
+    // The cast of the previous data must not be returned after rebinding
+    A.share(B);
+    ASSERT_EQUALS(tensor_cast<double>(A)(0), 2.0);
+}
+
 RUN_TESTS()
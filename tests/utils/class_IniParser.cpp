@@ -55,4 +55,59 @@ TEST(IniParser, load)
     ASSERT_THROW(iniConfig.currentSection(), std::runtime_error);
 }
 
+TEST(IniParser, cache)
+{
+    const std::string path = "IniParser_cache";
+
+    UnitTest::FileWriteContent("IniParser_cache.in", "[conv1]\n"
+                                                     "NbOutputs=16\n"
+                                                     "Stride=2\n");
+
+    {
+        IniParser iniConfig;
+        iniConfig.setCachePath(path);
+        iniConfig.load("IniParser_cache.in");
+        iniConfig.setCacheValue("Test", "value");
+        iniConfig.saveCache();
+    }
+
+    {
+        IniParser iniConfig;
+        iniConfig.setCachePath(path);
+        iniConfig.load("IniParser_cache.in");
+
+        ASSERT_TRUE(iniConfig.isCached());
+
+        std::string value;
+        ASSERT_TRUE(iniConfig.getCacheValue("Test", value));
+        ASSERT_EQUALS(value, "value");
+
+        iniConfig.currentSection("conv1");
+
+        ASSERT_EQUALS(iniConfig.getProperty<int>("NbOutputs"), 16);
+        // Unread properties are still detected
+        ASSERT_THROW(iniConfig.currentSection(), std::runtime_error);
+    }
+
+    // The cache is invalidated when the file content changes
+    UnitTest::FileWriteContent("IniParser_cache.in", "[conv1]\n"
+                                                     "NbOutputs=32\n"
+                                                     "Stride=2\n");
+
+    {
+        IniParser iniConfig;
+        iniConfig.setCachePath(path);
+        iniConfig.load("IniParser_cache.in");
+
+        ASSERT_TRUE(!iniConfig.isCached());
+
+        std::string value;
+        ASSERT_TRUE(!iniConfig.getCacheValue("Test", value));
+
+        iniConfig.currentSection("conv1");
+
+        ASSERT_EQUALS(iniConfig.getProperty<int>("NbOutputs"), 32);
+    }
+}
+
 RUN_TESTS()
@@ -19,6 +19,7 @@
 */
 
 #include "utils/DSP.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
 
@@ -101,4 +102,188 @@ TEST_DATASET(DSP,
     }
 }
 
+// Reference O(n^2) DFT
+std::vector<std::complex<double> > dft(const std::vector<std::complex<double> >
+                                       & x, bool inverse = false)
+{
+    const unsigned int size = x.size();
+    std::vector<std::complex<double> > y(size, 0.0);
+
+    for (unsigned int k = 0; k < size; ++k) {
+        for (unsigned int n = 0; n < size; ++n) {
+            const double angle = ((inverse) ? 2.0 : -2.0) * M_PI
+                                 * ((unsigned long long)k * n % size) / size;
+            y[k] += x[n] * std::polar(1.0, angle);
+        }
+
+        if (inverse)
+            y[k] /= (double)size;
+    }
+
+    return y;
+}
+
+TEST_DATASET(DSP,
+             FftPlan,
+             (unsigned int size, bool inverse),
+             std::make_tuple(1U, false),
+             std::make_tuple(2U, false),
+             std::make_tuple(4U, false),
+             std::make_tuple(8U, false),
+             std::make_tuple(64U, false),
+             std::make_tuple(512U, false),
+             std::make_tuple(1024U, false),
+             std::make_tuple(3U, false),
+             std::make_tuple(6U, false),
+             std::make_tuple(17U, false),
+             std::make_tuple(100U, false),
+             std::make_tuple(1000U, false),
+             std::make_tuple(8U, true),
+             std::make_tuple(1024U, true),
+             std::make_tuple(17U, true),
+             std::make_tuple(100U, true))
+{
+    Random::mtSeed(0);
+
+    std::vector<std::complex<double> > x(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        x[i] = std::complex<double>(Random::randUniform(-1.0, 1.0),
+                                    Random::randUniform(-1.0, 1.0));
+    }
+
+    const std::vector<std::complex<double> > yRef = dft(x, inverse);
+
+    DSP::FftPlan<double> plan(size, inverse);
+    plan.execute(x);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        ASSERT_EQUALS_DELTA(x[i].real(), yRef[i].real(), 1.0e-9);
+        ASSERT_EQUALS_DELTA(x[i].imag(), yRef[i].imag(), 1.0e-9);
+    }
+
+    // Round trip, in single precision
+    std::vector<std::complex<float> > xf(size);
+
+    for (unsigned int i = 0; i < size; ++i)
+        xf[i] = std::complex<float>(yRef[i]);
+
+    DSP::getFftPlan<float>(size, !inverse).execute(xf);
+    DSP::getFftPlan<float>(size, inverse).execute(xf);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        ASSERT_EQUALS_DELTA(xf[i].real(), yRef[i].real(), 1.0e-4);
+        ASSERT_EQUALS_DELTA(xf[i].imag(), yRef[i].imag(), 1.0e-4);
+    }
+}
+
+TEST_DATASET(DSP,
+             rfft,
+             (unsigned int size),
+             std::make_tuple(1U),
+             std::make_tuple(2U),
+             std::make_tuple(4U),
+             std::make_tuple(7U),
+             std::make_tuple(8U),
+             std::make_tuple(30U),
+             std::make_tuple(256U),
+             std::make_tuple(2048U))
+{
+    Random::mtSeed(0);
+
+    std::vector<double> x(size);
+
+    for (unsigned int i = 0; i < size; ++i)
+        x[i] = Random::randUniform(-1.0, 1.0);
+
+    const std::vector<std::complex<double> > yRef = dft(DSP::toComplex(x));
+    const std::vector<std::complex<double> > y = DSP::rfft(x);
+
+    ASSERT_EQUALS(y.size(), size / 2 + 1);
+
+    for (unsigned int i = 0; i < y.size(); ++i) {
+        ASSERT_EQUALS_DELTA(y[i].real(), yRef[i].real(), 1.0e-9);
+        ASSERT_EQUALS_DELTA(y[i].imag(), yRef[i].imag(), 1.0e-9);
+    }
+}
+
+TEST_DATASET(DSP,
+             fft2,
+             (unsigned int width, unsigned int height),
+             std::make_tuple(1U, 1U),
+             std::make_tuple(8U, 4U),
+             std::make_tuple(5U, 12U),
+             std::make_tuple(32U, 24U))
+{
+    Random::mtSeed(0);
+
+    std::vector<std::complex<double> > x(width * height);
+
+    for (unsigned int i = 0; i < x.size(); ++i)
+        x[i] = Random::randUniform(-1.0, 1.0);
+
+    const std::vector<std::complex<double> > x0 = x;
+
+    DSP::fft2(x, width, height);
+
+    for (unsigned int k = 0; k < height; ++k) {
+        for (unsigned int l = 0; l < width; ++l) {
+            std::complex<double> yRef = 0.0;
+
+            for (unsigned int i = 0; i < height; ++i) {
+                for (unsigned int j = 0; j < width; ++j) {
+                    yRef += x0[i * width + j] * std::polar(1.0,
+                        -2.0 * M_PI * ((k * i) / (double)height
+                                       + (l * j) / (double)width));
+                }
+            }
+
+            ASSERT_EQUALS_DELTA(x[k * width + l].real(), yRef.real(), 1.0e-9);
+            ASSERT_EQUALS_DELTA(x[k * width + l].imag(), yRef.imag(), 1.0e-9);
+        }
+    }
+
+    DSP::fft2(x, width, height, true);
+
+    for (unsigned int i = 0; i < x.size(); ++i) {
+        ASSERT_EQUALS_DELTA(x[i].real(), x0[i].real(), 1.0e-9);
+        ASSERT_EQUALS_DELTA(x[i].imag(), x0[i].imag(), 1.0e-9);
+    }
+}
+
+TEST(DSP, stft)
+{
+    Random::mtSeed(0);
+
+    std::vector<double> x(1000);
+
+    for (unsigned int i = 0; i < x.size(); ++i)
+        x[i] = Random::randUniform(-1.0, 1.0);
+
+    const unsigned int nFft = 64;
+    const std::vector<std::vector<std::complex<double> > > y
+        = DSP::stft(x, nFft);
+    const std::vector<double> w = Hann<double>()(nFft);
+
+    ASSERT_EQUALS(y.size(), nFft);
+
+    // Frame t is centered on t * nFft/2, and rotated for zero phase
+    for (unsigned int t = 2; t < y[0].size() - 2; ++t) {
+        std::vector<std::complex<double> > frame(nFft);
+        const int offset = -((int)nFft / 2) + t * nFft / 2;
+
+        for (unsigned int n = 0; n < nFft; ++n)
+            frame[n] = x[offset + n] * w[n];
+
+        std::rotate(frame.begin(), frame.begin() + nFft / 2, frame.end());
+
+        const std::vector<std::complex<double> > yRef = dft(frame);
+
+        for (unsigned int f = 0; f < nFft; ++f) {
+            ASSERT_EQUALS_DELTA(y[f][t].real(), yRef[f].real(), 1.0e-9);
+            ASSERT_EQUALS_DELTA(y[f][t].imag(), yRef[f].imag(), 1.0e-9);
+        }
+    }
+}
+
 RUN_TESTS()